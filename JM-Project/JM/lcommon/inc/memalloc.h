@@ -23,6 +23,37 @@
 #include "lagrangian.h"
 #include "quant_params.h"
 
+#define MEM_ARENA_ALIGNMENT   64          //!< alignment of the arena allocations (cache line)
+#define MEM_ARENA_BLOCK_SIZE  (64 * 1024) //!< smallest block an arena takes from the heap
+#define MEM_PLANE_ALIGNMENT   64          //!< alignment of pel (0, 0) of the padded planes (cache line)
+
+//! Counters of an arena, kept from its creation
+typedef struct mem_arena_stats
+{
+  int64 allocs;        //!< allocations served
+  int64 blocks;        //!< blocks taken from the heap
+  int64 resets;        //!< resets
+  int64 peak;          //!< most bytes handed out between two resets
+} MemArenaStats;
+
+//! block of an arena
+typedef struct mem_arena_block
+{
+  struct mem_arena_block *next;
+  size_t  size;        //!< bytes of data
+  size_t  used;        //!< bytes of data handed out
+  byte   *data;        //!< MEM_ARENA_ALIGNMENT aligned
+} MemArenaBlock;
+
+//! Arena: allocations are only released all together, by reset_mem_arena()
+typedef struct mem_arena
+{
+  MemArenaBlock *blocks;   //!< the block allocations are taken from, followed by the full ones
+  size_t  reserved;        //!< bytes of data of all blocks
+  size_t  in_use;          //!< bytes handed out since the last reset
+  MemArenaStats stats;
+} MemArena;
+
 extern int  get_mem2Ddist(DistortionData ***array2D, int dim0, int dim1);
 
 extern int  get_mem2Dlm  (LambdaParams ***array2D, int dim0, int dim1);
@@ -183,6 +214,26 @@ extern int  malloc_mem3Dpel_2SLayers(imgpel ****buf0, int imgtype0, imgpel ****b
 extern void free_mem2Dpel_2SLayers(imgpel ***buf0, imgpel ***buf1);
 extern void free_mem3Dpel_2SLayers(imgpel ****buf0, imgpel ****buf1);
 
+extern MemArena *new_mem_arena  (void);
+extern void  free_mem_arena     (MemArena *arena);
+extern void  reset_mem_arena    (MemArena *arena);
+extern void *mem_arena_alloc    (MemArena *arena, size_t size);
+extern void  add_mem_arena_stats(MemArenaStats *sum, MemArena *arena);
+
+extern int  get_mem2D_arena   (MemArena *arena, byte ***array2D, int dim0, int dim1);
+extern int  get_mem3D_arena   (MemArena *arena, byte ****array3D, int dim0, int dim1, int dim2);
+extern int  get_mem2Dint_arena(MemArena *arena, int ***array2D, int dim0, int dim1);
+extern int  get_mem3Dint_arena(MemArena *arena, int ****array3D, int dim0, int dim1, int dim2);
+extern int  get_mem4Dint_arena(MemArena *arena, int *****array4D, int dim0, int dim1, int dim2, int dim3);
+extern int  get_mem2Dpel_arena(MemArena *arena, imgpel ***array2D, int dim0, int dim1);
+extern int  get_mem3Dpel_arena(MemArena *arena, imgpel ****array3D, int dim0, int dim1, int dim2);
+extern int  get_mem4Dpel_arena(MemArena *arena, imgpel *****array4D, int dim0, int dim1, int dim2, int dim3);
+extern int  get_mem2Dmv_arena (MemArena *arena, MotionVector ***array2D, int dim0, int dim1);
+extern int  get_mem3Dmv_arena (MemArena *arena, MotionVector ****array3D, int dim0, int dim1, int dim2);
+extern int  get_mem4Dmv_arena (MemArena *arena, MotionVector *****array4D, int dim0, int dim1, int dim2, int dim3);
+extern int  get_mem5Dmv_arena (MemArena *arena, MotionVector ******array5D, int dim0, int dim1, int dim2, int dim3, int dim4);
+extern int  get_mem6Dmv_arena (MemArena *arena, MotionVector *******array6D, int dim0, int dim1, int dim2, int dim3, int dim4, int dim5);
+
 
 static inline void* mem_malloc(size_t nitems)
 {
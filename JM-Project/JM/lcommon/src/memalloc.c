@@ -883,24 +883,29 @@ int get_mem2Dpel_pad(imgpel ***array2D, int dim0, int dim1, int iPadY, int iPadX
   int i;
   imgpel *curr = NULL;
   int iHeight, iWidth;
+  size_t origin;
   
   iHeight = dim0+2*iPadY;
   iWidth = dim1+2*iPadX;
-  if((*array2D    = (imgpel**)mem_malloc(iHeight*sizeof(imgpel*))) == NULL)
+  origin = (iPadY * iWidth + iPadX) * sizeof(imgpel);
+
+  // the row pointers are preceded by the pointer to the allocated data,
+  // which start up to MEM_PLANE_ALIGNMENT bytes before the padded plane
+  if((*array2D    = (imgpel**)mem_malloc((iHeight + 1)*sizeof(imgpel*))) == NULL)
     no_mem_exit("get_mem2Dpel_pad: array2D");
-  if((*(*array2D) = (imgpel* )mem_calloc(iHeight * iWidth, sizeof(imgpel ))) == NULL)
+  if((*(*array2D) = (imgpel* )mem_calloc(iHeight * iWidth * sizeof(imgpel) + MEM_PLANE_ALIGNMENT, 1)) == NULL)
     no_mem_exit("get_mem2Dpel_pad: array2D");
 
-  (*array2D)[0] += iPadX;
-  curr = (*array2D)[0];
-  for(i = 1 ; i < iHeight; i++)
+  // pel (0, 0) is MEM_PLANE_ALIGNMENT aligned
+  curr = (imgpel *) ((((size_t) (*array2D)[0] + origin + MEM_PLANE_ALIGNMENT - 1) & ~((size_t) MEM_PLANE_ALIGNMENT - 1)) - origin);
+  (*array2D)[1] = curr + iPadX;
+  for(i = 2 ; i <= iHeight; i++)
   {
-    curr += iWidth;
-    (*array2D)[i] = curr;
+    (*array2D)[i] = (*array2D)[i - 1] + iWidth;
   }
-  (*array2D) = &((*array2D)[iPadY]);
+  (*array2D) = &((*array2D)[iPadY + 1]);
 
-  return iHeight * (sizeof(imgpel*) + iWidth * sizeof(imgpel));
+  return (iHeight + 1) * sizeof(imgpel*) + iHeight * iWidth * sizeof(imgpel) + MEM_PLANE_ALIGNMENT;
 }
 
 
@@ -1070,12 +1075,12 @@ void free_mem2Dpel_pad(imgpel **array2D, int iPadY, int iPadX)
   {
     if (*array2D)
     {
-      mem_free (array2D[-iPadY]-iPadX);
+      mem_free (array2D[-iPadY - 1]);
     }
     else 
       error ("free_mem2Dpel_pad: trying to free unused memory",100);
 
-    mem_free (&array2D[-iPadY]);
+    mem_free (&array2D[-iPadY - 1]);
   } 
   else
   {
@@ -2720,3 +2725,435 @@ void free_mem2Ddistblk(distblk **array2D)
     error ("free_mem2Ddistblk: trying to free unused memory",100);
   }
 }
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Takes a block of at least size bytes from the heap for an arena
+ ************************************************************************
+ */
+static MemArenaBlock *new_mem_arena_block(MemArena *arena, size_t size)
+{
+  MemArenaBlock *block;
+
+  if ((block = (MemArenaBlock *) malloc(sizeof(MemArenaBlock) + size + MEM_ARENA_ALIGNMENT)) == NULL)
+    no_mem_exit("new_mem_arena_block: block");
+
+  block->data = (byte *) (((size_t) (block + 1) + MEM_ARENA_ALIGNMENT - 1) & ~((size_t) MEM_ARENA_ALIGNMENT - 1));
+  block->size = size;
+  block->used = 0;
+  block->next = arena->blocks;
+  arena->blocks    = block;
+  arena->reserved += size;
+  arena->stats.blocks++;
+
+  return block;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocates an empty arena. Its blocks are taken from the heap as
+ *    the allocations need them.
+ ************************************************************************
+ */
+MemArena *new_mem_arena(void)
+{
+  MemArena *arena;
+
+  if ((arena = (MemArena *) calloc(1, sizeof(MemArena))) == NULL)
+    no_mem_exit("new_mem_arena: arena");
+
+  return arena;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Frees an arena and all memory allocated from it
+ ************************************************************************
+ */
+void free_mem_arena(MemArena *arena)
+{
+  MemArenaBlock *block, *next;
+
+  if (arena == NULL)
+    return;
+
+  for (block = arena->blocks; block != NULL; block = next)
+  {
+    next = block->next;
+    free(block);
+  }
+  free(arena);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Releases all memory allocated from an arena, keeping its blocks.
+ *    An arena that needed several blocks gets a single block holding
+ *    them all, so that the same allocations do not reach the heap again.
+ ************************************************************************
+ */
+void reset_mem_arena(MemArena *arena)
+{
+  MemArenaBlock *block, *next;
+
+  if (arena->blocks != NULL && arena->blocks->next != NULL)
+  {
+    size_t reserved = arena->reserved;
+
+    for (block = arena->blocks; block != NULL; block = next)
+    {
+      next = block->next;
+      free(block);
+    }
+    arena->blocks   = NULL;
+    arena->reserved = 0;
+    new_mem_arena_block(arena, reserved);
+  }
+  if (arena->blocks != NULL)
+    arena->blocks->used = 0;
+
+  arena->in_use = 0;
+  arena->stats.resets++;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocates size bytes from an arena, set to 0 and aligned at
+ *    MEM_ARENA_ALIGNMENT
+ ************************************************************************
+ */
+void *mem_arena_alloc(MemArena *arena, size_t size)
+{
+  MemArenaBlock *block = arena->blocks;
+  void *d;
+
+  size = (size + MEM_ARENA_ALIGNMENT - 1) & ~((size_t) MEM_ARENA_ALIGNMENT - 1);
+
+  if (block == NULL || block->used + size > block->size)
+    block = new_mem_arena_block(arena, size > MEM_ARENA_BLOCK_SIZE ? size : MEM_ARENA_BLOCK_SIZE);
+
+  d = block->data + block->used;
+  block->used += size;
+  memset(d, 0, size);
+
+  arena->in_use += size;
+  arena->stats.allocs++;
+  if ((int64) arena->in_use > arena->stats.peak)
+    arena->stats.peak = arena->in_use;
+
+  return d;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Adds the counters of an arena to sum (the peaks are added, giving
+ *    the bytes the arenas hold at most)
+ ************************************************************************
+ */
+void add_mem_arena_stats(MemArenaStats *sum, MemArena *arena)
+{
+  sum->allocs += arena->stats.allocs;
+  sum->blocks += arena->stats.blocks;
+  sum->resets += arena->stats.resets;
+  sum->peak   += arena->stats.peak;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate 2D memory array -> unsigned char array2D[dim0][dim1]
+ *    from an arena
+ *
+ * \par Output:
+ *    memory size in bytes
+ ************************************************************************/
+int get_mem2D_arena(MemArena *arena, byte ***array2D, int dim0, int dim1)
+{
+  int i;
+
+  *array2D    = (byte**) mem_arena_alloc(arena, dim0 * sizeof(byte*));
+  *(*array2D) = (byte* ) mem_arena_alloc(arena, dim0 * dim1 * sizeof(byte));
+
+  for(i = 1 ; i < dim0; i++)
+    (*array2D)[i] = (*array2D)[i-1] + dim1;
+
+  return dim0 * (sizeof(byte*) + dim1 * sizeof(byte));
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate 3D memory array -> unsigned char array3D[dim0][dim1][dim2]
+ *    from an arena
+ *
+ * \par Output:
+ *    memory size in bytes
+ ************************************************************************/
+int get_mem3D_arena(MemArena *arena, byte ****array3D, int dim0, int dim1, int dim2)
+{
+  int  i, mem_size = dim0 * sizeof(byte**);
+
+  *array3D = (byte***) mem_arena_alloc(arena, dim0 * sizeof(byte**));
+
+  mem_size += get_mem2D_arena(arena, *array3D, dim0 * dim1, dim2);
+
+  for(i = 1; i < dim0; i++)
+    (*array3D)[i] =  (*array3D)[i-1] + dim1;
+
+  return mem_size;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate 2D memory array -> int array2D[dim0][dim1] from an arena
+ *
+ * \par Output:
+ *    memory size in bytes
+ ************************************************************************/
+int get_mem2Dint_arena(MemArena *arena, int ***array2D, int dim0, int dim1)
+{
+  int i;
+
+  *array2D    = (int**) mem_arena_alloc(arena, dim0 * sizeof(int*));
+  *(*array2D) = (int* ) mem_arena_alloc(arena, dim0 * dim1 * sizeof(int));
+
+  for(i = 1 ; i < dim0; i++)
+    (*array2D)[i] = (*array2D)[i-1] + dim1;
+
+  return dim0 * (sizeof(int*) + dim1 * sizeof(int));
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate 3D memory array -> int array3D[dim0][dim1][dim2] from an
+ *    arena
+ *
+ * \par Output:
+ *    memory size in bytes
+ ************************************************************************/
+int get_mem3Dint_arena(MemArena *arena, int ****array3D, int dim0, int dim1, int dim2)
+{
+  int  i, mem_size = dim0 * sizeof(int**);
+
+  *array3D = (int***) mem_arena_alloc(arena, dim0 * sizeof(int**));
+
+  mem_size += get_mem2Dint_arena(arena, *array3D, dim0 * dim1, dim2);
+
+  for(i = 1; i < dim0; i++)
+    (*array3D)[i] =  (*array3D)[i-1] + dim1;
+
+  return mem_size;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate 4D memory array -> int array4D[dim0][dim1][dim2][dim3]
+ *    from an arena
+ *
+ * \par Output:
+ *    memory size in bytes
+ ************************************************************************/
+int get_mem4Dint_arena(MemArena *arena, int *****array4D, int dim0, int dim1, int dim2, int dim3)
+{
+  int  i, mem_size = dim0 * sizeof(int***);
+
+  *array4D = (int****) mem_arena_alloc(arena, dim0 * sizeof(int***));
+
+  mem_size += get_mem3Dint_arena(arena, *array4D, dim0 * dim1, dim2, dim3);
+
+  for(i = 1; i < dim0; i++)
+    (*array4D)[i] =  (*array4D)[i-1] + dim1;
+
+  return mem_size;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate 2D memory array -> imgpel array2D[dim0][dim1] from an
+ *    arena
+ *
+ * \par Output:
+ *    memory size in bytes
+ ************************************************************************/
+int get_mem2Dpel_arena(MemArena *arena, imgpel ***array2D, int dim0, int dim1)
+{
+  int i;
+
+  *array2D    = (imgpel**) mem_arena_alloc(arena, dim0 * sizeof(imgpel*));
+  *(*array2D) = (imgpel* ) mem_arena_alloc(arena, dim0 * dim1 * sizeof(imgpel));
+
+  for(i = 1 ; i < dim0; i++)
+    (*array2D)[i] = (*array2D)[i-1] + dim1;
+
+  return dim0 * (sizeof(imgpel*) + dim1 * sizeof(imgpel));
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate 3D memory array -> imgpel array3D[dim0][dim1][dim2] from
+ *    an arena
+ *
+ * \par Output:
+ *    memory size in bytes
+ ************************************************************************/
+int get_mem3Dpel_arena(MemArena *arena, imgpel ****array3D, int dim0, int dim1, int dim2)
+{
+  int i, mem_size = dim0 * sizeof(imgpel**);
+
+  *array3D = (imgpel***) mem_arena_alloc(arena, dim0 * sizeof(imgpel**));
+
+  mem_size += get_mem2Dpel_arena(arena, *array3D, dim0 * dim1, dim2);
+
+  for(i = 1; i < dim0; i++)
+    (*array3D)[i] = (*array3D)[i - 1] + dim1;
+
+  return mem_size;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate 4D memory array -> imgpel array4D[dim0][dim1][dim2][dim3]
+ *    from an arena
+ *
+ * \par Output:
+ *    memory size in bytes
+ ************************************************************************/
+int get_mem4Dpel_arena(MemArena *arena, imgpel *****array4D, int dim0, int dim1, int dim2, int dim3)
+{
+  int  i, mem_size = dim0 * sizeof(imgpel***);
+
+  *array4D = (imgpel****) mem_arena_alloc(arena, dim0 * sizeof(imgpel***));
+
+  mem_size += get_mem3Dpel_arena(arena, *array4D, dim0 * dim1, dim2, dim3);
+
+  for(i = 1; i < dim0; i++)
+    (*array4D)[i] = (*array4D)[i - 1] + dim1;
+
+  return mem_size;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate 2D memory array -> MotionVector array2D[dim0][dim1] from
+ *    an arena
+ *
+ * \par Output:
+ *    memory size in bytes
+ ************************************************************************/
+int get_mem2Dmv_arena(MemArena *arena, MotionVector ***array2D, int dim0, int dim1)
+{
+  int i;
+
+  *array2D    = (MotionVector**) mem_arena_alloc(arena, dim0 * sizeof(MotionVector*));
+  *(*array2D) = (MotionVector* ) mem_arena_alloc(arena, dim0 * dim1 * sizeof(MotionVector));
+
+  for(i = 1 ; i < dim0; i++)
+    (*array2D)[i] = (*array2D)[i-1] + dim1;
+
+  return dim0 * (sizeof(MotionVector*) + dim1 * sizeof(MotionVector));
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate 3D memory array -> MotionVector array3D[dim0][dim1][dim2]
+ *    from an arena
+ *
+ * \par Output:
+ *    memory size in bytes
+ ************************************************************************/
+int get_mem3Dmv_arena(MemArena *arena, MotionVector ****array3D, int dim0, int dim1, int dim2)
+{
+  int i, mem_size = dim0 * sizeof(MotionVector**);
+
+  *array3D = (MotionVector***) mem_arena_alloc(arena, dim0 * sizeof(MotionVector**));
+
+  mem_size += get_mem2Dmv_arena(arena, *array3D, dim0 * dim1, dim2);
+
+  for(i = 1; i < dim0; i++)
+    (*array3D)[i] = (*array3D)[i - 1] + dim1;
+
+  return mem_size;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate 4D memory array -> MotionVector array4D[dim0][dim1][dim2][dim3]
+ *    from an arena
+ *
+ * \par Output:
+ *    memory size in bytes
+ ************************************************************************/
+int get_mem4Dmv_arena(MemArena *arena, MotionVector *****array4D, int dim0, int dim1, int dim2, int dim3)
+{
+  int i, mem_size = dim0 * sizeof(MotionVector***);
+
+  *array4D = (MotionVector****) mem_arena_alloc(arena, dim0 * sizeof(MotionVector***));
+
+  mem_size += get_mem3Dmv_arena(arena, *array4D, dim0 * dim1, dim2, dim3);
+
+  for(i = 1; i < dim0; i++)
+    (*array4D)[i] = (*array4D)[i - 1] + dim1;
+
+  return mem_size;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate 5D memory array -> MotionVector array5D[dim0][dim1][dim2][dim3][dim4]
+ *    from an arena
+ *
+ * \par Output:
+ *    memory size in bytes
+ ************************************************************************/
+int get_mem5Dmv_arena(MemArena *arena, MotionVector ******array5D, int dim0, int dim1, int dim2, int dim3, int dim4)
+{
+  int i, mem_size = dim0 * sizeof(MotionVector****);
+
+  *array5D = (MotionVector*****) mem_arena_alloc(arena, dim0 * sizeof(MotionVector****));
+
+  mem_size += get_mem4Dmv_arena(arena, *array5D, dim0 * dim1, dim2, dim3, dim4);
+
+  for(i = 1; i < dim0; i++)
+    (*array5D)[i] = (*array5D)[i - 1] + dim1;
+
+  return mem_size;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate 6D memory array -> MotionVector array6D[dim0][dim1][dim2][dim3][dim4][dim5]
+ *    from an arena
+ *
+ * \par Output:
+ *    memory size in bytes
+ ************************************************************************/
+int get_mem6Dmv_arena(MemArena *arena, MotionVector *******array6D, int dim0, int dim1, int dim2, int dim3, int dim4, int dim5)
+{
+  int i, mem_size = dim0 * sizeof(MotionVector*****);
+
+  *array6D = (MotionVector******) mem_arena_alloc(arena, dim0 * sizeof(MotionVector*****));
+
+  mem_size += get_mem5Dmv_arena(arena, *array6D, dim0 * dim1, dim2, dim3, dim4, dim5);
+
+  for(i = 1; i < dim0; i++)
+    (*array6D)[i] = (*array6D)[i - 1] + dim1;
+
+  return mem_size;
+}
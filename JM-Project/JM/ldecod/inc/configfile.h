@@ -52,6 +52,7 @@ Mapping Map[] = {
 #endif
     {"DPBPLUS0",                 &cfgparams.dpb_plus[0],                  0,   1.0,                       1,  -16.0,            16.0,                             },
     {"DPBPLUS1",                 &cfgparams.dpb_plus[1],                  0,   0.0,                       1,  -16.0,            16.0,                             },
+    {"PicturePool",              &cfgparams.PicturePool,                  0,   0.0,                       1,  0.0,              1.0,                             },
     {NULL,                       NULL,                                   -1,   0.0,                       0,  0.0,              0.0,                             },
 };
 #endif
@@ -950,6 +950,7 @@ typedef struct video_par
 /******************* end deprecative variables; ***************************************/
 
   struct dec_stat_parameters *dec_stats;
+  struct pic_pool *p_PicPool;                //!< PicturePool: pictures freed for reuse
 } VideoParameters;
 
 
@@ -1016,6 +1017,7 @@ typedef struct inp_par
 
   int bDisplayDecParams;
   int dpb_plus[2];
+  int PicturePool;                      //!< Keep the freed pictures for reuse by pictures of the same size and layout
 } InputParameters;
 
 typedef struct old_slice_par
@@ -24,6 +24,7 @@
 #include "global.h"
 
 #define MAX_LIST_SIZE 33
+#define PIC_POOL_SIZE 32   //!< pictures kept at most by the picture pool (PicturePool)
 //! definition of pic motion parameters
 typedef struct pic_motion_params_old
 {
@@ -131,10 +132,18 @@ typedef struct storable_picture
   char listXsize[MAX_NUM_SLICES][2];
   struct storable_picture **listX[MAX_NUM_SLICES][2];
   int         layer_id;
+  struct pic_pool *pool;      //!< PicturePool: pool the picture is freed to, its motion info is kept when unmarked
 } StorablePicture;
 
 typedef StorablePicture *StorablePicturePtr;
 
+//! Pictures freed by free_storable_picture() kept for alloc_storable_picture() (PicturePool)
+typedef struct pic_pool
+{
+  int               size;                 //!< pictures in the pool
+  StorablePicture  *pic[PIC_POOL_SIZE];
+} PicPool;
+
 //! Frame Stores for Decoded Picture Buffer
 typedef struct frame_store
 {
@@ -208,6 +217,8 @@ extern FrameStore*       alloc_frame_store(void);
 extern void              free_frame_store (FrameStore* f);
 extern StorablePicture*  alloc_storable_picture(VideoParameters *p_Vid, PictureStructure type, int size_x, int size_y, int size_x_cr, int size_y_cr, int is_output);
 extern void              free_storable_picture (StorablePicture* p);
+extern void              init_pic_pool         (VideoParameters *p_Vid);
+extern void              free_pic_pool         (VideoParameters *p_Vid);
 extern void              store_picture_in_dpb(DecodedPictureBuffer *p_Dpb, StorablePicture* p);
 extern StorablePicture*  get_short_term_pic (Slice *currSlice, DecodedPictureBuffer *p_Dpb, int picNum);
 
@@ -297,6 +297,9 @@ static void free_img( VideoParameters *p_Vid)
     free (p_Vid->dec_stats);
 #endif
 
+    // after the DPB and the output buffer
+    free_pic_pool(p_Vid);
+
     free (p_Vid);
     p_Vid = NULL;
   }
@@ -1141,6 +1144,8 @@ int OpenDecoder(InputParameters *p_Inp)
   pDecoder->p_Vid->conceal_mode = p_Inp->conceal_mode;
   pDecoder->p_Vid->ref_poc_gap = p_Inp->ref_poc_gap;
   pDecoder->p_Vid->poc_gap = p_Inp->poc_gap;
+  if (p_Inp->PicturePool)
+    init_pic_pool(pDecoder->p_Vid);
 #if TRACE
   if ((pDecoder->p_trace = fopen(TRACEFILE,"w"))==0)             // append new statistic at the end
   {
@@ -505,6 +505,66 @@ void alloc_pic_motion(PicMotionParamsOld *motion, int size_y, int size_x)
     no_mem_exit("alloc_storable_picture: motion->mb_field");
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Takes from the picture pool a picture of this size and of the
+ *    layout of the active SPS, or returns NULL if there is none.
+ *    Only the buffers of the picture are kept, the motion info cleared
+ *    as calloc() does for a new picture. The planes are written before
+ *    they are read.
+ ************************************************************************
+ */
+static StorablePicture *get_pooled_picture(VideoParameters *p_Vid, int size_x, int size_y, int size_x_cr, int size_y_cr)
+{
+  PicPool *pool = p_Vid->p_PicPool;
+  StorablePicture *s, b;
+  int blk_y = size_y >> BLOCK_SHIFT, blk_x = size_x >> BLOCK_SHIFT;
+  int i, nplane;
+
+  // most recently freed first
+  for (i = pool->size - 1; i >= 0; --i)
+  {
+    s = pool->pic[i];
+    if (s->size_x == size_x && s->size_y == size_y && s->size_x_cr == size_x_cr && s->size_y_cr == size_y_cr
+      && s->iLumaPadY == p_Vid->iLumaPadY && s->iLumaPadX == p_Vid->iLumaPadX
+      && s->iChromaPadY == p_Vid->iChromaPadY && s->iChromaPadX == p_Vid->iChromaPadX
+      && (s->imgUV != NULL) == (p_Vid->active_sps->chroma_format_idc != YUV400)
+      && (s->JVmv_info[0] != NULL) == (p_Vid->separate_colour_plane_flag != 0))
+      break;
+  }
+  if (i < 0)
+    return NULL;
+
+  for (--pool->size; i < pool->size; ++i)
+    pool->pic[i] = pool->pic[i + 1];
+
+  b = *s;
+  memset(s, 0, sizeof(StorablePicture));
+  s->imgY    = b.imgY;
+  s->imgUV   = b.imgUV;
+  s->mv_info = b.mv_info;
+  s->motion  = b.motion;
+  for (nplane = 0; nplane < MAX_PLANE; nplane++)
+  {
+    s->JVmv_info[nplane] = b.JVmv_info[nplane];
+    s->JVmotion[nplane]  = b.JVmotion[nplane];
+  }
+
+  memset(s->mv_info[0], 0, blk_y * blk_x * sizeof(PicMotionParams));
+  memset(s->motion.mb_field, 0, blk_y * blk_x * sizeof(byte));
+  for (nplane = 0; nplane < MAX_PLANE; nplane++)
+  {
+    if (s->JVmv_info[nplane])
+    {
+      memset(s->JVmv_info[nplane][0], 0, blk_y * blk_x * sizeof(PicMotionParams));
+      memset(s->JVmotion[nplane].mb_field, 0, blk_y * blk_x * sizeof(byte));
+    }
+  }
+
+  return s;
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -531,33 +591,52 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
 {
   seq_parameter_set_rbsp_t *active_sps = p_Vid->active_sps;  
 
-  StorablePicture *s;
+  StorablePicture *s = NULL;
   int   nplane;
 
   //printf ("Allocating (%s) picture (x=%d, y=%d, x_cr=%d, y_cr=%d)\n", (type == FRAME)?"FRAME":(type == TOP_FIELD)?"TOP_FIELD":"BOTTOM_FIELD", size_x, size_y, size_x_cr, size_y_cr);
 
-  s = calloc (1, sizeof(StorablePicture));
-  if (NULL==s)
-    no_mem_exit("alloc_storable_picture: s");
-
   if (structure!=FRAME)
   {
     size_y    /= 2;
     size_y_cr /= 2;
   }
 
-  s->PicSizeInMbs = (size_x*size_y)/256;
-  s->imgUV = NULL;
-
-  get_mem2Dpel_pad (&(s->imgY), size_y, size_x, p_Vid->iLumaPadY, p_Vid->iLumaPadX);
-  s->iLumaStride = size_x+2*p_Vid->iLumaPadX;
-  s->iLumaExpandedHeight = size_y+2*p_Vid->iLumaPadY;
+  if (p_Vid->p_PicPool != NULL)
+  {
+    s = get_pooled_picture(p_Vid, size_x, size_y, size_x_cr, size_y_cr);
+  }
 
-  if (active_sps->chroma_format_idc != YUV400)
+  if (s == NULL)
   {
-    get_mem3Dpel_pad(&(s->imgUV), 2, size_y_cr, size_x_cr, p_Vid->iChromaPadY, p_Vid->iChromaPadX);
+    s = calloc (1, sizeof(StorablePicture));
+    if (NULL==s)
+      no_mem_exit("alloc_storable_picture: s");
+
+    get_mem2Dpel_pad (&(s->imgY), size_y, size_x, p_Vid->iLumaPadY, p_Vid->iLumaPadX);
+    if (active_sps->chroma_format_idc != YUV400)
+    {
+      get_mem3Dpel_pad(&(s->imgUV), 2, size_y_cr, size_x_cr, p_Vid->iChromaPadY, p_Vid->iChromaPadX);
+    }
+
+    get_mem2Dmp     ( &s->mv_info, (size_y >> BLOCK_SHIFT), (size_x >> BLOCK_SHIFT));
+    alloc_pic_motion( &s->motion , (size_y >> BLOCK_SHIFT), (size_x >> BLOCK_SHIFT));
+
+    if( (p_Vid->separate_colour_plane_flag != 0) )
+    {
+      for( nplane=0; nplane<MAX_PLANE; nplane++ )
+      {
+        get_mem2Dmp      (&s->JVmv_info[nplane], (size_y >> BLOCK_SHIFT), (size_x >> BLOCK_SHIFT));
+        alloc_pic_motion(&s->JVmotion[nplane] , (size_y >> BLOCK_SHIFT), (size_x >> BLOCK_SHIFT));
+      }
+    }
   }
+  s->pool = p_Vid->p_PicPool;
 
+  s->PicSizeInMbs = (size_x*size_y)/256;
+
+  s->iLumaStride = size_x+2*p_Vid->iLumaPadX;
+  s->iLumaExpandedHeight = size_y+2*p_Vid->iLumaPadY;
   s->iChromaStride =size_x_cr + 2*p_Vid->iChromaPadX;
   s->iChromaExpandedHeight = size_y_cr + 2*p_Vid->iChromaPadY;
   s->iLumaPadY   = p_Vid->iLumaPadY;
@@ -567,18 +646,6 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
 
   s->separate_colour_plane_flag = p_Vid->separate_colour_plane_flag;
 
-  get_mem2Dmp     ( &s->mv_info, (size_y >> BLOCK_SHIFT), (size_x >> BLOCK_SHIFT));
-  alloc_pic_motion( &s->motion , (size_y >> BLOCK_SHIFT), (size_x >> BLOCK_SHIFT));
-
-  if( (p_Vid->separate_colour_plane_flag != 0) )
-  {
-    for( nplane=0; nplane<MAX_PLANE; nplane++ )
-    {
-      get_mem2Dmp      (&s->JVmv_info[nplane], (size_y >> BLOCK_SHIFT), (size_x >> BLOCK_SHIFT));
-      alloc_pic_motion(&s->JVmotion[nplane] , (size_y >> BLOCK_SHIFT), (size_x >> BLOCK_SHIFT));
-    }
-  }
-
   s->pic_num   = 0;
   s->frame_num = 0;
   s->long_term_frame_idx = 0;
@@ -692,6 +759,29 @@ void free_storable_picture(StorablePicture* p)
   int nplane;
   if (p)
   {
+    PicPool *pool = p->pool;
+
+    // back to the pool, without the memory allocated again with the picture
+    if (pool != NULL && pool->size < PIC_POOL_SIZE)
+    {
+      int i, j;
+      if (p->seiHasTone_mapping)
+        free(p->tone_mapping_lut);
+      for(j = 0; j < MAX_NUM_SLICES; j++)
+      {
+        for(i=0; i<2; i++)
+        {
+          if(p->listX[j][i])
+          {
+            free(p->listX[j][i]);
+            p->listX[j][i] = NULL;
+          }
+        }
+      }
+      pool->pic[pool->size++] = p;
+      return;
+    }
+
     if (p->mv_info)
     {
       free_mem2Dmp(p->mv_info);
@@ -747,6 +837,43 @@ void free_storable_picture(StorablePicture* p)
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Creates the picture pool (PicturePool): the pictures freed are kept
+ *    with their buffers for the next pictures of the same size and layout
+ ************************************************************************
+ */
+void init_pic_pool(VideoParameters *p_Vid)
+{
+  if ((p_Vid->p_PicPool = (PicPool *) calloc(1, sizeof(PicPool))) == NULL)
+    no_mem_exit("init_pic_pool: p_Vid->p_PicPool");
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Frees the picture pool and the pictures in it. The pictures taken
+ *    from the pool must all be freed before.
+ ************************************************************************
+ */
+void free_pic_pool(VideoParameters *p_Vid)
+{
+  PicPool *pool = p_Vid->p_PicPool;
+  int i;
+
+  if (pool == NULL)
+    return;
+
+  for (i = 0; i < pool->size; ++i)
+  {
+    pool->pic[i]->pool = NULL;
+    free_storable_picture(pool->pic[i]);
+  }
+  free(pool);
+  p_Vid->p_PicPool = NULL;
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -782,17 +909,18 @@ void unmark_for_reference(FrameStore* fs)
 
   fs->is_reference = 0;
 
-  if(fs->frame)
+  // a picture of the pool keeps its buffers until it is reused
+  if(fs->frame && !fs->frame->pool)
   {
     free_pic_motion(&fs->frame->motion);
   }
 
-  if (fs->top_field)
+  if (fs->top_field && !fs->top_field->pool)
   {
     free_pic_motion(&fs->top_field->motion);
   }
 
-  if (fs->bottom_field)
+  if (fs->bottom_field && !fs->bottom_field->pool)
   {
     free_pic_motion(&fs->bottom_field->motion);
   }
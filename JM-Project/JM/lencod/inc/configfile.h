@@ -82,6 +82,12 @@ Mapping Map[] = {
     {"MbLineIntraUpdate",        &cfgparams.intra_upd,                    0,   0.0,                       1,  0.0,              1.0,                             },
     {"SliceMode",                &cfgparams.slice_mode,                   0,   0.0,                       1,  0.0,              3.0,                             },
     {"SliceArgument",            &cfgparams.slice_argument,               0,   1.0,                       2,  1.0,              1.0,                             },
+    {"SliceThreads",             &cfgparams.SliceThreads,                 0,   0.0,                       2,  0.0,              0.0,                             },
+    {"WavefrontThreads",         &cfgparams.WavefrontThreads,             0,   0.0,                       2,  0.0,              0.0,                             },
+    {"BFrameThreads",            &cfgparams.BFrameThreads,                0,   0.0,                       2,  0.0,              0.0,                             },
+    {"DeblockThreads",           &cfgparams.DeblockThreads,               0,   0.0,                       2,  0.0,              0.0,                             },
+    {"SliceArenas",              &cfgparams.SliceArenas,                  0,   0.0,                       1,  0.0,              1.0,                             },
+    {"PicturePool",              &cfgparams.PicturePool,                  0,   0.0,                       1,  0.0,              1.0,                             },
     {"UseConstrainedIntraPred",  &cfgparams.UseConstrainedIntraPred,      0,   0.0,                       1,  0.0,              1.0,                             },
     {"InputFile",                &cfgparams.input_file1.fname,            1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
     {"InputHeaderLength",        &cfgparams.infile_header,                0,   0.0,                       2,  0.0,              1.0,                             },
@@ -89,6 +95,7 @@ Mapping Map[] = {
     {"ReconFile",                &cfgparams.ReconFile,                    1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
     {"TraceFile",                &cfgparams.TraceFile,                    1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
     {"StatsFile",                &cfgparams.StatsFile,                    1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
+    {"METraceFile",              &cfgparams.METraceFile,                  1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
     {"DisposableP",              &cfgparams.DisposableP,                  0,   0.0,                       1,  0.0,              1.0,                             },
     {"SetFirstAsLongTerm",       &cfgparams.SetFirstAsLongTerm,           0,   0.0,                       1,  0.0,              1.0,                             },
     {"MultiSourceData",          &cfgparams.MultiSourceData,              0,   0.0,                       0,  0.0,              2.0,                             },
@@ -275,6 +282,7 @@ Mapping Map[] = {
     {"Verbose",                  &cfgparams.Verbose,                      0,   1.0,                       1,  0.0,              4.0,                             },
     {"SkipGlobalStats",          &cfgparams.skip_gl_stats,                0,   0.0,                       1,  0.0,              1.0,                             },
     {"OnTheFlyFractMCP",         &cfgparams.OnTheFlyFractMCP,             0,   0.0,                       1,  0.0,              3.0,                             },
+    {"LazySubPelInterp",         &cfgparams.LazySubPelInterp,             0,   0.0,                       1,  0.0,              1.0,                             },
     {"ChromaMCBuffer",           &cfgparams.ChromaMCBuffer,               0,   0.0,                       1,  0.0,              1.0,                             },
     {"ChromaMEEnable",           &cfgparams.ChromaMEEnable,               0,   0.0,                       1,  0.0,              2.0,                             },
     {"ChromaMEWeight",           &cfgparams.ChromaMEWeight,               0,   1.0,                       2,  0.0,              1.0,                             },    
@@ -395,10 +403,15 @@ Mapping Map[] = {
     {"PreferDispOrder",          &cfgparams.PreferDispOrder,              0,   1.0,                       1,  0.0,              1.0,                             },
     {"PreferPowerOfTwo",         &cfgparams.PreferPowerOfTwo,             0,   0.0,                       1,  0.0,              1.0,                             },
     {"FrmStructBufferLength",    &cfgparams.FrmStructBufferLength,        0,  16.0,                       1,  1.0,            128.0,                             },
+    {"Lookahead",                &cfgparams.Lookahead,                    0,   0.0,                       1,  0.0,            250.0,                             },
+    {"AdaptiveBFrames",          &cfgparams.AdaptiveBFrames,              0,   1.0,                       1,  0.0,              1.0,                             },
+    {"SceneCutThreshold",        &cfgparams.SceneCutThreshold,            0,  40.0,                       1,  0.0,            100.0,                             },
 
     // Fast Mode Decision
     {"EarlySkipEnable",          &cfgparams.EarlySkipEnable,              0,   0.0,                       1,  0.0,              1.0,                             },
     {"SelectiveIntraEnable",     &cfgparams.SelectiveIntraEnable,         0,   0.0,                       1,  0.0,              1.0,                             },
+    {"EarlyTermination",         &cfgparams.EarlyTermination,             0,   0.0,                       1,  0.0,              7.0,                             },
+    {"EarlyTerminationStrength", &cfgparams.EarlyTerminationStrength,     0, 100.0,                       1,  1.0,            400.0,                             },
 
     //================================
     // Motion Estimation (ME) Parameters
@@ -409,7 +422,7 @@ Mapping Map[] = {
     {"SetMVXLimit",              &cfgparams.SetMVXLimit,                  0,   0.0,                       1,  0.0,           2048.0,                             },
     {"SetMVYLimit",              &cfgparams.SetMVYLimit,                  0,   0.0,                       1,  0.0,            512.0,                             },
     // Fast ME enable
-    {"SearchMode",               &cfgparams.SearchMode[0],                0,   0.0,                       1, -1.0,              3.0,                             },
+    {"SearchMode",               &cfgparams.SearchMode[0],                0,   0.0,                       1, -1.0,              4.0,                             },
     // Parameters for UMHEX control
     {"UMHexDSR",                 &cfgparams.UMHexDSR,                     0,   1.0,                       1,  0.0,              1.0,                             },
     {"UMHexScale",               &cfgparams.UMHexScale,                   0,   1.0,                       0,  0.0,              0.0,                             },
@@ -613,7 +626,7 @@ Mapping MapView1[] = {
   {"DFBetaNRefSPSlice",       &cfgparams.EnhLayerDFBeta[0][SP_SLICE],          0,   0.0,                       1, -6.0,              6.0,                             },
   {"DFBetaRefSISlice",        &cfgparams.EnhLayerDFBeta[1][SI_SLICE],          0,   0.0,                       1, -6.0,              6.0,                             },
   {"DFBetaNRefSISlice",       &cfgparams.EnhLayerDFBeta[0][SI_SLICE],          0,   0.0,                       1, -6.0,              6.0,                             },
-  {"SearchMode",              &cfgparams.SearchMode[1],                        0,   0.0,                       1, -1.0,              3.0,                             },
+  {"SearchMode",              &cfgparams.SearchMode[1],                        0,   0.0,                       1, -1.0,              4.0,                             },
   {"EPZSTemporal",            &cfgparams.EPZSTemporal[1],                      0,   0.0,                       1,  0.0,              1.0,                             },
   {"EnableEPZSScalers",       &cfgparams.EnableEnhLayerEPZSScalers,            0,   0.0,                       1,  0.0,              1.0,                             },
   {"EPZSMinThresScale",       &cfgparams.EPZSMinThresScale[1],                 0,   0.0,                       0,  0.0,              0.0,                             },
@@ -18,6 +18,7 @@
 
 extern void  create_context_memory       (VideoParameters *p_Vid, InputParameters *p_Inp);
 extern void  free_context_memory         (VideoParameters *p_Vid);
+extern void  copy_context_memory         (VideoParameters *dst, VideoParameters *src);
 extern void  update_field_frame_contexts (VideoParameters *p_Vid, int);
 extern void  SetCtxModelNumber           (Slice *currSlice);
 extern void  init_contexts               (Slice *currSlice);
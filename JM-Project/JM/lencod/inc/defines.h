@@ -43,11 +43,12 @@
 #define USE_RND_COST              0    //!< Perform ME RD decision using a rounding estimate of the motion cost
 #define JM_INT_DIVIDE             1
 #define JM_MEM_DISTORTION         0
+#define JM_SIMD_DISTORTION        1    //!< Use SSE2/SSE4.1/AVX2 ME SAD/SSE functions when the CPU supports them (x86, GCC/Clang)
+#define JM_SAD_CACHE              1    //!< Share 4x4 SADs between the partitions of a macroblock in ADS integer search (SAD metric only)
 #define JCOST_CALC_SCALEUP        1    //!< 1: J = (D<<LAMBDA_ACCURACY_BITS)+Lambda*R; 0: J = D + ((Lambda*R+Rounding)>>LAMBDA_ACCURACY_BITS)
 #define INTRA_RDCOSTCALC_ET       1    //!< Early termination 
 #define INTRA_RDCOSTCALC_NNZ      1    //1: to recover block's nzn after rdcost calculation;
 #define JCOST_OVERFLOWCHECK       0    //!<1: to check the J cost if it is overflow>
-#define JM_PARALLEL_DEBLOCK       0    //!< Enables Parallel Deblocking
 #define SIMULCAST_ENABLE          0
 
 #define MVC_EXTENSION_ENABLE      1    //!< enable support for the Multiview High Profile
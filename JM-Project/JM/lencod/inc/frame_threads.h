@@ -0,0 +1,70 @@
+
+/*!
+ ***************************************************************************
+ * \file
+ *    frame_threads.h
+ *
+ * \brief
+ *    Headerfile for the concurrent coding of runs of consecutive non
+ *    reference B frames (BFrameThreads > 1)
+ **************************************************************************
+ */
+
+#ifndef _FRAME_THREADS_H_
+#define _FRAME_THREADS_H_
+
+#include "enc_statistics.h"
+
+//! Buffers a frame coding context owns instead of sharing those of the master
+typedef struct frame_buffers
+{
+  Block8x8Info       *b8x8info;
+  distblk         ****motion_cost;
+  struct sad_cache   *p_SADCache;
+  QuantParameters    *p_Quant;
+  struct hme_info    *pHMEInfo;
+  struct ads_memory  *p_ADS;
+  Macroblock         *mb_data;
+  char              **ipredmode;
+  char              **ipredmode8x8;
+  int              ***nz_coeff;
+  short              *intra_block;
+  int             ****ARCofAdj4x4;
+  int             ****ARCofAdj8x8;
+  LambdaParams      **lambda;
+  double            **lambda_md;
+  double           ***lambda_me;
+  int              ***lambda_mf;
+  double            **lambda_rdoq;
+  ImageData           imgData;
+  struct storable_picture **enc_frame_picture;
+  struct storable_picture **enc_field_picture;
+  Picture           **frame_pic;
+  struct pic_pool    *p_PicPool;
+  byte               *MapUnitToSliceGroupMap;
+  byte               *MBAmap;
+  int              ***initialized;
+  int              ***modelNumber;
+} FrameBuffers;
+
+typedef struct frame_threads
+{
+  int               num_threads;
+  struct thread_pool *pool;      //!< threads coding the frames of a run
+  int               run_length;  //!< frames of the current run
+  int               next_frame;  //!< first frame of the run no thread has taken yet
+  int               run_goes_on; //!< the frame after the run found by FrameThreadsRunLength() belongs to it as well
+  VideoParameters  *ctx;         //!< coding context of each frame of a run
+  QuantParameters  *quant;       //!< p_Quant of each context
+  StatParameters   *stats;       //!< p_Stats of each context while coding (discarded)
+  DistortionParams *dist;        //!< p_Dist of each context while coding
+  InputParameters  *inp;         //!< p_Inp of each context while coding
+  int              *coded;       //!< frames of the run with input data
+} FrameThreads;
+
+extern int  FrameThreadsInit     (VideoParameters *p_Vid);
+extern void FrameThreadsDelete   (VideoParameters *p_Vid);
+extern int  FrameThreadsRunLength(VideoParameters *p_Vid, int curr_frame_to_code, int frames_to_code);
+extern void FrameThreadsEncode   (VideoParameters *p_Vid, int curr_frame_to_code, int n);
+
+#endif
@@ -376,6 +376,7 @@ typedef struct macroblock_enc
   short               list_offset;
   Boolean             prev_recode_mb;
   int                 DeblockCall;
+  byte                mixedModeEdgeFlag;
 
   int                 mbAddrA, mbAddrB, mbAddrC, mbAddrD;
   byte                mbAvailA, mbAvailB, mbAvailC, mbAvailD;
@@ -617,6 +618,7 @@ typedef struct slice
   int                 bitdepth_lambda_scale;
 
   DataPartition       *partArr;     //!< array of partitions
+  struct stat_parameters *cur_stats; //!< statistics the slice is accounted in
   MotionInfoContexts  *mot_ctx;     //!< pointer to struct of context models for use in CABAC
   TextureInfoContexts *tex_ctx;     //!< pointer to struct of context models for use in CABAC
 
@@ -661,6 +663,8 @@ typedef struct slice
   int **tblk4x4;     //!< Transform related array
   int ****i16blk4x4;
 
+  struct mem_arena *arena;   //!< arena of the picture the slice buffers are taken from (SliceArenas), NULL: heap
+
   RD_DATA *rddata;
   // RD_DATA data. Moved here to enable parallelization at the slice level
   // of RDOQ
@@ -857,6 +861,7 @@ typedef struct picture
   int   no_slices;
   int   bits_per_picture;
   struct slice *slices[MAXSLICEPERPICTURE];
+  struct mem_arena *arena[MAXSLICEPERPICTURE];  //!< buffers of the slices (SliceArenas), reset when they are freed
 
   DistMetric distortion;
   byte  idr_flag;
@@ -1060,10 +1065,10 @@ typedef struct video_par
   unsigned int max_pic_order_cnt_lsb;
 
   int64  me_tot_time;
+  int64  subpel_tot_time;      //!< luma sub-pel interpolation of the references (getSubImagesLuma)
   int64  tot_time;
   int64  me_time;
-
-  byte mixedModeEdgeFlag;
+  int64  frame_time;           //!< time spent so far on the frame being coded (encode_one_frame)
 
   int *RefreshPattern;
   int *IntraMBs;
@@ -1078,6 +1083,17 @@ typedef struct video_par
   struct umhex_struct *p_UMHex;
   struct umhex_smp_struct *p_UMHexSMP;
   struct me_full_fast *p_ffast_me;
+  struct ads_memory *p_ADS;
+  struct sad_cache *p_SADCache;
+  struct lazy_sub_pel *p_LazySubPel;
+  struct slice_threads *p_SliceThreads;
+  struct wavefront *p_Wavefront;
+  struct frame_threads *p_FrameThreads;
+  struct thread_pool *p_DeblockThreads;
+  struct lookahead *p_Lookahead;
+  struct early_term *p_EarlyTerm;
+  struct mem_arena_stats *p_ArenaStats;   //!< counters of the slice arenas of pictures already freed
+  struct pic_pool *p_PicPool;             //!< PicturePool: pictures freed for reuse (NULL in the frame thread contexts)
 
   struct search_window *p_search_window;
 
@@ -1376,6 +1392,7 @@ typedef struct video_par
 
   // files
   FILE *p_log;                     //!< SNR file
+  FILE *p_me_trace;                //!< per-block ME trace (METraceFile)
 
   // generic output file
   FILE **f_out;
@@ -1567,6 +1584,8 @@ extern void no_mem_exit  (char *where);
 extern int  get_mem_ACcoeff_new  (int****** cofAC, int chroma);
 extern int  get_mem_ACcoeff      (VideoParameters *p_Vid, int*****);
 extern int  get_mem_DCcoeff      (int****);
+extern int  get_mem_ACcoeff_arena(struct mem_arena *arena, VideoParameters *p_Vid, int*****);
+extern int  get_mem_DCcoeff_arena(struct mem_arena *arena, int****);
 extern void free_mem_ACcoeff     (int****);
 extern void free_mem_ACcoeff_new (int***** cofAC);
 extern void free_mem_DCcoeff     (int***);
@@ -1591,6 +1610,11 @@ extern void read_SP_coefficients       (VideoParameters *p_Vid, InputParameters
 extern void init_redundant_frame       (VideoParameters *p_Vid, InputParameters *p_Inp);
 extern void set_redundant_frame        (VideoParameters *p_Vid, InputParameters *p_Inp);
 extern void encode_one_redundant_frame (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void prepare_frame_params       (VideoParameters *p_Vid, InputParameters *p_Inp, int curr_frame_to_code);
+extern int  init_orig_buffers          (VideoParameters *p_Vid, ImageData *imgData);
+extern void free_orig_planes           (VideoParameters *p_Vid, ImageData *imgData);
+extern Picture *malloc_picture         (void);
+extern void free_picture               (Picture *pic);
 
 
 // struct with pointers to the sub-images
@@ -29,6 +29,9 @@ typedef struct coding_info {
 } CodingInfo;
 
 extern int     encode_one_frame      ( VideoParameters *p_Vid, InputParameters *p_Inp);
+extern int     start_one_frame       ( VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void    code_one_frame        ( VideoParameters *p_Vid);
+extern void    finish_one_frame      ( VideoParameters *p_Vid);
 extern Boolean dummy_slice_too_big   ( int bits_slice);
 extern void    copy_rdopt_data       ( Macroblock *currMB);       // For MB level field/frame coding tools
 extern void    UnifiedOneForthPix    ( VideoParameters *p_Vid, StorablePicture *s);
@@ -38,6 +41,7 @@ extern void    UnifiedOneForthPix_JV ( VideoParameters *p_Vid, int nplane, Stora
 extern void    frame_picture         ( VideoParameters *p_Vid, Picture *frame, ImageData *imgData, int rd_pass);
 extern byte    get_idr_flag          ( VideoParameters *p_Vid );
 extern byte    get_random_access_flag( VideoParameters *p_Vid );
+extern void    accumulate_coding_stats( struct stat_parameters *dst, struct stat_parameters *src );
 extern void    write_non_vcl_nalu    ( VideoParameters *p_Vid);
 extern void    write_non_vcl_nalu_bot_fld( VideoParameters *p_Vid );
 #if (MVC_EXTENSION_ENABLE)
@@ -0,0 +1,29 @@
+
+/*!
+ ***************************************************************************
+ * \file
+ *    img_luma_simd.h
+ *
+ * \brief
+ *    Headerfile for the SIMD luma sub-image interpolation functions
+ **************************************************************************
+ */
+
+#ifndef _IMG_LUMA_SIMD_H_
+#define _IMG_LUMA_SIMD_H_
+
+//! Interpolation passes of getSubImagesLuma
+typedef struct
+{
+  void (*hor_six_tap)     (VideoParameters *p_Vid, StorablePicture *s, imgpel **dstImg, imgpel **srcImg);
+  void (*ver_six_tap)     (VideoParameters *p_Vid, StorablePicture *s, imgpel **dstImg, imgpel **srcImg);
+  void (*ver_six_tap_tmp) (VideoParameters *p_Vid, StorablePicture *s, imgpel **dstImg);
+  void (*bilinear)        (StorablePicture *s, imgpel **dstImg, imgpel **srcImgL, imgpel **srcImgR);
+  void (*hor_bilinear)    (StorablePicture *s, imgpel **dstImg, imgpel **srcImgL, imgpel **srcImgR);
+  void (*ver_bilinear)    (StorablePicture *s, imgpel **dstImg, imgpel **srcImgT, imgpel **srcImgB);
+  void (*diag_bilinear)   (StorablePicture *s, imgpel **dstImg, imgpel **srcImgT, imgpel **srcImgB);
+} SubImageFuncs;
+
+extern const SubImageFuncs *get_sub_image_funcs_simd(void);
+
+#endif
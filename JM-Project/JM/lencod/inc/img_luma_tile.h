@@ -0,0 +1,61 @@
+
+/*!
+ ***************************************************************************
+ * \file
+ *    img_luma_tile.h
+ *
+ * \brief
+ *    Headerfile for the lazy, tile based luma sub-pel interpolation
+ *    (LazySubPelInterp = 1)
+ **************************************************************************
+ */
+
+#ifndef _IMG_LUMA_TILE_H_
+#define _IMG_LUMA_TILE_H_
+
+#include "mbuffer.h"
+
+#define SUB_TILE_SIZE_LOG2  6                          //!< tiles of 64x64 luma samples
+#define SUB_TILE_SIZE       (1 << SUB_TILE_SIZE_LOG2)
+#define SUB_TILES(n)        (((n) + SUB_TILE_SIZE - 1) >> SUB_TILE_SIZE_LOG2)
+
+typedef distblk (*LazyUniPredFn) (StorablePicture *ref1, MEBlock *, distblk, MotionVector *);
+typedef distblk (*LazyBiPredFn)  (StorablePicture *ref1, StorablePicture *ref2, MEBlock *, distblk, MotionVector *, MotionVector *);
+
+typedef struct lazy_sub_pel
+{
+  int   *tmp;            //!< horizontal six-tap sums of one tile (plus filter margin)
+  int64  tiles_filled;   //!< tiles interpolated
+  int64  tiles_total;    //!< tiles of all references set up for lazy interpolation
+
+  // distortion functions of the DPB, called once the tiles are interpolated
+  LazyUniPredFn computeSAD,  computeSADWP,  computeSATD, computeSATDWP, computeSSE, computeSSEWP;
+  LazyBiPredFn  computeBiPredSAD1,  computeBiPredSAD2;
+  LazyBiPredFn  computeBiPredSATD1, computeBiPredSATD2;
+  LazyBiPredFn  computeBiPredSSE1,  computeBiPredSSE2;
+} LazySubPel;
+
+extern int  LazySubPelInit     (VideoParameters *p_Vid);
+extern void LazySubPelDelete   (VideoParameters *p_Vid);
+extern void LazySubPelSetupDpb (VideoParameters *p_Vid, DecodedPictureBuffer *p_Dpb);
+extern void LazySubPelReset    (VideoParameters *p_Vid, StorablePicture *s);
+extern void LazySubPelFill     (VideoParameters *p_Vid, StorablePicture *s, int x, int y, int width, int height);
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Makes sure the sub-pel samples of the block UMVLine4X(ref, y, x)
+ *    points to are interpolated. Nothing to do for integer positions
+ *    and for references interpolated in full.
+ ************************************************************************
+ */
+static inline void LazySubPelBlock (VideoParameters *p_Vid, StorablePicture *ref, int y, int x, int width, int height)
+{
+  if (ref->sub_tile_map != NULL && ((x | y) & 0x03))
+  {
+    LazySubPelFill(p_Vid, ref, iClip3(-IMG_PAD_SIZE_X, ref->size_x_pad, x >> 2) + IMG_PAD_SIZE_X,
+      iClip3(-IMG_PAD_SIZE_Y, ref->size_y_pad, y >> 2) + IMG_PAD_SIZE_Y, width, height);
+  }
+}
+
+#endif
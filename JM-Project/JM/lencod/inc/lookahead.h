@@ -0,0 +1,80 @@
+
+/*!
+ ***************************************************************************
+ * \file
+ *    lookahead.h
+ *
+ * \brief
+ *    Headerfile for the lookahead pre-analysis of the input frames
+ *    (Lookahead > 0)
+ **************************************************************************
+ */
+
+#ifndef _LOOKAHEAD_H_
+#define _LOOKAHEAD_H_
+
+#include "thread_pool.h"
+
+//! Analysis of one frame, on its 2:1 downscaled luma (8x8 blocks: one per macroblock)
+typedef struct lookahead_frame
+{
+  int           frame_no;      //!< display order frame number
+  imgpel      **lowres;        //!< downscaled luma, padded by LOOKAHEAD_PAD pels
+  int          *intra;         //!< intra cost of each block
+  int          *inter;         //!< cost of each block predicted from the previous frame, at most its intra cost
+  MotionVector *mv;            //!< MV of each block against the previous frame, lowres pels
+  float        *propagate;     //!< propagation cost of each block
+  int64         intra_cost;    //!< sum of the intra costs
+  int64         inter_cost;    //!< sum of the inter costs
+  int           intra_blocks;  //!< blocks not cheaper to predict from the previous frame
+  int           scene_cut;
+} LookaheadFrame;
+
+//! Summary of the analysis and of the decisions taken from it
+typedef struct lookahead_stats
+{
+  int     frames;              //!< frames analysed
+  int     scene_cuts;          //!< scene cuts detected
+  int     cuts_coded;          //!< scene cuts coded as I frames
+  int     runs;                //!< runs of B frames placed
+  int     b_frames;            //!< B frames in these runs
+  int     runs_shortened;      //!< runs shorter than NumberBFrames
+  double  propagate;           //!< propagation costs of the frames with a full window
+  double  intra;               //!< intra costs of the same frames
+  int     initial_qp;          //!< initial QP given to rate control, -1: none
+} LookaheadStats;
+
+typedef struct lookahead
+{
+  ThreadPool     *pool;         //!< one worker analysing the frames; its lock guards the fields below
+  VideoParameters vid;          //!< copy of the encoder parameters owning the buffers of read_one_frame()
+  VideoDataFile   input;        //!< own handle on the input file
+  imgpel        **frame[3];     //!< input frame read
+  LookaheadFrame *ring;         //!< analysed frames, frame f in ring[f % ring_size]
+  int             ring_size;
+  int             width;        //!< downscaled luma size, without the padding
+  int             height;
+  int             blk_width;    //!< blocks per row
+  int             blk_height;
+  int             num_blocks;
+  int             depth;        //!< Lookahead: frames analysed ahead of the frames asked for
+  int             range;        //!< search range, lowres pels
+  int64           first_cost;   //!< costs of the first depth frames (intra for the first, inter for the others)
+  int             first_frames;
+
+  // guarded by the pool lock
+  int             num_frames;   //!< frames of the sequence (less if the input ends early)
+  int             frames_done;  //!< frames analysed so far
+  int             frames_wanted;//!< last frame the worker may analyse
+  int             quit;
+  LookaheadStats  stats;
+} Lookahead;
+
+extern int  LookaheadInit      (VideoParameters *p_Vid);
+extern void LookaheadDelete    (VideoParameters *p_Vid);
+extern int  LookaheadBFrames   (VideoParameters *p_Vid, int first, int max_b);
+extern int  LookaheadSceneCut  (VideoParameters *p_Vid, int frame_no);
+extern int  LookaheadInitialQP (VideoParameters *p_Vid, double bit_rate, double frame_rate);
+extern void LookaheadGetStats  (VideoParameters *p_Vid, LookaheadStats *stats);
+
+#endif
@@ -20,8 +20,6 @@
 
 #include "global.h"
 
-#define GROUP_SIZE  1
-
 /*********************************************************************************************************/
 
 // NOTE: In principle, the alpha and beta tables are calculated with the formulas below
@@ -69,6 +69,7 @@ static const short block_size[8][2] =
 
 extern void  next_macroblock  (Macroblock* currMB);
 extern void  start_macroblock (Slice *currSlice, Macroblock** currMB, int mb_addr, Boolean mb_field);
+extern void  set_MB_parameters(Slice *currSlice, Macroblock *currMB);
 extern void  reset_macroblock (Macroblock *currMB);
 extern void  end_macroblock   (Macroblock* currMB, Boolean *end_of_slice, Boolean *recode_macroblock);
 extern void  write_macroblock (Macroblock* currMB, int eos_bit);
@@ -21,6 +21,8 @@
 #include "enc_statistics.h"
 
 #define MAX_LIST_SIZE 33
+#define PIC_POOL_SIZE 32   //!< pictures kept at most by the picture pool (PicturePool)
+#define MAX_SUB_PLANES 64  //!< sub-pel planes of a component at most (4:2:0 chroma, 8x8)
 
 typedef struct frame_store FrameStore;
 typedef struct distortion_estimation Dist_Estm;
@@ -51,6 +53,15 @@ typedef struct pic_motion_params
 } PicMotionParams;
 
 
+//! Contiguous view of a padded plane: pel (x, y) is base[y * stride + x]
+typedef struct pel_plane
+{
+  imgpel *base;      //!< pel (0, 0), MEM_PLANE_ALIGNMENT aligned
+  int     stride;    //!< pels from a row to the next
+  int     pad_y;     //!< rows of padding above and below
+  int     pad_x;     //!< pels of padding left and right
+} PelPlane;
+
 //! definition a picture (field or frame)
 typedef struct storable_picture
 {
@@ -92,6 +103,9 @@ typedef struct storable_picture
   imgpel **** p_img_sub[MAX_PLANE];      //!< pointer array for storing top address of imgY_sub/imgUV_sub[]
   imgpel **   p_curr_img;                //!< current int-pel ref. picture area to be used for motion estimation
   imgpel **** p_curr_img_sub;            //!< current sub-pel ref. picture area to be used for motion estimation
+  PelPlane    plane[MAX_PLANE];          //!< views of p_img[]
+  PelPlane    plane_sub[MAX_PLANE][MAX_SUB_PLANES]; //!< views of p_img_sub[], sub-pel plane [dy][dx] at [dy * columns + dx]
+  PelPlane   *p_curr_plane_sub;          //!< views of p_curr_img_sub
   
   // Hierarchical ME Image buffer
   imgpel ***  pHmeImage;     //!< Array allocated with dimensions [level][y][x];
@@ -137,11 +151,22 @@ typedef struct storable_picture
   int  bInterpolated;
   int  ref_pic_na[6];
   int  otf_flag;
+  byte *sub_tile_map;   //!< LazySubPelInterp: tiles of imgY_sub already interpolated
+  struct pic_pool *pool;  //!< PicturePool: pool the picture is freed to, its sub-pel planes are kept when unmarked
   //int  separate_colour_plane_flag;
 } StorablePicture;
 
 typedef StorablePicture *StorablePicturePtr;
 
+//! Pictures freed by free_storable_picture() kept for alloc_storable_picture() (PicturePool)
+typedef struct pic_pool
+{
+  int               size;                 //!< pictures in the pool
+  StorablePicture  *pic[PIC_POOL_SIZE];
+  int64             allocs;               //!< pictures allocated
+  int64             reuses;               //!< of these, taken from the pool
+} PicPool;
+
 //! Frame Stores for Decoded Picture Buffer
 struct frame_store
 {
@@ -231,6 +256,8 @@ extern FrameStore*      alloc_frame_store(void);
 extern void             free_frame_store          (VideoParameters *p_Vid, FrameStore* f);
 extern StorablePicture* alloc_storable_picture    (VideoParameters *p_Vid, PictureStructure type, int size_x, int size_y, int size_x_cr, int size_y_cr);
 extern void             free_storable_picture     (VideoParameters *p_Vid, StorablePicture* p);
+extern int              init_pic_pool             (VideoParameters *p_Vid);
+extern void             free_pic_pool             (VideoParameters *p_Vid);
 extern void             store_picture_in_dpb      (DecodedPictureBuffer *p_Dpb, StorablePicture* p, FrameFormat *output);
 extern void             replace_top_pic_with_frame(DecodedPictureBuffer *p_Dpb, StorablePicture* p, FrameFormat *output);
 extern void             flush_dpb                 (DecodedPictureBuffer *p_Dpb, FrameFormat *output);
@@ -0,0 +1,57 @@
+/*!
+ ***************************************************************************
+ * \file
+ *    md_early_term.h
+ *
+ * \brief
+ *    Headerfile for the adaptive early termination of the mode decision
+ *    (EarlyTermination > 0)
+ **************************************************************************
+ */
+
+#ifndef _MD_EARLY_TERM_H_
+#define _MD_EARLY_TERM_H_
+
+//! Decisions the mode decision may take early, bit (1 << decision) of EarlyTermination
+typedef enum
+{
+  ET_P8X8  = 0,   //!< no 8x8 sub-partitions when the 16x16, 16x8 and 8x16 cost is low
+  ET_INTRA = 1,   //!< no intra modes in inter slices when the inter cost is low against the activity
+  ET_REF   = 2,   //!< no references past the first when the cost on the first is low
+  ET_DECISIONS = 3
+} EarlyTermDecision;
+
+//! Per decision counters
+typedef struct early_term_stats
+{
+  int64 tested;      //!< macroblocks (partitions for ET_REF) the decision was taken for
+  int64 skipped;     //!< of these, search skipped
+  int64 trained;     //!< samples of the training macroblocks
+  int64 won;         //!< of these, the search that would be skipped gave the best mode
+} EarlyTermStats;
+
+typedef struct early_term
+{
+  int             qp_scale;                   //!< bitdepth_luma_qp_scale: the tables start at QP -qp_scale
+  double         *log_mean[ET_DECISIONS];     //!< per QP, running mean of the log of the measure of the training macroblocks
+  double         *low[ET_DECISIONS];          //!< per QP, lowest measure at which the search that could have been skipped won
+  int            *samples[ET_DECISIONS];      //!< per QP, samples of the training macroblocks
+  int            *wins[ET_DECISIONS];         //!< per QP, samples won by the search that could have been skipped
+  EarlyTermStats  stats[ET_DECISIONS];
+
+  // macroblock in mode decision
+  int             active;                     //!< between EarlyTermStartMB() and EarlyTermEndMB()
+  int             train;                      //!< training macroblock: all modes are searched
+  double          measure[ET_DECISIONS];      //!< measure of the macroblock, < 0: not taken
+} EarlyTerm;
+
+extern int  EarlyTermInit     (VideoParameters *p_Vid);
+extern void EarlyTermDelete   (VideoParameters *p_Vid);
+extern void EarlyTermStartMB  (Macroblock *currMB);
+extern void EarlyTermEndMB    (Macroblock *currMB);
+extern int  EarlyTermSkipP8x8 (Macroblock *currMB, distblk cost);
+extern int  EarlyTermSkipIntra(Macroblock *currMB, distblk cost);
+extern int  EarlyTermSkipRefs (Macroblock *currMB, int blocktype, distblk cost);
+extern void EarlyTermTrainRefs(Macroblock *currMB, int blocktype, distblk cost, int won);
+
+#endif
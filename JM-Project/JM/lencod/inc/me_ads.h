@@ -0,0 +1,58 @@
+
+/*!
+ ************************************************************************
+ * \file
+ *     me_ads.h
+ *
+ * \brief
+ *    Headerfile for Adaptive Diamond Search (ADS) motion estimation
+ *    (SearchMode = 4)
+ **************************************************************************
+ */
+
+#ifndef _ME_ADS_H_
+#define _ME_ADS_H_
+
+//! MVs of one picture kept by the ADS predictor memory
+typedef struct ads_mv_store
+{
+  MotionVector *mv;      //!< [list][ref][blocktype grid], quarter-pel
+  short        *dist;    //!< POC distance spanned by each MV, 0 = not set
+  int           pic_no;  //!< frame number the store belongs to, -1 = none
+} ADSMvStore;
+
+//! ADS predictor memory: per list, reference and blocktype MVs of the current and previous picture
+typedef struct ads_memory
+{
+  int         num_ref;    //!< references kept per list
+  int         grid_size;  //!< entries per list and reference
+  int         offset[8];  //!< first entry of each blocktype grid
+  int         stride[8];  //!< blocks per row of each blocktype grid
+  ADSMvStore *cur;
+  ADSMvStore *prev;
+  ADSMvStore  store[2];
+} ADSMemory;
+
+//! Block of a plain plane searched by ADS_plane_search (lookahead)
+typedef struct ads_plane_block
+{
+  imgpel **cur;          //!< current plane
+  imgpel **ref;          //!< reference plane, padded by pad pels on each side
+  int      width;        //!< plane size without the padding
+  int      height;
+  int      pad;
+  int      pos_x;        //!< top left pel of the block
+  int      pos_y;
+  int      size;         //!< block width and height
+} ADSPlaneBlock;
+
+extern int  ADSInit        (VideoParameters *p_Vid);
+extern void ADSDelete      (VideoParameters *p_Vid);
+extern void ADSPictureInit (VideoParameters *p_Vid);
+extern void ADSCopyMemory  (VideoParameters *dst, VideoParameters *src);
+
+extern distblk ADS_motion_estimation        (Macroblock *, MotionVector *, MEBlock *, distblk, int);
+extern distblk ADS_bipred_motion_estimation (Macroblock *, int, MotionVector *, MotionVector *, MotionVector *, MotionVector *, MEBlock *, int, distblk, int);
+extern int     ADS_plane_search             (const ADSPlaneBlock *block, const MotionVector *cand, int num_cand, const MotionVector *pred, int range, int lambda, MotionVector *mv);
+
+#endif
@@ -0,0 +1,25 @@
+
+/*!
+ ***************************************************************************
+ * \file
+ *    me_distortion_simd.h
+ *
+ * \brief
+ *    Headerfile for the SIMD motion estimation distortion functions
+ **************************************************************************
+ */
+
+#ifndef _ME_DISTORTION_SIMD_H_
+#define _ME_DISTORTION_SIMD_H_
+
+#define SIMD_NONE   0
+#define SIMD_SSE2   1
+#define SIMD_SSE41  2
+#define SIMD_AVX2   3
+
+extern int  get_simd_level        (void);
+extern void init_distortion_simd  (DecodedPictureBuffer *p_Dpb);
+extern void select_distortion_simd(VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void select_sadcache_simd  (struct sad_cache *p_cache);
+
+#endif
@@ -108,6 +108,9 @@ extern void    EPZS_hierarchical_predictors    (EPZSParameters * p_EPZS, MEBlock
  
 extern void  EPZSDelete                (VideoParameters *p_Vid);
 extern void  EPZSStructDelete          (Slice *currSlice);
+extern int   EPZSStructCopy            (Slice *currSlice, EPZSParameters *p_src);
+extern void  EPZSStructCopyDelete      (Slice *currSlice);
+extern void  EPZSResetMemory           (Slice *currSlice);
 extern void  EPZSSliceInit             (Slice *currSlice);
 extern int   EPZSInit                  (VideoParameters *p_Vid);
 extern int   EPZSStructInit            (Slice *currSlice);
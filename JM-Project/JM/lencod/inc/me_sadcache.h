@@ -0,0 +1,45 @@
+
+/*!
+ ************************************************************************
+ * \file
+ *     me_sadcache.h
+ *
+ * \brief
+ *    Headerfile for the per macroblock 4x4 SAD cache shared by the
+ *    partitions of the ADS integer-pel search
+ **************************************************************************
+ */
+
+#ifndef _ME_SADCACHE_H_
+#define _ME_SADCACHE_H_
+
+#define SAD_CACHE_BITS  11   //!< log2 of the number of cached displacements
+
+//! SADs of n (1, 2 or 4) horizontally adjacent 4x4 blocks
+typedef void (*SAD4x4RowFn) (imgpel *src, int src_stride, imgpel *ref, int ref_stride, int n, int *sad);
+
+//! 4x4 SADs of the current macroblock for one reference and integer displacement
+typedef struct sad_cache_entry
+{
+  struct storable_picture *ref;   //!< key: reference picture
+  short                    dx;    //!< key: integer-pel displacement
+  short                    dy;
+  unsigned int             stamp; //!< macroblock the entry belongs to
+  int                      valid; //!< 4x4 blocks whose SAD is set, bit 4 * y + x
+  int                      sad[16];
+} SADCacheEntry;
+
+typedef struct sad_cache
+{
+  SADCacheEntry *entry;
+  SAD4x4RowFn    sad4x4_row;
+  unsigned int   stamp;  //!< bumped for every new macroblock
+  int            mb_x;   //!< luma position of the macroblock the cache holds
+  int            mb_y;
+} SADCache;
+
+extern int     SADCacheInit     (VideoParameters *p_Vid);
+extern void    SADCacheDelete   (VideoParameters *p_Vid);
+extern distblk computeSADCached (struct storable_picture *ref1, MEBlock *mv_block, distblk min_mcost, MotionVector *cand);
+
+#endif
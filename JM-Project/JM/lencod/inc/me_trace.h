@@ -0,0 +1,52 @@
+
+/*!
+ ************************************************************************
+ * \file
+ *     me_trace.h
+ *
+ * \brief
+ *    Per-block motion estimation trace (shared format with the ADS harness,
+ *    JM-Project/lencod/inc/me_trace.h)
+ *
+ *    File layout, little-endian:
+ *      header (16 bytes): "METR", uint32 version, uint32 width, uint32 height
+ *      record (36 bytes): uint32 frame, uint32 ref_frame, uint16 x, uint16 y,
+ *                         uint8 w, uint8 h, uint8 list, uint8 ref_idx,
+ *                         uint16 range, uint16 reserved,
+ *                         int16 pred_x, int16 pred_y, int16 mv_x, int16 mv_y,
+ *                         uint32 cost, uint32 points
+ *    Frame numbers index the input file, MVs and predictors are integer-pel.
+ ************************************************************************
+ */
+
+#ifndef _ME_TRACE_H_
+#define _ME_TRACE_H_
+
+#define ME_TRACE_VERSION      1
+#define ME_TRACE_HEADER_SIZE 16
+#define ME_TRACE_RECORD_SIZE 36
+
+typedef struct me_trace_record
+{
+  uint32 frame;       //!< current frame in the input file
+  uint32 ref_frame;   //!< reference frame in the input file
+  uint16 x;           //!< block position in pels
+  uint16 y;
+  byte   w;           //!< block size in pels
+  byte   h;
+  byte   list;
+  byte   ref_idx;
+  uint16 range;       //!< +/- integer search range
+  int16  pred_x;      //!< search start (integer-pel)
+  int16  pred_y;
+  int16  mv_x;        //!< chosen integer-pel motion vector
+  int16  mv_y;
+  uint32 cost;        //!< integer-pel motion cost
+  uint32 points;      //!< search points visited
+} METraceRecord;
+
+extern void init_me_trace  (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void close_me_trace (VideoParameters *p_Vid);
+extern void write_me_trace (VideoParameters *p_Vid, const METraceRecord *rec);
+
+#endif
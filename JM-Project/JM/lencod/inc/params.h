@@ -62,6 +62,12 @@ struct inp_par_enc
 
   int slice_mode;                       //!< Indicate what algorithm to use for setting slices
   int slice_argument;                   //!< Argument to the specified slice algorithm
+  int SliceThreads;                     //!< Number of threads coding the slices of a picture concurrently (0/1: off)
+  int WavefrontThreads;                 //!< Number of threads deciding the macroblock rows of a picture concurrently (0/1: off)
+  int BFrameThreads;                    //!< Number of consecutive non reference B frames coded concurrently (0/1: off)
+  int DeblockThreads;                   //!< Number of threads deblocking the macroblock rows of a picture concurrently (0/1: off)
+  int SliceArenas;                      //!< Take the slice buffers from arenas of the picture, reset after each picture
+  int PicturePool;                      //!< Keep the freed pictures for reuse by pictures of the same size and layout
   int UseConstrainedIntraPred;          //!< 0: Inter MB pixels are allowed for intra prediction 1: Not allowed
   int  SetFirstAsLongTerm;              //!< Support for temporal considerations for CB plus encoding
   int  infile_header;                   //!< If input file has a header set this to the length of the header
@@ -89,6 +95,7 @@ struct inp_par_enc
   char ReconFile2    [FILE_NAME_SIZE];  //!< Reconstructed Pictures (view 1)
   char TraceFile     [FILE_NAME_SIZE];  //!< Trace Outputs
   char StatsFile     [FILE_NAME_SIZE];  //!< Stats File
+  char METraceFile   [FILE_NAME_SIZE];  //!< Per-block ME trace (binary, SearchMode = 4)
   char QmatrixFile   [FILE_NAME_SIZE];  //!< Q matrix cfg file
   int  ProcessInput;                    //!< Filter Input Sequence
   int  EnableOpenGOP;                   //!< support for open gops.
@@ -250,6 +257,7 @@ struct inp_par_enc
   int RandomIntraMBRefresh;     //!< Number of pseudo-random intra-MBs per picture
 
   int OnTheFlyFractMCP;         //!< On the fly interpolation mode
+  int LazySubPelInterp;         //!< Interpolate the sub-pel images tile by tile on first use
 
   // Chroma interpolation and buffering
   int ChromaMCBuffer;
@@ -390,6 +398,8 @@ struct inp_par_enc
   // Fast Mode Decision
   int EarlySkipEnable;
   int SelectiveIntraEnable;
+  int EarlyTermination;              //!< searches the mode decision may skip: 1: 8x8 sub-partitions, 2: intra in inter slices, 4: references past the first
+  int EarlyTerminationStrength;      //!< skip below this percent of the learned threshold
   int DisposableP;
   int DispPQPOffset;
 
@@ -406,6 +416,9 @@ struct inp_par_enc
   int PreferDispOrder;       //!< Prefer display order when building the prediction structure as opposed to coding order
   int PreferPowerOfTwo;      //!< Prefer prediction structures that have lengths expressed as powers of two
   int FrmStructBufferLength; //!< Number of frames that is populated every time populate_frm_struct is called
+  int Lookahead;             //!< Number of frames analysed ahead of the coded ones (0: off)
+  int AdaptiveBFrames;       //!< Shorten the runs of B frames where the lookahead finds many intra blocks
+  int SceneCutThreshold;     //!< Code a frame as I if the lookahead finds its inter cost within this percentage of its intra cost (0: off)
   // support for "soft" 3:2 pulldown
   int rc_cpb_size;
   int SEIVUI32Pulldown;                //!< Enable 3:2 pulldown through VUI and SEI metadata signalling. Three methods are supported.
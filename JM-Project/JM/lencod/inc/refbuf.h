@@ -17,12 +17,14 @@
  * \brief
  *    Yields a pel line _pointer_ from one of the 16 sub-images
  *    Input does not require subpixel image indices
+ *    The sub-images are addressed through their contiguous views
+ *    (base and stride), not through their row pointers
  ************************************************************************
  */
 static inline imgpel *UMVLine4X (StorablePicture *ref, int y, int x)
 {
-  //return &(ref->p_curr_img_sub[(y & 0x03)][(x & 0x03)][iClip3( 0, ref->size_y_pad, y >> 2)][iClip3( 0, ref->size_x_pad, x >> 2)]);
-  return &(ref->p_curr_img_sub[(y & 0x03)][(x & 0x03)][iClip3( -IMG_PAD_SIZE_Y, ref->size_y_pad, y >> 2)][iClip3(-IMG_PAD_SIZE_X, ref->size_x_pad, x >> 2)]);
+  PelPlane *plane = &ref->p_curr_plane_sub[((y & 0x03) << 2) + (x & 0x03)];
+  return plane->base + iClip3( -IMG_PAD_SIZE_Y, ref->size_y_pad, y >> 2) * plane->stride + iClip3(-IMG_PAD_SIZE_X, ref->size_x_pad, x >> 2);
 }
 
 /*!
@@ -34,8 +36,8 @@ static inline imgpel *UMVLine4X (StorablePicture *ref, int y, int x)
  */
 static inline imgpel *UMVLine4Xcr (StorablePicture *ref, int cmp, int y, int x)
 {
-  //return &(ref->p_img_sub[cmp][(y & 0x03)][(x & 0x03)][iClip3( 0, ref->size_y_cr_pad, y >> 2)][iClip3( 0, ref->size_x_cr_pad, x >> 2)]);
-  return &(ref->p_img_sub[cmp][(y & 0x03)][(x & 0x03)][iClip3(-ref->pad_size_uv_y, ref->size_y_cr_pad, y >> 2)][iClip3(-ref->pad_size_uv_x, ref->size_x_cr_pad, x >> 2)]);
+  PelPlane *plane = &ref->plane_sub[cmp][(y & 0x03) * (ref->chroma_mask_mv_x + 1) + (x & 0x03)];
+  return plane->base + iClip3(-ref->pad_size_uv_y, ref->size_y_cr_pad, y >> 2) * plane->stride + iClip3(-ref->pad_size_uv_x, ref->size_x_cr_pad, x >> 2);
 }
 
 /*!
@@ -47,7 +49,8 @@ static inline imgpel *UMVLine4Xcr (StorablePicture *ref, int cmp, int y, int x)
  */
 static inline imgpel *FastLine4X (StorablePicture *ref, int y, int x)
 {
-  return &(ref->p_curr_img_sub[(y & 0x03)][(x & 0x03)][y >> 2][x >> 2]);
+  PelPlane *plane = &ref->p_curr_plane_sub[((y & 0x03) << 2) + (x & 0x03)];
+  return plane->base + (y >> 2) * plane->stride + (x >> 2);
 }
 
 /*!
@@ -60,8 +63,8 @@ static inline imgpel *FastLine4X (StorablePicture *ref, int y, int x)
  */
 static inline imgpel *UMVLine8X_chroma (StorablePicture *ref, int cmp, int y, int x)
 {
-  //return &(ref->p_img_sub[cmp][y & ref->chroma_mask_mv_y][x & ref->chroma_mask_mv_x][iClip3 (0, ref->size_y_cr_pad, y >> ref->chroma_shift_y)][iClip3 (0, ref->size_x_cr_pad, x >> ref->chroma_shift_x)]);
-  return &(ref->p_img_sub[cmp][y & ref->chroma_mask_mv_y][x & ref->chroma_mask_mv_x][iClip3 (-ref->pad_size_uv_y, ref->size_y_cr_pad, y >> ref->chroma_shift_y)][iClip3 (-ref->pad_size_uv_x, ref->size_x_cr_pad, x >> ref->chroma_shift_x)]);
+  PelPlane *plane = &ref->plane_sub[cmp][(y & ref->chroma_mask_mv_y) * (ref->chroma_mask_mv_x + 1) + (x & ref->chroma_mask_mv_x)];
+  return plane->base + iClip3 (-ref->pad_size_uv_y, ref->size_y_cr_pad, y >> ref->chroma_shift_y) * plane->stride + iClip3 (-ref->pad_size_uv_x, ref->size_x_cr_pad, x >> ref->chroma_shift_x);
 }
 
 /*!
@@ -74,7 +77,8 @@ static inline imgpel *UMVLine8X_chroma (StorablePicture *ref, int cmp, int y, in
  */
 static inline imgpel *FastLine8X_chroma (StorablePicture *ref, int cmp, int y, int x)
 {
-  return &(ref->p_img_sub[cmp][y & ref->chroma_mask_mv_y][x & ref->chroma_mask_mv_x][y >> ref->chroma_shift_y][x >> ref->chroma_shift_x]);
+  PelPlane *plane = &ref->plane_sub[cmp][(y & ref->chroma_mask_mv_y) * (ref->chroma_mask_mv_x + 1) + (x & ref->chroma_mask_mv_x)];
+  return plane->base + (y >> ref->chroma_shift_y) * plane->stride + (x >> ref->chroma_shift_x);
 }
 
 
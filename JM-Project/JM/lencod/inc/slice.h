@@ -35,14 +35,22 @@ static const int QP2QUANT[40]=
 
 
 extern int  encode_one_slice       ( VideoParameters *p_Vid, int SliceGroupId, int TotalCodedMBs );
+extern Slice *start_encode_slice   ( VideoParameters *p_Vid, int SliceGroupId, struct stat_parameters *cur_stats );
+extern int  encode_slice_macroblocks ( Slice *currSlice, Macroblock **currMB );
+extern void code_slice_macroblock  ( Slice *currSlice, Macroblock **currMB, int mb_addr );
+extern void end_encode_slice       ( Macroblock *currMB, int lastslice );
 extern int  encode_one_slice_MBAFF ( VideoParameters *p_Vid, int SliceGroupId, int TotalCodedMBs );
 extern void init_slice             ( VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr );
 extern void init_slice_lite        ( VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr );
 extern void free_slice_list        ( Picture *currPic );
+extern void add_slice_arena_stats  ( struct mem_arena_stats *sum, Picture *currPic );
+extern void get_slice_arena_stats  ( VideoParameters *p_Vid, struct mem_arena_stats *sum );
 
 extern void SetLagrangianMultipliersOn (Slice *currSlice);
 extern void SetLagrangianMultipliersOff(Slice *currSlice);
 extern void  free_slice                (Slice *currSlice);
+extern Slice *copy_slice               (VideoParameters *p_Vid, Slice *currSlice);
+extern void  free_slice_copy           (Slice *copy);
 
 
 #endif
@@ -0,0 +1,55 @@
+
+/*!
+ ***************************************************************************
+ * \file
+ *    slice_threads.h
+ *
+ * \brief
+ *    Headerfile for the concurrent coding of the slices of a picture
+ *    (SliceThreads > 1)
+ **************************************************************************
+ */
+
+#ifndef _SLICE_THREADS_H_
+#define _SLICE_THREADS_H_
+
+#include "enc_statistics.h"
+
+//! Picture level counters the macroblocks of a slice add to
+typedef struct slice_counters
+{
+  int   pic_bin_count;
+  int   bytes_in_picture;
+  int   intras;
+  int   iInterViewMBs;
+  int   SumFrameQP;
+  int   NumberofCodedMacroBlocks;
+  int64 me_time;
+  int64 me_tot_time;
+} SliceCounters;
+
+typedef struct slice_threads
+{
+  int              num_threads;
+  struct thread_pool *pool;       //!< threads coding the slices of a batch
+  int              batch_size;    //!< slices of the current batch
+  int              next_slice;    //!< first slice of the batch no thread has taken yet
+  VideoParameters *worker;        //!< coding state of the slices of a batch, one per thread
+  StatParameters  *stats;         //!< p_Stats of each worker (bit_slice)
+  StatParameters  *slice_stats;   //!< statistics of the slice coded by each worker
+  SliceCounters   *start;         //!< counters of each worker once its slice is set up
+  Slice          **slice;
+  Macroblock     **last_mb;       //!< last macroblock of each slice
+  int             *last_mb_nr;    //!< address of the last macroblock of each slice
+  int             *coded_mbs;     //!< macroblocks coded in each slice
+} SliceThreads;
+
+extern int  init_coding_worker(VideoParameters *p_Vid, VideoParameters *worker, StatParameters *p_Stats);
+extern void free_coding_worker(VideoParameters *worker);
+extern void copy_coding_state (VideoParameters *dst, VideoParameters *src);
+
+extern int  SliceThreadsInit  (VideoParameters *p_Vid);
+extern void SliceThreadsDelete(VideoParameters *p_Vid);
+extern int  SliceThreadsEncodePlane(VideoParameters *p_Vid);
+
+#endif
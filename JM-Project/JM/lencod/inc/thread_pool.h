@@ -0,0 +1,32 @@
+
+/*!
+ ***************************************************************************
+ * \file
+ *    thread_pool.h
+ *
+ * \brief
+ *    Headerfile for the persistent worker threads of the encoder
+ *    (POSIX threads or Win32 threads, no OpenMP needed)
+ **************************************************************************
+ */
+
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+//! Job run by every thread of a pool, thread is 0 for the calling thread
+typedef void (*ThreadJob) (void *arg, int thread);
+
+typedef struct thread_pool ThreadPool;
+
+extern ThreadPool *create_thread_pool (int num_threads);
+extern void        free_thread_pool   (ThreadPool *pool);
+extern int         run_thread_pool    (ThreadPool *pool, ThreadJob job, void *arg);
+extern int         start_thread_pool  (ThreadPool *pool, ThreadJob job, void *arg);
+extern void        finish_thread_pool (ThreadPool *pool);
+
+extern void        lock_thread_pool   (ThreadPool *pool);
+extern void        unlock_thread_pool (ThreadPool *pool);
+extern void        wait_thread_pool   (ThreadPool *pool);
+extern void        signal_thread_pool (ThreadPool *pool);
+
+#endif
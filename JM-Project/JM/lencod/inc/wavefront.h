@@ -0,0 +1,41 @@
+
+/*!
+ ***************************************************************************
+ * \file
+ *    wavefront.h
+ *
+ * \brief
+ *    Headerfile for the wavefront mode decision of the macroblock rows of
+ *    a picture (WavefrontThreads > 1)
+ **************************************************************************
+ */
+
+#ifndef _WAVEFRONT_H_
+#define _WAVEFRONT_H_
+
+#include "enc_statistics.h"
+
+typedef struct wavefront
+{
+  int                   num_threads;
+  struct thread_pool   *pool;         //!< threads deciding the rows; its lock guards next_row and mbs_done
+  VideoParameters      *p_Vid;        //!< master of the picture being decided
+  int                   next_row;     //!< first row no thread has taken yet
+  VideoParameters      *worker;       //!< coding state of the rows of each thread
+  StatParameters       *stats;        //!< p_Stats of each worker
+  StatParameters       *slice_stats;  //!< statistics of the mode decision writes of each worker (discarded)
+  Slice               **slice;        //!< copy of the current slice used by each worker
+  int64                *me_time;      //!< motion estimation time of each worker
+  int64                *me_tot_time;
+  int               *****cofAC;       //!< AC coefficients decided for each macroblock
+  int                ****cofDC;       //!< DC coefficients decided for each macroblock
+  MotionInfoContexts   *mot_ctx;      //!< CABAC models each macroblock row starts with
+  TextureInfoContexts  *tex_ctx;
+  int                  *mbs_done;     //!< macroblocks decided in each row
+} Wavefront;
+
+extern int  WavefrontInit  (VideoParameters *p_Vid);
+extern void WavefrontDelete(VideoParameters *p_Vid);
+extern int  WavefrontEncodePlane(VideoParameters *p_Vid);
+
+#endif
@@ -104,28 +104,31 @@ int WriteAnnexbNALU (VideoParameters *p_Vid, NALU_t *n, FILE **f_annexb)
 
   fflush (*f_annexb);
 #if TRACE
-  //fprintf (p_Enc->p_trace, "\nAnnex B NALU w/ %s startcode, len %d, forbidden_bit %d, nal_reference_idc %d, nal_unit_type %d\n\n\n",
-  //  n->startcodeprefix_len == 4?"long":"short", n->len + 1, n->forbidden_bit, n->nal_reference_idc, n->nal_unit_type);
-  fprintf (p_Enc->p_trace, "\nAnnex B NALU w/ %s startcode, len %d,", n->startcodeprefix_len == 4?"long":"short", n->len + 1);
-  fprintf (p_Enc->p_trace, "\n                forbidden_bit       %d,", n->forbidden_bit);
-  fprintf (p_Enc->p_trace, "\n                nal_reference_idc   %d,", n->nal_reference_idc);
-  fprintf (p_Enc->p_trace, "\n                nal_unit_type       %d ", n->nal_unit_type);
-#if (MVC_EXTENSION_ENABLE)
-  if(n->nal_unit_type==NALU_TYPE_PREFIX || n->nal_unit_type==NALU_TYPE_SLC_EXT)
+  if (p_Enc->p_trace != NULL)
   {
-    fprintf (p_Enc->p_trace, "\n                svc_extension_flag  %d ", n->svc_extension_flag);
-    fprintf (p_Enc->p_trace, "\n                non_idr_flag        %d ", n->non_idr_flag);
-    fprintf (p_Enc->p_trace, "\n                priority_id         %d ", n->priority_id);
-
-    fprintf (p_Enc->p_trace, "\n                view_id             %d ", p_Vid->p_Inp->MVCFlipViews ? !(n->view_id) : n->view_id);
-    fprintf (p_Enc->p_trace, "\n                temporal_id         %d ", n->temporal_id);
-    fprintf (p_Enc->p_trace, "\n                anchor_pic_flag     %d ", n->anchor_pic_flag);
-    fprintf (p_Enc->p_trace, "\n                inter_view_flag     %d ", n->inter_view_flag);
-    fprintf (p_Enc->p_trace, "\n                reserved_one_bit    %d ", n->reserved_one_bit);
-  }
+    //fprintf (p_Enc->p_trace, "\nAnnex B NALU w/ %s startcode, len %d, forbidden_bit %d, nal_reference_idc %d, nal_unit_type %d\n\n\n",
+    //  n->startcodeprefix_len == 4?"long":"short", n->len + 1, n->forbidden_bit, n->nal_reference_idc, n->nal_unit_type);
+    fprintf (p_Enc->p_trace, "\nAnnex B NALU w/ %s startcode, len %d,", n->startcodeprefix_len == 4?"long":"short", n->len + 1);
+    fprintf (p_Enc->p_trace, "\n                forbidden_bit       %d,", n->forbidden_bit);
+    fprintf (p_Enc->p_trace, "\n                nal_reference_idc   %d,", n->nal_reference_idc);
+    fprintf (p_Enc->p_trace, "\n                nal_unit_type       %d ", n->nal_unit_type);
+#if (MVC_EXTENSION_ENABLE)
+    if(n->nal_unit_type==NALU_TYPE_PREFIX || n->nal_unit_type==NALU_TYPE_SLC_EXT)
+    {
+      fprintf (p_Enc->p_trace, "\n                svc_extension_flag  %d ", n->svc_extension_flag);
+      fprintf (p_Enc->p_trace, "\n                non_idr_flag        %d ", n->non_idr_flag);
+      fprintf (p_Enc->p_trace, "\n                priority_id         %d ", n->priority_id);
+
+      fprintf (p_Enc->p_trace, "\n                view_id             %d ", p_Vid->p_Inp->MVCFlipViews ? !(n->view_id) : n->view_id);
+      fprintf (p_Enc->p_trace, "\n                temporal_id         %d ", n->temporal_id);
+      fprintf (p_Enc->p_trace, "\n                anchor_pic_flag     %d ", n->anchor_pic_flag);
+      fprintf (p_Enc->p_trace, "\n                inter_view_flag     %d ", n->inter_view_flag);
+      fprintf (p_Enc->p_trace, "\n                reserved_one_bit    %d ", n->reserved_one_bit);
+    }
 #endif
-  fprintf (p_Enc->p_trace, "\n----------------------------------------------------------------------------\n\n\n");
-  fflush (p_Enc->p_trace);
+    fprintf (p_Enc->p_trace, "\n----------------------------------------------------------------------------\n\n\n");
+    fflush (p_Enc->p_trace);
+  }
 #endif
   return BitsWritten;
 }
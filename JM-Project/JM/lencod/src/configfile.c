@@ -1244,6 +1244,12 @@ static void PatchInp (VideoParameters *p_Vid, InputParameters *p_Inp)
     p_Inp->ChromaMCBuffer = 1;
   }
 
+  if ( p_Inp->LazySubPelInterp && (p_Inp->OnTheFlyFractMCP || p_Inp->yuv_format == YUV444) )
+  {
+    fprintf(stderr, "Warning: LazySubPelInterp cannot be used with OnTheFlyFractMCP or 4:4:4 coding, disabling LazySubPelInterp.\n");
+    p_Inp->LazySubPelInterp = 0;
+  }
+
   if (p_Inp->EnableOpenGOP && p_Inp->ReferenceReorder != 1)
   {
     printf("If OpenGOP is enabled than ReferenceReorder is set to 1. \n");
@@ -1259,6 +1265,18 @@ static void PatchInp (VideoParameters *p_Vid, InputParameters *p_Inp)
     )
     p_Inp->EPZSSubPelGrid = 0;
 
+  // HME runs its pyramid search through the EPZS engine; its MVs are used
+  // as predictors by EPZS and ADS, so it is only built for those
+  if (p_Inp->HMEEnable && p_Inp->SearchMode[0] != EPZS && p_Inp->SearchMode[0] != ADS
+#if (MVC_EXTENSION_ENABLE)
+    && (!p_Inp->SepViewInterSearch || (p_Inp->SearchMode[1] != EPZS && p_Inp->SearchMode[1] != ADS))
+#endif
+    )
+  {
+    printf("Warning: HMEEnable requires SearchMode = 3 (EPZS) or 4 (ADS). Process Disabled.\n");
+    p_Inp->HMEEnable = 0;
+  }
+
   if (p_Inp->redundant_pic_flag)
   {
     if (p_Inp->PicInterlace || p_Inp->MbInterlace)
@@ -1443,6 +1461,120 @@ static void PatchInp (VideoParameters *p_Vid, InputParameters *p_Inp)
     p_Inp->RDPictureFrameQPPSlice = 0;
     p_Inp->RDPictureFrameQPBSlice = 0;
   }
+
+  // Slices are only coded concurrently when nothing but the picture level
+  // state ties one slice to the next
+  if (p_Inp->SliceThreads > 1)
+  {
+    if (p_Inp->slice_mode != 1 || p_Inp->num_slice_groups_minus1 > 0 || p_Inp->MbInterlace
+      || p_Inp->separate_colour_plane_flag || p_Inp->num_of_views > 1)
+    {
+      fprintf(stderr, "Warning: SliceThreads requires SliceMode = 1 without FMO, MB-AFF, separate colour planes or MVC, disabling SliceThreads.\n");
+      p_Inp->SliceThreads = 0;
+    }
+    else if (p_Inp->RCEnable || p_Inp->AdaptiveRounding || (p_Inp->UseRDOQuant && p_Inp->RDOQ_QP_Num > 1)
+      || p_Inp->WPIterMC || p_Inp->WPMCPrecision || p_Inp->rdopt == 3)
+    {
+      fprintf(stderr, "Warning: SliceThreads cannot be used with RCEnable, AdaptiveRounding, RDOQ_QP_Num > 1, WPIterMC, WPMCPrecision or RDOptimization = 3, disabling SliceThreads.\n");
+      p_Inp->SliceThreads = 0;
+    }
+    else if (p_Inp->SearchMode[0] == UM_HEX || p_Inp->SearchMode[0] == UM_HEX_SIMPLE || p_Inp->SearchMode[0] == FAST_FULL_SEARCH
+      || p_Inp->LazySubPelInterp || (int) strlen (p_Inp->METraceFile) > 0)
+    {
+      fprintf(stderr, "Warning: SliceThreads cannot be used with UMHex, UMHexSMP, fast full search, LazySubPelInterp or METraceFile, disabling SliceThreads.\n");
+      p_Inp->SliceThreads = 0;
+    }
+    else if (p_Enc->p_trace != NULL)
+    {
+      fprintf(stderr, "Warning: the trace file cannot be written by concurrent slices, closing %s.\n", p_Inp->TraceFile);
+      fclose(p_Enc->p_trace);
+      p_Enc->p_trace = NULL;
+    }
+  }
+
+  // Macroblock rows are only decided concurrently when the macroblocks of
+  // a row depend on the rows above through the picture alone
+  if (p_Inp->WavefrontThreads > 1)
+  {
+    if (p_Inp->SliceThreads > 1 || p_Inp->slice_mode != 0 || p_Inp->num_slice_groups_minus1 > 0 || p_Inp->MbInterlace
+      || p_Inp->separate_colour_plane_flag || p_Inp->num_of_views > 1 || p_Inp->yuv_format == YUV444)
+    {
+      fprintf(stderr, "Warning: WavefrontThreads requires SliceMode = 0 without SliceThreads, FMO, MB-AFF, 4:4:4 or MVC, disabling WavefrontThreads.\n");
+      p_Inp->WavefrontThreads = 0;
+    }
+    else if (p_Inp->RCEnable || p_Inp->AdaptiveRounding || (p_Inp->UseRDOQuant && p_Inp->RDOQ_QP_Num > 1)
+      || p_Inp->WPIterMC || p_Inp->WPMCPrecision || p_Inp->rdopt == 3 || p_Inp->CtxAdptLagrangeMult)
+    {
+      fprintf(stderr, "Warning: WavefrontThreads cannot be used with RCEnable, AdaptiveRounding, RDOQ_QP_Num > 1, WPIterMC, WPMCPrecision, RDOptimization = 3 or CtxAdptLagrangeMult, disabling WavefrontThreads.\n");
+      p_Inp->WavefrontThreads = 0;
+    }
+    else if (p_Inp->SearchMode[0] == UM_HEX || p_Inp->SearchMode[0] == UM_HEX_SIMPLE || p_Inp->SearchMode[0] == FAST_FULL_SEARCH
+      || p_Inp->LazySubPelInterp || (int) strlen (p_Inp->METraceFile) > 0)
+    {
+      fprintf(stderr, "Warning: WavefrontThreads cannot be used with UMHex, UMHexSMP, fast full search, LazySubPelInterp or METraceFile, disabling WavefrontThreads.\n");
+      p_Inp->WavefrontThreads = 0;
+    }
+    else if (p_Enc->p_trace != NULL)
+    {
+      fprintf(stderr, "Warning: the trace file cannot be written by concurrent macroblock rows, closing %s.\n", p_Inp->TraceFile);
+      fclose(p_Enc->p_trace);
+      p_Enc->p_trace = NULL;
+    }
+  }
+
+  // Non reference B frames are only coded concurrently when a frame leaves
+  // nothing but its bitstream and reconstruction to the frames after it
+  if (p_Inp->BFrameThreads > 1)
+  {
+    if (p_Inp->SliceThreads > 1 || p_Inp->WavefrontThreads > 1 || p_Inp->PicInterlace || p_Inp->MbInterlace
+      || p_Inp->separate_colour_plane_flag || p_Inp->num_of_views > 1 || p_Inp->ExplicitSeqCoding || p_Inp->redundant_pic_flag
+      || p_Inp->sp_periodicity || p_Inp->si_frame_indicator || p_Inp->enable_32_pulldown || p_Inp->of_mode == PAR_OF_RTP)
+    {
+      fprintf(stderr, "Warning: BFrameThreads cannot be used with SliceThreads, WavefrontThreads, interlace, separate colour planes, MVC, ExplicitSeqCoding, redundant pictures, SP/SI frames, 3:2 pulldown or RTP output, disabling BFrameThreads.\n");
+      p_Inp->BFrameThreads = 0;
+    }
+    else if (p_Inp->RCEnable || p_Inp->RDPictureDecision || p_Inp->rdopt == 3
+      || p_Inp->WeightedPrediction || p_Inp->WeightedBiprediction || p_Inp->WPIterMC || p_Inp->WPMCPrecision
+      || p_Inp->CtxAdptLagrangeMult || p_Inp->DistortionYUVtoRGB || p_Inp->MDReference[0] || p_Inp->MDReference[1]
+      || p_Inp->RestrictRef || p_Inp->RandomIntraMBRefresh || p_Inp->pic_order_cnt_type == 2)
+    {
+      fprintf(stderr, "Warning: BFrameThreads cannot be used with RCEnable, RDPictureDecision, RDOptimization = 3, weighted prediction, CtxAdptLagrangeMult, DistortionYUVtoRGB, MDReference, RestrictRefFrames, RandomIntraMBRefresh or POC type 2, disabling BFrameThreads.\n");
+      p_Inp->BFrameThreads = 0;
+    }
+    else if (p_Inp->SearchMode[0] == UM_HEX || p_Inp->SearchMode[0] == UM_HEX_SIMPLE || p_Inp->SearchMode[0] == FAST_FULL_SEARCH
+      || p_Inp->LazySubPelInterp || (int) strlen (p_Inp->METraceFile) > 0)
+    {
+      fprintf(stderr, "Warning: BFrameThreads cannot be used with UMHex, UMHexSMP, fast full search, LazySubPelInterp or METraceFile, disabling BFrameThreads.\n");
+      p_Inp->BFrameThreads = 0;
+    }
+    else if (p_Enc->p_trace != NULL)
+    {
+      fprintf(stderr, "Warning: the trace file cannot be written by concurrent frames, closing %s.\n", p_Inp->TraceFile);
+      fclose(p_Enc->p_trace);
+      p_Enc->p_trace = NULL;
+    }
+  }
+
+  // The lookahead analyses the frames ahead and places the prediction structures
+  // a few GOPs at a time, which the field and explicit structures do not follow
+  if (p_Inp->Lookahead)
+  {
+    if (p_Inp->PicInterlace || p_Inp->num_of_views > 1 || p_Inp->ExplicitSeqCoding || p_Inp->intra_delay
+      || p_Inp->enable_32_pulldown || p_Inp->input_file1.vdtype == VIDEO_TIFF)
+    {
+      fprintf(stderr, "Warning: Lookahead cannot be used with field coding, MVC, ExplicitSeqCoding, IntraDelay, 3:2 pulldown or TIFF input, disabling Lookahead.\n");
+      p_Inp->Lookahead = 0;
+    }
+    else
+      p_Inp->Lookahead = imax(p_Inp->Lookahead, p_Inp->NumberBFrames + 1);
+  }
+
+  // The early termination thresholds are learned from macroblock to macroblock
+  if (p_Inp->EarlyTermination && (p_Inp->SliceThreads > 1 || p_Inp->WavefrontThreads > 1 || p_Inp->BFrameThreads > 1))
+  {
+    fprintf(stderr, "Warning: EarlyTermination cannot be used with SliceThreads, WavefrontThreads or BFrameThreads, disabling EarlyTermination.\n");
+    p_Inp->EarlyTermination = 0;
+  }
 }
 
 /*!
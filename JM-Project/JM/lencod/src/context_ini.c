@@ -72,6 +72,12 @@ void free_context_memory (VideoParameters *p_Vid)
   free_mem3Dint(p_Vid->modelNumber);
 }
 
+void copy_context_memory (VideoParameters *dst, VideoParameters *src)
+{
+  memcpy(&dst->initialized[0][0][0], &src->initialized[0][0][0], 3 * FRAME_TYPES * src->number_of_slices * sizeof(int));
+  memcpy(&dst->modelNumber[0][0][0], &src->modelNumber[0][0][0], 3 * FRAME_TYPES * src->number_of_slices * sizeof(int));
+}
+
 #define BIARI_CTX_INIT2(qp, ii,jj,ctx,tab) \
 { \
   for (i=0; i<ii; i++) \
@@ -0,0 +1,553 @@
+
+/*!
+*************************************************************************************
+* \file frame_threads.c
+*
+* \brief
+*    Concurrent coding of runs of consecutive non reference B frames
+*    (BFrameThreads > 1).
+*
+*    A non reference B frame only reads the references already in the
+*    DPB, and the frames coded after it only see its bitstream and its
+*    reconstruction (for output). encode_sequence() hands each run of up
+*    to BFrameThreads such frames to FrameThreadsEncode(), which codes
+*    every frame of the run with its own coding context: a copy of the
+*    master VideoParameters with private picture, macroblock, RD, rounding
+*    and motion search buffers, sharing the DPB, the parameter sets and
+*    the sequence structure. The run is coded in three phases:
+*
+*    - the frames are set up and read in coding order (start_one_frame),
+*      each context continuing from the state left by the one before;
+*    - the frames are coded concurrently (code_one_frame) on a thread
+*      pool of BFrameThreads threads;
+*    - the frames are written, stored in the DPB and reported in coding
+*      order (finish_one_frame), as encode_one_frame() would do it, so
+*      the NAL units and the output keep their order.
+*
+*    The state a frame adapts for the frames after it (the CABAC models
+*    kept with ContextInitMethod = 1, the adaptive rounding offsets, the
+*    ADS predictor memory) is taken by every frame of a run from the frame
+*    coded before the run, and the one left by the last frame of the run
+*    is kept. A run of more than BFrameThreads frames is coded in parts
+*    that all start from that state. The bitstream therefore differs from
+*    the serial one when these tools are used, but not with the number of
+*    threads.
+*    Configurations with other state carried from frame to frame are
+*    rejected in PatchInp().
+*
+*************************************************************************************
+*/
+
+#include "global.h"
+#include "frame_threads.h"
+#include "slice_threads.h"
+#include "slice.h"
+#include "image.h"
+#include "context_ini.h"
+#include "fmo.h"
+#include "macroblock.h"
+#include "memalloc.h"
+#include "me_ads.h"
+#include "me_hme.h"
+#include "report.h"
+#include "thread_pool.h"
+
+//! Reads the buffers owned by p_Vid
+static void get_frame_buffers (VideoParameters *p_Vid, FrameBuffers *b)
+{
+  b->b8x8info               = p_Vid->b8x8info;
+  b->motion_cost            = p_Vid->motion_cost;
+  b->p_SADCache             = p_Vid->p_SADCache;
+  b->p_Quant                = p_Vid->p_Quant;
+  b->pHMEInfo               = p_Vid->pHMEInfo;
+  b->p_ADS                  = p_Vid->p_ADS;
+  b->mb_data                = p_Vid->mb_data;
+  b->ipredmode              = p_Vid->ipredmode;
+  b->ipredmode8x8           = p_Vid->ipredmode8x8;
+  b->nz_coeff               = p_Vid->nz_coeff_buf[0];
+  b->intra_block            = p_Vid->intra_block;
+  b->ARCofAdj4x4            = p_Vid->ARCofAdj4x4;
+  b->ARCofAdj8x8            = p_Vid->ARCofAdj8x8;
+  b->lambda                 = p_Vid->lambda_buf[0];
+  b->lambda_md              = p_Vid->lambda_md_buf[0];
+  b->lambda_me              = p_Vid->lambda_me_buf[0];
+  b->lambda_mf              = p_Vid->lambda_mf_buf[0];
+  b->lambda_rdoq            = p_Vid->lambda_rdoq_buf[0];
+  b->imgData                = p_Vid->imgData;
+  b->enc_frame_picture      = p_Vid->enc_frame_picture;
+  b->enc_field_picture      = p_Vid->enc_field_picture;
+  b->frame_pic              = p_Vid->frame_pic;
+  b->p_PicPool              = p_Vid->p_PicPool;
+  b->MapUnitToSliceGroupMap = p_Vid->MapUnitToSliceGroupMap;
+  b->MBAmap                 = p_Vid->MBAmap;
+  b->initialized            = p_Vid->initialized;
+  b->modelNumber            = p_Vid->modelNumber;
+}
+
+//! Points p_Vid to the buffers in b
+static void set_frame_buffers (VideoParameters *p_Vid, FrameBuffers *b)
+{
+  p_Vid->b8x8info               = b->b8x8info;
+  p_Vid->motion_cost            = b->motion_cost;
+  p_Vid->p_SADCache             = b->p_SADCache;
+  p_Vid->p_Quant                = b->p_Quant;
+  p_Vid->pHMEInfo               = b->pHMEInfo;
+  p_Vid->p_ADS                  = b->p_ADS;
+  p_Vid->mb_data                = b->mb_data;
+  p_Vid->ipredmode              = b->ipredmode;
+  p_Vid->ipredmode8x8           = b->ipredmode8x8;
+  p_Vid->nz_coeff               = p_Vid->nz_coeff_buf[0] = b->nz_coeff;
+  p_Vid->intra_block            = b->intra_block;
+  p_Vid->ARCofAdj4x4            = b->ARCofAdj4x4;
+  p_Vid->ARCofAdj8x8            = b->ARCofAdj8x8;
+  p_Vid->lambda                 = p_Vid->lambda_buf[0]      = b->lambda;
+  p_Vid->lambda_md              = p_Vid->lambda_md_buf[0]   = b->lambda_md;
+  p_Vid->lambda_me              = p_Vid->lambda_me_buf[0]   = b->lambda_me;
+  p_Vid->lambda_mf              = p_Vid->lambda_mf_buf[0]   = b->lambda_mf;
+  p_Vid->lambda_rdoq            = p_Vid->lambda_rdoq_buf[0] = b->lambda_rdoq;
+  p_Vid->imgData                = b->imgData;
+  p_Vid->enc_frame_picture      = b->enc_frame_picture;
+  p_Vid->enc_field_picture      = b->enc_field_picture;
+  p_Vid->frame_pic              = b->frame_pic;
+  p_Vid->p_PicPool              = b->p_PicPool;
+  p_Vid->MapUnitToSliceGroupMap = b->MapUnitToSliceGroupMap;
+  p_Vid->MBAmap                 = b->MBAmap;
+  p_Vid->initialized            = b->initialized;
+  p_Vid->modelNumber            = b->modelNumber;
+}
+
+//! Copies the coding state of src to dst, dst keeping its own buffers
+static void copy_frame_state (VideoParameters *dst, VideoParameters *src)
+{
+  FrameBuffers b;
+
+  get_frame_buffers(dst, &b);
+  *dst = *src;
+  set_frame_buffers(dst, &b);
+}
+
+//! Largest QP index of the quantization and rounding tables
+static int max_quant_qp (InputParameters *p_Inp)
+{
+  return 3 + 6 * imax(p_Inp->output.bit_depth[0], p_Inp->output.bit_depth[1]);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Copies the state the frames of a run adapt for the frames after
+ *    them from src to dst: the CABAC model selection, the quantization
+ *    and adaptive rounding tables, the lambdas and the ADS memory
+ ***********************************************************************
+ */
+static void copy_adaptive_state (VideoParameters *dst, VideoParameters *src)
+{
+  InputParameters *p_Inp = src->p_Inp;
+  int max_qp = max_quant_qp(p_Inp);
+  int scale = src->bitdepth_luma_qp_scale;
+  int j, qp;
+
+  copy_context_memory(dst, src);
+
+  memcpy(&dst->p_Quant->q_params_4x4[0][0][0][0][0], &src->p_Quant->q_params_4x4[0][0][0][0][0], 3 * 2 * (max_qp + 1) * 16 * sizeof(LevelQuantParams));
+  memcpy(&dst->p_Quant->q_params_8x8[0][0][0][0][0], &src->p_Quant->q_params_8x8[0][0][0][0][0], 3 * 2 * (max_qp + 1) * 64 * sizeof(LevelQuantParams));
+  if (p_Inp->AdaptiveRounding)
+  {
+    int lists = p_Inp->AdaptRoundingFixed ? 1 : max_qp + 1;
+    memcpy(&dst->p_Quant->OffsetList4x4[0][0][0], &src->p_Quant->OffsetList4x4[0][0][0], lists * 25 * 16 * sizeof(short));
+    memcpy(&dst->p_Quant->OffsetList8x8[0][0][0], &src->p_Quant->OffsetList8x8[0][0][0], lists * 15 * 64 * sizeof(short));
+  }
+
+  memcpy(&dst->lambda[0][-scale],    &src->lambda[0][-scale],    10 * (52 + scale) * sizeof(LambdaParams));
+  memcpy(&dst->lambda_md[0][-scale], &src->lambda_md[0][-scale], 10 * (52 + scale) * sizeof(double));
+  if (p_Inp->UseRDOQuant)
+    memcpy(&dst->lambda_rdoq[0][-scale], &src->lambda_rdoq[0][-scale], 10 * (52 + scale) * sizeof(double));
+  for (j = 0; j < 10; ++j)
+  {
+    for (qp = -scale; qp < 52; ++qp)
+    {
+      memcpy(dst->lambda_me[j][qp], src->lambda_me[j][qp], 3 * sizeof(double));
+      memcpy(dst->lambda_mf[j][qp], src->lambda_mf[j][qp], 3 * sizeof(int));
+    }
+  }
+
+  if (src->p_ADS != NULL)
+    ADSCopyMemory(dst, src);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Allocates the buffers of a frame coding context. Returns the number
+ *    of bytes allocated.
+ ***********************************************************************
+ */
+static int init_frame_context (VideoParameters *p_Vid, VideoParameters *ctx, QuantParameters *p_Quant)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  int max_qp = max_quant_qp(p_Inp);
+  int scale = p_Vid->bitdepth_luma_qp_scale;
+  int memory_size = 0;
+  int j;
+
+  *ctx = *p_Vid;
+  memory_size += init_coding_worker(p_Vid, ctx, p_Vid->p_Stats);
+
+  *p_Quant = *p_Vid->p_Quant;
+  memory_size += get_mem5Dquant(&p_Quant->q_params_4x4, 3, 2, max_qp + 1, 4, 4);
+  memory_size += get_mem5Dquant(&p_Quant->q_params_8x8, 3, 2, max_qp + 1, 8, 8);
+  if (p_Inp->AdaptiveRounding)
+  {
+    int lists = p_Inp->AdaptRoundingFixed ? 1 : max_qp + 1;
+    memory_size += get_mem3Dshort(&p_Quant->OffsetList4x4, lists, 25, 16);
+    memory_size += get_mem3Dshort(&p_Quant->OffsetList8x8, lists, 15, 64);
+    if (p_Vid->yuv_format != YUV400)
+    {
+      memory_size += get_mem4Dint(&ctx->ARCofAdj4x4, 3, MAXMODE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+      memory_size += get_mem4Dint(&ctx->ARCofAdj8x8, p_Vid->P444_joined ? 3 : 1, MAXMODE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    }
+    else
+    {
+      memory_size += get_mem4Dint(&ctx->ARCofAdj4x4, 1, MAXMODE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+      memory_size += get_mem4Dint(&ctx->ARCofAdj8x8, 1, MAXMODE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    }
+  }
+  ctx->p_Quant = p_Quant;
+
+  if (p_Vid->pHMEInfo != NULL)
+    InitHMEInfo(ctx, p_Inp);
+  if (p_Vid->p_ADS != NULL)
+    memory_size += ADSInit(ctx);
+
+  if ((ctx->mb_data = alloc_mbs(ctx, p_Vid->FrameSizeInMbs, p_Vid->num_of_layers)) == NULL)
+    no_mem_exit("init_frame_context: ctx->mb_data");
+  memory_size += get_mem2D((byte ***) &ctx->ipredmode, p_Vid->height_blk, p_Vid->width_blk);
+  memory_size += get_mem2D((byte ***) &ctx->ipredmode8x8, p_Vid->height_blk, p_Vid->width_blk);
+  memset(&ctx->ipredmode[0][0],    -1, p_Vid->height_blk * p_Vid->width_blk * sizeof(char));
+  memset(&ctx->ipredmode8x8[0][0], -1, p_Vid->height_blk * p_Vid->width_blk * sizeof(char));
+  memory_size += get_mem3Dint(&ctx->nz_coeff_buf[0], p_Vid->FrameSizeInMbs, 4, 4 + p_Vid->num_blk8x8_uv);
+  ctx->nz_coeff = ctx->nz_coeff_buf[0];
+  if (p_Inp->UseConstrainedIntraPred)
+  {
+    if ((ctx->intra_block = (short *) calloc(p_Vid->FrameSizeInMbs, sizeof(short))) == NULL)
+      no_mem_exit("init_frame_context: ctx->intra_block");
+    memory_size += p_Vid->FrameSizeInMbs * sizeof(short);
+  }
+
+  memory_size += get_mem2Dolm    (&ctx->lambda_buf[0],    10, 52 + scale, scale);
+  memory_size += get_mem2Dodouble(&ctx->lambda_md_buf[0], 10, 52 + scale, scale);
+  memory_size += get_mem3Dodouble(&ctx->lambda_me_buf[0], 10, 52 + scale, 3, scale);
+  memory_size += get_mem3Doint   (&ctx->lambda_mf_buf[0], 10, 52 + scale, 3, scale);
+  if (p_Inp->UseRDOQuant)
+    memory_size += get_mem2Dodouble(&ctx->lambda_rdoq_buf[0], 10, 52 + scale, scale);
+  ctx->lambda      = ctx->lambda_buf[0];
+  ctx->lambda_md   = ctx->lambda_md_buf[0];
+  ctx->lambda_me   = ctx->lambda_me_buf[0];
+  ctx->lambda_mf   = ctx->lambda_mf_buf[0];
+  ctx->lambda_rdoq = ctx->lambda_rdoq_buf[0];
+
+  memory_size += init_orig_buffers(ctx, &ctx->imgData);
+
+  if ((ctx->enc_frame_picture = (StorablePicture **) calloc(6, sizeof(StorablePicture *))) == NULL)
+    no_mem_exit("init_frame_context: ctx->enc_frame_picture");
+  if ((ctx->enc_field_picture = (StorablePicture **) calloc(2, sizeof(StorablePicture *))) == NULL)
+    no_mem_exit("init_frame_context: ctx->enc_field_picture");
+  if ((ctx->frame_pic = (Picture **) malloc(p_Vid->frm_iter * sizeof(Picture *))) == NULL)
+    no_mem_exit("init_frame_context: ctx->frame_pic");
+  for (j = 0; j < p_Vid->frm_iter; ++j)
+    ctx->frame_pic[j] = malloc_picture();
+
+  // FmoInit() allocates the maps of each picture
+  ctx->MapUnitToSliceGroupMap = NULL;
+  ctx->MBAmap = NULL;
+  // the pictures of the contexts, allocated and freed while the frames
+  // are coded concurrently, bypass the picture pool
+  ctx->p_PicPool = NULL;
+
+  create_context_memory(ctx, p_Inp);
+
+  return memory_size;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Frees the buffers of a frame coding context
+ ***********************************************************************
+ */
+static void free_frame_context (VideoParameters *ctx, QuantParameters *p_Quant)
+{
+  InputParameters *p_Inp = ctx->p_Inp;
+  int scale = ctx->bitdepth_luma_qp_scale;
+  int j;
+
+  free_coding_worker(ctx);
+
+  free_mem5Dquant(p_Quant->q_params_4x4);
+  free_mem5Dquant(p_Quant->q_params_8x8);
+  if (p_Inp->AdaptiveRounding)
+  {
+    free_mem3Dshort(p_Quant->OffsetList4x4);
+    free_mem3Dshort(p_Quant->OffsetList8x8);
+    free_mem4Dint(ctx->ARCofAdj4x4);
+    free_mem4Dint(ctx->ARCofAdj8x8);
+  }
+
+  FreeHMEInfo(ctx);
+  ADSDelete(ctx);
+
+  free_mbs(ctx->mb_data, ctx->FrameSizeInMbs);
+  free_mem2D((byte **) ctx->ipredmode);
+  free_mem2D((byte **) ctx->ipredmode8x8);
+  free_mem3Dint(ctx->nz_coeff_buf[0]);
+  free_pointer(ctx->intra_block);
+
+  free_mem2Dolm    (ctx->lambda_buf[0], scale);
+  free_mem2Dodouble(ctx->lambda_md_buf[0], scale);
+  free_mem3Dodouble(ctx->lambda_me_buf[0], 10, 52 + scale, scale);
+  free_mem3Doint   (ctx->lambda_mf_buf[0], 10, 52 + scale, scale);
+  if (p_Inp->UseRDOQuant)
+    free_mem2Dodouble(ctx->lambda_rdoq_buf[0], scale);
+
+  free_orig_planes(ctx, &ctx->imgData);
+
+  free(ctx->enc_frame_picture);
+  free(ctx->enc_field_picture);
+  for (j = 0; j < ctx->frm_iter; ++j)
+    free_picture(ctx->frame_pic[j]);
+  free(ctx->frame_pic);
+
+  FmoUninit(ctx);
+
+  free_context_memory(ctx);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Codes the frames of the run taken by one thread of the pool
+ ***********************************************************************
+ */
+static void code_frames (void *arg, int thread)
+{
+  FrameThreads *p_ft = (FrameThreads *) arg;
+
+  for (;;)
+  {
+    int k;
+
+    lock_thread_pool(p_ft->pool);
+    k = p_ft->next_frame++;
+    unlock_thread_pool(p_ft->pool);
+    if (k >= p_ft->run_length)
+      break;
+
+    if (p_ft->coded[k])
+      code_one_frame(&p_ft->ctx[k]);
+  }
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Allocates the coding contexts of the frames of a run. Returns the
+ *    number of bytes allocated.
+ ***********************************************************************
+ */
+int FrameThreadsInit (VideoParameters *p_Vid)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  FrameThreads *p_ft;
+  int n = p_Inp->BFrameThreads;
+  int memory_size = 0;
+  int i;
+
+  if ((p_ft = (FrameThreads *) calloc(1, sizeof(FrameThreads))) == NULL)
+    no_mem_exit("FrameThreadsInit: p_ft");
+  if ((p_ft->ctx = (VideoParameters *) calloc(n, sizeof(VideoParameters))) == NULL)
+    no_mem_exit("FrameThreadsInit: p_ft->ctx");
+  if ((p_ft->quant = (QuantParameters *) calloc(n, sizeof(QuantParameters))) == NULL)
+    no_mem_exit("FrameThreadsInit: p_ft->quant");
+  if ((p_ft->stats = (StatParameters *) calloc(n, sizeof(StatParameters))) == NULL)
+    no_mem_exit("FrameThreadsInit: p_ft->stats");
+  if ((p_ft->dist = (DistortionParams *) calloc(n, sizeof(DistortionParams))) == NULL)
+    no_mem_exit("FrameThreadsInit: p_ft->dist");
+  if ((p_ft->inp = (InputParameters *) calloc(n, sizeof(InputParameters))) == NULL)
+    no_mem_exit("FrameThreadsInit: p_ft->inp");
+  if ((p_ft->coded = (int *) calloc(n, sizeof(int))) == NULL)
+    no_mem_exit("FrameThreadsInit: p_ft->coded");
+  memory_size += sizeof(FrameThreads) + n * (sizeof(VideoParameters) + sizeof(QuantParameters) + sizeof(StatParameters)
+    + sizeof(DistortionParams) + sizeof(InputParameters) + sizeof(int));
+
+  for (i = 0; i < n; ++i)
+    memory_size += init_frame_context(p_Vid, &p_ft->ctx[i], &p_ft->quant[i]);
+
+  p_ft->pool = create_thread_pool(n);
+  p_ft->num_threads = n;
+  p_Vid->p_FrameThreads = p_ft;
+
+  return memory_size;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Frees the coding contexts of the frames of a run
+ ***********************************************************************
+ */
+void FrameThreadsDelete (VideoParameters *p_Vid)
+{
+  FrameThreads *p_ft = p_Vid->p_FrameThreads;
+  int i, j;
+
+  if (p_ft == NULL)
+    return;
+
+  free_thread_pool(p_ft->pool);
+  for (i = 0; i < p_ft->num_threads; ++i)
+  {
+    // the slice arenas of the contexts are counted with those of p_Vid
+    if (p_Vid->p_ArenaStats)
+    {
+      for (j = 0; j < p_Vid->frm_iter; ++j)
+        add_slice_arena_stats(p_Vid->p_ArenaStats, p_ft->ctx[i].frame_pic[j]);
+    }
+    p_ft->ctx[i].p_Inp = p_Vid->p_Inp;
+    free_frame_context(&p_ft->ctx[i], &p_ft->quant[i]);
+  }
+  free(p_ft->coded);
+  free(p_ft->inp);
+  free(p_ft->dist);
+  free(p_ft->stats);
+  free(p_ft->quant);
+  free(p_ft->ctx);
+  free(p_ft);
+  p_Vid->p_FrameThreads = NULL;
+}
+
+//! True if frame frame_to_code of the coding order is a non reference B frame of the populated sequence structure
+static int is_run_frame (VideoParameters *p_Vid, int frame_to_code, int frames_to_code)
+{
+  FrameUnitStruct *p_frm = p_Vid->p_pred->p_frm + frame_to_code % p_Vid->frm_struct_buffer;
+
+  if (frame_to_code >= frames_to_code || frame_to_code >= p_Vid->p_pred->pop_start_frame)
+    return FALSE;
+  return (p_frm->frame_no < p_Vid->p_Inp->no_frames && p_frm->type == B_SLICE && p_frm->nal_ref_idc == 0 && !p_frm->idr_flag);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Returns the number of consecutive non reference B frames starting
+ *    with frame curr_frame_to_code of the coding order, up to
+ *    BFrameThreads, to be coded by FrameThreadsEncode(). Only frames of
+ *    the populated part of the sequence structure are counted. Returns 0
+ *    if the frame is coded alone by encode_one_frame(), which is the
+ *    case for a single frame unless it ends a longer run.
+ ***********************************************************************
+ */
+int FrameThreadsRunLength (VideoParameters *p_Vid, int curr_frame_to_code, int frames_to_code)
+{
+  FrameThreads *p_ft = p_Vid->p_FrameThreads;
+  int in_run, n = 0;
+
+  if (p_ft == NULL)
+    return 0;
+
+  in_run = p_ft->run_goes_on;
+  while (n < p_ft->num_threads && is_run_frame(p_Vid, curr_frame_to_code + n, frames_to_code))
+    ++n;
+  p_ft->run_goes_on = (n == p_ft->num_threads && is_run_frame(p_Vid, curr_frame_to_code + n, frames_to_code));
+
+  return (n > 1 || in_run) ? n : 0;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Codes the run of n non reference B frames starting with frame
+ *    curr_frame_to_code of the coding order
+ ***********************************************************************
+ */
+void FrameThreadsEncode (VideoParameters *p_Vid, int curr_frame_to_code, int n)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  FrameThreads *p_ft = p_Vid->p_FrameThreads;
+  int k;
+
+  // set up and read the frames in coding order
+  for (k = 0; k < n; ++k)
+  {
+    VideoParameters *ctx = &p_ft->ctx[k];
+    int frame_num_bak;
+
+    copy_frame_state(ctx, k ? &p_ft->ctx[k - 1] : p_Vid);
+    copy_adaptive_state(ctx, p_Vid);
+
+    // the frames are coded with private statistics, the frame counter
+    // of the distortion statistics is kept from frame to frame
+    p_ft->stats[k] = *p_Vid->p_Stats;
+    p_ft->dist[k]  = k ? p_ft->dist[k - 1] : *p_Vid->p_Dist;
+    ctx->p_Inp   = p_Inp;
+    ctx->p_Stats = &p_ft->stats[k];
+    ctx->p_Dist  = &p_ft->dist[k];
+
+    ctx->curr_frm_idx = ctx->number = curr_frame_to_code + k;
+    ctx->p_curr_frm_struct = p_Vid->p_pred->p_frm + (ctx->curr_frm_idx % ctx->frm_struct_buffer);
+
+    frame_num_bak = ctx->p_EncodePar[ctx->dpb_layer_id]->frame_num;
+    prepare_frame_params(ctx, p_Inp, ctx->curr_frm_idx);
+
+    p_ft->coded[k] = start_one_frame(ctx, p_Inp);
+    if (!p_ft->coded[k])
+      ctx->frame_num = ctx->p_CurrEncodePar->frame_num = frame_num_bak;
+    else
+      ctx->p_CurrEncodePar->last_ref_idc = ctx->nal_reference_idc ? 1 : 0;
+
+    ctx->me_tot_time = 0;
+    p_ft->inp[k] = *p_Inp;
+    ctx->p_Inp = &p_ft->inp[k];
+  }
+
+  p_ft->run_length = n;
+  p_ft->next_frame = 0;
+  if (!run_thread_pool(p_ft->pool, code_frames, p_ft))
+    code_frames(p_ft, 0);
+
+  // write, store and report the frames in coding order, each one
+  // continuing from the counters left by the one before
+  for (k = 0; k < n; ++k)
+  {
+    VideoParameters *ctx = &p_ft->ctx[k];
+
+    ctx->p_Inp   = p_Inp;
+    ctx->p_Stats = p_Vid->p_Stats;
+    ctx->p_Dist  = p_Vid->p_Dist;
+    ctx->p_Stats->bit_slice = p_ft->stats[k].bit_slice;
+    ctx->p_Dist->frame_ctr  = p_ft->dist[k].frame_ctr;
+    memcpy(ctx->p_Dist->metric[SSE].value, p_ft->dist[k].metric[SSE].value, 3 * sizeof(float));
+
+    ctx->tot_time           = p_Vid->tot_time;
+    ctx->subpel_tot_time    = p_Vid->subpel_tot_time;
+    ctx->me_tot_time       += p_Vid->me_tot_time;
+    ctx->total_frame_buffer = p_Vid->total_frame_buffer;
+    ctx->last_bit_ctr_n     = p_Vid->last_bit_ctr_n;
+
+    if (p_ft->coded[k])
+    {
+      DecodedPictureBuffer *p_Dpb = ctx->p_Dpb_layer[ctx->dpb_layer_id];
+
+      p_Dpb->p_Vid = ctx;
+      finish_one_frame(ctx);
+      if (p_Inp->ReportFrameStats)
+        report_frame_statistic(ctx, p_Inp);
+      p_Dpb->p_Vid = p_Vid;
+    }
+
+    copy_frame_state(p_Vid, ctx);
+  }
+
+  // the rest of a longer run starts from the same state as this part
+  if (!p_ft->run_goes_on)
+    copy_adaptive_state(p_Vid, &p_ft->ctx[n - 1]);
+}
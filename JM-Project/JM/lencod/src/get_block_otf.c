@@ -44,7 +44,7 @@ static void get_block_00(imgpel *block, imgpel *cur_img,  int block_size_y, int
  *    Qpel (1,0) horizontal
  ************************************************************************
  */ 
-static void get_luma_10(imgpel *block, imgpel **cur_imgY, int block_size_y, int block_size_x, int x_pos , int max_imgpel_value)
+static void get_luma_10(imgpel *block, imgpel *cur_img, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
 {
   imgpel *p0, *p1, *p2, *p3, *p4, *p5;
   imgpel *orig_line, *cur_line;
@@ -53,8 +53,8 @@ static void get_luma_10(imgpel *block, imgpel **cur_imgY, int block_size_y, int
   
   for (j = 0; j < block_size_y; j++)
   {
-    cur_line = &(cur_imgY[j][x_pos]); 
-    p0 = &cur_imgY[j][x_pos - 2];
+    cur_line = &(cur_img[j * shift_x + x_pos]); 
+    p0 = &cur_img[j * shift_x + x_pos - 2];
     p1 = p0 + 1;
     p2 = p1 + 1;
     p3 = p2 + 1;
@@ -79,7 +79,7 @@ static void get_luma_10(imgpel *block, imgpel **cur_imgY, int block_size_y, int
  *    Half horizontal
  ************************************************************************
  */ 
-static void get_luma_20(imgpel *block, imgpel **cur_imgY, int block_size_y, int block_size_x, int x_pos , int max_imgpel_value)
+static void get_luma_20(imgpel *block, imgpel *cur_img, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
  {
   imgpel *p0, *p1, *p2, *p3, *p4, *p5;
   imgpel *orig_line;
@@ -88,7 +88,7 @@ static void get_luma_20(imgpel *block, imgpel **cur_imgY, int block_size_y, int
 
   for (j = 0; j < block_size_y; j++)
   {
-    p0 = &cur_imgY[j][x_pos - 2];
+    p0 = &cur_img[j * shift_x + x_pos - 2];
     p1 = p0 + 1;
     p2 = p1 + 1;
     p3 = p2 + 1;
@@ -111,7 +111,7 @@ static void get_luma_20(imgpel *block, imgpel **cur_imgY, int block_size_y, int
  *    Qpel (3,0) horizontal
  ************************************************************************
  */ 
-static void get_luma_30(imgpel *block, imgpel **cur_imgY, int block_size_y, int block_size_x, int x_pos , int max_imgpel_value)
+static void get_luma_30(imgpel *block, imgpel *cur_img, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
 {
   imgpel *p0, *p1, *p2, *p3, *p4, *p5;
   imgpel *orig_line, *cur_line;
@@ -120,8 +120,8 @@ static void get_luma_30(imgpel *block, imgpel **cur_imgY, int block_size_y, int
   
   for (j = 0; j < block_size_y; j++)
   {
-    cur_line = &(cur_imgY[j][x_pos + 1]);
-    p0 = &cur_imgY[j][x_pos - 2];
+    cur_line = &(cur_img[j * shift_x + x_pos + 1]);
+    p0 = &cur_img[j * shift_x + x_pos - 2];
     p1 = p0 + 1;
     p2 = p1 + 1;
     p3 = p2 + 1;
@@ -147,14 +147,14 @@ static void get_luma_30(imgpel *block, imgpel **cur_imgY, int block_size_y, int
  *    Qpel vertical (0, 1)
  ************************************************************************
  */ 
-static void get_luma_01(imgpel *block, imgpel **cur_imgY, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
+static void get_luma_01(imgpel *block, imgpel *cur_img, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
 {
   imgpel *p0, *p1, *p2, *p3, *p4, *p5;
   imgpel *orig_line, *cur_line;
   int i, j;
   int result;
   int jj = 0;
-  p0 = &(cur_imgY[ - 2][x_pos]);
+  p0 = &(cur_img[-2 * shift_x + x_pos]);
   for (j = 0; j < block_size_y; j++)
   {                  
     p1 = p0 + shift_x;          
@@ -163,7 +163,7 @@ static void get_luma_01(imgpel *block, imgpel **cur_imgY, int block_size_y, int
     p4 = p3 + shift_x;
     p5 = p4 + shift_x;
     orig_line = block + j*block_size_x ;
-    cur_line = &(cur_imgY[jj++][x_pos]);
+    cur_line = &(cur_img[(jj++) * shift_x + x_pos]);
 
     for (i = 0; i < block_size_x; i++)
     {
@@ -183,13 +183,13 @@ static void get_luma_01(imgpel *block, imgpel **cur_imgY, int block_size_y, int
  *    Half vertical
  ************************************************************************
  */ 
-static void get_luma_02(imgpel *block, imgpel **cur_imgY, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
+static void get_luma_02(imgpel *block, imgpel *cur_img, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
 {
   imgpel *p0, *p1, *p2, *p3, *p4, *p5;
   imgpel *orig_line;
   int i, j;
   int result;
-  p0 = &(cur_imgY[ - 2][x_pos]);
+  p0 = &(cur_img[-2 * shift_x + x_pos]);
   for (j = 0; j < block_size_y; j++)
   {                  
     p1 = p0 + shift_x;          
@@ -216,7 +216,7 @@ static void get_luma_02(imgpel *block, imgpel **cur_imgY, int block_size_y, int
  *    Qpel vertical (0, 3)
  ************************************************************************
  */ 
-static void get_luma_03(imgpel *block, imgpel **cur_imgY, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
+static void get_luma_03(imgpel *block, imgpel *cur_img, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
 {
   imgpel *p0, *p1, *p2, *p3, *p4, *p5;
   imgpel *orig_line, *cur_line;
@@ -224,7 +224,7 @@ static void get_luma_03(imgpel *block, imgpel **cur_imgY, int block_size_y, int
   int result;
   int jj = 1;
 
-  p0 = &(cur_imgY[ -2][x_pos]);
+  p0 = &(cur_img[-2 * shift_x + x_pos]);
   for (j = 0; j < block_size_y; j++)
   {                  
     p1 = p0 + shift_x;          
@@ -233,7 +233,7 @@ static void get_luma_03(imgpel *block, imgpel **cur_imgY, int block_size_y, int
     p4 = p3 + shift_x;
     p5 = p4 + shift_x;
     orig_line = block + j*block_size_x ;
-    cur_line = &(cur_imgY[jj++][x_pos]);
+    cur_line = &(cur_img[(jj++) * shift_x + x_pos]);
 
     for (i = 0; i < block_size_x; i++)
     {
@@ -253,7 +253,7 @@ static void get_luma_03(imgpel *block, imgpel **cur_imgY, int block_size_y, int
  *    Hpel horizontal, Qpel vertical (2, 1)
  ************************************************************************
  */ 
-static void get_luma_21(imgpel *block, imgpel **cur_imgY, int *tmp_res, int block_size_y, int block_size_x, int x_pos, int max_imgpel_value)
+static void get_luma_21(imgpel *block, imgpel *cur_img, int *tmp_res, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
 {
   int i, j;
   /* Vertical & horizontal interpolation */
@@ -267,7 +267,7 @@ static void get_luma_21(imgpel *block, imgpel **cur_imgY, int *tmp_res, int bloc
 
   for (j = 0; j < block_size_y + 5; j++)
   {
-    p0 = &cur_imgY[jj++][x_pos - 2];
+    p0 = &cur_img[(jj++) * shift_x + x_pos - 2];
     p1 = p0 + 1;
     p2 = p1 + 1;
     p3 = p2 + 1;
@@ -310,7 +310,7 @@ static void get_luma_21(imgpel *block, imgpel **cur_imgY, int *tmp_res, int bloc
  *    Hpel horizontal, Hpel vertical (2, 2)
  ************************************************************************
  */ 
-static void get_luma_22(imgpel *block, imgpel **cur_imgY, int *tmp_res, int block_size_y, int block_size_x, int x_pos, int max_imgpel_value)
+static void get_luma_22(imgpel *block, imgpel *cur_img, int *tmp_res, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
 {
   int i, j;
   /* Vertical & horizontal interpolation */
@@ -324,7 +324,7 @@ static void get_luma_22(imgpel *block, imgpel **cur_imgY, int *tmp_res, int bloc
 
   for (j = 0; j < block_size_y + 5; j++)
   {
-    p0 = &cur_imgY[jj++][x_pos - 2];
+    p0 = &cur_img[(jj++) * shift_x + x_pos - 2];
     p1 = p0 + 1;
     p2 = p1 + 1;
     p3 = p2 + 1;
@@ -363,7 +363,7 @@ static void get_luma_22(imgpel *block, imgpel **cur_imgY, int *tmp_res, int bloc
  *    Hpel horizontal, Qpel vertical (2, 3)
  ************************************************************************
  */ 
-static void get_luma_23(imgpel *block, imgpel **cur_imgY, int *tmp_res, int block_size_y, int block_size_x, int x_pos, int max_imgpel_value)
+static void get_luma_23(imgpel *block, imgpel *cur_img, int *tmp_res, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
 {
   int i, j;
   /* Vertical & horizontal interpolation */
@@ -377,7 +377,7 @@ static void get_luma_23(imgpel *block, imgpel **cur_imgY, int *tmp_res, int bloc
 
   for (j = 0; j < block_size_y + 5; j++)
   {
-    p0 = &cur_imgY[jj++][x_pos - 2];
+    p0 = &cur_img[(jj++) * shift_x + x_pos - 2];
     p1 = p0 + 1;
     p2 = p1 + 1;
     p3 = p2 + 1;
@@ -420,7 +420,7 @@ static void get_luma_23(imgpel *block, imgpel **cur_imgY, int *tmp_res, int bloc
  *    Qpel horizontal, Hpel vertical (1, 2)
  ************************************************************************
  */ 
-static void get_luma_12(imgpel *block, imgpel **cur_imgY, int *tmp_res, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
+static void get_luma_12(imgpel *block, imgpel *cur_img, int *tmp_res, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
 {
   int i, j;
   int *tmp_line;
@@ -429,7 +429,7 @@ static void get_luma_12(imgpel *block, imgpel **cur_imgY, int *tmp_res, int bloc
   imgpel *orig_line;  
   int result;      
 
-  p0 = &(cur_imgY[ -2][x_pos - 2]);
+  p0 = &(cur_img[-2 * shift_x + x_pos - 2]);
   for (j = 0; j < block_size_y; j++)
   {                    
     p1 = p0 + shift_x;
@@ -474,7 +474,7 @@ static void get_luma_12(imgpel *block, imgpel **cur_imgY, int *tmp_res, int bloc
  *    Qpel horizontal, Hpel vertical (3, 2)
  ************************************************************************
  */ 
-static void get_luma_32(imgpel *block, imgpel **cur_imgY, int *tmp_res, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
+static void get_luma_32(imgpel *block, imgpel *cur_img, int *tmp_res, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
 {
   int i, j;
   int *tmp_line;
@@ -483,7 +483,7 @@ static void get_luma_32(imgpel *block, imgpel **cur_imgY, int *tmp_res, int bloc
   imgpel *orig_line;  
   int result;      
 
-  p0 = &(cur_imgY[ -2][x_pos - 2]);
+  p0 = &(cur_img[-2 * shift_x + x_pos - 2]);
   for (j = 0; j < block_size_y; j++)
   {                    
     p1 = p0 + shift_x;
@@ -528,7 +528,7 @@ static void get_luma_32(imgpel *block, imgpel **cur_imgY, int *tmp_res, int bloc
  *    Qpel horizontal, Qpel vertical (3, 3)
  ************************************************************************
  */ 
-static void get_luma_33(imgpel *block, imgpel **cur_imgY, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
+static void get_luma_33(imgpel *block, imgpel *cur_img, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
 {
   int i, j;
   imgpel *p0, *p1, *p2, *p3, *p4, *p5;
@@ -539,7 +539,7 @@ static void get_luma_33(imgpel *block, imgpel **cur_imgY, int block_size_y, int
 
   for (j = 0; j < block_size_y; j++)
   {
-    p0 = &cur_imgY[jj++][x_pos - 2];
+    p0 = &cur_img[(jj++) * shift_x + x_pos - 2];
     p1 = p0 + 1;
     p2 = p1 + 1;
     p3 = p2 + 1;
@@ -556,7 +556,7 @@ static void get_luma_33(imgpel *block, imgpel **cur_imgY, int block_size_y, int
     }
   }
 
-  p0 = &(cur_imgY[-2][x_pos + 1]);
+  p0 = &(cur_img[-2 * shift_x + x_pos + 1]);
   for (j = 0; j < block_size_y; j++)
   {        
     p1 = p0 + shift_x;
@@ -584,7 +584,7 @@ static void get_luma_33(imgpel *block, imgpel **cur_imgY, int block_size_y, int
  *    Qpel horizontal, Qpel vertical (1, 1)
  ************************************************************************
  */ 
-static void get_luma_11(imgpel *block, imgpel **cur_imgY, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
+static void get_luma_11(imgpel *block, imgpel *cur_img, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
 {
   int i, j;
   imgpel *p0, *p1, *p2, *p3, *p4, *p5;
@@ -595,7 +595,7 @@ static void get_luma_11(imgpel *block, imgpel **cur_imgY, int block_size_y, int
 
   for (j = 0; j < block_size_y; j++)
   {
-    p0 = &cur_imgY[jj++][x_pos - 2];
+    p0 = &cur_img[(jj++) * shift_x + x_pos - 2];
     p1 = p0 + 1;
     p2 = p1 + 1;
     p3 = p2 + 1;
@@ -612,7 +612,7 @@ static void get_luma_11(imgpel *block, imgpel **cur_imgY, int block_size_y, int
     }
   }
 
-  p0 = &(cur_imgY[-2][x_pos]);
+  p0 = &(cur_img[-2 * shift_x + x_pos]);
   for (j = 0; j < block_size_y; j++)
   {        
     p1 = p0 + shift_x;
@@ -639,7 +639,7 @@ static void get_luma_11(imgpel *block, imgpel **cur_imgY, int block_size_y, int
  *    Qpel horizontal, Qpel vertical (1, 3)
  ************************************************************************
  */ 
-static void get_luma_13(imgpel *block, imgpel **cur_imgY, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
+static void get_luma_13(imgpel *block, imgpel *cur_img, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
 {
   /* Diagonal interpolation */
   int i, j;
@@ -651,7 +651,7 @@ static void get_luma_13(imgpel *block, imgpel **cur_imgY, int block_size_y, int
 
   for (j = 0; j < block_size_y; j++)
   {
-    p0 = &cur_imgY[jj++][x_pos - 2];
+    p0 = &cur_img[(jj++) * shift_x + x_pos - 2];
     p1 = p0 + 1;
     p2 = p1 + 1;
     p3 = p2 + 1;
@@ -668,7 +668,7 @@ static void get_luma_13(imgpel *block, imgpel **cur_imgY, int block_size_y, int
     }
   }
 
-  p0 = &(cur_imgY[-2][x_pos]);
+  p0 = &(cur_img[-2 * shift_x + x_pos]);
   for (j = 0; j < block_size_y; j++)
   {        
     p1 = p0 + shift_x;
@@ -695,7 +695,7 @@ static void get_luma_13(imgpel *block, imgpel **cur_imgY, int block_size_y, int
  *    Qpel horizontal, Qpel vertical (3, 1)
  ************************************************************************
  */ 
-static void get_luma_31(imgpel *block, imgpel **cur_imgY, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
+static void get_luma_31(imgpel *block, imgpel *cur_img, int block_size_y, int block_size_x, int x_pos, int shift_x, int max_imgpel_value)
 {
   /* Diagonal interpolation */
   int i, j;
@@ -707,7 +707,7 @@ static void get_luma_31(imgpel *block, imgpel **cur_imgY, int block_size_y, int
 
   for (j = 0; j < block_size_y; j++)
   {
-    p0 = &cur_imgY[jj++][x_pos - 2];
+    p0 = &cur_img[(jj++) * shift_x + x_pos - 2];
     p1 = p0 + 1;
     p2 = p1 + 1;
     p3 = p2 + 1;
@@ -724,7 +724,7 @@ static void get_luma_31(imgpel *block, imgpel **cur_imgY, int block_size_y, int
     }
   }
 
-  p0 = &(cur_imgY[-2][x_pos + 1]);
+  p0 = &(cur_img[-2 * shift_x + x_pos + 1]);
   for (j = 0; j < block_size_y; j++)
   {        
     p1 = p0 + shift_x;
@@ -763,65 +763,67 @@ static inline void get_block_luma_otf(  VideoParameters *p_Vid,  //!< video enco
                       int    pl                //!< plane
                     )
 {
-  imgpel **ref_block = (p_Vid->P444_joined && pl>PLANE_Y)? ref->imgUV[pl-1] : ref->imgY;
+  PelPlane *plane = &ref->plane[(p_Vid->P444_joined && pl>PLANE_Y) ? pl : PLANE_Y];
   int    dx = (pic_pix_x & 0x03);
   int    dy = (pic_pix_y & 0x03);
   int    x_pos = iClip3(-IMG_PAD_SIZE_X+2,  ref->size_x_pad-2, pic_pix_x>>2);
   int    y_pos = iClip3(-IMG_PAD_SIZE_Y+2, ref->size_y_pad-2, pic_pix_y>>2);
+  int    stride = plane->stride;
+  imgpel *ref_line = plane->base + y_pos * stride;
 
   if (dx == 0 && dy == 0)
-    get_block_00(mpred, &(ref_block[y_pos][x_pos]), block_size_y, block_size_x, p_Vid->padded_size_x);
+    get_block_00(mpred, ref_line + x_pos, block_size_y, block_size_x, stride);
   else
   { /* other positions */
     if (dy == 0) /* No vertical interpolation */
     {         
       if (dx == 1)
-        get_luma_10(mpred, &ref_block[y_pos], block_size_y, block_size_x, x_pos, p_Vid->max_imgpel_value);
+        get_luma_10(mpred, ref_line, block_size_y, block_size_x, x_pos, stride, p_Vid->max_imgpel_value);
       else if (dx == 2)
-        get_luma_20(mpred, &ref_block[y_pos], block_size_y, block_size_x, x_pos, p_Vid->max_imgpel_value);
+        get_luma_20(mpred, ref_line, block_size_y, block_size_x, x_pos, stride, p_Vid->max_imgpel_value);
       else
-        get_luma_30(mpred, &ref_block[y_pos], block_size_y, block_size_x, x_pos, p_Vid->max_imgpel_value);
+        get_luma_30(mpred, ref_line, block_size_y, block_size_x, x_pos, stride, p_Vid->max_imgpel_value);
     }
     else if (dx == 0) /* No horizontal interpolation */        
     {         
       if (dy == 1)
-        get_luma_01(mpred, &ref_block[y_pos], block_size_y, block_size_x, x_pos, p_Vid->padded_size_x, p_Vid->max_imgpel_value);
+        get_luma_01(mpred, ref_line, block_size_y, block_size_x, x_pos, stride, p_Vid->max_imgpel_value);
       else if (dy == 2)
-        get_luma_02(mpred, &ref_block[y_pos], block_size_y, block_size_x, x_pos, p_Vid->padded_size_x, p_Vid->max_imgpel_value);
+        get_luma_02(mpred, ref_line, block_size_y, block_size_x, x_pos, stride, p_Vid->max_imgpel_value);
       else
-        get_luma_03(mpred, &ref_block[y_pos], block_size_y, block_size_x, x_pos, p_Vid->padded_size_x, p_Vid->max_imgpel_value);
+        get_luma_03(mpred, ref_line, block_size_y, block_size_x, x_pos, stride, p_Vid->max_imgpel_value);
     }
     else if (dx == 2)  /* Vertical & horizontal interpolation */
     {  
       if (dy == 1)
-        get_luma_21(mpred, &ref_block[y_pos], tmp_pred, block_size_y, block_size_x, x_pos, p_Vid->max_imgpel_value);
+        get_luma_21(mpred, ref_line, tmp_pred, block_size_y, block_size_x, x_pos, stride, p_Vid->max_imgpel_value);
       else if (dy == 2)
-        get_luma_22(mpred, &ref_block[y_pos], tmp_pred, block_size_y, block_size_x, x_pos, p_Vid->max_imgpel_value);
+        get_luma_22(mpred, ref_line, tmp_pred, block_size_y, block_size_x, x_pos, stride, p_Vid->max_imgpel_value);
       else
-        get_luma_23(mpred, &ref_block[y_pos], tmp_pred, block_size_y, block_size_x, x_pos, p_Vid->max_imgpel_value);
+        get_luma_23(mpred, ref_line, tmp_pred, block_size_y, block_size_x, x_pos, stride, p_Vid->max_imgpel_value);
     }
     else if (dy == 2)
     {
       if (dx == 1)
-        get_luma_12(mpred, &ref_block[y_pos], tmp_pred, block_size_y, block_size_x, x_pos, p_Vid->padded_size_x, p_Vid->max_imgpel_value);
+        get_luma_12(mpred, ref_line, tmp_pred, block_size_y, block_size_x, x_pos, stride, p_Vid->max_imgpel_value);
       else
-        get_luma_32(mpred, &ref_block[y_pos], tmp_pred, block_size_y, block_size_x, x_pos, p_Vid->padded_size_x, p_Vid->max_imgpel_value);
+        get_luma_32(mpred, ref_line, tmp_pred, block_size_y, block_size_x, x_pos, stride, p_Vid->max_imgpel_value);
     }
     else
     {
       if (dx == 1)
       {
         if (dy == 1)
-          get_luma_11(mpred, &ref_block[y_pos], block_size_y, block_size_x, x_pos, p_Vid->padded_size_x, p_Vid->max_imgpel_value);
+          get_luma_11(mpred, ref_line, block_size_y, block_size_x, x_pos, stride, p_Vid->max_imgpel_value);
         else
-          get_luma_13(mpred, &ref_block[y_pos], block_size_y, block_size_x, x_pos, p_Vid->padded_size_x, p_Vid->max_imgpel_value);
+          get_luma_13(mpred, ref_line, block_size_y, block_size_x, x_pos, stride, p_Vid->max_imgpel_value);
       }
       else
       {
         if (dy == 1)
-          get_luma_31(mpred, &ref_block[y_pos], block_size_y, block_size_x, x_pos, p_Vid->padded_size_x, p_Vid->max_imgpel_value);
+          get_luma_31(mpred, ref_line, block_size_y, block_size_x, x_pos, stride, p_Vid->max_imgpel_value);
         else
-          get_luma_33(mpred, &ref_block[y_pos], block_size_y, block_size_x, x_pos, p_Vid->padded_size_x, p_Vid->max_imgpel_value);
+          get_luma_33(mpred, ref_line, block_size_y, block_size_x, x_pos, stride, p_Vid->max_imgpel_value);
       }
     }
   }
@@ -861,11 +863,12 @@ void get_block_luma_otf_L1(  VideoParameters *p_Vid,  //!< video encoding parame
     int j; 
     imgpel *ref_line ;
     ref->p_curr_img_sub = (p_Vid->P444_joined && pl>PLANE_Y) ? (ref->imgUV_sub[pl-1]):(ref->imgY_sub); // select plane for 4:4:4 compatibility
+    ref->p_curr_plane_sub = ref->plane_sub[(p_Vid->P444_joined && pl>PLANE_Y) ? pl : PLANE_Y];
     ref_line = UMVLine4X_otf ( ref, pic_pix_y, pic_pix_x ) ;
     for (j = 0; j < block_size_y; j++) 
     {
       memcpy(mpred, ref_line, block_size_x * sizeof(imgpel));
-      ref_line += p_Vid->padded_size_x;
+      ref_line += ref->p_curr_plane_sub->stride;
       mpred += block_size_x;
     }
   }
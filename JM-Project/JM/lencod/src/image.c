@@ -68,6 +68,9 @@
 #include "md_common.h"
 #include "me_epzs_common.h"
 #include "me_hme.h"
+#include "me_ads.h"
+#include "slice_threads.h"
+#include "wavefront.h"
 
 extern void UpdateDecoders            (VideoParameters *p_Vid, InputParameters *p_Inp, StorablePicture *enc_pic);
 
@@ -200,6 +203,11 @@ static void code_a_plane(VideoParameters *p_Vid, InputParameters *p_Inp)
   reset_pic_bin_count(p_Vid);
   p_Vid->bytes_in_picture = 0;
 
+  if (p_Vid->p_SliceThreads != NULL && !p_Vid->mb_aff_frame_flag)
+    NumberOfCodedMBs = SliceThreadsEncodePlane (p_Vid);
+  else if (p_Vid->p_Wavefront != NULL && !p_Vid->mb_aff_frame_flag)
+    NumberOfCodedMBs = WavefrontEncodePlane (p_Vid);
+
   while (NumberOfCodedMBs < p_Vid->PicSizeInMbs)       // loop over slices
   {
     // Encode one SLice Group
@@ -355,48 +363,59 @@ byte get_random_access_flag( VideoParameters *p_Vid )
 /*!
  ************************************************************************
  * \brief
- *    Update global stats
+ *    Adds the mode and bit usage statistics of src to dst
  ************************************************************************
  */
-void update_global_stats(InputParameters *p_Inp, StatParameters *gl_stats, StatParameters *cur_stats)
+void accumulate_coding_stats(StatParameters *dst, StatParameters *src)
 {  
   int i, j, k;
-  
-  if (p_Inp->skip_gl_stats == 0)
+
+  for (i = 0; i < 4; i++)
   {
-    for (i = 0; i < 4; i++)
-    {
-      gl_stats->intra_chroma_mode[i]    += cur_stats->intra_chroma_mode[i];
-    }
+    dst->intra_chroma_mode[i]    += src->intra_chroma_mode[i];
+  }
 
-    for (i = 0; i < 5; i++)
-    {
-      gl_stats->quant[i]                 += cur_stats->quant[i];
-      gl_stats->num_macroblocks[i]       += cur_stats->num_macroblocks[i];
-      gl_stats->bit_use_mb_type [i]      += cur_stats->bit_use_mb_type[i];
-      gl_stats->bit_use_header  [i]      += cur_stats->bit_use_header[i];
-      gl_stats->tmp_bit_use_cbp [i]      += cur_stats->tmp_bit_use_cbp[i];
-      gl_stats->bit_use_coeffC  [i]      += cur_stats->bit_use_coeffC[i];
-      gl_stats->bit_use_coeff[0][i]      += cur_stats->bit_use_coeff[0][i];
-      gl_stats->bit_use_coeff[1][i]      += cur_stats->bit_use_coeff[1][i]; 
-      gl_stats->bit_use_coeff[2][i]      += cur_stats->bit_use_coeff[2][i]; 
-      gl_stats->bit_use_delta_quant[i]   += cur_stats->bit_use_delta_quant[i];
-      gl_stats->bit_use_stuffing_bits[i] += cur_stats->bit_use_stuffing_bits[i];
+  for (i = 0; i < 5; i++)
+  {
+    dst->quant[i]                 += src->quant[i];
+    dst->num_macroblocks[i]       += src->num_macroblocks[i];
+    dst->bit_use_mb_type [i]      += src->bit_use_mb_type[i];
+    dst->bit_use_header  [i]      += src->bit_use_header[i];
+    dst->tmp_bit_use_cbp [i]      += src->tmp_bit_use_cbp[i];
+    dst->bit_use_coeffC  [i]      += src->bit_use_coeffC[i];
+    dst->bit_use_coeff[0][i]      += src->bit_use_coeff[0][i];
+    dst->bit_use_coeff[1][i]      += src->bit_use_coeff[1][i]; 
+    dst->bit_use_coeff[2][i]      += src->bit_use_coeff[2][i]; 
+    dst->bit_use_delta_quant[i]   += src->bit_use_delta_quant[i];
+    dst->bit_use_stuffing_bits[i] += src->bit_use_stuffing_bits[i];
 
-      for (k = 0; k < 2; k++)
-        gl_stats->b8_mode_0_use[i][k] += cur_stats->b8_mode_0_use[i][k];
+    for (k = 0; k < 2; k++)
+      dst->b8_mode_0_use[i][k] += src->b8_mode_0_use[i][k];
 
-      for (j = 0; j < 15; j++)
-      {
-        gl_stats->mode_use[i][j]     += cur_stats->mode_use[i][j];
-        gl_stats->bit_use_mode[i][j] += cur_stats->bit_use_mode[i][j];
-        for (k = 0; k < 2; k++)
-          gl_stats->mode_use_transform[i][j][k] += cur_stats->mode_use_transform[i][j][k];
-      }
+    for (j = 0; j < 15; j++)
+    {
+      dst->mode_use[i][j]     += src->mode_use[i][j];
+      dst->bit_use_mode[i][j] += src->bit_use_mode[i][j];
+      for (k = 0; k < 2; k++)
+        dst->mode_use_transform[i][j][k] += src->mode_use_transform[i][j][k];
     }
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Update global stats
+ ************************************************************************
+ */
+void update_global_stats(InputParameters *p_Inp, StatParameters *gl_stats, StatParameters *cur_stats)
+{  
+  if (p_Inp->skip_gl_stats == 0)
+  {
+    accumulate_coding_stats(gl_stats, cur_stats);
+  }
+}
+
 static void storeRedundantFrame(VideoParameters *p_Vid)
 {
   int j, k;
@@ -795,6 +814,8 @@ void perform_encode_frame(VideoParameters *p_Vid)
     if (p_Vid->type!=I_SLICE && p_Vid->type!=SI_SLICE)
       invoke_HME(p_Vid, 0);
   }
+  if (p_Vid->p_ADS)
+    ADSPictureInit(p_Vid);
     
 #if (MVC_EXTENSION_ENABLE)
   if(p_Vid->view_id!=1 || !p_Vid->sec_view_force_fld)
@@ -1177,20 +1198,17 @@ int update_video_stats(VideoParameters *p_Vid)
 /*!
  ************************************************************************
  * \brief
- *    Encodes one frame
+ *    Sets up the coding of one frame and reads its input data.
+ *    Returns 0 if there is no input data left for the frame.
  ************************************************************************
  */
-int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
+int start_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
 {
   int i;
   int nplane;
 
-  //Rate control
-  int bits = 0;
-
   TIME_T start_time;
   TIME_T end_time;
-  int64  tmp_time;
 
   p_Vid->me_time = 0;
   p_Vid->rd_pass = 0;
@@ -1285,11 +1303,54 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
     p_Vid->pWPX->curr_wp_rd_pass->algorithm = WP_REGULAR;
   }
 
-  if (p_Inp->PicInterlace == FIELD_CODING)
+  gettime(&end_time);
+  p_Vid->frame_time = timediff(&start_time, &end_time);
+
+  return 1;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Codes the frame set up by start_one_frame()
+ ************************************************************************
+ */
+void code_one_frame (VideoParameters *p_Vid)
+{
+  TIME_T start_time;
+  TIME_T end_time;
+
+  gettime(&start_time);
+
+  if (p_Vid->p_Inp->PicInterlace == FIELD_CODING)
     perform_encode_field(p_Vid);
   else
     perform_encode_frame(p_Vid);
 
+  gettime(&end_time);
+  p_Vid->frame_time += timediff(&start_time, &end_time);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Writes the frame coded by code_one_frame(), stores it in the DPB
+ *    and reports its statistics
+ ************************************************************************
+ */
+void finish_one_frame (VideoParameters *p_Vid)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+
+  //Rate control
+  int bits = 0;
+
+  TIME_T start_time;
+  TIME_T end_time;
+  int64  tmp_time;
+
+  gettime(&start_time);
+
   p_Vid->p_Stats->frame_counter++;
   p_Vid->p_Stats->frame_ctr[p_Vid->type]++;
 
@@ -1396,7 +1457,7 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
   }
 
   gettime(&end_time);    // end time in ms
-  tmp_time  = timediff(&start_time, &end_time);
+  tmp_time  = p_Vid->frame_time + timediff(&start_time, &end_time);
   p_Vid->tot_time += tmp_time;
   tmp_time  = timenorm(tmp_time);
   p_Vid->me_time   = timenorm(p_Vid->me_time);
@@ -1449,6 +1510,21 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
   update_bitcounter_stats(p_Vid);
 
   update_idr_order_stats(p_Vid);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Encodes one frame
+ ************************************************************************
+ */
+int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  if ( !start_one_frame (p_Vid, p_Inp) )
+    return 0;
+
+  code_one_frame  (p_Vid);
+  finish_one_frame(p_Vid);
 
   return 1;
 }
@@ -2193,6 +2269,7 @@ void UnifiedOneForthPix ( VideoParameters *p_Vid, StorablePicture *s)
   // Y component
   s->p_img_sub[0] = s->imgY_sub;
   s->p_curr_img_sub = s->imgY_sub;
+  s->p_curr_plane_sub = s->plane_sub[PLANE_Y];
   s->p_curr_img = s->imgY;
 
   // derive the subpixel images for first component
@@ -2207,20 +2284,24 @@ void UnifiedOneForthPix ( VideoParameters *p_Vid, StorablePicture *s)
       if (p_Vid->P444_joined)
       {
         imgpel **** p_curr_img_sub = s->p_curr_img_sub;
+        PelPlane *  p_curr_plane_sub = s->p_curr_plane_sub;
         imgpel **   p_curr_img = s->p_curr_img;
         //U
         select_plane(p_Vid, PLANE_U);
         s->p_curr_img_sub = s->imgUV_sub[0];
+        s->p_curr_plane_sub = s->plane_sub[PLANE_U];
         s->p_curr_img = s->imgUV[0];
         getSubImagesLuma (p_Vid, s);
         //V
         select_plane(p_Vid, PLANE_V);
         s->p_curr_img_sub = s->imgUV_sub[1];
+        s->p_curr_plane_sub = s->plane_sub[PLANE_V];
         s->p_curr_img = s->imgUV[1];
         getSubImagesLuma (p_Vid, s);
         //Y
         select_plane(p_Vid, PLANE_Y);
         s->p_curr_img_sub = p_curr_img_sub;
+        s->p_curr_plane_sub = p_curr_plane_sub;
         s->p_curr_img = p_curr_img;
       }
       else
@@ -2273,6 +2354,7 @@ void UnifiedOneForthPix_JV (VideoParameters *p_Vid, int nplane, StorablePicture
   s->colour_plane_id = nplane;
   s->p_curr_img = s->p_img[nplane];
   s->p_curr_img_sub = s->p_img_sub[nplane];
+  s->p_curr_plane_sub = s->plane_sub[nplane];
 
   if( (!p_Inp->OnTheFlyFractMCP) || (p_Inp->OnTheFlyFractMCP==OTF_L1) )
   {
@@ -3112,6 +3194,7 @@ void select_plane(VideoParameters *p_Vid, ColorPlane color_plane)
   p_Vid->pCurImg              = p_Vid->pImgOrg[color_plane];
   p_Vid->enc_picture->p_curr_img     = p_Vid->enc_picture->p_img[color_plane];
   p_Vid->enc_picture->p_curr_img_sub = p_Vid->enc_picture->p_img_sub[color_plane];
+  p_Vid->enc_picture->p_curr_plane_sub = p_Vid->enc_picture->plane_sub[color_plane];
   p_Vid->max_imgpel_value     = (short) p_Vid->max_pel_value_comp[color_plane];
   p_Vid->dc_pred_value        = p_Vid->dc_pred_value_comp[color_plane];
 }
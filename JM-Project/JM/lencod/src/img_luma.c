@@ -21,6 +21,8 @@
 #include "global.h"
 #include "image.h"
 #include "img_luma.h"
+#include "img_luma_simd.h"
+#include "img_luma_tile.h"
 #include "memalloc.h"
 
 
@@ -610,8 +612,22 @@ static void getDiagSubImageBiLinear( StorablePicture *s, imgpel **dstImg, imgpel
  */
 void getSubImagesLuma( VideoParameters *p_Vid, StorablePicture *s )
 {
+  static const SubImageFuncs sub_image_c =
+  {
+    getHorSubImageSixTap, getVerSubImageSixTap, getVerSubImageSixTapTmp,
+    getSubImageBiLinear, getHorSubImageBiLinear, getVerSubImageBiLinear, getDiagSubImageBiLinear
+  };
+  const SubImageFuncs *f = get_sub_image_funcs_simd();
   imgpel ****cImgSub   = s->p_curr_img_sub;
   int        otf_shift = ( p_Vid->p_Inp->OnTheFlyFractMCP == OTF_L1 ) ? (1) : (0) ;
+#if GET_METIME
+  TIME_T start_time, end_time;
+
+  gettime(&start_time);
+#endif
+
+  if (f == NULL)
+    f = &sub_image_c;
 
   //  0  1  2  3
   //  4  5  6  7
@@ -631,50 +647,66 @@ void getSubImagesLuma( VideoParameters *p_Vid, StorablePicture *s )
     getSubImageInteger_s( s, cImgSub[0][0], s->p_curr_img);
   }
 
+  // LazySubPelInterp: the other sub-images are interpolated tile by tile on first use
+  if (s->sub_tile_map != NULL)
+  {
+    LazySubPelReset(p_Vid, s);
+#if GET_METIME
+    gettime(&end_time);
+    p_Vid->subpel_tot_time += timediff(&start_time, &end_time);
+#endif
+    return;
+  }
+
   //// HALF-PEL POSITIONS: SIX-TAP FILTER ////
 
   // sub-image 2 [0][2]
   // HOR interpolate (six-tap) sub-image [0][0]
-  getHorSubImageSixTap( p_Vid, s, cImgSub[0][2>>otf_shift], cImgSub[0][0] );
+  f->hor_six_tap( p_Vid, s, cImgSub[0][2>>otf_shift], cImgSub[0][0] );
 
   // sub-image 8 [2][0]
   // VER interpolate (six-tap) sub-image [0][0]
-  getVerSubImageSixTap( p_Vid, s, cImgSub[2>>otf_shift][0], cImgSub[0][0]);
+  f->ver_six_tap( p_Vid, s, cImgSub[2>>otf_shift][0], cImgSub[0][0]);
 
   // sub-image 10 [2][2]
   // VER interpolate (six-tap) sub-image [0][2]
-  getVerSubImageSixTapTmp( p_Vid, s, cImgSub[2>>otf_shift][2>>otf_shift]);
+  f->ver_six_tap_tmp( p_Vid, s, cImgSub[2>>otf_shift][2>>otf_shift]);
 
   if( !p_Vid->p_Inp->OnTheFlyFractMCP )
   {
     //// QUARTER-PEL POSITIONS: BI-LINEAR INTERPOLATION ////
 
     // sub-image 1 [0][1]
-    getSubImageBiLinear    ( s, cImgSub[0][1], cImgSub[0][0], cImgSub[0][2]);
+    f->bilinear     ( s, cImgSub[0][1], cImgSub[0][0], cImgSub[0][2]);
     // sub-image 4 [1][0]
-    getSubImageBiLinear    ( s, cImgSub[1][0], cImgSub[0][0], cImgSub[2][0]);
+    f->bilinear     ( s, cImgSub[1][0], cImgSub[0][0], cImgSub[2][0]);
     // sub-image 5 [1][1]
-    getSubImageBiLinear    ( s, cImgSub[1][1], cImgSub[0][2], cImgSub[2][0]);
+    f->bilinear     ( s, cImgSub[1][1], cImgSub[0][2], cImgSub[2][0]);
     // sub-image 6 [1][2]
-    getSubImageBiLinear    ( s, cImgSub[1][2], cImgSub[0][2], cImgSub[2][2]);
+    f->bilinear     ( s, cImgSub[1][2], cImgSub[0][2], cImgSub[2][2]);
     // sub-image 9 [2][1]
-    getSubImageBiLinear    ( s, cImgSub[2][1], cImgSub[2][0], cImgSub[2][2]);
+    f->bilinear     ( s, cImgSub[2][1], cImgSub[2][0], cImgSub[2][2]);
 
     // sub-image 3  [0][3]
-    getHorSubImageBiLinear ( s, cImgSub[0][3], cImgSub[0][2], cImgSub[0][0]);
+    f->hor_bilinear ( s, cImgSub[0][3], cImgSub[0][2], cImgSub[0][0]);
     // sub-image 7  [1][3]
-    getHorSubImageBiLinear ( s, cImgSub[1][3], cImgSub[0][2], cImgSub[2][0]);
+    f->hor_bilinear ( s, cImgSub[1][3], cImgSub[0][2], cImgSub[2][0]);
     // sub-image 11 [2][3]
-    getHorSubImageBiLinear ( s, cImgSub[2][3], cImgSub[2][2], cImgSub[2][0]);
+    f->hor_bilinear ( s, cImgSub[2][3], cImgSub[2][2], cImgSub[2][0]);
 
     // sub-image 12 [3][0]
-    getVerSubImageBiLinear ( s, cImgSub[3][0], cImgSub[2][0], cImgSub[0][0]);
+    f->ver_bilinear ( s, cImgSub[3][0], cImgSub[2][0], cImgSub[0][0]);
     // sub-image 13 [3][1]
-    getVerSubImageBiLinear ( s, cImgSub[3][1], cImgSub[2][0], cImgSub[0][2]);
+    f->ver_bilinear ( s, cImgSub[3][1], cImgSub[2][0], cImgSub[0][2]);
     // sub-image 14 [3][2]
-    getVerSubImageBiLinear ( s, cImgSub[3][2], cImgSub[2][2], cImgSub[0][2]);
+    f->ver_bilinear ( s, cImgSub[3][2], cImgSub[2][2], cImgSub[0][2]);
 
     // sub-image 15 [3][3]
-    getDiagSubImageBiLinear( s, cImgSub[3][3], cImgSub[0][2], cImgSub[2][0]);
+    f->diag_bilinear( s, cImgSub[3][3], cImgSub[0][2], cImgSub[2][0]);
   }
+
+#if GET_METIME
+  gettime(&end_time);
+  p_Vid->subpel_tot_time += timediff(&start_time, &end_time);
+#endif
 }
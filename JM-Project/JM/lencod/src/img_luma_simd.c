@@ -0,0 +1,327 @@
+
+/*!
+*************************************************************************************
+* \file img_luma_simd.c
+*
+* \brief
+*    AVX2 versions of the luma sub-image interpolation passes of
+*    getSubImagesLuma (six-tap half-pel planes and bilinear quarter-pel
+*    planes). They walk the padded planes exactly like the C versions in
+*    img_luma.c, including the clamped taps at the picture borders, and
+*    produce identical samples for 8 and 16 bit imgpel.
+*
+*    Like me_distortion_simd.c the kernels are compiled with function
+*    target attributes; get_sub_image_funcs_simd() returns them only when
+*    the CPU supports AVX2.
+*
+*************************************************************************************
+*/
+
+#include "global.h"
+#include "image.h"
+#include "img_luma.h"
+#include "img_luma_simd.h"
+#include "me_distortion_simd.h"
+
+#if (JM_SIMD_DISTORTION && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+
+#include <immintrin.h>
+
+#define AVX2         __attribute__((target("avx2")))
+#define AVX2_INLINE  static inline __attribute__((target("avx2"), always_inline))
+
+/*
+ * 8 pels widened to 32 bit lanes, and 8 clipped 32 bit lanes stored as pels
+ */
+#if (IMGTYPE == 0)
+AVX2_INLINE __m256i load_pel8_32(const imgpel *p) { return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) p)); }
+AVX2_INLINE void store_pel8_32(imgpel *p, __m256i v)
+{
+  __m128i w = _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), _MM_SHUFFLE(3, 1, 2, 0)));
+  _mm_storel_epi64((__m128i *) p, _mm_packus_epi16(w, w));
+}
+#else
+AVX2_INLINE __m256i load_pel8_32(const imgpel *p) { return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) p)); }
+AVX2_INLINE void store_pel8_32(imgpel *p, __m256i v)
+{
+  _mm_storeu_si128((__m128i *) p, _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), _MM_SHUFFLE(3, 1, 2, 0))));
+}
+#endif
+
+//! tap0 * (a + d) + tap1 * (b + e) + tap2 * (c + f), 32 bit lanes
+AVX2_INLINE __m256i six_tap_avx2(__m256i a, __m256i b, __m256i c, __m256i d, __m256i e, __m256i f)
+{
+  __m256i v = _mm256_mullo_epi32(_mm256_add_epi32(a, d), _mm256_set1_epi32(ONE_FOURTH_TAP[0][0]));
+  v = _mm256_add_epi32(v, _mm256_mullo_epi32(_mm256_add_epi32(b, e), _mm256_set1_epi32(ONE_FOURTH_TAP[0][1])));
+  return _mm256_add_epi32(v, _mm256_mullo_epi32(_mm256_add_epi32(c, f), _mm256_set1_epi32(ONE_FOURTH_TAP[0][2])));
+}
+
+//! iClip1(max, rshift_rnd_sf(v, shift)), 32 bit lanes
+AVX2_INLINE __m256i round_clip_avx2(__m256i v, int shift, __m256i max)
+{
+  v = _mm256_srai_epi32(_mm256_add_epi32(v, _mm256_set1_epi32(1 << (shift - 1))), shift);
+  return _mm256_min_epi32(_mm256_max_epi32(v, _mm256_setzero_si256()), max);
+}
+
+//! Horizontal six-tap sample at i, taps outside [0, n) clamped to the line ends
+static inline int hor_six_tap_clamped(const imgpel *src, int i, int n)
+{
+  return ONE_FOURTH_TAP[0][0] * (src[iClip3(0, n - 1, i    )] + src[iClip3(0, n - 1, i + 1)])
+       + ONE_FOURTH_TAP[0][1] * (src[iClip3(0, n - 1, i - 1)] + src[iClip3(0, n - 1, i + 2)])
+       + ONE_FOURTH_TAP[0][2] * (src[iClip3(0, n - 1, i - 2)] + src[iClip3(0, n - 1, i + 3)]);
+}
+
+/*!
+************************************************************************
+* \brief
+*    Horizontal six-tap pass, see getHorSubImageSixTap
+************************************************************************
+*/
+AVX2 static void getHorSubImageSixTap_avx2(VideoParameters *p_Vid, StorablePicture *s, imgpel **dstImg, imgpel **srcImg)
+{
+  int jpad, ipad, is;
+  int ypadded_size = s->size_y_padded;
+  int xpadded_size = s->size_x_padded;
+  int max_imgpel_value = p_Vid->max_imgpel_value;
+  __m256i max = _mm256_set1_epi32(max_imgpel_value);
+
+  for (jpad = -IMG_PAD_SIZE_Y; jpad < ypadded_size - IMG_PAD_SIZE_Y; jpad++)
+  {
+    imgpel *wBufSrc = srcImg[jpad] - IMG_PAD_SIZE_X;
+    imgpel *wBufDst = dstImg[jpad] - IMG_PAD_SIZE_X;
+    int    *iBufDst = p_Vid->imgY_sub_tmp[jpad] - IMG_PAD_SIZE_X;
+
+    for (ipad = 0; ipad < 2; ipad++)
+    {
+      is = hor_six_tap_clamped(wBufSrc, ipad, xpadded_size);
+      iBufDst[ipad] = is;
+      wBufDst[ipad] = (imgpel) iClip1(max_imgpel_value, rshift_rnd_sf(is, 5));
+    }
+    // center: all six taps inside the line
+    for (; ipad + 8 <= xpadded_size - 3; ipad += 8)
+    {
+      __m256i v = six_tap_avx2(load_pel8_32(wBufSrc + ipad    ), load_pel8_32(wBufSrc + ipad - 1), load_pel8_32(wBufSrc + ipad - 2),
+                               load_pel8_32(wBufSrc + ipad + 1), load_pel8_32(wBufSrc + ipad + 2), load_pel8_32(wBufSrc + ipad + 3));
+      _mm256_storeu_si256((__m256i *) (iBufDst + ipad), v);
+      store_pel8_32(wBufDst + ipad, round_clip_avx2(v, 5, max));
+    }
+    for (; ipad < xpadded_size; ipad++)
+    {
+      is = hor_six_tap_clamped(wBufSrc, ipad, xpadded_size);
+      iBufDst[ipad] = is;
+      wBufDst[ipad] = (imgpel) iClip1(max_imgpel_value, rshift_rnd_sf(is, 5));
+    }
+  }
+}
+
+//! One line of the vertical six-tap pass on pels, srcImgA..F as in getVerSubImageSixTap
+AVX2_INLINE void ver_six_tap_line(imgpel *dst, imgpel *srcImgA, imgpel *srcImgB, imgpel *srcImgC,
+                                  imgpel *srcImgD, imgpel *srcImgE, imgpel *srcImgF, int n, int max_imgpel_value)
+{
+  __m256i max = _mm256_set1_epi32(max_imgpel_value);
+  int ipad = 0, is;
+
+  for (; ipad + 8 <= n; ipad += 8)
+  {
+    __m256i v = six_tap_avx2(load_pel8_32(srcImgA + ipad), load_pel8_32(srcImgB + ipad), load_pel8_32(srcImgC + ipad),
+                             load_pel8_32(srcImgD + ipad), load_pel8_32(srcImgE + ipad), load_pel8_32(srcImgF + ipad));
+    store_pel8_32(dst + ipad, round_clip_avx2(v, 5, max));
+  }
+  for (; ipad < n; ipad++)
+  {
+    is = ONE_FOURTH_TAP[0][0] * (srcImgA[ipad] + srcImgD[ipad]) + ONE_FOURTH_TAP[0][1] * (srcImgB[ipad] + srcImgE[ipad])
+       + ONE_FOURTH_TAP[0][2] * (srcImgC[ipad] + srcImgF[ipad]);
+    dst[ipad] = (imgpel) iClip1(max_imgpel_value, rshift_rnd_sf(is, 5));
+  }
+}
+
+//! One line of the vertical six-tap pass on the horizontal intermediate values
+AVX2_INLINE void ver_six_tap_tmp_line(imgpel *dst, int *srcImgA, int *srcImgB, int *srcImgC,
+                                      int *srcImgD, int *srcImgE, int *srcImgF, int n, int max_imgpel_value)
+{
+  __m256i max = _mm256_set1_epi32(max_imgpel_value);
+  int ipad = 0, is;
+
+#define LOAD_INT8(p) _mm256_loadu_si256((const __m256i *) (p))
+  for (; ipad + 8 <= n; ipad += 8)
+  {
+    __m256i v = six_tap_avx2(LOAD_INT8(srcImgA + ipad), LOAD_INT8(srcImgB + ipad), LOAD_INT8(srcImgC + ipad),
+                             LOAD_INT8(srcImgD + ipad), LOAD_INT8(srcImgE + ipad), LOAD_INT8(srcImgF + ipad));
+    store_pel8_32(dst + ipad, round_clip_avx2(v, 10, max));
+  }
+#undef LOAD_INT8
+  for (; ipad < n; ipad++)
+  {
+    is = ONE_FOURTH_TAP[0][0] * (srcImgA[ipad] + srcImgD[ipad]) + ONE_FOURTH_TAP[0][1] * (srcImgB[ipad] + srcImgE[ipad])
+       + ONE_FOURTH_TAP[0][2] * (srcImgC[ipad] + srcImgF[ipad]);
+    dst[ipad] = (imgpel) iClip1(max_imgpel_value, rshift_rnd_sf(is, 10));
+  }
+}
+
+/*!
+************************************************************************
+* \brief
+*    Vertical six-tap pass on integer pels, see getVerSubImageSixTap
+************************************************************************
+*/
+AVX2 static void getVerSubImageSixTap_avx2(VideoParameters *p_Vid, StorablePicture *s, imgpel **dstImg, imgpel **srcImg)
+{
+  int jpad;
+  int ypadded_size = s->size_y_padded;
+  int xpadded_size = s->size_x_padded;
+  int maxy = ypadded_size - 1 - IMG_PAD_SIZE_Y;
+  int top, bottom;
+
+  for (jpad = -IMG_PAD_SIZE_Y; jpad < ypadded_size - IMG_PAD_SIZE_Y; jpad++)
+  {
+    // rows above the first and below the last line are clamped (top / bottom lines of getVerSubImageSixTap)
+    top    = (jpad < 2 - IMG_PAD_SIZE_Y);
+    bottom = (jpad >= ypadded_size - 3 - IMG_PAD_SIZE_Y);
+    ver_six_tap_line(dstImg[jpad] - IMG_PAD_SIZE_X,
+      srcImg[jpad] - IMG_PAD_SIZE_X,
+      srcImg[top ? -IMG_PAD_SIZE_Y : jpad - 1] - IMG_PAD_SIZE_X,
+      srcImg[top ? -IMG_PAD_SIZE_Y : jpad - 2] - IMG_PAD_SIZE_X,
+      srcImg[bottom ? imin(maxy, jpad + 1) : jpad + 1] - IMG_PAD_SIZE_X,
+      srcImg[bottom ? maxy : jpad + 2] - IMG_PAD_SIZE_X,
+      srcImg[bottom ? maxy : jpad + 3] - IMG_PAD_SIZE_X,
+      xpadded_size, p_Vid->max_imgpel_value);
+  }
+}
+
+/*!
+************************************************************************
+* \brief
+*    Vertical six-tap pass on the horizontal intermediate values, see
+*    getVerSubImageSixTapTmp
+************************************************************************
+*/
+AVX2 static void getVerSubImageSixTapTmp_avx2(VideoParameters *p_Vid, StorablePicture *s, imgpel **dstImg)
+{
+  int jpad;
+  int ypadded_size = s->size_y_padded;
+  int xpadded_size = s->size_x_padded;
+  int maxy = ypadded_size - 1 - IMG_PAD_SIZE_Y;
+  int top, bottom;
+  int **tmp = p_Vid->imgY_sub_tmp;
+
+  for (jpad = -IMG_PAD_SIZE_Y; jpad < ypadded_size - IMG_PAD_SIZE_Y; jpad++)
+  {
+    top    = (jpad < 2 - IMG_PAD_SIZE_Y);
+    bottom = (jpad >= ypadded_size - 3 - IMG_PAD_SIZE_Y);
+    ver_six_tap_tmp_line(dstImg[jpad] - IMG_PAD_SIZE_X,
+      tmp[jpad] - IMG_PAD_SIZE_X,
+      tmp[top ? -IMG_PAD_SIZE_Y : jpad - 1] - IMG_PAD_SIZE_X,
+      tmp[top ? -IMG_PAD_SIZE_Y : jpad - 2] - IMG_PAD_SIZE_X,
+      tmp[bottom ? imin(maxy, jpad + 1) : jpad + 1] - IMG_PAD_SIZE_X,
+      tmp[bottom ? maxy : jpad + 2] - IMG_PAD_SIZE_X,
+      tmp[bottom ? maxy : jpad + 3] - IMG_PAD_SIZE_X,
+      xpadded_size, p_Vid->max_imgpel_value);
+  }
+}
+
+//! dst[i] = rshift_rnd_sf(a[i] + b[i], 1) for n pels
+AVX2_INLINE void average_line(imgpel *dst, const imgpel *a, const imgpel *b, int n)
+{
+  int i = 0;
+
+#if (IMGTYPE == 0)
+  for (; i + 32 <= n; i += 32)
+    _mm256_storeu_si256((__m256i *) (dst + i), _mm256_avg_epu8(_mm256_loadu_si256((const __m256i *) (a + i)), _mm256_loadu_si256((const __m256i *) (b + i))));
+#else
+  for (; i + 16 <= n; i += 16)
+    _mm256_storeu_si256((__m256i *) (dst + i), _mm256_avg_epu16(_mm256_loadu_si256((const __m256i *) (a + i)), _mm256_loadu_si256((const __m256i *) (b + i))));
+#endif
+  for (; i < n; i++)
+    dst[i] = (imgpel) rshift_rnd_sf(a[i] + b[i], 1);
+}
+
+/*!
+************************************************************************
+* \brief
+*    Bilinear passes, see getSubImageBiLinear, getHorSubImageBiLinear,
+*    getVerSubImageBiLinear and getDiagSubImageBiLinear
+************************************************************************
+*/
+AVX2 static void getSubImageBiLinear_avx2(StorablePicture *s, imgpel **dstImg, imgpel **srcImgL, imgpel **srcImgR)
+{
+  int jpad;
+
+  for (jpad = -IMG_PAD_SIZE_Y; jpad < s->size_y_padded - IMG_PAD_SIZE_Y; jpad++)
+    average_line(dstImg[jpad] - IMG_PAD_SIZE_X, srcImgL[jpad] - IMG_PAD_SIZE_X, srcImgR[jpad] - IMG_PAD_SIZE_X, s->size_x_padded);
+}
+
+AVX2 static void getHorSubImageBiLinear_avx2(StorablePicture *s, imgpel **dstImg, imgpel **srcImgL, imgpel **srcImgR)
+{
+  int jpad;
+  int xpadded_size = s->size_x_padded - 1;
+
+  for (jpad = -IMG_PAD_SIZE_Y; jpad < s->size_y_padded - IMG_PAD_SIZE_Y; jpad++)
+  {
+    imgpel *wBufSrcL = srcImgL[jpad] - IMG_PAD_SIZE_X;
+    imgpel *wBufSrcR = srcImgR[jpad] - IMG_PAD_SIZE_X;
+    imgpel *wBufDst  = dstImg[jpad] - IMG_PAD_SIZE_X;
+
+    average_line(wBufDst, wBufSrcL, wBufSrcR + 1, xpadded_size);
+    // right padded area
+    wBufDst[xpadded_size] = (imgpel) rshift_rnd_sf(wBufSrcL[xpadded_size] + wBufSrcR[xpadded_size], 1);
+  }
+}
+
+AVX2 static void getVerSubImageBiLinear_avx2(StorablePicture *s, imgpel **dstImg, imgpel **srcImgT, imgpel **srcImgB)
+{
+  int jpad;
+  int ypadded_size = s->size_y_padded - 1;
+
+  for (jpad = -IMG_PAD_SIZE_Y; jpad < ypadded_size - IMG_PAD_SIZE_Y; jpad++)
+    average_line(dstImg[jpad] - IMG_PAD_SIZE_X, srcImgT[jpad] - IMG_PAD_SIZE_X, srcImgB[jpad + 1] - IMG_PAD_SIZE_X, s->size_x_padded);
+  // bottom
+  average_line(dstImg[jpad] - IMG_PAD_SIZE_X, srcImgT[jpad] - IMG_PAD_SIZE_X, srcImgB[jpad] - IMG_PAD_SIZE_X, s->size_x_padded);
+}
+
+AVX2 static void getDiagSubImageBiLinear_avx2(StorablePicture *s, imgpel **dstImg, imgpel **srcImgT, imgpel **srcImgB)
+{
+  int jpad;
+  int xpadded_size = s->size_x_padded - 1;
+  int maxy = s->size_y_padded - 1 - IMG_PAD_SIZE_Y;
+
+  for (jpad = -IMG_PAD_SIZE_Y; jpad <= maxy; jpad++)
+  {
+    imgpel *wBufSrcL = srcImgT[imin(maxy, jpad + 1)] - IMG_PAD_SIZE_X;
+    imgpel *wBufSrcR = srcImgB[jpad] - IMG_PAD_SIZE_X;
+    imgpel *wBufDst  = dstImg[jpad] - IMG_PAD_SIZE_X;
+
+    average_line(wBufDst, wBufSrcL, wBufSrcR + 1, xpadded_size);
+    wBufDst[xpadded_size] = (imgpel) rshift_rnd_sf(wBufSrcL[xpadded_size] + wBufSrcR[xpadded_size], 1);
+  }
+}
+
+static const SubImageFuncs sub_image_avx2 =
+{
+  getHorSubImageSixTap_avx2,
+  getVerSubImageSixTap_avx2,
+  getVerSubImageSixTapTmp_avx2,
+  getSubImageBiLinear_avx2,
+  getHorSubImageBiLinear_avx2,
+  getVerSubImageBiLinear_avx2,
+  getDiagSubImageBiLinear_avx2
+};
+
+/*!
+************************************************************************
+* \brief
+*    AVX2 interpolation passes, or NULL if the CPU does not support them
+************************************************************************
+*/
+const SubImageFuncs *get_sub_image_funcs_simd(void)
+{
+  return (get_simd_level() == SIMD_AVX2) ? &sub_image_avx2 : NULL;
+}
+
+#else
+
+const SubImageFuncs *get_sub_image_funcs_simd(void)
+{
+  return NULL;
+}
+
+#endif
@@ -0,0 +1,366 @@
+
+/*!
+*************************************************************************************
+* \file img_luma_tile.c
+*
+* \brief
+*    Lazy, tile based luma sub-pel interpolation (LazySubPelInterp = 1).
+*
+*    Instead of interpolating all 15 sub-pel images of a reference picture in
+*    getSubImagesLuma, the padded picture is divided into tiles of
+*    SUB_TILE_SIZE x SUB_TILE_SIZE samples, and all sub-pel phases of a tile
+*    are interpolated when motion estimation or compensation first reads a
+*    fractional position in it. A per picture map records the tiles done.
+*    The sub-images keep their layout, so the ME and MC functions access
+*    them as usual; the distortion functions of the DPB are wrapped so the
+*    tiles are filled first, and OneComponentLumaPrediction does the same.
+*    The samples are identical to those of getSubImagesLuma.
+*
+*************************************************************************************
+*/
+
+#include "global.h"
+#include "img_luma_tile.h"
+#include "img_luma.h"
+
+#define TILE_TMP_STRIDE  (SUB_TILE_SIZE + 1)   //!< tile plus the column needed by the quarter-pel averages
+
+//! horizontal six-tap sums of the padded columns [x0, x1) of a row, taps clamped to the row
+static void hor_six_tap_line (const imgpel *src, int *dst, int x0, int x1, int width)
+{
+  const int tap0 = ONE_FOURTH_TAP[0][0];
+  const int tap1 = ONE_FOURTH_TAP[0][1];
+  const int tap2 = ONE_FOURTH_TAP[0][2];
+  int i = x0;
+  int xc = imin(x1, width - 3);
+
+  for (; i < x1 && i < 2; ++i)
+    dst[i] = tap0 * (src[i] + src[imin(i + 1, width - 1)]) + tap1 * (src[imax(i - 1, 0)] + src[imin(i + 2, width - 1)])
+      + tap2 * (src[imax(i - 2, 0)] + src[imin(i + 3, width - 1)]);
+  for (; i < xc; ++i)
+    dst[i] = tap0 * (src[i] + src[i + 1]) + tap1 * (src[i - 1] + src[i + 2]) + tap2 * (src[i - 2] + src[i + 3]);
+  for (; i < x1; ++i)
+    dst[i] = tap0 * (src[i] + src[imin(i + 1, width - 1)]) + tap1 * (src[imax(i - 1, 0)] + src[imin(i + 2, width - 1)])
+      + tap2 * (src[imax(i - 2, 0)] + src[imin(i + 3, width - 1)]);
+}
+
+//! dst[i] = (a[i] + b[i + shift] + 1) >> 1 for the padded columns [x0, x1), b clamped to the row
+static inline void average_line (imgpel *dst, const imgpel *a, const imgpel *b, int shift, int x0, int x1, int width)
+{
+  int i;
+  int xc = (shift && x1 == width) ? x1 - 1 : x1;
+
+  for (i = x0; i < xc; ++i)
+    dst[i] = (imgpel) ((a[i] + b[i + shift] + 1) >> 1);
+  if (xc < x1)
+    dst[xc] = (imgpel) ((a[xc] + b[xc] + 1) >> 1);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Interpolates all sub-pel images of one tile. Coordinates are in
+ *    the padded picture. The half-pel images are computed one row and
+ *    one column beyond the tile, for the quarter-pel averages; those
+ *    samples are the same as the neighbouring tiles compute.
+ ************************************************************************
+ */
+static void fill_tile (VideoParameters *p_Vid, LazySubPel *p_lazy, StorablePicture *s, int tile_x, int tile_y)
+{
+  const int tap0 = ONE_FOURTH_TAP[0][0];
+  const int tap1 = ONE_FOURTH_TAP[0][1];
+  const int tap2 = ONE_FOURTH_TAP[0][2];
+  int max_imgpel_value = p_Vid->max_imgpel_value;
+  int width  = s->size_x_padded;
+  int height = s->size_y_padded;
+  int x0 = tile_x << SUB_TILE_SIZE_LOG2;
+  int y0 = tile_y << SUB_TILE_SIZE_LOG2;
+  int x1 = imin(x0 + SUB_TILE_SIZE, width);
+  int y1 = imin(y0 + SUB_TILE_SIZE, height);
+  int xe = imin(x1 + 1, width);
+  int ye = imin(y1 + 1, height);
+  int i, j, k, is;
+  int *tmp;
+  imgpel ****sub = s->imgY_sub;
+  imgpel *row[6];
+  int *trow[6];
+
+  // horizontal six-tap sums of rows y0 - 2 .. y1 + 2 (clamped), row k of tmp is row y0 - 2 + k
+  for (k = 0; k < y1 - y0 + 5; ++k)
+  {
+    hor_six_tap_line(sub[0][0][iClip3(0, height - 1, y0 - 2 + k) - IMG_PAD_SIZE_Y] - IMG_PAD_SIZE_X,
+      p_lazy->tmp + k * TILE_TMP_STRIDE - x0, x0, xe, width);
+  }
+
+  // sub-image [0][2]
+  for (j = y0; j < ye; ++j)
+  {
+    imgpel *dst = sub[0][2][j - IMG_PAD_SIZE_Y] - IMG_PAD_SIZE_X;
+    tmp = p_lazy->tmp + (j - y0 + 2) * TILE_TMP_STRIDE - x0;
+    for (i = x0; i < xe; ++i)
+      dst[i] = (imgpel) iClip1(max_imgpel_value, rshift_rnd_sf(tmp[i], 5));
+  }
+
+  // sub-images [2][0] and [2][2]
+  for (j = y0; j < y1; ++j)
+  {
+    imgpel *dst20 = sub[2][0][j - IMG_PAD_SIZE_Y] - IMG_PAD_SIZE_X;
+    imgpel *dst22 = sub[2][2][j - IMG_PAD_SIZE_Y] - IMG_PAD_SIZE_X;
+
+    for (k = 0; k < 6; ++k)
+    {
+      row[k]  = sub[0][0][iClip3(0, height - 1, j - 2 + k) - IMG_PAD_SIZE_Y] - IMG_PAD_SIZE_X;
+      trow[k] = p_lazy->tmp + (j - y0 + k) * TILE_TMP_STRIDE - x0;
+    }
+    for (i = x0; i < xe; ++i)
+    {
+      is = tap0 * (row[2][i] + row[3][i]) + tap1 * (row[1][i] + row[4][i]) + tap2 * (row[0][i] + row[5][i]);
+      dst20[i] = (imgpel) iClip1(max_imgpel_value, rshift_rnd_sf(is, 5));
+    }
+    for (i = x0; i < x1; ++i)
+    {
+      is = tap0 * (trow[2][i] + trow[3][i]) + tap1 * (trow[1][i] + trow[4][i]) + tap2 * (trow[0][i] + trow[5][i]);
+      dst22[i] = (imgpel) iClip1(max_imgpel_value, rshift_rnd_sf(is, 10));
+    }
+  }
+
+  // quarter-pel sub-images, right and bottom neighbours clamped like getSubImagesLuma
+  for (j = y0; j < y1; ++j)
+  {
+    int jb = imin(j + 1, height - 1) - IMG_PAD_SIZE_Y;
+    int jc = j - IMG_PAD_SIZE_Y;
+    imgpel *p00 = sub[0][0][jc] - IMG_PAD_SIZE_X, *p02 = sub[0][2][jc] - IMG_PAD_SIZE_X;
+    imgpel *p20 = sub[2][0][jc] - IMG_PAD_SIZE_X, *p22 = sub[2][2][jc] - IMG_PAD_SIZE_X;
+    imgpel *b00 = sub[0][0][jb] - IMG_PAD_SIZE_X, *b02 = sub[0][2][jb] - IMG_PAD_SIZE_X;
+
+    average_line(sub[0][1][jc] - IMG_PAD_SIZE_X, p00, p02, 0, x0, x1, width);
+    average_line(sub[1][0][jc] - IMG_PAD_SIZE_X, p00, p20, 0, x0, x1, width);
+    average_line(sub[1][1][jc] - IMG_PAD_SIZE_X, p02, p20, 0, x0, x1, width);
+    average_line(sub[1][2][jc] - IMG_PAD_SIZE_X, p02, p22, 0, x0, x1, width);
+    average_line(sub[2][1][jc] - IMG_PAD_SIZE_X, p20, p22, 0, x0, x1, width);
+
+    average_line(sub[0][3][jc] - IMG_PAD_SIZE_X, p02, p00, 1, x0, x1, width);
+    average_line(sub[1][3][jc] - IMG_PAD_SIZE_X, p02, p20, 1, x0, x1, width);
+    average_line(sub[2][3][jc] - IMG_PAD_SIZE_X, p22, p20, 1, x0, x1, width);
+
+    average_line(sub[3][0][jc] - IMG_PAD_SIZE_X, p20, b00, 0, x0, x1, width);
+    average_line(sub[3][1][jc] - IMG_PAD_SIZE_X, p20, b02, 0, x0, x1, width);
+    average_line(sub[3][2][jc] - IMG_PAD_SIZE_X, p22, b02, 0, x0, x1, width);
+
+    average_line(sub[3][3][jc] - IMG_PAD_SIZE_X, b02, p20, 1, x0, x1, width);
+  }
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Interpolates the tiles of the padded area (x, y, width, height)
+ *    not interpolated yet
+ ***********************************************************************
+ */
+void LazySubPelFill (VideoParameters *p_Vid, StorablePicture *s, int x, int y, int width, int height)
+{
+  LazySubPel *p_lazy = p_Vid->p_LazySubPel;
+  int tile_cols = SUB_TILES(s->size_x_padded);
+  int tx0 = x >> SUB_TILE_SIZE_LOG2;
+  int ty0 = y >> SUB_TILE_SIZE_LOG2;
+  int tx1 = (imin(x + width,  s->size_x_padded) - 1) >> SUB_TILE_SIZE_LOG2;
+  int ty1 = (imin(y + height, s->size_y_padded) - 1) >> SUB_TILE_SIZE_LOG2;
+  int tx, ty;
+
+  for (ty = ty0; ty <= ty1; ++ty)
+  {
+    byte *map = s->sub_tile_map + ty * tile_cols;
+    for (tx = tx0; tx <= tx1; ++tx)
+    {
+      if (!map[tx])
+      {
+#if GET_METIME
+        TIME_T start_time, end_time;
+
+        gettime(&start_time);
+#endif
+        fill_tile(p_Vid, p_lazy, s, tx, ty);
+        map[tx] = 1;
+        ++p_lazy->tiles_filled;
+#if GET_METIME
+        gettime(&end_time);
+        p_Vid->subpel_tot_time += timediff(&start_time, &end_time);
+#endif
+      }
+    }
+  }
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Marks all tiles of a reference as not interpolated. Called by
+ *    getSubImagesLuma instead of interpolating the sub-images.
+ ***********************************************************************
+ */
+void LazySubPelReset (VideoParameters *p_Vid, StorablePicture *s)
+{
+  int tiles = SUB_TILES(s->size_x_padded) * SUB_TILES(s->size_y_padded);
+
+  memset(s->sub_tile_map, 0, tiles * sizeof(byte));
+  p_Vid->p_LazySubPel->tiles_total += tiles;
+}
+
+static distblk computeSAD_lazy (StorablePicture *ref1, MEBlock *mv_block, distblk min_mcost, MotionVector *cand)
+{
+  VideoParameters *p_Vid = mv_block->p_Vid;
+  LazySubPelBlock(p_Vid, ref1, cand->mv_y, cand->mv_x, mv_block->blocksize_x, mv_block->blocksize_y);
+  return p_Vid->p_LazySubPel->computeSAD(ref1, mv_block, min_mcost, cand);
+}
+
+static distblk computeSADWP_lazy (StorablePicture *ref1, MEBlock *mv_block, distblk min_mcost, MotionVector *cand)
+{
+  VideoParameters *p_Vid = mv_block->p_Vid;
+  LazySubPelBlock(p_Vid, ref1, cand->mv_y, cand->mv_x, mv_block->blocksize_x, mv_block->blocksize_y);
+  return p_Vid->p_LazySubPel->computeSADWP(ref1, mv_block, min_mcost, cand);
+}
+
+static distblk computeSATD_lazy (StorablePicture *ref1, MEBlock *mv_block, distblk min_mcost, MotionVector *cand)
+{
+  VideoParameters *p_Vid = mv_block->p_Vid;
+  LazySubPelBlock(p_Vid, ref1, cand->mv_y, cand->mv_x, mv_block->blocksize_x, mv_block->blocksize_y);
+  return p_Vid->p_LazySubPel->computeSATD(ref1, mv_block, min_mcost, cand);
+}
+
+static distblk computeSATDWP_lazy (StorablePicture *ref1, MEBlock *mv_block, distblk min_mcost, MotionVector *cand)
+{
+  VideoParameters *p_Vid = mv_block->p_Vid;
+  LazySubPelBlock(p_Vid, ref1, cand->mv_y, cand->mv_x, mv_block->blocksize_x, mv_block->blocksize_y);
+  return p_Vid->p_LazySubPel->computeSATDWP(ref1, mv_block, min_mcost, cand);
+}
+
+static distblk computeSSE_lazy (StorablePicture *ref1, MEBlock *mv_block, distblk min_mcost, MotionVector *cand)
+{
+  VideoParameters *p_Vid = mv_block->p_Vid;
+  LazySubPelBlock(p_Vid, ref1, cand->mv_y, cand->mv_x, mv_block->blocksize_x, mv_block->blocksize_y);
+  return p_Vid->p_LazySubPel->computeSSE(ref1, mv_block, min_mcost, cand);
+}
+
+static distblk computeSSEWP_lazy (StorablePicture *ref1, MEBlock *mv_block, distblk min_mcost, MotionVector *cand)
+{
+  VideoParameters *p_Vid = mv_block->p_Vid;
+  LazySubPelBlock(p_Vid, ref1, cand->mv_y, cand->mv_x, mv_block->blocksize_x, mv_block->blocksize_y);
+  return p_Vid->p_LazySubPel->computeSSEWP(ref1, mv_block, min_mcost, cand);
+}
+
+//! fills the tiles of both blocks of a bi-predictive candidate
+static inline void lazy_bipred_blocks (StorablePicture *ref1, StorablePicture *ref2, MEBlock *mv_block, MotionVector *cand1, MotionVector *cand2)
+{
+  LazySubPelBlock(mv_block->p_Vid, ref1, cand1->mv_y, cand1->mv_x, mv_block->blocksize_x, mv_block->blocksize_y);
+  LazySubPelBlock(mv_block->p_Vid, ref2, cand2->mv_y, cand2->mv_x, mv_block->blocksize_x, mv_block->blocksize_y);
+}
+
+static distblk computeBiPredSAD1_lazy (StorablePicture *ref1, StorablePicture *ref2, MEBlock *mv_block, distblk min_mcost, MotionVector *cand1, MotionVector *cand2)
+{
+  lazy_bipred_blocks(ref1, ref2, mv_block, cand1, cand2);
+  return mv_block->p_Vid->p_LazySubPel->computeBiPredSAD1(ref1, ref2, mv_block, min_mcost, cand1, cand2);
+}
+
+static distblk computeBiPredSAD2_lazy (StorablePicture *ref1, StorablePicture *ref2, MEBlock *mv_block, distblk min_mcost, MotionVector *cand1, MotionVector *cand2)
+{
+  lazy_bipred_blocks(ref1, ref2, mv_block, cand1, cand2);
+  return mv_block->p_Vid->p_LazySubPel->computeBiPredSAD2(ref1, ref2, mv_block, min_mcost, cand1, cand2);
+}
+
+static distblk computeBiPredSATD1_lazy (StorablePicture *ref1, StorablePicture *ref2, MEBlock *mv_block, distblk min_mcost, MotionVector *cand1, MotionVector *cand2)
+{
+  lazy_bipred_blocks(ref1, ref2, mv_block, cand1, cand2);
+  return mv_block->p_Vid->p_LazySubPel->computeBiPredSATD1(ref1, ref2, mv_block, min_mcost, cand1, cand2);
+}
+
+static distblk computeBiPredSATD2_lazy (StorablePicture *ref1, StorablePicture *ref2, MEBlock *mv_block, distblk min_mcost, MotionVector *cand1, MotionVector *cand2)
+{
+  lazy_bipred_blocks(ref1, ref2, mv_block, cand1, cand2);
+  return mv_block->p_Vid->p_LazySubPel->computeBiPredSATD2(ref1, ref2, mv_block, min_mcost, cand1, cand2);
+}
+
+static distblk computeBiPredSSE1_lazy (StorablePicture *ref1, StorablePicture *ref2, MEBlock *mv_block, distblk min_mcost, MotionVector *cand1, MotionVector *cand2)
+{
+  lazy_bipred_blocks(ref1, ref2, mv_block, cand1, cand2);
+  return mv_block->p_Vid->p_LazySubPel->computeBiPredSSE1(ref1, ref2, mv_block, min_mcost, cand1, cand2);
+}
+
+static distblk computeBiPredSSE2_lazy (StorablePicture *ref1, StorablePicture *ref2, MEBlock *mv_block, distblk min_mcost, MotionVector *cand1, MotionVector *cand2)
+{
+  lazy_bipred_blocks(ref1, ref2, mv_block, cand1, cand2);
+  return mv_block->p_Vid->p_LazySubPel->computeBiPredSSE2(ref1, ref2, mv_block, min_mcost, cand1, cand2);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Wraps the distortion functions of a DPB layer so that the tiles
+ *    they read are interpolated first
+ ***********************************************************************
+ */
+void LazySubPelSetupDpb (VideoParameters *p_Vid, DecodedPictureBuffer *p_Dpb)
+{
+  LazySubPel *p_lazy = p_Vid->p_LazySubPel;
+
+  p_lazy->computeSAD         = p_Dpb->pf_computeSAD;
+  p_lazy->computeSADWP       = p_Dpb->pf_computeSADWP;
+  p_lazy->computeSATD        = p_Dpb->pf_computeSATD;
+  p_lazy->computeSATDWP      = p_Dpb->pf_computeSATDWP;
+  p_lazy->computeSSE         = p_Dpb->pf_computeSSE;
+  p_lazy->computeSSEWP       = p_Dpb->pf_computeSSEWP;
+  p_lazy->computeBiPredSAD1  = p_Dpb->pf_computeBiPredSAD1;
+  p_lazy->computeBiPredSAD2  = p_Dpb->pf_computeBiPredSAD2;
+  p_lazy->computeBiPredSATD1 = p_Dpb->pf_computeBiPredSATD1;
+  p_lazy->computeBiPredSATD2 = p_Dpb->pf_computeBiPredSATD2;
+  p_lazy->computeBiPredSSE1  = p_Dpb->pf_computeBiPredSSE1;
+  p_lazy->computeBiPredSSE2  = p_Dpb->pf_computeBiPredSSE2;
+
+  p_Dpb->pf_computeSAD         = computeSAD_lazy;
+  p_Dpb->pf_computeSADWP       = computeSADWP_lazy;
+  p_Dpb->pf_computeSATD        = computeSATD_lazy;
+  p_Dpb->pf_computeSATDWP      = computeSATDWP_lazy;
+  p_Dpb->pf_computeSSE         = computeSSE_lazy;
+  p_Dpb->pf_computeSSEWP       = computeSSEWP_lazy;
+  p_Dpb->pf_computeBiPredSAD1  = computeBiPredSAD1_lazy;
+  p_Dpb->pf_computeBiPredSAD2  = computeBiPredSAD2_lazy;
+  p_Dpb->pf_computeBiPredSATD1 = computeBiPredSATD1_lazy;
+  p_Dpb->pf_computeBiPredSATD2 = computeBiPredSATD2_lazy;
+  p_Dpb->pf_computeBiPredSSE1  = computeBiPredSSE1_lazy;
+  p_Dpb->pf_computeBiPredSSE2  = computeBiPredSSE2_lazy;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Allocates the lazy interpolation state. Returns the number of
+ *    bytes allocated.
+ ***********************************************************************
+ */
+int LazySubPelInit (VideoParameters *p_Vid)
+{
+  LazySubPel *p_lazy;
+
+  if ((p_lazy = (LazySubPel *) calloc(1, sizeof(LazySubPel))) == NULL)
+    no_mem_exit("LazySubPelInit: p_lazy");
+  if ((p_lazy->tmp = (int *) calloc((SUB_TILE_SIZE + 5) * TILE_TMP_STRIDE, sizeof(int))) == NULL)
+    no_mem_exit("LazySubPelInit: p_lazy->tmp");
+  p_Vid->p_LazySubPel = p_lazy;
+
+  return sizeof(LazySubPel) + (SUB_TILE_SIZE + 5) * TILE_TMP_STRIDE * sizeof(int);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Frees the lazy interpolation state
+ ***********************************************************************
+ */
+void LazySubPelDelete (VideoParameters *p_Vid)
+{
+  if (p_Vid->p_LazySubPel == NULL)
+    return;
+  free(p_Vid->p_LazySubPel->tmp);
+  free(p_Vid->p_LazySubPel);
+  p_Vid->p_LazySubPel = NULL;
+}
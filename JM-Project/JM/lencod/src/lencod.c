@@ -71,6 +71,15 @@
 #include "me_umhex.h"
 #include "me_umhexsmp.h"
 #include "me_hme.h"
+#include "me_ads.h"
+#include "me_sadcache.h"
+#include "img_luma_tile.h"
+#include "slice_threads.h"
+#include "wavefront.h"
+#include "frame_threads.h"
+#include "lookahead.h"
+#include "md_early_term.h"
+#include "thread_pool.h"
 #include "output.h"
 #include "parset.h"
 #include "q_matrix.h"
@@ -91,6 +100,7 @@
 #include "mc_prediction.h"
 #include "me_distortion.h"
 #include "me_distortion_otf.h"
+#include "me_distortion_simd.h"
 #include "md_distortion.h"
 #include "mode_decision.h"
 #include "transform8x8.h"
@@ -364,6 +374,9 @@ void setup_dpb_layer(DecodedPictureBuffer *p_Dpb, VideoParameters *p_Vid, InputP
     p_Dpb->pf_computeSSEWP = computeSSEWP;
     p_Dpb->pf_computeBiPredSSE1 = computeBiPredSSE1;
     p_Dpb->pf_computeBiPredSSE2 = computeBiPredSSE2;
+    init_distortion_simd(p_Dpb);
+    if (p_Vid->p_LazySubPel)
+      LazySubPelSetupDpb(p_Vid, p_Dpb);
     p_Dpb->pf_luma_prediction    = luma_prediction;
     p_Dpb->pf_luma_prediction_bi = luma_prediction_bi;
     p_Dpb->pf_chroma_prediction  = chroma_prediction;
@@ -605,6 +618,14 @@ static void init_encoder(VideoParameters *p_Vid, InputParameters *p_Inp)
     wpxInitWPXPasses(p_Vid, p_Inp);
 
   init_motion_search_module (p_Vid, p_Inp);
+
+  if (p_Inp->SliceThreads > 1)
+    SliceThreadsInit(p_Vid);
+  if (p_Inp->WavefrontThreads > 1)
+    WavefrontInit(p_Vid);
+  if (p_Inp->DeblockThreads > 1)
+    p_Vid->p_DeblockThreads = create_thread_pool(p_Inp->DeblockThreads);
+
   information_init(p_Vid, p_Inp, p_Vid->p_Stats);
 
   if(p_Inp->DistortionYUVtoRGB)
@@ -663,6 +684,10 @@ static void init_encoder(VideoParameters *p_Vid, InputParameters *p_Inp)
   {
     setup_dpb_layer(p_Vid->p_Dpb_layer[i], p_Vid, p_Inp);
   }
+
+  // the frame coding contexts are copies of the fully set up p_Vid
+  if (p_Inp->BFrameThreads > 1)
+    FrameThreadsInit(p_Vid);
 }
 
 void setup_coding_layer(VideoParameters *p_Vid)
@@ -817,7 +842,7 @@ void setup_coding_layer(VideoParameters *p_Vid)
 *    Prepare parameters for the current frame
 ************************************************************************
 */
-static void prepare_frame_params(VideoParameters *p_Vid, InputParameters *p_Inp, int curr_frame_to_code)
+void prepare_frame_params(VideoParameters *p_Vid, InputParameters *p_Inp, int curr_frame_to_code)
 {
   SeqStructure *p_seq_struct = p_Vid->p_pred;
   FrameUnitStruct *p_cur_frm = p_Vid->p_curr_frm_struct;
@@ -969,6 +994,18 @@ static void encode_sequence(VideoParameters *p_Vid, InputParameters *p_Inp)
       continue;
     }
 
+    // runs of non reference B frames are coded concurrently
+    if (p_Vid->p_FrameThreads != NULL)
+    {
+      int n = FrameThreadsRunLength(p_Vid, curr_frame_to_code, frames_to_code);
+      if (n > 0)
+      {
+        FrameThreadsEncode(p_Vid, curr_frame_to_code, n);
+        curr_frame_to_code += n - 1;
+        continue;
+      }
+    }
+
     // Update frame_num counter
     frame_num_bak = p_Vid->p_EncodePar[p_Vid->dpb_layer_id]->frame_num;
 
@@ -1060,6 +1097,11 @@ void free_encoder_memory(VideoParameters *p_Vid, InputParameters *p_Inp)
   if (p_Enc->p_trace)
     fclose(p_Enc->p_trace);
 
+  SliceThreadsDelete(p_Vid);
+  WavefrontDelete(p_Vid);
+  FrameThreadsDelete(p_Vid);
+  free_thread_pool(p_Vid->p_DeblockThreads);
+  p_Vid->p_DeblockThreads = NULL;
   clear_motion_search_module (p_Vid, p_Inp);
 
   RandomIntraUninit(p_Vid);
@@ -1517,7 +1559,7 @@ static void free_params (InputParameters *p_Inp)
  *    Pointer to a Picture
  ************************************************************************
  */
-Picture *malloc_picture()
+Picture *malloc_picture(void)
 {
   Picture *pic;
   if ((pic = calloc (1, sizeof (Picture))) == NULL) no_mem_exit ("malloc_picture: Picture structure");
@@ -1537,7 +1579,11 @@ void free_picture(Picture *pic)
 {
   if (pic != NULL)
   {
+    int i;
+
     free_slice_list(pic);
+    for (i = 0; i < MAXSLICEPERPICTURE; i++)
+      free_mem_arena(pic->arena[i]);
     free_pointer (pic);
   }
 }
@@ -1777,10 +1823,20 @@ static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
       smpUMHEX_init(p_Vid);
       memory_size += smpUMHEX_get_mem(p_Vid);
     }
-    if (p_Inp->SearchMode[0] == EPZS || p_Inp->SearchMode[1] == EPZS)
+    if (p_Inp->SearchMode[0] == EPZS || p_Inp->SearchMode[1] == EPZS || p_Inp->HMEEnable)
     {
       memory_size += EPZSInit(p_Vid);
     }
+    if (p_Inp->SearchMode[0] == ADS || p_Inp->SearchMode[1] == ADS)
+    {
+      memory_size += ADSInit(p_Vid);
+    }
+#if (JM_SAD_CACHE)
+    if ((p_Inp->SearchMode[0] == ADS || p_Inp->SearchMode[1] == ADS) && p_Inp->MEErrorMetric[F_PEL] == ERROR_SAD && !p_Inp->OnTheFlyFractMCP)
+    {
+      memory_size += SADCacheInit(p_Vid);
+    }
+#endif
   }
 
   if (p_Inp->RCEnable)
@@ -1805,6 +1861,28 @@ static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
     memory_size += get_mem2Dint_pad (&p_Vid->imgY_sub_tmp, p_Vid->height, p_Vid->width, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
   }
 
+  if (p_Inp->LazySubPelInterp)
+  {
+    memory_size += LazySubPelInit(p_Vid);
+  }
+
+  if (p_Inp->EarlyTermination)
+  {
+    memory_size += EarlyTermInit(p_Vid);
+  }
+
+  if (p_Inp->SliceArenas)
+  {
+    if ((p_Vid->p_ArenaStats = (MemArenaStats *) calloc(1, sizeof(MemArenaStats))) == NULL)
+      no_mem_exit("init_global_buffers: p_Vid->p_ArenaStats");
+    memory_size += sizeof(MemArenaStats);
+  }
+
+  if (p_Inp->PicturePool)
+  {
+    memory_size += init_pic_pool(p_Vid);
+  }
+
   //if ( p_Inp->ChromaMCBuffer )
     chroma_mc_setup(p_Vid);
 
@@ -1832,6 +1910,10 @@ static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
 
   memory_size += init_process_image( p_Vid, p_Inp );
 
+  // the prediction structure asks the lookahead where to place the B frames
+  if (p_Inp->Lookahead)
+    memory_size += LookaheadInit(p_Vid);
+
   p_Vid->p_pred = init_seq_structure( p_Vid, p_Inp, &memory_size );
 
   return memory_size;
@@ -1988,6 +2070,11 @@ static void free_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
     free_mem2Dint_pad (p_Vid->imgY_sub_tmp, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
     p_Vid->imgY_sub_tmp = NULL;
   }
+  LazySubPelDelete(p_Vid);
+  EarlyTermDelete(p_Vid);
+  free_pointer(p_Vid->p_ArenaStats);
+  p_Vid->p_ArenaStats = NULL;
+  free_pic_pool(p_Vid);
 
   // free mem, allocated in init_img()
   // free intra pred mode buffer for blocks
@@ -2097,10 +2184,15 @@ static void free_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
     {
       smpUMHEX_free_mem(p_Vid);
     }
-    if (p_Inp->SearchMode[0] == EPZS || p_Inp->SearchMode[1] == EPZS)
+    if (p_Inp->SearchMode[0] == EPZS || p_Inp->SearchMode[1] == EPZS || p_Inp->HMEEnable)
     {
       EPZSDelete(p_Vid);
     }
+    if (p_Inp->SearchMode[0] == ADS || p_Inp->SearchMode[1] == ADS)
+    {
+      ADSDelete(p_Vid);
+    }
+    SADCacheDelete(p_Vid);
   }
 
   if (p_Inp->RCEnable)
@@ -2127,6 +2219,7 @@ static void free_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
   }
 
   clear_process_image( p_Vid, p_Inp );
+  LookaheadDelete(p_Vid);
   free_seq_structure( p_Vid->p_pred );
 }
 
@@ -2170,6 +2263,33 @@ int get_mem_DCcoeff (int**** cofDC)
   return 3 * 2 * 18 * sizeof(int); 
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate memory for AC coefficients from an arena
+ ************************************************************************
+ */
+int get_mem_ACcoeff_arena (MemArena *arena, VideoParameters *p_Vid, int***** cofAC)
+{
+  int num_blk8x8 = BLOCK_SIZE + p_Vid->num_blk8x8_uv;
+
+  get_mem4Dint_arena(arena, cofAC, num_blk8x8, BLOCK_SIZE, 2, 65);
+
+  return num_blk8x8 * BLOCK_SIZE * 2 * 65 * sizeof(int);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate memory for DC coefficients from an arena
+ ************************************************************************
+ */
+int get_mem_DCcoeff_arena (MemArena *arena, int**** cofDC)
+{
+  get_mem3Dint_arena(arena, cofDC, 3, 2, 18);
+  return 3 * 2 * 18 * sizeof(int);
+}
+
 
 /*!
  ************************************************************************
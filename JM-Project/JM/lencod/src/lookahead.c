@@ -0,0 +1,637 @@
+
+/*!
+*************************************************************************************
+* \file lookahead.c
+*
+* \brief
+*    Lookahead pre-analysis of the input frames (Lookahead > 0).
+*
+*    A worker thread reads the input ahead of the encoder, scales the luma
+*    of each frame down 2:1 and estimates for every 8x8 block of the small
+*    frame (one macroblock of the input)
+*
+*    - an intra cost: the SATD of the best of the DC, vertical and
+*      horizontal predictions from the neighbouring source pels;
+*    - an inter cost against the previous frame: the SATD + lambda * R(mvd)
+*      of the MV found by the ADS search (ADS_plane_search), at most the
+*      intra cost.
+*
+*    From these it derives the intra and inter cost of each frame, the
+*    blocks that would be intra coded, scene cuts (frames whose inter cost
+*    is not SceneCutThreshold percent below their intra cost) and the
+*    propagation cost of each block: the part of the cost of the next
+*    Lookahead frames that is predicted from it, carried back along the
+*    motion of the chain of frames (the MB-tree of x264, with the B frames
+*    analysed as P frames).
+*
+*    The prediction structure asks for the length of each run of B frames
+*    (LookaheadBFrames) and codes the scene cuts as I frames
+*    (LookaheadSceneCut); rate control takes its initial QP from the
+*    costs of the first frames (LookaheadInitialQP). The worker stays at
+*    most Lookahead frames ahead of the last frame asked for and keeps the
+*    analysed frames in a ring of Lookahead + NumberBFrames + 2.
+*
+*************************************************************************************
+*/
+
+#include <math.h>
+
+#include "global.h"
+#include "lookahead.h"
+#include "input.h"
+#include "img_io.h"
+#include "memalloc.h"
+#include "me_ads.h"
+#include "me_distortion.h"
+
+#define LOOKAHEAD_BLOCK       8   //!< block size of the analysis, downscaled pels
+#define LOOKAHEAD_PAD        32   //!< padding of the downscaled frames
+#define LOOKAHEAD_LAMBDA      2   //!< lambda of the MV rate, per bit
+#define LOOKAHEAD_B_INTRA    10   //!< a frame with more intra blocks (percent) ends a run of B frames
+#define LOOKAHEAD_RATE_SCALE 1.4  //!< bits of a frame ~ LOOKAHEAD_RATE_SCALE * cost / Qstep
+
+//! Analysis of display order frame f
+static inline LookaheadFrame *lookahead_frame (Lookahead *la, int f)
+{
+  return &la->ring[f % la->ring_size];
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Reads frame f and scales its luma down 2:1 into the ring
+ * \return
+ *    0 if the input ends before frame f
+ ***********************************************************************
+ */
+static int lookahead_read (Lookahead *la, int f)
+{
+  VideoParameters *p_Vid = &la->vid;
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  imgpel **lowres = lookahead_frame(la, f)->lowres;
+  int x, y;
+
+  if (!read_one_frame(p_Vid, &la->input, (1 + p_Inp->frame_skip) * f, p_Inp->infile_header, &p_Inp->source, &p_Inp->output, la->frame))
+    return 0;
+  pad_borders(p_Inp->output, p_Vid->width, p_Vid->height, p_Vid->width_cr, p_Vid->height_cr, la->frame);
+
+  for (y = 0; y < la->height; ++y)
+  {
+    imgpel *src0 = la->frame[0][2 * y];
+    imgpel *src1 = la->frame[0][2 * y + 1];
+
+    for (x = 0; x < la->width; ++x)
+      lowres[y][x] = (imgpel) ((src0[2 * x] + src0[2 * x + 1] + src1[2 * x] + src1[2 * x + 1] + 2) >> 2);
+  }
+
+  // pad the borders for the search
+  for (y = 0; y < la->height; ++y)
+  {
+    for (x = 1; x <= LOOKAHEAD_PAD; ++x)
+    {
+      lowres[y][-x] = lowres[y][0];
+      lowres[y][la->width - 1 + x] = lowres[y][la->width - 1];
+    }
+  }
+  for (y = 1; y <= LOOKAHEAD_PAD; ++y)
+  {
+    memcpy(&lowres[-y][-LOOKAHEAD_PAD], &lowres[0][-LOOKAHEAD_PAD], (la->width + 2 * LOOKAHEAD_PAD) * sizeof(imgpel));
+    memcpy(&lowres[la->height - 1 + y][-LOOKAHEAD_PAD], &lowres[la->height - 1][-LOOKAHEAD_PAD], (la->width + 2 * LOOKAHEAD_PAD) * sizeof(imgpel));
+  }
+
+  return 1;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Intra cost of the block at (x0, y0): SATD of the best of the DC,
+ *    vertical and horizontal predictions from the source pels around it
+ ***********************************************************************
+ */
+static int lookahead_intra_cost (Lookahead *la, imgpel **p, int x0, int y0)
+{
+  short diff[LOOKAHEAD_BLOCK * LOOKAHEAD_BLOCK];
+  int dc = 0, n = 0, best, x, y;
+
+  if (y0 > 0)
+  {
+    for (x = 0; x < LOOKAHEAD_BLOCK; ++x)
+      dc += p[y0 - 1][x0 + x];
+    n += LOOKAHEAD_BLOCK;
+  }
+  if (x0 > 0)
+  {
+    for (y = 0; y < LOOKAHEAD_BLOCK; ++y)
+      dc += p[y0 + y][x0 - 1];
+    n += LOOKAHEAD_BLOCK;
+  }
+  dc = n ? (dc + (n >> 1)) / n : (int) la->vid.dc_pred_value_comp[0];
+
+  for (y = 0; y < LOOKAHEAD_BLOCK; ++y)
+    for (x = 0; x < LOOKAHEAD_BLOCK; ++x)
+      diff[y * LOOKAHEAD_BLOCK + x] = (short) (p[y0 + y][x0 + x] - dc);
+  best = HadamardSAD8x8(diff);
+
+  if (y0 > 0)
+  {
+    for (y = 0; y < LOOKAHEAD_BLOCK; ++y)
+      for (x = 0; x < LOOKAHEAD_BLOCK; ++x)
+        diff[y * LOOKAHEAD_BLOCK + x] = (short) (p[y0 + y][x0 + x] - p[y0 - 1][x0 + x]);
+    best = imin(best, HadamardSAD8x8(diff));
+  }
+  if (x0 > 0)
+  {
+    for (y = 0; y < LOOKAHEAD_BLOCK; ++y)
+      for (x = 0; x < LOOKAHEAD_BLOCK; ++x)
+        diff[y * LOOKAHEAD_BLOCK + x] = (short) (p[y0 + y][x0 + x] - p[y0 + y][x0 - 1]);
+    best = imin(best, HadamardSAD8x8(diff));
+  }
+
+  return best;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Inter cost of block (bx, by) of cur predicted from prev. The ADS
+ *    search starts from the zero MV, the median predictor, the MV of the
+ *    block in the previous frame and those of the left and top blocks.
+ ***********************************************************************
+ */
+static int lookahead_inter_cost (Lookahead *la, LookaheadFrame *cur, LookaheadFrame *prev, int bx, int by)
+{
+  short diff[LOOKAHEAD_BLOCK * LOOKAHEAD_BLOCK];
+  int b = by * la->blk_width + bx;
+  MotionVector *mv = &cur->mv[b];
+  MotionVector cand[5], pred = {0, 0};
+  ADSPlaneBlock block;
+  int mcost, sad = 0, n = 0, x, y;
+
+  block.cur    = cur->lowres;
+  block.ref    = prev->lowres;
+  block.width  = la->width;
+  block.height = la->height;
+  block.pad    = LOOKAHEAD_PAD;
+  block.pos_x  = bx * LOOKAHEAD_BLOCK;
+  block.pos_y  = by * LOOKAHEAD_BLOCK;
+  block.size   = LOOKAHEAD_BLOCK;
+
+  if (bx > 0 && by > 0 && bx < la->blk_width - 1)
+  {
+    MotionVector *a = &cur->mv[b - 1];
+    MotionVector *t = &cur->mv[b - la->blk_width];
+    MotionVector *c = &cur->mv[b - la->blk_width + 1];
+
+    pred.mv_x = (short) imedian(a->mv_x, t->mv_x, c->mv_x);
+    pred.mv_y = (short) imedian(a->mv_y, t->mv_y, c->mv_y);
+  }
+  else if (bx > 0)
+    pred = cur->mv[b - 1];
+  else if (by > 0)
+    pred = cur->mv[b - la->blk_width];
+
+  cand[n].mv_x = cand[n].mv_y = 0;
+  ++n;
+  cand[n++] = pred;
+  if (prev->frame_no > 0)
+    cand[n++] = prev->mv[b];
+  if (bx > 0)
+    cand[n++] = cur->mv[b - 1];
+  if (by > 0)
+    cand[n++] = cur->mv[b - la->blk_width];
+
+  mcost = ADS_plane_search(&block, cand, n, &pred, la->range, LOOKAHEAD_LAMBDA, mv);
+
+  // SATD of the MV found, with the rate of its search cost
+  for (y = 0; y < LOOKAHEAD_BLOCK; ++y)
+  {
+    imgpel *c = &cur->lowres[block.pos_y + y][block.pos_x];
+    imgpel *r = &prev->lowres[block.pos_y + mv->mv_y + y][block.pos_x + mv->mv_x];
+
+    for (x = 0; x < LOOKAHEAD_BLOCK; ++x)
+    {
+      diff[y * LOOKAHEAD_BLOCK + x] = (short) (c[x] - r[x]);
+      sad += iabs(c[x] - r[x]);
+    }
+  }
+
+  return HadamardSAD8x8(diff) + mcost - sad;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Intra and inter costs, MVs and scene cut of frame f
+ ***********************************************************************
+ */
+static void lookahead_analyse_frame (Lookahead *la, int f)
+{
+  InputParameters *p_Inp = la->vid.p_Inp;
+  LookaheadFrame *cur  = lookahead_frame(la, f);
+  LookaheadFrame *prev = (f > 0) ? lookahead_frame(la, f - 1) : NULL;
+  int bx, by;
+
+  cur->frame_no     = f;
+  cur->intra_cost   = 0;
+  cur->inter_cost   = 0;
+  cur->intra_blocks = 0;
+
+  for (by = 0; by < la->blk_height; ++by)
+  {
+    for (bx = 0; bx < la->blk_width; ++bx)
+    {
+      int b = by * la->blk_width + bx;
+      int intra = lookahead_intra_cost(la, cur->lowres, bx * LOOKAHEAD_BLOCK, by * LOOKAHEAD_BLOCK);
+      int inter = intra;
+
+      cur->mv[b].mv_x = cur->mv[b].mv_y = 0;
+      if (prev)
+        inter = imin(intra, lookahead_inter_cost(la, cur, prev, bx, by));
+      if (inter == intra)
+        ++cur->intra_blocks;
+
+      cur->intra[b] = intra;
+      cur->inter[b] = inter;
+      cur->intra_cost += intra;
+      cur->inter_cost += inter;
+    }
+  }
+
+  cur->scene_cut = prev && p_Inp->SceneCutThreshold > 0
+    && cur->inter_cost * 100 >= (int64) (100 - p_Inp->SceneCutThreshold) * cur->intra_cost;
+}
+
+//! Adds amount to the propagation cost of block (bx, by) of frm, if inside the frame
+static inline void lookahead_add_propagate (Lookahead *la, LookaheadFrame *frm, int bx, int by, float amount)
+{
+  if (bx >= 0 && bx < la->blk_width && by >= 0 && by < la->blk_height)
+    frm->propagate[by * la->blk_width + bx] += amount;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Propagation costs of frame g over frames g + 1 .. last: from the
+ *    last frame back, the share (intra - inter) / intra of the cost of
+ *    each block and of what it propagates itself goes to the blocks of
+ *    the previous frame its MV points to, by overlap. Returns the sum of
+ *    the propagation costs of frame g.
+ ***********************************************************************
+ */
+static double lookahead_propagate (Lookahead *la, int g, int last)
+{
+  double sum = 0.0;
+  int f, bx, by;
+
+  for (f = g; f <= last; ++f)
+    memset(lookahead_frame(la, f)->propagate, 0, la->num_blocks * sizeof(float));
+
+  for (f = last; f > g; --f)
+  {
+    LookaheadFrame *cur = lookahead_frame(la, f);
+    LookaheadFrame *ref = lookahead_frame(la, f - 1);
+
+    for (by = 0; by < la->blk_height; ++by)
+    {
+      for (bx = 0; bx < la->blk_width; ++bx)
+      {
+        int b = by * la->blk_width + bx;
+        int intra = cur->intra[b];
+        int x, y, fx, fy;
+        float amount;
+
+        if (cur->inter[b] >= intra)
+          continue;
+        amount = (cur->propagate[b] + intra) * (float) (intra - cur->inter[b]) / (float) intra;
+
+        x  = bx * LOOKAHEAD_BLOCK + cur->mv[b].mv_x;
+        y  = by * LOOKAHEAD_BLOCK + cur->mv[b].mv_y;
+        fx = x & (LOOKAHEAD_BLOCK - 1);
+        fy = y & (LOOKAHEAD_BLOCK - 1);
+        x >>= 3;
+        y >>= 3;
+        amount /= (float) (LOOKAHEAD_BLOCK * LOOKAHEAD_BLOCK);
+        lookahead_add_propagate(la, ref, x,     y,     amount * (LOOKAHEAD_BLOCK - fx) * (LOOKAHEAD_BLOCK - fy));
+        lookahead_add_propagate(la, ref, x + 1, y,     amount * fx * (LOOKAHEAD_BLOCK - fy));
+        lookahead_add_propagate(la, ref, x,     y + 1, amount * (LOOKAHEAD_BLOCK - fx) * fy);
+        lookahead_add_propagate(la, ref, x + 1, y + 1, amount * fx * fy);
+      }
+    }
+  }
+
+  for (f = 0; f < la->num_blocks; ++f)
+    sum += lookahead_frame(la, g)->propagate[f];
+  return sum;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Job of the lookahead worker: analyses the frames in display order,
+ *    at most up to frames_wanted
+ ***********************************************************************
+ */
+static void lookahead_run (void *arg, int thread)
+{
+  Lookahead *la = (Lookahead *) arg;
+  double propagate;
+  int f, g, last;
+
+  (void) thread;
+  for (f = 0; ; ++f)
+  {
+    lock_thread_pool(la->pool);
+    while (f > la->frames_wanted && f < la->num_frames && !la->quit)
+      wait_thread_pool(la->pool);
+    if (f >= la->num_frames || la->quit)
+    {
+      unlock_thread_pool(la->pool);
+      break;
+    }
+    unlock_thread_pool(la->pool);
+
+    if (!lookahead_read(la, f))
+    {
+      lock_thread_pool(la->pool);
+      la->num_frames = f;
+      signal_thread_pool(la->pool);
+      unlock_thread_pool(la->pool);
+      break;
+    }
+    lookahead_analyse_frame(la, f);
+    if (f < la->depth)
+    {
+      la->first_cost += f ? lookahead_frame(la, f)->inter_cost : lookahead_frame(la, f)->intra_cost;
+      ++la->first_frames;
+    }
+    propagate = (f >= la->depth) ? lookahead_propagate(la, f - la->depth, f) : 0.0;
+
+    lock_thread_pool(la->pool);
+    la->frames_done = f + 1;
+    la->stats.frames = f + 1;
+    la->stats.scene_cuts += lookahead_frame(la, f)->scene_cut;
+    if (f >= la->depth)
+    {
+      la->stats.propagate += propagate;
+      la->stats.intra     += (double) lookahead_frame(la, f - la->depth)->intra_cost;
+    }
+    signal_thread_pool(la->pool);
+    unlock_thread_pool(la->pool);
+  }
+
+  // the last frames propagate over what is left of the sequence
+  lock_thread_pool(la->pool);
+  last = la->quit ? -1 : la->frames_done - 1;
+  unlock_thread_pool(la->pool);
+  for (g = imax(0, last - la->depth + 1); g < last; ++g)
+  {
+    propagate = lookahead_propagate(la, g, last);
+    lock_thread_pool(la->pool);
+    la->stats.propagate += propagate;
+    la->stats.intra     += (double) lookahead_frame(la, g)->intra_cost;
+    unlock_thread_pool(la->pool);
+  }
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Lets the worker analyse up to Lookahead frames past frame last and
+ *    waits, with the pool locked, until frame last is analysed or the
+ *    input ended
+ ***********************************************************************
+ */
+static void lookahead_wait (Lookahead *la, int last)
+{
+  if (la->frames_wanted < last + la->depth)
+  {
+    la->frames_wanted = last + la->depth;
+    signal_thread_pool(la->pool);
+  }
+  while (la->frames_done <= last && la->frames_done < la->num_frames)
+    wait_thread_pool(la->pool);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Starts the lookahead worker. Returns the number of bytes allocated.
+ ***********************************************************************
+ */
+int LookaheadInit (VideoParameters *p_Vid)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  Lookahead *la;
+  int memory_size = sizeof(Lookahead);
+  int i;
+
+  if ((la = (Lookahead *) calloc(1, sizeof(Lookahead))) == NULL)
+    no_mem_exit("LookaheadInit: la");
+
+  la->depth         = p_Inp->Lookahead;
+  la->width         = p_Vid->width  >> 1;
+  la->height        = p_Vid->height >> 1;
+  la->blk_width     = la->width  / LOOKAHEAD_BLOCK;
+  la->blk_height    = la->height / LOOKAHEAD_BLOCK;
+  la->num_blocks    = la->blk_width * la->blk_height;
+  la->range         = imax(p_Inp->search_range[0] >> 1, 4);
+  la->num_frames    = p_Inp->no_frames;
+  la->frames_wanted = la->depth;
+  la->ring_size     = la->depth + p_Inp->NumberBFrames + 2;
+  la->stats.initial_qp = -1;
+
+  // the input is read with its own file handle and buffers
+  la->vid      = *p_Vid;
+  la->vid.buf  = NULL;
+  la->vid.ibuf = NULL;
+  AllocateFrameMemory(&la->vid, p_Inp, &p_Inp->source);
+  la->input = p_Inp->input_file1;
+  OpenFiles(&la->input);
+
+  memory_size += get_mem2Dpel(&la->frame[0], p_Vid->height, p_Vid->width);
+  if (p_Vid->yuv_format != YUV400)
+  {
+    memory_size += get_mem2Dpel(&la->frame[1], p_Vid->height_cr, p_Vid->width_cr);
+    memory_size += get_mem2Dpel(&la->frame[2], p_Vid->height_cr, p_Vid->width_cr);
+  }
+
+  if ((la->ring = (LookaheadFrame *) calloc(la->ring_size, sizeof(LookaheadFrame))) == NULL)
+    no_mem_exit("LookaheadInit: la->ring");
+  for (i = 0; i < la->ring_size; ++i)
+  {
+    LookaheadFrame *frm = &la->ring[i];
+
+    memory_size += get_mem2Dpel_pad(&frm->lowres, la->height, la->width, LOOKAHEAD_PAD, LOOKAHEAD_PAD);
+    if ((frm->intra = (int *) calloc(la->num_blocks, sizeof(int))) == NULL)
+      no_mem_exit("LookaheadInit: frm->intra");
+    if ((frm->inter = (int *) calloc(la->num_blocks, sizeof(int))) == NULL)
+      no_mem_exit("LookaheadInit: frm->inter");
+    if ((frm->mv = (MotionVector *) calloc(la->num_blocks, sizeof(MotionVector))) == NULL)
+      no_mem_exit("LookaheadInit: frm->mv");
+    if ((frm->propagate = (float *) calloc(la->num_blocks, sizeof(float))) == NULL)
+      no_mem_exit("LookaheadInit: frm->propagate");
+    memory_size += la->num_blocks * (2 * sizeof(int) + sizeof(MotionVector) + sizeof(float));
+    frm->frame_no = -1;
+  }
+
+  la->pool = create_thread_pool(2);
+  start_thread_pool(la->pool, lookahead_run, la);
+  p_Vid->p_Lookahead = la;
+
+  return memory_size;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Stops the lookahead worker and frees its memory
+ ***********************************************************************
+ */
+void LookaheadDelete (VideoParameters *p_Vid)
+{
+  Lookahead *la = p_Vid->p_Lookahead;
+  int i;
+
+  if (la == NULL)
+    return;
+
+  lock_thread_pool(la->pool);
+  la->quit = 1;
+  signal_thread_pool(la->pool);
+  unlock_thread_pool(la->pool);
+  finish_thread_pool(la->pool);
+  free_thread_pool(la->pool);
+
+  CloseFiles(&la->input);
+  DeleteFrameMemory(&la->vid);
+  free_mem2Dpel(la->frame[0]);
+  if (la->frame[1])
+  {
+    free_mem2Dpel(la->frame[1]);
+    free_mem2Dpel(la->frame[2]);
+  }
+  for (i = 0; i < la->ring_size; ++i)
+  {
+    free_mem2Dpel_pad(la->ring[i].lowres, LOOKAHEAD_PAD, LOOKAHEAD_PAD);
+    free(la->ring[i].intra);
+    free(la->ring[i].inter);
+    free(la->ring[i].mv);
+    free(la->ring[i].propagate);
+  }
+  free(la->ring);
+  free(la);
+  p_Vid->p_Lookahead = NULL;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Number of B frames, at most max_b, to code before the anchor of the
+ *    prediction structure starting at display order frame first. The run
+ *    ends before a scene cut and, with AdaptiveBFrames, before a frame
+ *    with more than LOOKAHEAD_B_INTRA percent of intra blocks.
+ ***********************************************************************
+ */
+int LookaheadBFrames (VideoParameters *p_Vid, int first, int max_b)
+{
+  Lookahead *la = p_Vid->p_Lookahead;
+  int b_frames = max_b;
+  int last, d;
+
+  lock_thread_pool(la->pool);
+  last = imin(first + max_b, la->num_frames - 1);
+  lookahead_wait(la, last);
+  for (d = first; d <= imin(last, la->frames_done - 1); ++d)
+  {
+    LookaheadFrame *frm = lookahead_frame(la, d);
+
+    if (frm->frame_no != d)
+      break;
+    if (frm->scene_cut || (p_Vid->p_Inp->AdaptiveBFrames && frm->intra_blocks * 100 > la->num_blocks * LOOKAHEAD_B_INTRA))
+    {
+      b_frames = imin(d - first, max_b);
+      break;
+    }
+  }
+  la->stats.runs++;
+  la->stats.b_frames += b_frames;
+  if (b_frames < max_b)
+    la->stats.runs_shortened++;
+  unlock_thread_pool(la->pool);
+
+  return b_frames;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    TRUE if display order frame frame_no is a scene cut, which is then
+ *    coded as an I frame
+ ***********************************************************************
+ */
+int LookaheadSceneCut (VideoParameters *p_Vid, int frame_no)
+{
+  Lookahead *la = p_Vid->p_Lookahead;
+  int scene_cut = 0;
+
+  lock_thread_pool(la->pool);
+  lookahead_wait(la, imin(frame_no, la->num_frames - 1));
+  if (frame_no < la->frames_done && lookahead_frame(la, frame_no)->frame_no == frame_no)
+    scene_cut = lookahead_frame(la, frame_no)->scene_cut;
+  la->stats.cuts_coded += scene_cut;
+  unlock_thread_pool(la->pool);
+
+  return scene_cut;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Initial QP of rate control: the QP whose Qstep brings the average
+ *    cost of the first Lookahead frames (the first intra, the others
+ *    predicted) to bit_rate / frame_rate bits per frame. Returns -1 when
+ *    nothing was analysed.
+ ***********************************************************************
+ */
+int LookaheadInitialQP (VideoParameters *p_Vid, double bit_rate, double frame_rate)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  Lookahead *la = p_Vid->p_Lookahead;
+  double cost, qstep;
+  int qp;
+
+  lock_thread_pool(la->pool);
+  while (la->frames_done < imin(la->depth, la->num_frames))
+    wait_thread_pool(la->pool);
+  unlock_thread_pool(la->pool);
+
+  if (la->first_frames == 0 || la->first_cost == 0 || bit_rate <= 0.0)
+    return -1;
+
+  cost  = (double) la->first_cost / la->first_frames;
+  qstep = LOOKAHEAD_RATE_SCALE * cost * frame_rate / bit_rate;
+  qp    = (int) floor(6.0 * log(qstep / 0.625) / log(2.0) + 0.5);
+  qp    = iClip3(imax(p_Inp->RCMinQP[I_SLICE], -p_Vid->bitdepth_luma_qp_scale), p_Inp->RCMaxQP[I_SLICE], qp);
+
+  lock_thread_pool(la->pool);
+  la->stats.initial_qp = qp;
+  unlock_thread_pool(la->pool);
+
+  return qp;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Copies the lookahead statistics (the worker may still be running)
+ ***********************************************************************
+ */
+void LookaheadGetStats (VideoParameters *p_Vid, LookaheadStats *stats)
+{
+  Lookahead *la = p_Vid->p_Lookahead;
+
+  lock_thread_pool(la->pool);
+  *stats = la->stats;
+  unlock_thread_pool(la->pool);
+}
@@ -24,6 +24,7 @@
 #include "image.h"
 #include "mb_access.h"
 #include "loop_filter.h"
+#include "thread_pool.h"
 
 extern void set_loop_filter_functions_mbaff (VideoParameters *p_Vid);
 extern void set_loop_filter_functions_normal(VideoParameters *p_Vid);
@@ -53,62 +54,115 @@ static void  init_Deblock(VideoParameters *p_Vid)
   }
 }
 
-#if (JM_PARALLEL_DEBLOCK == 0)
+//! Macroblock rows of a picture deblocked by the threads of a pool
+typedef struct deblock_rows
+{
+  VideoParameters *p_Vid;
+  imgpel         **imgY;
+  imgpel        ***imgUV;
+  int              width;       //!< macroblocks (macroblock pairs in MB-AFF) per row
+  int              height;      //!< rows
+  int              pairs;       //!< 1: MB-AFF, the rows are macroblock pair rows
+  int              next_row;    //!< first row no thread has taken yet
+  int             *mbs_done;    //!< macroblocks (pairs) deblocked in each row
+} DeblockRows;
+
 /*!
  *****************************************************************************************
  * \brief
- *    Filter all macroblocks in order of increasing macroblock address.
+ *    Deblocks the rows taken by one thread of the pool. Macroblock (x, y)
+ *    is filtered once (x + 1, y - 1) is: the top edge of (x, y) is filtered
+ *    after the left edge of (x + 1, y - 1), which changes the samples of
+ *    (x, y - 1) next to it, as in raster order.
  *****************************************************************************************
  */
-void DeblockFrame(VideoParameters *p_Vid, imgpel **imgY, imgpel ***imgUV)
+static void deblock_rows(void *arg, int thread)
 {
-  unsigned int i;
-  init_Deblock(p_Vid);
-  for (i=0; i < p_Vid->PicSizeInMbs; i++)
-  {
-    DeblockMb( p_Vid, imgY, imgUV, i ) ;
-  }
-}
-#else
-static void DeblockParallel(VideoParameters *p_Vid, imgpel **imgY, imgpel ***imgUV, unsigned int column, int block, int n_last)
-{
-  int i, j;
-  
-  for (j = 0; j < GROUP_SIZE; j++)
+  DeblockRows *p_rows = (DeblockRows *) arg;
+  VideoParameters *p_Vid = p_rows->p_Vid;
+  ThreadPool *pool = p_Vid->p_DeblockThreads;
+  int width = p_rows->width;
+
+  for (;;)
   {
-    i = block++ * (p_Vid->PicWidthInMbs - 2) + column;
+    int row, x;
+    int above = 0;
 
-    DeblockMb( p_Vid, imgY, imgUV, i ) ;
-    if (block == n_last) break;
+    lock_thread_pool(pool);
+    row = p_rows->next_row++;
+    unlock_thread_pool(pool);
+    if (row >= p_rows->height)
+      break;
+
+    for (x = 0; x < width; ++x)
+    {
+      int mb = row * width + x;
+      int needed = imin(x + 2, width);
+
+      if (row > 0 && above < needed)
+      {
+        lock_thread_pool(pool);
+        while ((above = p_rows->mbs_done[row - 1]) < needed)
+          wait_thread_pool(pool);
+        unlock_thread_pool(pool);
+      }
+
+      if (p_rows->pairs)
+      {
+        DeblockMb(p_Vid, p_rows->imgY, p_rows->imgUV, 2 * mb);
+        DeblockMb(p_Vid, p_rows->imgY, p_rows->imgUV, 2 * mb + 1);
+      }
+      else
+        DeblockMb(p_Vid, p_rows->imgY, p_rows->imgUV, mb);
+
+      lock_thread_pool(pool);
+      p_rows->mbs_done[row] = x + 1;
+      signal_thread_pool(pool);
+      unlock_thread_pool(pool);
+    }
   }
 }
 
 /*!
  *****************************************************************************************
  * \brief
- *    Filter all macroblocks in a diagonal manner to enable parallelization.
+ *    Filter all macroblocks of a picture. With DeblockThreads > 1 the
+ *    macroblock (pair) rows are filtered concurrently by the threads of
+ *    p_Vid->p_DeblockThreads, each row two macroblocks behind the row
+ *    above; otherwise, or when the pool is busy with another picture,
+ *    in order of increasing macroblock address.
  *****************************************************************************************
  */
 void DeblockFrame(VideoParameters *p_Vid, imgpel **imgY, imgpel ***imgUV)
 {
-  int iheightMBs =(p_Vid->PicSizeInMbs/p_Vid->PicWidthInMbs);
-  unsigned int i, k = p_Vid->PicWidthInMbs + 2 * (iheightMBs - 1);
+  unsigned int i;
   init_Deblock(p_Vid);
 
-  for (i = 0; i < k; i++)
+  if (p_Vid->p_DeblockThreads != NULL)
   {
-    int nn;    
-    int n_last = imin(iheightMBs, (i >> 1) + 1);
-    int n_start = (i < p_Vid->PicWidthInMbs) ? 0 : ((i - p_Vid->PicWidthInMbs) >> 1) + 1;
-
-#if defined(OPENMP)
-#pragma omp parallel for
-#endif
-    for (nn = n_start; nn < n_last; nn += GROUP_SIZE)
-      DeblockParallel(p_Vid, imgY, imgUV, i, nn, n_last);
+    DeblockRows rows;
+
+    rows.p_Vid    = p_Vid;
+    rows.imgY     = imgY;
+    rows.imgUV    = imgUV;
+    rows.pairs    = p_Vid->mb_aff_frame_flag;
+    rows.width    = p_Vid->PicWidthInMbs;
+    rows.height   = p_Vid->PicSizeInMbs / (p_Vid->PicWidthInMbs << rows.pairs);
+    rows.next_row = 0;
+    if ((rows.mbs_done = (int *) calloc(rows.height, sizeof(int))) == NULL)
+      no_mem_exit("DeblockFrame: rows.mbs_done");
+
+    i = run_thread_pool(p_Vid->p_DeblockThreads, deblock_rows, &rows);
+    free(rows.mbs_done);
+    if (i)
+      return;
+  }
+
+  for (i=0; i < p_Vid->PicSizeInMbs; i++)
+  {
+    DeblockMb( p_Vid, imgY, imgUV, i ) ;
   }
 }
-#endif
 
 /*!
  *****************************************************************************************
@@ -132,7 +186,7 @@ static void DeblockMb(VideoParameters *p_Vid, imgpel **imgY, imgpel ***imgUV, in
   Slice  *currSlice = MbQ->p_Slice;
   int           mvlimit = (p_Vid->structure!=FRAME) || (p_Vid->mb_aff_frame_flag && MbQ->mb_field) ? 2 : 4;
   seq_parameter_set_rbsp_t *active_sps = p_Vid->active_sps;
-  p_Vid->mixedModeEdgeFlag = 0;
+  MbQ->mixedModeEdgeFlag = 0;
 
   // return, if filter is disabled
   if (MbQ->DFDisableIdc == 1) 
@@ -262,7 +316,7 @@ static void DeblockMb(VideoParameters *p_Vid, imgpel **imgY, imgpel ***imgUV, in
         }
       }
 
-      if (!edge && !MbQ->mb_field && p_Vid->mixedModeEdgeFlag) 
+      if (!edge && !MbQ->mb_field && MbQ->mixedModeEdgeFlag) 
       {
         // this is the extra horizontal edge between a frame macroblock pair and a field above it
         MbQ->DeblockCall = 2;
@@ -74,7 +74,7 @@ static void get_strength_ver_MBAff(byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ
     blkP = (short) ((pixP.y & 0xFFFC) + (pixP.x >> 2));
 
     MbP = &(p_Vid->mb_data[pixP.mb_addr]);
-    p_Vid->mixedModeEdgeFlag = (byte) (MbQ->mb_field != MbP->mb_field);   
+    MbQ->mixedModeEdgeFlag = (byte) (MbQ->mb_field != MbP->mb_field);   
 
     if (p_Vid->type==SP_SLICE || p_Vid->type==SI_SLICE)
     {
@@ -95,7 +95,7 @@ static void get_strength_ver_MBAff(byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ
           // if no coefs, but vector difference >= 1 set Strength=1
           // if this is a mixed mode edge then one set of reference pictures will be frame and the
           // other will be field
-          if (p_Vid->mixedModeEdgeFlag)
+          if (MbQ->mixedModeEdgeFlag)
           {
             (Strength[idx] = 1);
           }
@@ -189,7 +189,7 @@ static void get_strength_hor_MBAff(byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ
     blkP = (short) ((pixP.y & 0xFFFC) + (pixP.x >> 2));
 
     MbP = &(p_Vid->mb_data[pixP.mb_addr]);
-    p_Vid->mixedModeEdgeFlag = (byte) (MbQ->mb_field != MbP->mb_field);   
+    MbQ->mixedModeEdgeFlag = (byte) (MbQ->mb_field != MbP->mb_field);   
 
     if (p_Vid->type==SP_SLICE || p_Vid->type==SI_SLICE)
     {
@@ -212,7 +212,7 @@ static void get_strength_hor_MBAff(byte Strength[MB_BLOCK_SIZE], Macroblock *MbQ
           // if no coefs, but vector difference >= 1 set Strength=1
           // if this is a mixed mode edge then one set of reference pictures will be frame and the
           // other will be field
-          if (p_Vid->mixedModeEdgeFlag)
+          if (MbQ->mixedModeEdgeFlag)
           {
             (Strength[idx] = 1);
           }
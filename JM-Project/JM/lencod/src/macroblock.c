@@ -160,7 +160,7 @@ void next_macroblock(Macroblock *currMB)
   int slice_type = currSlice->slice_type;
   BitCounter *mbBits = &currMB->bits;
   int i;
-  StatParameters *cur_stats = &p_Vid->enc_picture->stats;
+  StatParameters *cur_stats = currSlice->cur_stats;
 
   if (mbBits->mb_total > p_Vid->max_bitCount)
     printf("Warning!!! Number of bits (%d) of macroblock_layer() data seems to exceed defined limit (%d).\n", mbBits->mb_total,p_Vid->max_bitCount);
@@ -432,7 +432,8 @@ void start_macroblock(Slice *currSlice, Macroblock **currMB, int mb_addr, Boolea
     mb_qp = p_Vid->qp;
   }
 
-  last_coded_mb = *currMB;   // save the address of the last coded MB
+  if (p_Inp->RCEnable)
+    last_coded_mb = *currMB;   // save the address of the last coded MB
   
   if ((*currMB)->mbAddrX == 0)
     p_Vid->BasicUnitQP = mb_qp;
@@ -2702,7 +2703,8 @@ void write_terminating_bit (Slice *currSlice, int bit)
 
   biari_encode_symbol_final(&(dataPart->ee_cabac), bit);
 #if TRACE
-  fprintf (p_Enc->p_trace, "      CABAC terminating bit = %d\n",bit);
+  if (p_Enc->p_trace != NULL)
+    fprintf (p_Enc->p_trace, "      CABAC terminating bit = %d\n",bit);
 #endif
 }
 
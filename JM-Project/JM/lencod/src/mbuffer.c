@@ -25,6 +25,7 @@
 #include "nalucommon.h"
 #include "img_luma.h"
 #include "img_chroma.h"
+#include "img_luma_tile.h"
 #include "errdo.h"
 #include "me_hme.h"
 
@@ -385,59 +386,29 @@ void alloc_pic_motion(PicMotionParamsOld *motion, int size_y, int size_x)
 /*!
  ************************************************************************
  * \brief
- *    Allocate memory for a stored picture.
- *
- * \param p_Vid
- *    VideoParameters
- * \param structure
- *    picture structure
- * \param size_x
- *    horizontal luma size
- * \param size_y
- *    vertical luma size
- * \param size_x_cr
- *    horizontal chroma size
- * \param size_y_cr
- *    vertical chroma size
- *
- * \return
- *    the allocated StorablePicture structure
+ *    Allocates the planes and the motion info of a stored picture,
+ *    with the sub-pel planes if sub_pel
  ************************************************************************
  */
-StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure structure, int size_x, int size_y, int size_x_cr, int size_y_cr)
+static void alloc_picture_buffers(VideoParameters *p_Vid, StorablePicture *s, int sub_pel, int size_x, int size_y, int size_x_cr, int size_y_cr)
 {
-  StorablePicture *s;
-  int   nplane;
   InputParameters *p_Inp = p_Vid->p_Inp;
+  int   nplane;
 
-  //printf ("Allocating (%s) picture (x=%d, y=%d, x_cr=%d, y_cr=%d)\n", (type == FRAME)?"FRAME":(type == TOP_FIELD)?"TOP_FIELD":"BOTTOM_FIELD", size_x, size_y, size_x_cr, size_y_cr);
-
-  s = calloc (1, sizeof(StorablePicture));
-  if (NULL==s)
-    no_mem_exit("alloc_storable_picture: s");
-
-  s->imgY       = NULL;
-  s->imgUV      = NULL;
-  s->imgY_sub   = NULL;
-  s->imgUV_sub  = NULL;
-  
-  s->p_img_sub[0] = NULL;
-  s->p_img_sub[1] = NULL;
-  s->p_img_sub[2] = NULL;
-
-  s->de_mem = NULL;
-  
-#if (MVC_EXTENSION_ENABLE)  
-  if ((p_Vid->nal_reference_idc != NALU_PRIORITY_DISPOSABLE) || ((p_Inp->num_of_views == 2) && p_Vid->view_id == 0)) //p_Vid->inter_view_flag[structure?structure-1: structure]))
-#else
-  if (p_Vid->nal_reference_idc != NALU_PRIORITY_DISPOSABLE)
-#endif
+  if (sub_pel)
   {
     if (!p_Inp->OnTheFlyFractMCP) // JLT : on-the-fly flag
     {
       get_mem4Dpel_pad(&(s->imgY_sub), 4, 4, size_y, size_x, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
       s->imgY = s->imgY_sub[0][0];
 
+      if (p_Inp->LazySubPelInterp)
+      {
+        int tiles = SUB_TILES(size_x + 2 * IMG_PAD_SIZE_X) * SUB_TILES(size_y + 2 * IMG_PAD_SIZE_Y);
+        if ((s->sub_tile_map = (byte *) calloc(tiles, sizeof(byte))) == NULL)
+          no_mem_exit("alloc_storable_picture: s->sub_tile_map");
+      }
+
       if ( p_Inp->ChromaMCBuffer || p_Vid->P444_joined || (p_Inp->yuv_format==YUV444 && !p_Vid->P444_joined))
       {
         // UV components
@@ -455,8 +426,6 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
           { // YUV444
             get_mem5Dpel_pad(&(s->imgUV_sub), 2, 4, 4, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
           }
-          s->p_img_sub[1] = s->imgUV_sub[0];
-          s->p_img_sub[2] = s->imgUV_sub[1];
           s->imgUV = (imgpel ***)malloc(2*sizeof(imgpel**));
           s->imgUV[0] = s->imgUV_sub[0][0][0];
           s->imgUV[1] = s->imgUV_sub[1][0][0];
@@ -489,8 +458,6 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
           { // YUV444
             get_mem5Dpel_pad(&(s->imgUV_sub), 2, 2, 2, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
           }
-          s->p_img_sub[1] = s->imgUV_sub[0];
-          s->p_img_sub[2] = s->imgUV_sub[1];
           s->imgUV = (imgpel ***)malloc(2*sizeof(imgpel**));
           s->imgUV[0] = s->imgUV_sub[0][0][0];
           s->imgUV[1] = s->imgUV_sub[1][0][0];
@@ -512,17 +479,6 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
     get_mem2Dpel_pad(&(s->imgY), size_y, size_x, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
     get_mem3Dpel_pad(&(s->imgUV), 2, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
   }  
-    
-  s->p_img[0] = s->imgY;
-  s->p_curr_img = s->p_img[0];    
-  s->p_curr_img_sub = s->p_img_sub[0];
-
-  if (p_Vid->yuv_format != YUV400)
-  {
-    //get_mem3Dpel (&(s->imgUV), 2, size_y_cr, size_x_cr);
-    s->p_img[1] = s->imgUV[0];
-    s->p_img[2] = s->imgUV[1];
-  }
 
   get_mem2Dmp (&s->mv_info, (size_y >> BLOCK_SHIFT), (size_x >> BLOCK_SHIFT));
   alloc_pic_motion(&s->motion, (size_y >> BLOCK_SHIFT), (size_x >> BLOCK_SHIFT));
@@ -535,6 +491,182 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
       alloc_pic_motion(&s->JVmotion[nplane], (size_y >> BLOCK_SHIFT), (size_x >> BLOCK_SHIFT));
     }
   }
+}
+
+//! Sets the view of a padded plane, or clears it if there is none
+static inline void set_pel_plane(PelPlane *plane, imgpel **img, int size_x, int pad_y, int pad_x)
+{
+  plane->base   = (img != NULL) ? img[0] : NULL;
+  plane->stride = size_x + 2 * pad_x;
+  plane->pad_y  = pad_y;
+  plane->pad_x  = pad_x;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Sets the views of the planes (p_img[]) and of the sub-pel planes
+ *    (imgY_sub, imgUV_sub) of a stored picture
+ ************************************************************************
+ */
+static void set_picture_planes(VideoParameters *p_Vid, StorablePicture *s)
+{
+  int otf_l1 = (p_Vid->p_Inp->OnTheFlyFractMCP == OTF_L1);
+  int pl, i, j, rows, cols;
+
+  memset(s->plane, 0, MAX_PLANE * sizeof(PelPlane));
+  memset(s->plane_sub, 0, MAX_PLANE * MAX_SUB_PLANES * sizeof(PelPlane));
+  for (pl = 0; pl < MAX_PLANE; pl++)
+  {
+    int size_x = (pl == PLANE_Y) ? s->size_x : s->size_x_cr;
+    int pad_y  = (pl == PLANE_Y) ? IMG_PAD_SIZE_Y : s->pad_size_uv_y;
+    int pad_x  = (pl == PLANE_Y) ? IMG_PAD_SIZE_X : s->pad_size_uv_x;
+    imgpel ****img_sub = (pl == PLANE_Y) ? s->imgY_sub : (s->imgUV_sub ? s->imgUV_sub[pl - 1] : NULL);
+
+    if (s->p_img[pl] != NULL)
+      set_pel_plane(&s->plane[pl], s->p_img[pl], size_x, pad_y, pad_x);
+    if (img_sub != NULL)
+    {
+      rows = ((pl == PLANE_Y) ? 4 : 4 * (s->size_y / s->size_y_cr)) >> otf_l1;
+      cols = ((pl == PLANE_Y) ? 4 : 4 * (s->size_x / s->size_x_cr)) >> otf_l1;
+      for (j = 0; j < rows; j++)
+        for (i = 0; i < cols; i++)
+          set_pel_plane(&s->plane_sub[pl][j * cols + i], img_sub[j][i], size_x, pad_y, pad_x);
+    }
+  }
+  s->p_curr_plane_sub = s->plane_sub[PLANE_Y];
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Takes from the picture pool a picture of this size, with the
+ *    sub-pel planes if sub_pel, or returns NULL if there is none.
+ *    Only the buffers of the picture are kept, cleared where a new
+ *    picture relies on calloc(): the motion info and the map of the
+ *    interpolated tiles. The planes are written before they are read.
+ ************************************************************************
+ */
+static StorablePicture *get_pooled_picture(PicPool *pool, int sub_pel, int size_x, int size_y, int size_x_cr, int size_y_cr)
+{
+  StorablePicture *s, b;
+  int blk_y = size_y >> BLOCK_SHIFT, blk_x = size_x >> BLOCK_SHIFT;
+  int i, nplane;
+
+  // most recently freed first
+  for (i = pool->size - 1; i >= 0; --i)
+  {
+    s = pool->pic[i];
+    if (s->size_x == size_x && s->size_y == size_y && s->size_x_cr == size_x_cr && s->size_y_cr == size_y_cr
+      && (s->imgY_sub != NULL) == (sub_pel != 0))
+      break;
+  }
+  if (i < 0)
+    return NULL;
+
+  for (--pool->size; i < pool->size; ++i)
+    pool->pic[i] = pool->pic[i + 1];
+  pool->reuses++;
+
+  b = *s;
+  memset(s, 0, sizeof(StorablePicture));
+  s->imgY         = b.imgY;
+  s->imgY_sub     = b.imgY_sub;
+  s->imgUV        = b.imgUV;
+  s->imgUV_sub    = b.imgUV_sub;
+  s->sub_tile_map = b.sub_tile_map;
+  s->mv_info      = b.mv_info;
+  s->motion       = b.motion;
+  for (nplane = 0; nplane < MAX_PLANE; nplane++)
+  {
+    s->JVmv_info[nplane] = b.JVmv_info[nplane];
+    s->JVmotion[nplane]  = b.JVmotion[nplane];
+  }
+
+  if (s->sub_tile_map)
+    memset(s->sub_tile_map, 0, SUB_TILES(size_x + 2 * IMG_PAD_SIZE_X) * SUB_TILES(size_y + 2 * IMG_PAD_SIZE_Y) * sizeof(byte));
+  memset(s->mv_info[0], 0, blk_y * blk_x * sizeof(PicMotionParams));
+  memset(s->motion.mb_field, 0, blk_y * blk_x * sizeof(byte));
+  for (nplane = 0; nplane < MAX_PLANE; nplane++)
+  {
+    if (s->JVmv_info[nplane])
+    {
+      memset(s->JVmv_info[nplane][0], 0, blk_y * blk_x * sizeof(PicMotionParams));
+      memset(s->JVmotion[nplane].mb_field, 0, blk_y * blk_x * sizeof(byte));
+    }
+  }
+
+  return s;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate memory for a stored picture.
+ *
+ * \param p_Vid
+ *    VideoParameters
+ * \param structure
+ *    picture structure
+ * \param size_x
+ *    horizontal luma size
+ * \param size_y
+ *    vertical luma size
+ * \param size_x_cr
+ *    horizontal chroma size
+ * \param size_y_cr
+ *    vertical chroma size
+ *
+ * \return
+ *    the allocated StorablePicture structure
+ ************************************************************************
+ */
+StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure structure, int size_x, int size_y, int size_x_cr, int size_y_cr)
+{
+  StorablePicture *s = NULL;
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  int   sub_pel;
+
+  //printf ("Allocating (%s) picture (x=%d, y=%d, x_cr=%d, y_cr=%d)\n", (type == FRAME)?"FRAME":(type == TOP_FIELD)?"TOP_FIELD":"BOTTOM_FIELD", size_x, size_y, size_x_cr, size_y_cr);
+
+#if (MVC_EXTENSION_ENABLE)  
+  sub_pel = (p_Vid->nal_reference_idc != NALU_PRIORITY_DISPOSABLE) || ((p_Inp->num_of_views == 2) && p_Vid->view_id == 0); //p_Vid->inter_view_flag[structure?structure-1: structure]))
+#else
+  sub_pel = (p_Vid->nal_reference_idc != NALU_PRIORITY_DISPOSABLE);
+#endif
+
+  if (p_Vid->p_PicPool != NULL)
+  {
+    p_Vid->p_PicPool->allocs++;
+    s = get_pooled_picture(p_Vid->p_PicPool, sub_pel && p_Inp->OnTheFlyFractMCP != OTF_L2, size_x, size_y, size_x_cr, size_y_cr);
+  }
+
+  if (s == NULL)
+  {
+    s = calloc (1, sizeof(StorablePicture));
+    if (NULL==s)
+      no_mem_exit("alloc_storable_picture: s");
+
+    alloc_picture_buffers(p_Vid, s, sub_pel, size_x, size_y, size_x_cr, size_y_cr);
+  }
+  s->pool = p_Vid->p_PicPool;
+
+  if (s->imgUV_sub)
+  {
+    s->p_img_sub[1] = s->imgUV_sub[0];
+    s->p_img_sub[2] = s->imgUV_sub[1];
+  }
+    
+  s->p_img[0] = s->imgY;
+  s->p_curr_img = s->p_img[0];    
+  s->p_curr_img_sub = s->p_img_sub[0];
+
+  if (p_Vid->yuv_format != YUV400)
+  {
+    //get_mem3Dpel (&(s->imgUV), 2, size_y_cr, size_x_cr);
+    s->p_img[1] = s->imgUV[0];
+    s->p_img[2] = s->imgUV[1];
+  }
 
   if (p_Inp->rdopt == 3) 
   {
@@ -569,6 +701,7 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
   s->size_y_cr_pad = (int) (size_y_cr - 1) + (p_Vid->pad_size_uv_y << 1) - (p_Vid->mb_cr_size_y) - p_Vid->pad_size_uv_y;
   s->pad_size_uv_x = p_Vid->pad_size_uv_x;
   s->pad_size_uv_y = p_Vid->pad_size_uv_y;
+  set_picture_planes(p_Vid, s);
 
   s->top_field    = NULL;
   s->bottom_field = NULL;
@@ -630,7 +763,8 @@ void free_pic_motion(PicMotionParamsOld *motion)
 
 static void free_frame_data_memory(StorablePicture *picture, int bFreeImage)
 {
-  if(picture)
+  // a picture of the pool keeps its buffers until it is reused
+  if(picture && (bFreeImage || !picture->pool))
   {
     if (picture->imgY_sub)
     {
@@ -657,6 +791,7 @@ static void free_frame_data_memory(StorablePicture *picture, int bFreeImage)
           {
             free_mem2Dpel_pad(picture->imgY_sub[k>>2][k&3], IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
             picture->imgY_sub[k>>2][k&3] = NULL;
+            picture->plane_sub[PLANE_Y][k].base = NULL;
           }
         }
       }
@@ -694,11 +829,13 @@ static void free_frame_data_memory(StorablePicture *picture, int bFreeImage)
           {
            free_mem2Dpel_pad(picture->imgUV_sub[0][j][i], picture->pad_size_uv_y, picture->pad_size_uv_x);
            picture->imgUV_sub[0][j][i] = NULL;
+           picture->plane_sub[PLANE_U][k].base = NULL;
           }
           if(picture->imgUV_sub[1][j][i])
           {
            free_mem2Dpel_pad(picture->imgUV_sub[1][j][i], picture->pad_size_uv_y, picture->pad_size_uv_x);
            picture->imgUV_sub[1][j][i] = NULL;
+           picture->plane_sub[PLANE_V][k].base = NULL;
           }
         }
       }
@@ -731,6 +868,18 @@ void free_storable_picture(VideoParameters *p_Vid, StorablePicture* p)
   if (p)
   {
     InputParameters *p_Inp = p_Vid->p_Inp;
+    PicPool *pool = p_Vid->p_PicPool;
+
+    // back to the pool, without the memory allocated again with the picture
+    if (pool != NULL && p->pool == pool && pool->size < PIC_POOL_SIZE)
+    {
+      if (p_Inp->rdopt == 3)
+        errdo_free_storable_picture(p);
+      if (p_Inp->HMEEnable)
+        FreeHMEMemory(&(p->pHmeImage), p_Vid, 1, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
+      pool->pic[pool->size++] = p;
+      return;
+    }
     
     if(p->imgY && !p->imgY_sub)
     {
@@ -745,6 +894,12 @@ void free_storable_picture(VideoParameters *p_Vid, StorablePicture* p)
     }
     
     free_frame_data_memory(p, 1);
+
+    if (p->sub_tile_map)
+    {
+      free(p->sub_tile_map);
+      p->sub_tile_map = NULL;
+    }
     
     if( (p_Inp->separate_colour_plane_flag != 0) )
     {
@@ -784,6 +939,43 @@ void free_storable_picture(VideoParameters *p_Vid, StorablePicture* p)
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Creates the picture pool (PicturePool): the pictures freed are kept
+ *    with their buffers for the next pictures of the same size and layout.
+ *    Returns the number of bytes allocated.
+ ************************************************************************
+ */
+int init_pic_pool(VideoParameters *p_Vid)
+{
+  if ((p_Vid->p_PicPool = (PicPool *) calloc(1, sizeof(PicPool))) == NULL)
+    no_mem_exit("init_pic_pool: p_Vid->p_PicPool");
+
+  return sizeof(PicPool);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Frees the picture pool and the pictures in it
+ ************************************************************************
+ */
+void free_pic_pool(VideoParameters *p_Vid)
+{
+  PicPool *pool = p_Vid->p_PicPool;
+  int i;
+
+  if (pool == NULL)
+    return;
+
+  // the pictures freed from now on go back to the heap
+  p_Vid->p_PicPool = NULL;
+  for (i = 0; i < pool->size; ++i)
+    free_storable_picture(p_Vid, pool->pic[i]);
+  free(pool);
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -3267,6 +3459,7 @@ static void copy_storable_picture(VideoParameters *p_Vid, StorablePicture *s, St
   }
 
   d->p_curr_img_sub = d->p_img_sub[0];
+  d->p_curr_plane_sub = d->plane_sub[0];
   for (j = 0; j < (size_y >> BLOCK_SHIFT); j++)
   {
     for (i = 0; i < (size_x >> BLOCK_SHIFT); i++)
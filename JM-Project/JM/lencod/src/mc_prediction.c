@@ -25,6 +25,7 @@
 #include "macroblock.h"
 #include "mc_prediction.h"
 #include "refbuf.h"
+#include "img_luma_tile.h"
 #include "image.h"
 #include "mb_access.h"
 #include "me_distortion.h"
@@ -124,7 +125,10 @@ static inline void OneComponentLumaPrediction ( VideoParameters *p_Vid, //!< vid
                                                )
 {
   int     j;
-  imgpel *ref_line = UMVLine4X (list, pic_pix_y, pic_pix_x);
+  imgpel *ref_line;
+
+  LazySubPelBlock(p_Vid, list, pic_pix_y, pic_pix_x, block_size_x, block_size_y);
+  ref_line = UMVLine4X (list, pic_pix_y, pic_pix_x);
 
   for (j = 0; j < block_size_y; j++) 
   {
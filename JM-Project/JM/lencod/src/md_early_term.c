@@ -0,0 +1,288 @@
+
+/*!
+*************************************************************************************
+* \file md_early_term.c
+*
+* \brief
+*    Adaptive early termination of the mode decision (EarlyTermination > 0).
+*
+*    Three searches of encode_one_macroblock_high and _low can be skipped,
+*    each selected by a bit of EarlyTermination:
+*
+*    - 1: the 8x8 sub-partitions, when the best 16x16, 16x8 or 8x16 cost
+*         per pel is low;
+*    - 2: the intra modes of inter slices, when the best inter cost is low
+*         against the activity of the source macroblock;
+*    - 4: the references past the first of a 16x16, 16x8 or 8x16
+*         partition, when its cost per pel on the first is low.
+*
+*    "Low" is learned per QP from one macroblock in ET_TRAIN_PERIOD, which
+*    searches everything: the threshold is the lower of the running
+*    geometric mean of the measure of these macroblocks (so that a few
+*    outliers do not move it) and of the lowest measure at which
+*    the search that could have been skipped still gave the best result
+*    (a floor that drops at once and rises slowly). A search is skipped
+*    when the measure is below EarlyTerminationStrength percent of the
+*    threshold, once ET_MIN_SAMPLES samples of the QP are known.
+*
+*************************************************************************************
+*/
+
+#include <math.h>
+
+#include "global.h"
+#include "md_early_term.h"
+
+#define ET_TRAIN_PERIOD   8   //!< one training macroblock in ET_TRAIN_PERIOD
+#define ET_MIN_SAMPLES   16   //!< samples of a QP before its searches are skipped
+#define ET_WINDOW        64   //!< the mean and the floor follow about the last ET_WINDOW samples
+#define ET_LOG_BIAS    0.01   //!< added to the measures of the geometric mean, which may be 0
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Allocates the thresholds of all QPs. Returns the number of bytes
+ *    allocated.
+ ***********************************************************************
+ */
+int EarlyTermInit (VideoParameters *p_Vid)
+{
+  EarlyTerm *et;
+  int num_qp = MAX_QP + 1 + p_Vid->bitdepth_luma_qp_scale;
+  int d;
+
+  if ((et = (EarlyTerm *) calloc(1, sizeof(EarlyTerm))) == NULL)
+    no_mem_exit("EarlyTermInit: et");
+  et->qp_scale = p_Vid->bitdepth_luma_qp_scale;
+  for (d = 0; d < ET_DECISIONS; ++d)
+  {
+    if ((et->log_mean[d] = (double *) calloc(num_qp, sizeof(double))) == NULL)
+      no_mem_exit("EarlyTermInit: et->log_mean");
+    if ((et->low[d] = (double *) calloc(num_qp, sizeof(double))) == NULL)
+      no_mem_exit("EarlyTermInit: et->low");
+    if ((et->samples[d] = (int *) calloc(num_qp, sizeof(int))) == NULL)
+      no_mem_exit("EarlyTermInit: et->samples");
+    if ((et->wins[d] = (int *) calloc(num_qp, sizeof(int))) == NULL)
+      no_mem_exit("EarlyTermInit: et->wins");
+  }
+  p_Vid->p_EarlyTerm = et;
+
+  return sizeof(EarlyTerm) + ET_DECISIONS * num_qp * 2 * (sizeof(double) + sizeof(int));
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Frees the early termination state
+ ***********************************************************************
+ */
+void EarlyTermDelete (VideoParameters *p_Vid)
+{
+  EarlyTerm *et = p_Vid->p_EarlyTerm;
+  int d;
+
+  if (et == NULL)
+    return;
+  for (d = 0; d < ET_DECISIONS; ++d)
+  {
+    free(et->log_mean[d]);
+    free(et->low[d]);
+    free(et->samples[d]);
+    free(et->wins[d]);
+  }
+  free(et);
+  p_Vid->p_EarlyTerm = NULL;
+}
+
+//! Adds a sample of a training macroblock, won if the search that could have been skipped gave the best result
+static void early_term_learn (EarlyTerm *et, int decision, int qp, double measure, int won)
+{
+  int q = qp + et->qp_scale;
+  double *low = &et->low[decision][q];
+
+  et->log_mean[decision][q] += (log(measure + ET_LOG_BIAS) - et->log_mean[decision][q]) / (double) (imin(et->samples[decision][q], ET_WINDOW - 1) + 1);
+  et->samples[decision][q]++;
+  et->stats[decision].trained++;
+
+  if (won)
+  {
+    if (et->wins[decision][q] == 0 || measure < *low)
+      *low = measure;
+    else
+      *low += (measure - *low) / (double) ET_WINDOW;
+    et->wins[decision][q]++;
+    et->stats[decision].won++;
+  }
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    TRUE if decision is enabled and the search can be skipped at this
+ *    measure. Training macroblocks keep the measure for EarlyTermEndMB().
+ ***********************************************************************
+ */
+static int early_term_skip (Macroblock *currMB, int decision, double measure)
+{
+  InputParameters *p_Inp = currMB->p_Inp;
+  EarlyTerm *et = currMB->p_Vid->p_EarlyTerm;
+  int q = currMB->qp + et->qp_scale;
+  double threshold;
+
+  if (!et->active || !(p_Inp->EarlyTermination & (1 << decision)))
+    return FALSE;
+
+  if (et->train)
+  {
+    et->measure[decision] = measure;
+    return FALSE;
+  }
+
+  et->stats[decision].tested++;
+  if (et->samples[decision][q] < ET_MIN_SAMPLES)
+    return FALSE;
+  threshold = exp(et->log_mean[decision][q]) - ET_LOG_BIAS;
+  if (et->wins[decision][q])
+    threshold = dmin(threshold, et->low[decision][q]);
+  if (measure * 100.0 < threshold * p_Inp->EarlyTerminationStrength)
+  {
+    et->stats[decision].skipped++;
+    return TRUE;
+  }
+  return FALSE;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Starts the mode decision of a macroblock: every ET_TRAIN_PERIOD-th
+ *    macroblock, at a position moving with each picture, trains
+ ***********************************************************************
+ */
+void EarlyTermStartMB (Macroblock *currMB)
+{
+  EarlyTerm *et = currMB->p_Vid->p_EarlyTerm;
+  int d;
+
+  et->active = TRUE;
+  et->train  = ((currMB->mbAddrX + currMB->p_Vid->number) % ET_TRAIN_PERIOD) == 0;
+  for (d = 0; d < ET_DECISIONS; ++d)
+    et->measure[d] = -1.0;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Ends the mode decision of a macroblock: a training macroblock
+ *    learns from the mode chosen
+ ***********************************************************************
+ */
+void EarlyTermEndMB (Macroblock *currMB)
+{
+  EarlyTerm *et = currMB->p_Vid->p_EarlyTerm;
+  short best_mode = currMB->best_mode;
+
+  if (et->train)
+  {
+    if (et->measure[ET_P8X8] >= 0.0)
+      early_term_learn(et, ET_P8X8, currMB->qp, et->measure[ET_P8X8], best_mode == P8x8);
+    if (et->measure[ET_INTRA] >= 0.0)
+      early_term_learn(et, ET_INTRA, currMB->qp, et->measure[ET_INTRA],
+        best_mode == I4MB || best_mode == I8MB || best_mode == I16MB || best_mode == IPCM);
+  }
+  et->active = FALSE;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    TRUE if the 8x8 sub-partitions need not be searched, cost being
+ *    the best 16x16, 16x8 or 8x16 cost
+ ***********************************************************************
+ */
+int EarlyTermSkipP8x8 (Macroblock *currMB, distblk cost)
+{
+  if (cost == DISTBLK_MAX)
+    return FALSE;
+  return early_term_skip(currMB, ET_P8X8, (double) dist_down(cost) / (double) (MB_BLOCK_SIZE * MB_BLOCK_SIZE));
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    TRUE if the intra modes need not be tested, cost being the best
+ *    inter cost. The measure is this cost over the activity of the
+ *    source macroblock: the lowest SAD of its mean and of its vertical
+ *    and horizontal predictions from the source pels around it (plus
+ *    MB_BLOCK_SIZE).
+ ***********************************************************************
+ */
+int EarlyTermSkipIntra (Macroblock *currMB, distblk cost)
+{
+  imgpel **cur_img = &currMB->p_Vid->pCurImg[currMB->opix_y];
+  int pix_x = currMB->pix_x;
+  int sum = 0, activity = 0, sad_v = 0, sad_h = 0, mean, i, j;
+
+  if (cost == DISTBLK_MAX)
+    return FALSE;
+
+  for (j = 0; j < MB_BLOCK_SIZE; ++j)
+    for (i = 0; i < MB_BLOCK_SIZE; ++i)
+      sum += cur_img[j][pix_x + i];
+  mean = (sum + (MB_PIXELS >> 1)) / MB_PIXELS;
+  for (j = 0; j < MB_BLOCK_SIZE; ++j)
+    for (i = 0; i < MB_BLOCK_SIZE; ++i)
+      activity += iabs(cur_img[j][pix_x + i] - mean);
+
+  if (currMB->opix_y > 0)
+  {
+    for (j = 0; j < MB_BLOCK_SIZE; ++j)
+      for (i = 0; i < MB_BLOCK_SIZE; ++i)
+        sad_v += iabs(cur_img[j][pix_x + i] - cur_img[-1][pix_x + i]);
+    activity = imin(activity, sad_v);
+  }
+  if (pix_x > 0)
+  {
+    for (j = 0; j < MB_BLOCK_SIZE; ++j)
+      for (i = 0; i < MB_BLOCK_SIZE; ++i)
+        sad_h += iabs(cur_img[j][pix_x + i] - cur_img[j][pix_x - 1]);
+    activity = imin(activity, sad_h);
+  }
+
+  return early_term_skip(currMB, ET_INTRA, (double) dist_down(cost) / (double) (activity + MB_BLOCK_SIZE));
+}
+
+//! pels of the partitions of blocktype 1 to 3
+static const int et_partition_pels[4] = { 0, 256, 128, 128 };
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    TRUE if the references past the first need not be searched for a
+ *    16x16, 16x8 or 8x16 partition, cost being its cost on the first
+ ***********************************************************************
+ */
+int EarlyTermSkipRefs (Macroblock *currMB, int blocktype, distblk cost)
+{
+  if (blocktype < 1 || blocktype > 3 || cost == DISTBLK_MAX)
+    return FALSE;
+  return early_term_skip(currMB, ET_REF, (double) dist_down(cost) / (double) et_partition_pels[blocktype]);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Sample of a training macroblock after all references of a
+ *    partition were searched: won if one past the first was cheaper
+ ***********************************************************************
+ */
+void EarlyTermTrainRefs (Macroblock *currMB, int blocktype, distblk cost, int won)
+{
+  EarlyTerm *et = currMB->p_Vid->p_EarlyTerm;
+
+  if (!et->active || !et->train || !(currMB->p_Inp->EarlyTermination & (1 << ET_REF))
+    || blocktype < 1 || blocktype > 3 || cost == DISTBLK_MAX)
+    return;
+
+  early_term_learn(et, ET_REF, currMB->qp, (double) dist_down(cost) / (double) et_partition_pels[blocktype], won);
+}
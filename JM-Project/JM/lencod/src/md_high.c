@@ -28,6 +28,7 @@
 #include "vlc.h"
 #include "rdopt.h"
 #include "mv_search.h"
+#include "md_early_term.h"
 
 /*!
 *************************************************************************************
@@ -78,6 +79,8 @@ void encode_one_macroblock_high (Macroblock *currMB)
 
   //===== Setup Macroblock encoding parameters =====
   init_enc_mb_params(currMB, &enc_mb, intra);
+  if (p_Vid->p_EarlyTerm)
+    EarlyTermStartMB(currMB);
   if (p_Inp->AdaptiveRounding)
   {
     reset_adaptive_rounding(p_Vid);
@@ -181,6 +184,9 @@ void encode_one_macroblock_high (Macroblock *currMB)
       } // if (enc_mb.valid[mode])
     } // for (mode=1; mode<4; mode++)
 
+    if (p_Vid->p_EarlyTerm && enc_mb.valid[P8x8] && EarlyTermSkipP8x8(currMB, min_cost))
+      enc_mb.valid[P8x8] = 0;
+
     if (enc_mb.valid[P8x8])
     {    
       currMB->valid_8x8 = FALSE;
@@ -226,6 +232,9 @@ void encode_one_macroblock_high (Macroblock *currMB)
 
       p_Vid->giRDOpt_B8OnlyFlag = FALSE;
     }
+
+    if (p_Vid->p_EarlyTerm && EarlyTermSkipIntra(currMB, min_cost))
+      enc_mb.valid[I4MB] = enc_mb.valid[I8MB] = enc_mb.valid[I16MB] = enc_mb.valid[IPCM] = 0;
   }
   else // if (!intra)
   {
@@ -295,6 +304,9 @@ void encode_one_macroblock_high (Macroblock *currMB)
 
   restore_nz_coeff(currMB);
 
+  if (p_Vid->p_EarlyTerm)
+    EarlyTermEndMB(currMB);
+
   intra1 = is_intra(currMB);
 
   //=====  S E T   F I N A L   M A C R O B L O C K   P A R A M E T E R S ======
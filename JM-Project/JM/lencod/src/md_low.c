@@ -33,6 +33,7 @@
 #include "memalloc.h"
 #include "mc_prediction.h"
 #include "rd_intra_jm.h"
+#include "md_early_term.h"
 
 /*!
  ************************************************************************
@@ -153,6 +154,8 @@ void encode_one_macroblock_low (Macroblock *currMB)
 
   //===== Setup Macroblock encoding parameters =====
   init_enc_mb_params(currMB, &enc_mb, intra);
+  if (p_Vid->p_EarlyTerm)
+    EarlyTermStartMB(currMB);
   if (p_Inp->AdaptiveRounding)
   {
     reset_adaptive_rounding(p_Vid);
@@ -262,6 +265,9 @@ void encode_one_macroblock_low (Macroblock *currMB)
       } // if (enc_mb.valid[mode])
     } // for (mode=1; mode<4; mode++)
 
+    if (p_Vid->p_EarlyTerm && enc_mb.valid[P8x8] && EarlyTermSkipP8x8(currMB, min_cost))
+      enc_mb.valid[P8x8] = 0;
+
     if (enc_mb.valid[P8x8])
     {
       //===== store coding state of macroblock =====
@@ -356,6 +362,9 @@ void encode_one_macroblock_low (Macroblock *currMB)
     // Find a motion vector for the Skip mode
     if(pslice)
       FindSkipModeMotionVector (currMB);
+
+    if (p_Vid->p_EarlyTerm && EarlyTermSkipIntra(currMB, min_cost))
+      enc_mb.valid[I4MB] = enc_mb.valid[I8MB] = enc_mb.valid[I16MB] = enc_mb.valid[IPCM] = 0;
   }
   else // if (!intra)
   {
@@ -555,6 +564,9 @@ void encode_one_macroblock_low (Macroblock *currMB)
     }
   }
 
+  if (p_Vid->p_EarlyTerm)
+    EarlyTermEndMB(currMB);
+
   intra1 = is_intra(currMB);
 
   //=====  S E T   F I N A L   M A C R O B L O C K   P A R A M E T E R S ======
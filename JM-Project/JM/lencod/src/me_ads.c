@@ -0,0 +1,748 @@
+
+/*!
+*************************************************************************************
+* \file me_ads.c
+*
+* \brief
+*    Motion Estimation using Adaptive Diamond Search (SearchMode = 4).
+*    Integer-pel single list and bi-predictive engines; sub-pel refinement
+*    uses the generic JM routines (see init_ME_engine).
+*
+*************************************************************************************
+*/
+
+// Includes
+#include <limits.h>
+
+#include "global.h"
+#include "mbuffer.h"
+#include "macroblock.h"
+#include "mv_search.h"
+#include "me_ads.h"
+#include "me_hme.h"
+#include "me_trace.h"
+
+#define ADS_MAX_ITERS   64  //!< iteration cap of the diamond search
+#define ADS_SMALL_ITERS 32  //!< iteration cap for partitions of 8 pels or less
+
+//! Large diamond (LDSP) and small diamond (SDSP) search patterns, integer-pel
+static const int ads_ldsp[8][2] = {
+  {  0, -2 }, {  2,  0 }, {  0,  2 }, { -2,  0 },
+  {  2, -2 }, {  2,  2 }, { -2,  2 }, { -2, -2 }
+};
+static const int ads_sdsp[4][2] = {
+  {  0, -1 }, {  1,  0 }, {  0,  1 }, { -1,  0 }
+};
+
+//! State of one integer-pel ADS search
+typedef struct
+{
+  VideoParameters *p_Vid;
+  StorablePicture *ref_picture;
+  StorablePicture *ref_picture2;  //!< bi-pred: picture of the fixed list, NULL otherwise
+  MEBlock         *mv_block;
+  const ADSPlaneBlock *plane;     //!< plane search (lookahead): the block searched instead of mv_block
+  MotionVector     pred;          //!< predicted position (absolute, sub-pel units; integer-pel displacement for plane searches)
+  MotionVector     center2;       //!< bi-pred: fixed position in ref_picture2 (absolute, sub-pel units)
+  distblk          fixed_cost;    //!< bi-pred: MV cost of the fixed list
+  int              lambda_factor;
+  int              range;         //!< window around (win_x, win_y), integer-pel
+  int              win_x, win_y;
+  int              min_x, max_x;  //!< displacements whose block stays inside the padded plane
+  int              min_y, max_y;
+  unsigned int     points;        //!< candidates evaluated
+} ADSSearch;
+
+//! Length of the se(v) code of v
+static inline int ads_se_bits (int v)
+{
+  int code = (v > 0) ? 2 * v : -2 * v + 1;
+  int bits = 1;
+
+  for (; code > 1; code >>= 1)
+    bits += 2;
+  return bits;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Cost SAD + lambda * R(mvd) of displacement (dx, dy) of a plane search.
+ *    A pel of the plane is 8 quarter-pels of the full resolution frame,
+ *    R is counted for those.
+ ***********************************************************************
+ */
+static distblk ads_plane_cost (ADSSearch *s, int dx, int dy, distblk bound)
+{
+  const ADSPlaneBlock *b = s->plane;
+  distblk mcost = s->lambda_factor * (ads_se_bits((dx - s->pred.mv_x) * 8) + ads_se_bits((dy - s->pred.mv_y) * 8));
+  int x, y;
+
+  ++s->points;
+  for (y = 0; y < b->size && mcost < bound; ++y)
+  {
+    imgpel *cur = &b->cur[b->pos_y + y][b->pos_x];
+    imgpel *ref = &b->ref[b->pos_y + dy + y][b->pos_x + dx];
+
+    for (x = 0; x < b->size; ++x)
+      mcost += iabs(cur[x] - ref[x]);
+  }
+  return mcost;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Motion cost D + lambda * R(mvd) of integer-pel displacement (dx, dy).
+ *    Returns a value >= bound as soon as the cost reaches bound.
+ ***********************************************************************
+ */
+static distblk ads_point_cost (ADSSearch *s, int dx, int dy, distblk bound)
+{
+  MEBlock *mv_block = s->mv_block;
+  MotionVector cand;
+  distblk mcost;
+
+  if (s->plane)
+    return ads_plane_cost(s, dx, dy, bound);
+
+  cand.mv_x = (short) (mv_block->pos_x_padded + (dx << 2));
+  cand.mv_y = (short) (mv_block->pos_y_padded + (dy << 2));
+
+  ++s->points;
+  mcost = s->fixed_cost + mv_cost (s->p_Vid, s->lambda_factor, &cand, &s->pred);
+  if (mcost >= bound)
+    return mcost;
+
+  if (s->ref_picture2)
+    return mcost + mv_block->computeBiPredFPel (s->ref_picture, s->ref_picture2, mv_block, bound - mcost, &cand, &s->center2);
+  return mcost + mv_block->computePredFPel (s->ref_picture, mv_block, bound - mcost, &cand);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    TRUE if displacement (dx, dy) is a valid search candidate
+ ***********************************************************************
+ */
+static inline int ads_in_window (const ADSSearch *s, int dx, int dy)
+{
+  return iabs(dx - s->win_x) <= s->range && iabs(dy - s->win_y) <= s->range
+      && dx >= s->min_x && dx <= s->max_x && dy >= s->min_y && dy <= s->max_y;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Set the displacement limits of the block: MVs may point into the
+ *    padding as far as UMVLine4X would clip them
+ ***********************************************************************
+ */
+static void ads_set_limits (ADSSearch *s)
+{
+  MEBlock *mv_block = s->mv_block;
+
+  s->min_x = -IMG_PAD_SIZE_X - mv_block->pos_x;
+  s->max_x = s->ref_picture->size_x_pad - mv_block->pos_x;
+  s->min_y = -IMG_PAD_SIZE_Y - mv_block->pos_y;
+  s->max_y = s->ref_picture->size_y_pad - mv_block->pos_y;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    MV found by the HME pyramid for the 8x8 block containing the
+ *    partition (finest level, quarter-pel). Returns 0 when HME is off
+ *    or has no result for this reference.
+ ***********************************************************************
+ */
+static int ads_hme_mv (Macroblock *currMB, ADSSearch *s, MotionVector *hme_mv)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  Slice *currSlice = currMB->p_Slice;
+  HMEInfo_t *pHMEInfo = p_Vid->pHMEInfo;
+  MEBlock *mv_block = s->mv_block;
+  int list = mv_block->list;
+  int ref = -1;
+  int i;
+
+  if (!currMB->p_Inp->HMEEnable || pHMEInfo == NULL || currSlice->structure != FRAME || currMB->list_offset)
+    return 0;
+
+  for (i = 0; i < (int) currSlice->p_Dpb->ref_frames_in_buffer; i++)
+  {
+    if (s->ref_picture->poc == pHMEInfo->poc[0][list][i])
+    {
+      ref = i;
+      break;
+    }
+  }
+  if (ref < 0)
+    return 0;
+
+  *hme_mv = pHMEInfo->p_hme_mv[0][list][ref][mv_block->pos_y >> pHMEInfo->HMEBlockSizeIdx][mv_block->pos_x >> pHMEInfo->HMEBlockSizeIdx];
+  return 1;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    MV of the co-located block in the reference picture, scaled by
+ *    POC distance to the current picture (quarter-pel). Returns 0 when
+ *    the co-located block is intra or its reference is no longer in the
+ *    reference lists (its POC would not be known).
+ ***********************************************************************
+ */
+static int ads_colocated_mv (Macroblock *currMB, ADSSearch *s, MotionVector *col_mv)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  Slice *currSlice = currMB->p_Slice;
+  StorablePicture *col = s->ref_picture;
+  StorablePicture *col_ref = NULL;
+  PicMotionParams *col_info;
+  int list, i, tb, td;
+
+  if (currSlice->structure != FRAME || currMB->list_offset || col->mv_info == NULL)
+    return 0;
+
+  col_info = &col->mv_info[s->mv_block->pos_y >> 2][s->mv_block->pos_x >> 2];
+  list = (col_info->ref_idx[LIST_0] >= 0) ? LIST_0 : LIST_1;
+  if (col_info->ref_idx[list] < 0)
+    return 0;
+
+  for (i = 0; i < currSlice->listXsize[LIST_0] && !col_ref; i++)
+    if (currSlice->listX[LIST_0][i] == col_info->ref_pic[list])
+      col_ref = currSlice->listX[LIST_0][i];
+  for (i = 0; i < currSlice->listXsize[LIST_1] && !col_ref; i++)
+    if (currSlice->listX[LIST_1][i] == col_info->ref_pic[list])
+      col_ref = currSlice->listX[LIST_1][i];
+  if (col_ref == NULL)
+    return 0;
+
+  td = col_ref->frame_poc - col->frame_poc;
+  tb = col->frame_poc - p_Vid->framepoc;
+  if (td == 0)
+    return 0;
+
+  col_mv->mv_x = (short) (col_info->mv[list].mv_x * tb / td);
+  col_mv->mv_y = (short) (col_info->mv[list].mv_y * tb / td);
+  return 1;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Allocates the ADS predictor memory: for every list, reference and
+ *    blocktype the MVs found in the current and the previous picture.
+ *    Returns the number of bytes allocated.
+ ***********************************************************************
+ */
+int ADSInit (VideoParameters *p_Vid)
+{
+  ADSMemory *p_ADS;
+  int blocktype, k, entries;
+
+  if ((p_ADS = (ADSMemory *) calloc(1, sizeof(ADSMemory))) == NULL)
+    no_mem_exit("ADSInit: p_ADS");
+
+  p_ADS->num_ref = imax(1, p_Vid->p_Inp->num_ref_frames);
+  for (blocktype = 1; blocktype < 8; ++blocktype)
+  {
+    p_ADS->offset[blocktype] = p_ADS->grid_size;
+    p_ADS->stride[blocktype] = (p_Vid->width + block_size[blocktype][0] - 1) / block_size[blocktype][0];
+    p_ADS->grid_size += p_ADS->stride[blocktype] * ((p_Vid->height + block_size[blocktype][1] - 1) / block_size[blocktype][1]);
+  }
+
+  entries = 2 * p_ADS->num_ref * p_ADS->grid_size;
+  for (k = 0; k < 2; ++k)
+  {
+    if ((p_ADS->store[k].mv = (MotionVector *) calloc(entries, sizeof(MotionVector))) == NULL)
+      no_mem_exit("ADSInit: p_ADS->store.mv");
+    if ((p_ADS->store[k].dist = (short *) calloc(entries, sizeof(short))) == NULL)
+      no_mem_exit("ADSInit: p_ADS->store.dist");
+    p_ADS->store[k].pic_no = -1;
+  }
+  p_ADS->cur  = &p_ADS->store[0];
+  p_ADS->prev = &p_ADS->store[1];
+  p_Vid->p_ADS = p_ADS;
+
+  return sizeof(ADSMemory) + 2 * entries * (sizeof(MotionVector) + sizeof(short));
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Frees the ADS predictor memory
+ ***********************************************************************
+ */
+void ADSDelete (VideoParameters *p_Vid)
+{
+  ADSMemory *p_ADS = p_Vid->p_ADS;
+  int k;
+
+  if (p_ADS == NULL)
+    return;
+  for (k = 0; k < 2; ++k)
+  {
+    free(p_ADS->store[k].mv);
+    free(p_ADS->store[k].dist);
+  }
+  free(p_ADS);
+  p_Vid->p_ADS = NULL;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Starts a new picture: the MVs of the current picture become the
+ *    previous ones. Further coding passes of the same picture (RDPictureDecision,
+ *    field/frame decision) keep what was found so far.
+ ***********************************************************************
+ */
+void ADSPictureInit (VideoParameters *p_Vid)
+{
+  ADSMemory *p_ADS = p_Vid->p_ADS;
+  ADSMvStore *tmp;
+
+  if (p_ADS->cur->pic_no == p_Vid->frm_no_in_file)
+    return;
+
+  tmp = p_ADS->prev;
+  p_ADS->prev = p_ADS->cur;
+  p_ADS->cur  = tmp;
+  memset(p_ADS->cur->dist, 0, 2 * p_ADS->num_ref * p_ADS->grid_size * sizeof(short));
+  p_ADS->cur->pic_no = p_Vid->frm_no_in_file;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Copies the MVs of the current picture of src to dst, for coding
+ *    contexts that continue from the predictor memory of another one
+ ***********************************************************************
+ */
+void ADSCopyMemory (VideoParameters *dst, VideoParameters *src)
+{
+  ADSMemory *p_dst = dst->p_ADS;
+  ADSMemory *p_src = src->p_ADS;
+  int entries = 2 * p_src->num_ref * p_src->grid_size;
+
+  memcpy(p_dst->cur->mv,   p_src->cur->mv,   entries * sizeof(MotionVector));
+  memcpy(p_dst->cur->dist, p_src->cur->dist, entries * sizeof(short));
+  p_dst->cur->pic_no = p_src->cur->pic_no;
+}
+
+//! Entry of the predictor memory for a list, reference, blocktype and luma position
+static inline int ads_memory_index (ADSMemory *p_ADS, int list, int ref, int blocktype, int pos_x, int pos_y)
+{
+  return (list * p_ADS->num_ref + ref) * p_ADS->grid_size + p_ADS->offset[blocktype]
+    + (pos_y / block_size[blocktype][1]) * p_ADS->stride[blocktype] + pos_x / block_size[blocktype][0];
+}
+
+//! Predictor memory is kept for frame coding of list 0 and 1 only
+static inline int ads_memory_valid (Macroblock *currMB, ADSSearch *s)
+{
+  return currMB->p_Vid->p_ADS != NULL && currMB->p_Slice->structure == FRAME && !currMB->list_offset
+    && s->mv_block->ref_idx < currMB->p_Vid->p_ADS->num_ref;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Reads one MV of the predictor memory and scales it to the POC
+ *    distance tb of the current search. Returns 0 if the entry is empty.
+ ***********************************************************************
+ */
+static int ads_memory_get (ADSMemory *p_ADS, ADSMvStore *store, int idx, int tb, MotionVector *mv)
+{
+  int td = store->dist[idx];
+
+  if (td == 0)
+    return 0;
+  mv->mv_x = (short) (store->mv[idx].mv_x * tb / td);
+  mv->mv_y = (short) (store->mv[idx].mv_y * tb / td);
+  return 1;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Candidates from the predictor memory (quarter-pel): the same block
+ *    in the previous picture, the same block searched against the
+ *    previous reference index and the enclosing larger partition of
+ *    this picture. Returns the number of candidates written to mv.
+ ***********************************************************************
+ */
+static int ads_memory_candidates (Macroblock *currMB, ADSSearch *s, MotionVector *mv)
+{
+  ADSMemory *p_ADS = currMB->p_Vid->p_ADS;
+  MEBlock *mv_block = s->mv_block;
+  int list = mv_block->list;
+  int ref = mv_block->ref_idx;
+  int blocktype = mv_block->blocktype;
+  int tb = currMB->p_Vid->framepoc - s->ref_picture->frame_poc;
+  int n = 0;
+
+  if (!ads_memory_valid(currMB, s) || tb == 0)
+    return 0;
+
+  n += ads_memory_get(p_ADS, p_ADS->prev, ads_memory_index(p_ADS, list, ref, blocktype, mv_block->pos_x, mv_block->pos_y), tb, &mv[n]);
+  if (ref > 0)
+    n += ads_memory_get(p_ADS, p_ADS->cur, ads_memory_index(p_ADS, list, ref - 1, blocktype, mv_block->pos_x, mv_block->pos_y), tb, &mv[n]);
+  if (blocktype > 1)
+  {
+    int parent = (blocktype < 5) ? 1 : 4;
+    n += ads_memory_get(p_ADS, p_ADS->cur, ads_memory_index(p_ADS, list, ref, parent, mv_block->pos_x, mv_block->pos_y), tb, &mv[n]);
+  }
+  return n;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Stores the MV (quarter-pel) found for the current block in the
+ *    predictor memory
+ ***********************************************************************
+ */
+static void ads_memory_store (Macroblock *currMB, ADSSearch *s, MotionVector *mv)
+{
+  ADSMemory *p_ADS = currMB->p_Vid->p_ADS;
+  MEBlock *mv_block = s->mv_block;
+  int tb = currMB->p_Vid->framepoc - s->ref_picture->frame_poc;
+  int idx;
+
+  if (!ads_memory_valid(currMB, s) || tb == 0)
+    return;
+
+  idx = ads_memory_index(p_ADS, mv_block->list, mv_block->ref_idx, mv_block->blocktype, mv_block->pos_x, mv_block->pos_y);
+  p_ADS->cur->mv[idx]   = *mv;
+  p_ADS->cur->dist[idx] = (short) tb;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Diamond search from (*cx, *cy), whose cost is center_cost.
+ *    Large diamond steps until the center is the best point, then one
+ *    small diamond step. Returns the cost of the final (*cx, *cy).
+ ***********************************************************************
+ */
+static distblk ads_diamond (ADSSearch *s, int *cx, int *cy, distblk center_cost, int max_iters)
+{
+  distblk min_mcost = center_cost;
+  int iters = 0;
+  int i;
+
+  while (iters++ < max_iters)
+  {
+    distblk best = min_mcost, mcost;
+    int best_dx = 0, best_dy = 0;
+
+    for (i = 0; i < 8; ++i)
+    {
+      int nx = *cx + ads_ldsp[i][0];
+      int ny = *cy + ads_ldsp[i][1];
+      if (!ads_in_window(s, nx, ny))
+        continue;
+      mcost = ads_point_cost(s, nx, ny, best);
+      if (mcost < best)
+      {
+        best    = mcost;
+        best_dx = ads_ldsp[i][0];
+        best_dy = ads_ldsp[i][1];
+      }
+    }
+
+    if (best < min_mcost)
+    {
+      *cx += best_dx;
+      *cy += best_dy;
+      min_mcost = best;
+      continue;
+    }
+
+    // LDSP converged: one SDSP refinement around the center
+    for (i = 0; i < 4; ++i)
+    {
+      int nx = *cx + ads_sdsp[i][0];
+      int ny = *cy + ads_sdsp[i][1];
+      if (!ads_in_window(s, nx, ny))
+        continue;
+      mcost = ads_point_cost(s, nx, ny, best);
+      if (mcost < best)
+      {
+        best    = mcost;
+        best_dx = ads_sdsp[i][0];
+        best_dy = ads_sdsp[i][1];
+      }
+    }
+    *cx += best_dx;
+    *cy += best_dy;
+    min_mcost = best;
+    break;
+  }
+
+  return min_mcost;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Write the ME trace record of a finished integer-pel search.
+ *    Frame numbers are positions in the input file so the trace can be
+ *    replayed on the source YUV.
+ ***********************************************************************
+ */
+static void trace_block (Macroblock *currMB, ADSSearch *s, MotionVector *init_mv, MotionVector *mv, distblk cost)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  InputParameters *p_Inp = currMB->p_Inp;
+  MEBlock *mv_block = s->mv_block;
+  int frame = p_Inp->start_frame + p_Vid->frm_no_in_file;
+  METraceRecord rec;
+
+#if JCOST_CALC_SCALEUP
+  cost >>= LAMBDA_ACCURACY_BITS;
+#endif
+
+  rec.frame     = (uint32) frame;
+  rec.ref_frame = (uint32) (frame - (p_Vid->framepoc - s->ref_picture->frame_poc) / 2);
+  rec.x         = (uint16) mv_block->pos_x;
+  rec.y         = (uint16) mv_block->pos_y;
+  rec.w         = (byte) mv_block->blocksize_x;
+  rec.h         = (byte) mv_block->blocksize_y;
+  rec.list      = (byte) (mv_block->list + currMB->list_offset);
+  rec.ref_idx   = (byte) mv_block->ref_idx;
+  rec.range     = (uint16) s->range;
+  rec.pred_x    = (int16) init_mv->mv_x;
+  rec.pred_y    = (int16) init_mv->mv_y;
+  rec.mv_x      = (int16) mv->mv_x;
+  rec.mv_y      = (int16) mv->mv_y;
+  rec.cost      = (uint32) (cost < UINT_MAX ? cost : UINT_MAX);
+  rec.points    = s->points;
+  write_me_trace(p_Vid, &rec);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Integer-pel Adaptive Diamond Search
+ *
+ *    The search starts from the cheapest of the median predictor, the
+ *    HME MV (HMEEnable), the co-located temporal MV and the MVs kept in
+ *    the predictor memory (see ads_memory_candidates). Candidates are
+ *    ranked by D + lambda * R(mvd) relative to the real MV predictor,
+ *    with the distortion taken from computePredFPel so that chroma ME
+ *    and weighted prediction apply.
+ ***********************************************************************
+ */
+distblk                                         //  ==> minimum motion cost after search
+ADS_motion_estimation (Macroblock   *currMB,        // <--  current Macroblock
+                       MotionVector *pred_mv,       // <--  motion vector predictor in sub-pel units
+                       MEBlock      *mv_block,      // <--  motion estimation structure
+                       distblk       min_mcost,     // <--  minimum motion cost (cost for center or huge value)
+                       int           lambda_factor  // <--  lagrangian parameter for determining motion cost
+                       )
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  InputParameters *p_Inp = currMB->p_Inp;
+  Slice *currSlice = currMB->p_Slice;
+  int   list = mv_block->list + currMB->list_offset;
+  MotionVector *mv = &mv_block->mv[(short) mv_block->list];
+  int   bsx = mv_block->blocksize_x;
+  int   bsy = mv_block->blocksize_y;
+  int   max_iters = ADS_MAX_ITERS;
+  int   cx, cy, i, nstart;
+  ADSSearch s;
+  MotionVector init_mv, best_mv, start[5];
+
+  memset(&s, 0, sizeof(s));
+  s.p_Vid         = p_Vid;
+  s.ref_picture   = currSlice->listX[list][(short) mv_block->ref_idx];
+  s.mv_block      = mv_block;
+  s.lambda_factor = lambda_factor;
+  s.pred.mv_x     = (short) (mv_block->pos_x_padded + pred_mv->mv_x);
+  s.pred.mv_y     = (short) (mv_block->pos_y_padded + pred_mv->mv_y);
+
+  // searchRange is kept in quarter-pel units
+  s.range = imax(abs(mv_block->searchRange.min_x), imax(abs(mv_block->searchRange.max_x), imax(abs(mv_block->searchRange.min_y), abs(mv_block->searchRange.max_y)))) >> 2;
+  if (s.range <= 0)
+    s.range = p_Inp->search_range[p_Vid->view_id];
+  if (bsx <= 8 || bsy <= 8)
+  {
+    s.range   = imax(s.range >> 1, 8);
+    max_iters = ADS_SMALL_ITERS;
+  }
+  ads_set_limits(&s);
+
+  cx = iClip3(s.min_x, s.max_x, mv->mv_x / 4); // quarter-pel to integer-pel
+  cy = iClip3(s.min_y, s.max_y, mv->mv_y / 4);
+  min_mcost = ads_point_cost(&s, cx, cy, DISTBLK_MAX);
+
+  // start from the best of the median, HME, co-located and remembered predictors
+  nstart = 0;
+  if (ads_hme_mv(currMB, &s, &start[nstart]))
+    ++nstart;
+  if (ads_colocated_mv(currMB, &s, &start[nstart]))
+    ++nstart;
+  nstart += ads_memory_candidates(currMB, &s, &start[nstart]);
+  for (i = 0; i < nstart; ++i)
+  {
+    int sx = (start[i].mv_x + 2) >> 2;
+    int sy = (start[i].mv_y + 2) >> 2;
+    distblk mcost;
+    int j;
+
+    if ((sx == cx && sy == cy) || !ads_in_window(&s, sx, sy))
+      continue;
+    for (j = 0; j < i; ++j)
+      if (sx == ((start[j].mv_x + 2) >> 2) && sy == ((start[j].mv_y + 2) >> 2))
+        break;
+    if (j < i)
+      continue;
+    mcost = ads_point_cost(&s, sx, sy, min_mcost);
+    if (mcost < min_mcost)
+    {
+      min_mcost = mcost;
+      cx = sx;
+      cy = sy;
+    }
+  }
+  init_mv.mv_x = (short) cx;
+  init_mv.mv_y = (short) cy;
+
+  min_mcost = ads_diamond(&s, &cx, &cy, min_mcost, max_iters);
+
+  best_mv.mv_x = (short) cx;
+  best_mv.mv_y = (short) cy;
+  mv->mv_x = (short) (cx * 4); // back to quarter-pel units
+  mv->mv_y = (short) (cy * 4);
+  ads_memory_store(currMB, &s, mv);
+
+  if (p_Vid->p_me_trace)
+    trace_block(currMB, &s, &init_mv, &best_mv, min_mcost);
+
+  return min_mcost;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Integer-pel bi-predictive Adaptive Diamond Search
+ *
+ *    Refines mv1 of list `list' by a diamond search around its current
+ *    value while the prediction of the other list stays at mv2, i.e. one
+ *    step of the BiPredMERefinements loop of BiPredBlockMotionSearch.
+ *    Drop-in replacement for full_search_bipred_motion_estimation: the
+ *    window is +-search_range around mv1, and mv1 is only changed when a
+ *    candidate beats min_mcost.
+ ***********************************************************************
+ */
+distblk                                                   //  ==> minimum motion cost after search
+ADS_bipred_motion_estimation (Macroblock   *currMB,       // <--  current Macroblock
+                              int           list,         // <--  reference list
+                              MotionVector *pred_mv1,     // <--  motion vector predictor from first list (x|y) in sub-pel units
+                              MotionVector *pred_mv2,     // <--  motion vector predictor from second list (x|y) in sub-pel units
+                              MotionVector *mv1,          // <--> in: search center (x|y) / out: motion vector (x|y) - in sub-pel units
+                              MotionVector *mv2,          // <--  in: search center (x|y)
+                              MEBlock      *mv_block,     // <--  motion vector information
+                              int           search_range, // <--  1-d search range in sub-pel units
+                              distblk       min_mcost,    // <--  minimum motion cost (cost for center or huge value)
+                              int           lambda_factor // <--  lagrangian parameter for determining motion cost
+                              )
+{
+  Slice *currSlice = currMB->p_Slice;
+  VideoParameters *p_Vid = currMB->p_Vid;
+  short ref = mv_block->ref_idx;
+  int   bsx = mv_block->blocksize_x;
+  int   bsy = mv_block->blocksize_y;
+  int   max_iters = (bsx <= 8 || bsy <= 8) ? ADS_SMALL_ITERS : ADS_MAX_ITERS;
+  int   cx, cy;
+  distblk mcost;
+  ADSSearch s;
+  MotionVector pred2;
+
+  memset(&s, 0, sizeof(s));
+  s.p_Vid         = p_Vid;
+  s.ref_picture   = currSlice->listX[list       + currMB->list_offset][ref];
+  s.ref_picture2  = currSlice->listX[(list ^ 1) + currMB->list_offset][0];
+  s.mv_block      = mv_block;
+  s.lambda_factor = lambda_factor;
+  s.pred.mv_x     = (short) (mv_block->pos_x_padded + pred_mv1->mv_x);
+  s.pred.mv_y     = (short) (mv_block->pos_y_padded + pred_mv1->mv_y);
+  s.center2.mv_x  = (short) (mv_block->pos_x_padded + mv2->mv_x);
+  s.center2.mv_y  = (short) (mv_block->pos_y_padded + mv2->mv_y);
+  pred2.mv_x      = (short) (mv_block->pos_x_padded + pred_mv2->mv_x);
+  pred2.mv_y      = (short) (mv_block->pos_y_padded + pred_mv2->mv_y);
+  s.fixed_cost    = mv_cost (p_Vid, lambda_factor, &s.center2, &pred2);
+  s.range         = search_range >> 2;
+  ads_set_limits(&s);
+
+  // BiPredBlockMotionSearch rounds the centers to integer-pel for this engine
+  s.win_x = cx = mv1->mv_x >> 2;
+  s.win_y = cy = mv1->mv_y >> 2;
+
+  mcost = ads_diamond(&s, &cx, &cy, ads_point_cost(&s, cx, cy, DISTBLK_MAX), max_iters);
+  if (mcost < min_mcost)
+  {
+    min_mcost = mcost;
+    mv1->mv_x = (short) (cx * 4);
+    mv1->mv_y = (short) (cy * 4);
+  }
+
+  return min_mcost;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Integer-pel Adaptive Diamond Search of a block of a plain plane,
+ *    used by the lookahead on its downscaled frames
+ *
+ *    The search starts from the cheapest of the num_cand candidates
+ *    (integer-pel displacements) and stays within +-range of the zero
+ *    MV and inside the padding of the reference plane. pred is the MV
+ *    predictor the rate is counted against.
+ * \return
+ *    SAD + lambda * R(mvd) of the MV written to mv
+ ***********************************************************************
+ */
+int ADS_plane_search (const ADSPlaneBlock *block, const MotionVector *cand, int num_cand, const MotionVector *pred, int range, int lambda, MotionVector *mv)
+{
+  ADSSearch s;
+  distblk min_mcost = DISTBLK_MAX;
+  int cx = 0, cy = 0, i;
+
+  memset(&s, 0, sizeof(s));
+  s.plane         = block;
+  s.pred          = *pred;
+  s.lambda_factor = lambda;
+  s.range         = range;
+  s.min_x = -block->pad - block->pos_x;
+  s.max_x = block->width + block->pad - block->size - block->pos_x;
+  s.min_y = -block->pad - block->pos_y;
+  s.max_y = block->height + block->pad - block->size - block->pos_y;
+
+  for (i = 0; i < num_cand; ++i)
+  {
+    int sx = iClip3(s.min_x, s.max_x, iClip3(-range, range, cand[i].mv_x));
+    int sy = iClip3(s.min_y, s.max_y, iClip3(-range, range, cand[i].mv_y));
+    distblk mcost;
+
+    if (i > 0 && sx == cx && sy == cy)
+      continue;
+    mcost = ads_point_cost(&s, sx, sy, min_mcost);
+    if (mcost < min_mcost)
+    {
+      min_mcost = mcost;
+      cx = sx;
+      cy = sy;
+    }
+  }
+
+  min_mcost = ads_diamond(&s, &cx, &cy, min_mcost, ADS_SMALL_ITERS);
+
+  mv->mv_x = (short) cx;
+  mv->mv_y = (short) cy;
+  return (int) min_mcost;
+}
@@ -24,6 +24,7 @@
 #include "refbuf.h"
 #include "mv_search.h"
 #include "me_distortion.h"
+#include "me_distortion_simd.h"
 
 
 //#define CHECKOVERFLOW(mcost) assert(mcost>=0)
@@ -163,6 +164,7 @@ void select_distortion(VideoParameters *p_Vid, InputParameters *p_Inp)
     p_Vid->distortion8x8 = distortion8x8SATD;
     break;
   }
+  select_distortion_simd(p_Vid, p_Inp);
 }
 
 
@@ -356,10 +358,9 @@ distblk computeSAD(StorablePicture *ref1,
   int y,x;
   short blocksize_x = mv_block->blocksize_x;
   short blocksize_y = mv_block->blocksize_y;
-  VideoParameters *p_Vid = mv_block->p_Vid;
-  int pad_size_x = p_Vid->padded_size_x - blocksize_x;
+  int pad_size_x = ref1->p_curr_plane_sub->stride - blocksize_x;
 #if (JM_MEM_DISTORTION)
-  int *imgpel_abs = p_Vid->imgpel_abs;
+  int *imgpel_abs = mv_block->p_Vid->imgpel_abs;
 #endif
 
   imgpel *src_line, *ref_line;
@@ -390,7 +391,7 @@ distblk computeSAD(StorablePicture *ref1,
     // calculate chroma conribution to motion compensation error
     int blocksize_x_cr = mv_block->blocksize_cr_x;
     int blocksize_y_cr = mv_block->blocksize_cr_y;
-    int cr_pad_size_x = p_Vid->cr_padded_size_x - blocksize_x_cr;
+    int cr_pad_size_x = ref1->plane_sub[PLANE_U][0].stride - blocksize_x_cr;
     int k;
     int mcr_cost = 0; // chroma me cost
 
@@ -446,7 +447,7 @@ distblk computeSADWP(StorablePicture *ref1,
 
   VideoParameters *p_Vid = mv_block->p_Vid;
   Slice *currSlice = mv_block->p_Slice;  
-  int pad_size_x = p_Vid->padded_size_x - blocksize_x;
+  int pad_size_x = ref1->p_curr_plane_sub->stride - blocksize_x;
   int max_imgpel_value = p_Vid->max_imgpel_value;
   short weight = mv_block->weight_luma;
   short offset = mv_block->offset_luma;
@@ -479,7 +480,7 @@ distblk computeSADWP(StorablePicture *ref1,
     // calculate chroma conribution to motion compensation error
     int blocksize_x_cr = mv_block->blocksize_cr_x;
     int blocksize_y_cr = mv_block->blocksize_cr_y;
-    int cr_pad_size_x = p_Vid->cr_padded_size_x - blocksize_x_cr;
+    int cr_pad_size_x = ref1->plane_sub[PLANE_U][0].stride - blocksize_x_cr;
     int k;
     int mcr_cost = 0;
     int max_imgpel_value_uv = p_Vid->max_pel_value_comp[1];
@@ -535,10 +536,9 @@ distblk computeBiPredSAD1(StorablePicture *ref1,
   int y,x;
   short blocksize_x = mv_block->blocksize_x;
   short blocksize_y = mv_block->blocksize_y;
-  VideoParameters *p_Vid = mv_block->p_Vid;
-  int pad_size_x = p_Vid->padded_size_x - blocksize_x;
+  int pad_size_x = ref1->p_curr_plane_sub->stride - blocksize_x;
 #if (JM_MEM_DISTORTION)
-  int *imgpel_abs = p_Vid->imgpel_abs;
+  int *imgpel_abs = mv_block->p_Vid->imgpel_abs;
 #endif
 
   imgpel *src_line   = mv_block->orig_pic[0];
@@ -581,7 +581,7 @@ distblk computeBiPredSAD1(StorablePicture *ref1,
     // calculate chroma conribution to motion compensation error
     int blocksize_x_cr = mv_block->blocksize_cr_x;
     int blocksize_y_cr = mv_block->blocksize_cr_y;
-    int cr_pad_size_x = p_Vid->cr_padded_size_x - blocksize_x_cr;
+    int cr_pad_size_x = ref1->plane_sub[PLANE_U][0].stride - blocksize_x_cr;
     int k;
     int mcr_cost = 0;
 
@@ -644,7 +644,7 @@ distblk computeBiPredSAD2(StorablePicture *ref1,
   short weight2 = mv_block->weight2;
   short offsetBi = mv_block->offsetBi;
 
-  int pad_size_x = p_Vid->padded_size_x - blocksize_x;
+  int pad_size_x = ref1->p_curr_plane_sub->stride - blocksize_x;
 
   imgpel *src_line   = mv_block->orig_pic[0];
   imgpel *ref2_line  = UMVLine4X(ref2, cand2->mv_y, cand2->mv_x);
@@ -690,7 +690,7 @@ distblk computeBiPredSAD2(StorablePicture *ref1,
     // calculate chroma conribution to motion compensation error
     int blocksize_x_cr = mv_block->blocksize_cr_x;
     int blocksize_y_cr = mv_block->blocksize_cr_y;
-    int cr_pad_size_x  = p_Vid->cr_padded_size_x - blocksize_x_cr;
+    int cr_pad_size_x  = ref1->plane_sub[PLANE_U][0].stride - blocksize_x_cr;
     int k;
     int mcr_cost = 0;
     int max_imgpel_value_uv = p_Vid->max_pel_value_comp[1];
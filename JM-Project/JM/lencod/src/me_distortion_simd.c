@@ -0,0 +1,1247 @@
+
+/*!
+*************************************************************************************
+* \file me_distortion_simd.c
+*
+* \brief
+*    SSE4.1 / AVX2 versions of the motion estimation SAD and SSE functions
+*    (computeSAD, computeSADWP, computeSSE, computeSSEWP and the BiPred
+*    variants), SSE2 versions of the unweighted SAD and SSE functions and
+*    of the SAD cache rows, and AVX2 versions of the SATD functions. Results are identical to the C versions in me_distortion.c,
+*    including the partial cost returned on early termination: the running
+*    cost is still checked against min_mcost after every luma row and after
+*    every chroma plane.
+*
+*    The kernels are compiled with function target attributes, so the rest
+*    of the encoder does not need any -m flags; init_distortion_simd() picks
+*    the best set the CPU supports at run time when the DPB layer is set up.
+*
+*************************************************************************************
+*/
+
+#include <limits.h>
+
+#include "global.h"
+#include "refbuf.h"
+#include "mv_search.h"
+#include "me_distortion.h"
+#include "me_distortion_simd.h"
+#include "me_sadcache.h"
+
+#if (JM_SIMD_DISTORTION && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+
+#include <immintrin.h>
+
+#define SSE2         __attribute__((target("sse2")))
+#define SSE41        __attribute__((target("sse4.1")))
+#define AVX2         __attribute__((target("avx2")))
+#define SIMD_INLINE  static inline __attribute__((always_inline))
+// Kernels are always inlined: an AVX2 function calling an out-of-line
+// SSE-encoded helper with dirty upper YMM halves pays a state transition
+// penalty on every call.
+#define SSE2_INLINE  static inline __attribute__((target("sse2"), always_inline))
+#define SSE41_INLINE static inline __attribute__((target("sse4.1"), always_inline))
+#define AVX2_INLINE  static inline __attribute__((target("avx2"), always_inline))
+
+//! Weighted prediction parameters of the component being measured
+typedef struct
+{
+  int w1;      //!< weight of ref1 (single list: the only weight)
+  int w2;      //!< weight of ref2
+  int round;
+  int denom;
+  int offset;
+  int max;     //!< max pel value of the component
+} SIMDWeights;
+
+typedef int (*UniRowFn)(const imgpel *src, const imgpel *ref, int width, const SIMDWeights *wp);
+typedef int (*BiRowFn) (const imgpel *src, const imgpel *ref1, const imgpel *ref2, int width, const SIMDWeights *wp);
+
+static inline int wp_uni_pel(int ref, const SIMDWeights *wp)
+{
+  return iClip1(wp->max, ((wp->w1 * ref + wp->round) >> wp->denom) + wp->offset);
+}
+
+static inline int wp_bi_pel(int ref1, int ref2, const SIMDWeights *wp)
+{
+  return iClip1(wp->max, ((wp->w1 * ref1 + wp->w2 * ref2 + wp->round) >> wp->denom) + wp->offset);
+}
+
+/*
+ * Pel loads, widened to 16 bit (SAD/SSE) or 32 bit (weighted prediction) lanes
+ */
+#if (IMGTYPE == 0)
+SSE2_INLINE __m128i load_pel4_16_sse2(const imgpel *p)
+{
+  int v;
+  memcpy(&v, p, sizeof(v));
+  return _mm_unpacklo_epi8(_mm_cvtsi32_si128(v), _mm_setzero_si128());
+}
+SSE2_INLINE __m128i load_pel8_16_sse2(const imgpel *p) { return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) p), _mm_setzero_si128()); }
+SSE41_INLINE __m128i load_pel4_16(const imgpel *p)
+{
+  int v;
+  memcpy(&v, p, sizeof(v));
+  return _mm_cvtepu8_epi16(_mm_cvtsi32_si128(v));
+}
+SSE41_INLINE __m128i load_pel8_16 (const imgpel *p) { return _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *) p)); }
+SSE41_INLINE __m128i load_pel4_32 (const imgpel *p)
+{
+  int v;
+  memcpy(&v, p, sizeof(v));
+  return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(v));
+}
+AVX2_INLINE __m256i load_pel16_16(const imgpel *p) { return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) p)); }
+AVX2_INLINE __m256i load_pel8_32 (const imgpel *p) { return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) p)); }
+#else
+SSE2_INLINE __m128i load_pel4_16_sse2(const imgpel *p) { return _mm_loadl_epi64((const __m128i *) p); }
+SSE2_INLINE __m128i load_pel8_16_sse2(const imgpel *p) { return _mm_loadu_si128((const __m128i *) p); }
+SSE41_INLINE __m128i load_pel4_16 (const imgpel *p) { return _mm_loadl_epi64((const __m128i *) p); }
+SSE41_INLINE __m128i load_pel8_16 (const imgpel *p) { return _mm_loadu_si128((const __m128i *) p); }
+SSE41_INLINE __m128i load_pel4_32 (const imgpel *p) { return _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *) p)); }
+AVX2_INLINE __m256i load_pel16_16(const imgpel *p) { return _mm256_loadu_si256((const __m256i *) p); }
+AVX2_INLINE __m256i load_pel8_32 (const imgpel *p) { return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) p)); }
+#endif
+
+SSE2_INLINE int hsum_sse2(__m128i v)
+{
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(v);
+}
+
+SSE41_INLINE int hsum_sse41(__m128i v)
+{
+  return hsum_sse2(v);
+}
+
+AVX2_INLINE int hsum_avx2(__m256i v)
+{
+  return hsum_sse41(_mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+}
+
+SSE41_INLINE __m128i wp_uni_sse41(__m128i ref, const SIMDWeights *wp)
+{
+  __m128i v = _mm_add_epi32(_mm_mullo_epi32(ref, _mm_set1_epi32(wp->w1)), _mm_set1_epi32(wp->round));
+  v = _mm_add_epi32(_mm_sra_epi32(v, _mm_cvtsi32_si128(wp->denom)), _mm_set1_epi32(wp->offset));
+  return _mm_min_epi32(_mm_max_epi32(v, _mm_setzero_si128()), _mm_set1_epi32(wp->max));
+}
+
+SSE41_INLINE __m128i wp_bi_sse41(__m128i ref1, __m128i ref2, const SIMDWeights *wp)
+{
+  __m128i v = _mm_add_epi32(_mm_mullo_epi32(ref1, _mm_set1_epi32(wp->w1)), _mm_mullo_epi32(ref2, _mm_set1_epi32(wp->w2)));
+  v = _mm_add_epi32(v, _mm_set1_epi32(wp->round));
+  v = _mm_add_epi32(_mm_sra_epi32(v, _mm_cvtsi32_si128(wp->denom)), _mm_set1_epi32(wp->offset));
+  return _mm_min_epi32(_mm_max_epi32(v, _mm_setzero_si128()), _mm_set1_epi32(wp->max));
+}
+
+AVX2_INLINE __m256i wp_uni_avx2(__m256i ref, const SIMDWeights *wp)
+{
+  __m256i v = _mm256_add_epi32(_mm256_mullo_epi32(ref, _mm256_set1_epi32(wp->w1)), _mm256_set1_epi32(wp->round));
+  v = _mm256_add_epi32(_mm256_sra_epi32(v, _mm_cvtsi32_si128(wp->denom)), _mm256_set1_epi32(wp->offset));
+  return _mm256_min_epi32(_mm256_max_epi32(v, _mm256_setzero_si256()), _mm256_set1_epi32(wp->max));
+}
+
+AVX2_INLINE __m256i wp_bi_avx2(__m256i ref1, __m256i ref2, const SIMDWeights *wp)
+{
+  __m256i v = _mm256_add_epi32(_mm256_mullo_epi32(ref1, _mm256_set1_epi32(wp->w1)), _mm256_mullo_epi32(ref2, _mm256_set1_epi32(wp->w2)));
+  v = _mm256_add_epi32(v, _mm256_set1_epi32(wp->round));
+  v = _mm256_add_epi32(_mm256_sra_epi32(v, _mm_cvtsi32_si128(wp->denom)), _mm256_set1_epi32(wp->offset));
+  return _mm256_min_epi32(_mm256_max_epi32(v, _mm256_setzero_si256()), _mm256_set1_epi32(wp->max));
+}
+
+/*
+ * SSE2 row kernels for the unweighted metrics. 8-bit pels are summed with
+ * PSADBW (bi-prediction averages with PAVGB first); 16-bit pels take
+ * |src - ref| as the OR of the two saturating differences, which needs no
+ * PABSW.
+ */
+SSE2_INLINE __m128i absdiff16_sse2(__m128i a, __m128i b)
+{
+  return _mm_or_si128(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a));
+}
+
+SSE2_INLINE int sad_row_sse2(const imgpel *src, const imgpel *ref, int width, const SIMDWeights *wp)
+{
+  __m128i acc = _mm_setzero_si128();
+  int x = 0, cost;
+
+#if (IMGTYPE == 0)
+  for (; x + 16 <= width; x += 16)
+    acc = _mm_add_epi32(acc, _mm_sad_epu8(_mm_loadu_si128((const __m128i *) (src + x)), _mm_loadu_si128((const __m128i *) (ref + x))));
+  if (x + 8 <= width)
+  {
+    acc = _mm_add_epi32(acc, _mm_sad_epu8(_mm_loadl_epi64((const __m128i *) (src + x)), _mm_loadl_epi64((const __m128i *) (ref + x))));
+    x += 8;
+  }
+#else
+  const __m128i one = _mm_set1_epi16(1);
+
+  for (; x + 8 <= width; x += 8)
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(absdiff16_sse2(load_pel8_16_sse2(src + x), load_pel8_16_sse2(ref + x)), one));
+#endif
+  if (x + 4 <= width)
+  {
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(absdiff16_sse2(load_pel4_16_sse2(src + x), load_pel4_16_sse2(ref + x)), _mm_set1_epi16(1)));
+    x += 4;
+  }
+  cost = hsum_sse2(acc);
+  for (; x < width; ++x)
+    cost += iabs(src[x] - ref[x]);
+  return cost;
+}
+
+SSE2_INLINE int sse_row_sse2(const imgpel *src, const imgpel *ref, int width, const SIMDWeights *wp)
+{
+  __m128i acc = _mm_setzero_si128(), d;
+  int x = 0, cost;
+
+  for (; x + 8 <= width; x += 8)
+  {
+    d = _mm_sub_epi16(load_pel8_16_sse2(src + x), load_pel8_16_sse2(ref + x));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(d, d));
+  }
+  if (x + 4 <= width)
+  {
+    d = _mm_sub_epi16(load_pel4_16_sse2(src + x), load_pel4_16_sse2(ref + x));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(d, d));
+    x += 4;
+  }
+  cost = hsum_sse2(acc);
+  for (; x < width; ++x)
+    cost += iabs2(src[x] - ref[x]);
+  return cost;
+}
+
+SSE2_INLINE int bisad_row_sse2(const imgpel *src, const imgpel *ref1, const imgpel *ref2, int width, const SIMDWeights *wp)
+{
+  __m128i acc = _mm_setzero_si128(), avg;
+  int x = 0, cost;
+
+#if (IMGTYPE == 0)
+  for (; x + 16 <= width; x += 16)
+  {
+    avg = _mm_avg_epu8(_mm_loadu_si128((const __m128i *) (ref1 + x)), _mm_loadu_si128((const __m128i *) (ref2 + x)));
+    acc = _mm_add_epi32(acc, _mm_sad_epu8(_mm_loadu_si128((const __m128i *) (src + x)), avg));
+  }
+  if (x + 8 <= width)
+  {
+    avg = _mm_avg_epu8(_mm_loadl_epi64((const __m128i *) (ref1 + x)), _mm_loadl_epi64((const __m128i *) (ref2 + x)));
+    acc = _mm_add_epi32(acc, _mm_sad_epu8(_mm_loadl_epi64((const __m128i *) (src + x)), avg));
+    x += 8;
+  }
+#else
+  const __m128i one = _mm_set1_epi16(1);
+
+  for (; x + 8 <= width; x += 8)
+  {
+    avg = _mm_avg_epu16(load_pel8_16_sse2(ref1 + x), load_pel8_16_sse2(ref2 + x));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(absdiff16_sse2(load_pel8_16_sse2(src + x), avg), one));
+  }
+#endif
+  if (x + 4 <= width)
+  {
+    avg = _mm_avg_epu16(load_pel4_16_sse2(ref1 + x), load_pel4_16_sse2(ref2 + x));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(absdiff16_sse2(load_pel4_16_sse2(src + x), avg), _mm_set1_epi16(1)));
+    x += 4;
+  }
+  cost = hsum_sse2(acc);
+  for (; x < width; ++x)
+    cost += iabs(src[x] - ((ref1[x] + ref2[x] + 1) >> 1));
+  return cost;
+}
+
+SSE2_INLINE int bisse_row_sse2(const imgpel *src, const imgpel *ref1, const imgpel *ref2, int width, const SIMDWeights *wp)
+{
+  __m128i acc = _mm_setzero_si128(), d;
+  int x = 0, cost;
+
+  for (; x + 8 <= width; x += 8)
+  {
+    d = _mm_sub_epi16(load_pel8_16_sse2(src + x), _mm_avg_epu16(load_pel8_16_sse2(ref1 + x), load_pel8_16_sse2(ref2 + x)));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(d, d));
+  }
+  if (x + 4 <= width)
+  {
+    d = _mm_sub_epi16(load_pel4_16_sse2(src + x), _mm_avg_epu16(load_pel4_16_sse2(ref1 + x), load_pel4_16_sse2(ref2 + x)));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(d, d));
+    x += 4;
+  }
+  cost = hsum_sse2(acc);
+  for (; x < width; ++x)
+    cost += iabs2(src[x] - ((ref1[x] + ref2[x] + 1) >> 1));
+  return cost;
+}
+
+/*
+ * SSE4.1 row kernels. 16-bit lanes hold |src - ref| exactly for the bit
+ * depths JM supports (<= 14 bits); PMADDWD sums pairs into 32 bits.
+ */
+SSE41_INLINE int sad_row_sse41(const imgpel *src, const imgpel *ref, int width, const SIMDWeights *wp)
+{
+  const __m128i one = _mm_set1_epi16(1);
+  __m128i acc = _mm_setzero_si128();
+  int x = 0, cost;
+
+  for (; x + 8 <= width; x += 8)
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_abs_epi16(_mm_sub_epi16(load_pel8_16(src + x), load_pel8_16(ref + x))), one));
+  if (x + 4 <= width)
+  {
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_abs_epi16(_mm_sub_epi16(load_pel4_16(src + x), load_pel4_16(ref + x))), one));
+    x += 4;
+  }
+  cost = hsum_sse41(acc);
+  for (; x < width; ++x)
+    cost += iabs(src[x] - ref[x]);
+  return cost;
+}
+
+SSE41_INLINE int sse_row_sse41(const imgpel *src, const imgpel *ref, int width, const SIMDWeights *wp)
+{
+  __m128i acc = _mm_setzero_si128(), d;
+  int x = 0, cost;
+
+  for (; x + 8 <= width; x += 8)
+  {
+    d = _mm_sub_epi16(load_pel8_16(src + x), load_pel8_16(ref + x));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(d, d));
+  }
+  if (x + 4 <= width)
+  {
+    d = _mm_sub_epi16(load_pel4_16(src + x), load_pel4_16(ref + x));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(d, d));
+    x += 4;
+  }
+  cost = hsum_sse41(acc);
+  for (; x < width; ++x)
+    cost += iabs2(src[x] - ref[x]);
+  return cost;
+}
+
+SSE41_INLINE int bisad_row_sse41(const imgpel *src, const imgpel *ref1, const imgpel *ref2, int width, const SIMDWeights *wp)
+{
+  const __m128i one = _mm_set1_epi16(1);
+  __m128i acc = _mm_setzero_si128(), avg;
+  int x = 0, cost;
+
+  for (; x + 8 <= width; x += 8)
+  {
+    avg = _mm_avg_epu16(load_pel8_16(ref1 + x), load_pel8_16(ref2 + x));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_abs_epi16(_mm_sub_epi16(load_pel8_16(src + x), avg)), one));
+  }
+  if (x + 4 <= width)
+  {
+    avg = _mm_avg_epu16(load_pel4_16(ref1 + x), load_pel4_16(ref2 + x));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_abs_epi16(_mm_sub_epi16(load_pel4_16(src + x), avg)), one));
+    x += 4;
+  }
+  cost = hsum_sse41(acc);
+  for (; x < width; ++x)
+    cost += iabs(src[x] - ((ref1[x] + ref2[x] + 1) >> 1));
+  return cost;
+}
+
+SSE41_INLINE int bisse_row_sse41(const imgpel *src, const imgpel *ref1, const imgpel *ref2, int width, const SIMDWeights *wp)
+{
+  __m128i acc = _mm_setzero_si128(), d;
+  int x = 0, cost;
+
+  for (; x + 8 <= width; x += 8)
+  {
+    d = _mm_sub_epi16(load_pel8_16(src + x), _mm_avg_epu16(load_pel8_16(ref1 + x), load_pel8_16(ref2 + x)));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(d, d));
+  }
+  if (x + 4 <= width)
+  {
+    d = _mm_sub_epi16(load_pel4_16(src + x), _mm_avg_epu16(load_pel4_16(ref1 + x), load_pel4_16(ref2 + x)));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(d, d));
+    x += 4;
+  }
+  cost = hsum_sse41(acc);
+  for (; x < width; ++x)
+    cost += iabs2(src[x] - ((ref1[x] + ref2[x] + 1) >> 1));
+  return cost;
+}
+
+SSE41_INLINE int sadwp_row_sse41(const imgpel *src, const imgpel *ref, int width, const SIMDWeights *wp)
+{
+  __m128i acc = _mm_setzero_si128();
+  int x = 0, cost;
+
+  for (; x + 4 <= width; x += 4)
+    acc = _mm_add_epi32(acc, _mm_abs_epi32(_mm_sub_epi32(load_pel4_32(src + x), wp_uni_sse41(load_pel4_32(ref + x), wp))));
+  cost = hsum_sse41(acc);
+  for (; x < width; ++x)
+    cost += iabs(src[x] - wp_uni_pel(ref[x], wp));
+  return cost;
+}
+
+SSE41_INLINE int ssewp_row_sse41(const imgpel *src, const imgpel *ref, int width, const SIMDWeights *wp)
+{
+  __m128i acc = _mm_setzero_si128(), d;
+  int x = 0, cost;
+
+  for (; x + 4 <= width; x += 4)
+  {
+    d = _mm_sub_epi32(load_pel4_32(src + x), wp_uni_sse41(load_pel4_32(ref + x), wp));
+    acc = _mm_add_epi32(acc, _mm_mullo_epi32(d, d));
+  }
+  cost = hsum_sse41(acc);
+  for (; x < width; ++x)
+    cost += iabs2(src[x] - wp_uni_pel(ref[x], wp));
+  return cost;
+}
+
+SSE41_INLINE int bisadwp_row_sse41(const imgpel *src, const imgpel *ref1, const imgpel *ref2, int width, const SIMDWeights *wp)
+{
+  __m128i acc = _mm_setzero_si128();
+  int x = 0, cost;
+
+  for (; x + 4 <= width; x += 4)
+    acc = _mm_add_epi32(acc, _mm_abs_epi32(_mm_sub_epi32(load_pel4_32(src + x), wp_bi_sse41(load_pel4_32(ref1 + x), load_pel4_32(ref2 + x), wp))));
+  cost = hsum_sse41(acc);
+  for (; x < width; ++x)
+    cost += iabs(src[x] - wp_bi_pel(ref1[x], ref2[x], wp));
+  return cost;
+}
+
+SSE41_INLINE int bissewp_row_sse41(const imgpel *src, const imgpel *ref1, const imgpel *ref2, int width, const SIMDWeights *wp)
+{
+  __m128i acc = _mm_setzero_si128(), d;
+  int x = 0, cost;
+
+  for (; x + 4 <= width; x += 4)
+  {
+    d = _mm_sub_epi32(load_pel4_32(src + x), wp_bi_sse41(load_pel4_32(ref1 + x), load_pel4_32(ref2 + x), wp));
+    acc = _mm_add_epi32(acc, _mm_mullo_epi32(d, d));
+  }
+  cost = hsum_sse41(acc);
+  for (; x < width; ++x)
+    cost += iabs2(src[x] - wp_bi_pel(ref1[x], ref2[x], wp));
+  return cost;
+}
+
+/*
+ * AVX2 row kernels: 16 pels (8 for weighted prediction) per step, the rest
+ * of the row goes through the SSE4.1 kernel.
+ */
+AVX2_INLINE int sad_row_avx2(const imgpel *src, const imgpel *ref, int width, const SIMDWeights *wp)
+{
+  const __m256i one = _mm256_set1_epi16(1);
+  __m256i acc = _mm256_setzero_si256();
+  int x = 0;
+
+  for (; x + 16 <= width; x += 16)
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_abs_epi16(_mm256_sub_epi16(load_pel16_16(src + x), load_pel16_16(ref + x))), one));
+  return hsum_avx2(acc) + (x < width ? sad_row_sse41(src + x, ref + x, width - x, wp) : 0);
+}
+
+AVX2_INLINE int sse_row_avx2(const imgpel *src, const imgpel *ref, int width, const SIMDWeights *wp)
+{
+  __m256i acc = _mm256_setzero_si256(), d;
+  int x = 0;
+
+  for (; x + 16 <= width; x += 16)
+  {
+    d = _mm256_sub_epi16(load_pel16_16(src + x), load_pel16_16(ref + x));
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(d, d));
+  }
+  return hsum_avx2(acc) + (x < width ? sse_row_sse41(src + x, ref + x, width - x, wp) : 0);
+}
+
+AVX2_INLINE int bisad_row_avx2(const imgpel *src, const imgpel *ref1, const imgpel *ref2, int width, const SIMDWeights *wp)
+{
+  const __m256i one = _mm256_set1_epi16(1);
+  __m256i acc = _mm256_setzero_si256(), avg;
+  int x = 0;
+
+  for (; x + 16 <= width; x += 16)
+  {
+    avg = _mm256_avg_epu16(load_pel16_16(ref1 + x), load_pel16_16(ref2 + x));
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_abs_epi16(_mm256_sub_epi16(load_pel16_16(src + x), avg)), one));
+  }
+  return hsum_avx2(acc) + (x < width ? bisad_row_sse41(src + x, ref1 + x, ref2 + x, width - x, wp) : 0);
+}
+
+AVX2_INLINE int bisse_row_avx2(const imgpel *src, const imgpel *ref1, const imgpel *ref2, int width, const SIMDWeights *wp)
+{
+  __m256i acc = _mm256_setzero_si256(), d;
+  int x = 0;
+
+  for (; x + 16 <= width; x += 16)
+  {
+    d = _mm256_sub_epi16(load_pel16_16(src + x), _mm256_avg_epu16(load_pel16_16(ref1 + x), load_pel16_16(ref2 + x)));
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(d, d));
+  }
+  return hsum_avx2(acc) + (x < width ? bisse_row_sse41(src + x, ref1 + x, ref2 + x, width - x, wp) : 0);
+}
+
+AVX2_INLINE int sadwp_row_avx2(const imgpel *src, const imgpel *ref, int width, const SIMDWeights *wp)
+{
+  __m256i acc = _mm256_setzero_si256();
+  int x = 0;
+
+  for (; x + 8 <= width; x += 8)
+    acc = _mm256_add_epi32(acc, _mm256_abs_epi32(_mm256_sub_epi32(load_pel8_32(src + x), wp_uni_avx2(load_pel8_32(ref + x), wp))));
+  return hsum_avx2(acc) + (x < width ? sadwp_row_sse41(src + x, ref + x, width - x, wp) : 0);
+}
+
+AVX2_INLINE int ssewp_row_avx2(const imgpel *src, const imgpel *ref, int width, const SIMDWeights *wp)
+{
+  __m256i acc = _mm256_setzero_si256(), d;
+  int x = 0;
+
+  for (; x + 8 <= width; x += 8)
+  {
+    d = _mm256_sub_epi32(load_pel8_32(src + x), wp_uni_avx2(load_pel8_32(ref + x), wp));
+    acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(d, d));
+  }
+  return hsum_avx2(acc) + (x < width ? ssewp_row_sse41(src + x, ref + x, width - x, wp) : 0);
+}
+
+AVX2_INLINE int bisadwp_row_avx2(const imgpel *src, const imgpel *ref1, const imgpel *ref2, int width, const SIMDWeights *wp)
+{
+  __m256i acc = _mm256_setzero_si256();
+  int x = 0;
+
+  for (; x + 8 <= width; x += 8)
+    acc = _mm256_add_epi32(acc, _mm256_abs_epi32(_mm256_sub_epi32(load_pel8_32(src + x), wp_bi_avx2(load_pel8_32(ref1 + x), load_pel8_32(ref2 + x), wp))));
+  return hsum_avx2(acc) + (x < width ? bisadwp_row_sse41(src + x, ref1 + x, ref2 + x, width - x, wp) : 0);
+}
+
+AVX2_INLINE int bissewp_row_avx2(const imgpel *src, const imgpel *ref1, const imgpel *ref2, int width, const SIMDWeights *wp)
+{
+  __m256i acc = _mm256_setzero_si256(), d;
+  int x = 0;
+
+  for (; x + 8 <= width; x += 8)
+  {
+    d = _mm256_sub_epi32(load_pel8_32(src + x), wp_bi_avx2(load_pel8_32(ref1 + x), load_pel8_32(ref2 + x), wp));
+    acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(d, d));
+  }
+  return hsum_avx2(acc) + (x < width ? bissewp_row_sse41(src + x, ref1 + x, ref2 + x, width - x, wp) : 0);
+}
+
+/*!
+************************************************************************
+* \brief
+*    Single list distortion of a block (luma, plus chroma when
+*    ChromaMEEnable is set), one row kernel call per row
+************************************************************************
+*/
+SIMD_INLINE distblk uni_block(StorablePicture *ref1, MEBlock *mv_block, distblk min_mcost, MotionVector *cand,
+                              UniRowFn row, int weighted)
+{
+  VideoParameters *p_Vid = mv_block->p_Vid;
+  Slice *currSlice = mv_block->p_Slice;
+  int imin_cost = dist_down(min_mcost);
+  int mcost = 0;
+  int y;
+  int blocksize_x = mv_block->blocksize_x;
+  int blocksize_y = mv_block->blocksize_y;
+  imgpel *src_line = mv_block->orig_pic[0];
+  imgpel *ref_line = UMVLine4X (ref1, cand->mv_y, cand->mv_x);
+  SIMDWeights wp = { 0, 0, 0, 0, 0, 0 };
+
+  if (weighted)
+  {
+    wp.w1     = mv_block->weight_luma;
+    wp.offset = mv_block->offset_luma;
+    wp.round  = currSlice->wp_luma_round;
+    wp.denom  = currSlice->luma_log_weight_denom;
+    wp.max    = p_Vid->max_imgpel_value;
+  }
+
+  for (y = 0; y < blocksize_y; y++)
+  {
+    mcost += row(src_line, ref_line, blocksize_x, &wp);
+    if(mcost > imin_cost)
+      return (dist_scale_f((distblk)mcost));
+    src_line += blocksize_x;
+    ref_line += p_Vid->padded_size_x;
+  }
+
+  if ( mv_block->ChromaMEEnable )
+  {
+    // calculate chroma conribution to motion compensation error
+    int blocksize_x_cr = mv_block->blocksize_cr_x;
+    int blocksize_y_cr = mv_block->blocksize_cr_y;
+    int k, mcr_cost;
+
+    for (k = 0; k < 2; k++)
+    {
+      if (weighted)
+      {
+        wp.w1     = mv_block->weight_cr[k];
+        wp.offset = mv_block->offset_cr[k];
+        wp.round  = currSlice->wp_chroma_round;
+        wp.denom  = currSlice->chroma_log_weight_denom;
+        wp.max    = p_Vid->max_pel_value_comp[1];
+      }
+      mcr_cost = 0;
+      src_line = mv_block->orig_pic[k+1];
+      ref_line = UMVLine8X_chroma ( ref1, k+1, cand->mv_y, cand->mv_x);
+      for (y = 0; y < blocksize_y_cr; y++)
+      {
+        mcr_cost += row(src_line, ref_line, blocksize_x_cr, &wp);
+        src_line += blocksize_x_cr;
+        ref_line += p_Vid->cr_padded_size_x;
+      }
+      mcost += mv_block->ChromaMEWeight * mcr_cost;
+
+      if(mcost > imin_cost)
+        return (dist_scale_f((distblk)mcost));
+    }
+  }
+
+  return (dist_scale((distblk)mcost));
+}
+
+/*!
+************************************************************************
+* \brief
+*    Bi-predictive distortion of a block, see uni_block()
+************************************************************************
+*/
+SIMD_INLINE distblk bi_block(StorablePicture *ref1, StorablePicture *ref2, MEBlock *mv_block, distblk min_mcost,
+                             MotionVector *cand1, MotionVector *cand2, BiRowFn row, int weighted)
+{
+  VideoParameters *p_Vid = mv_block->p_Vid;
+  Slice *currSlice = mv_block->p_Slice;
+  int imin_cost = dist_down(min_mcost);
+  int mcost = 0;
+  int y;
+  int blocksize_x = mv_block->blocksize_x;
+  int blocksize_y = mv_block->blocksize_y;
+  imgpel *src_line  = mv_block->orig_pic[0];
+  imgpel *ref2_line = UMVLine4X(ref2, cand2->mv_y, cand2->mv_x);
+  imgpel *ref1_line = UMVLine4X(ref1, cand1->mv_y, cand1->mv_x);
+  SIMDWeights wp = { 0, 0, 0, 0, 0, 0 };
+
+  if (weighted)
+  {
+    // chroma uses the luma rounding and denominator as in computeBiPredSAD2
+    wp.w1     = mv_block->weight1;
+    wp.w2     = mv_block->weight2;
+    wp.offset = mv_block->offsetBi;
+    wp.round  = 2 * currSlice->wp_luma_round;
+    wp.denom  = currSlice->luma_log_weight_denom + 1;
+    wp.max    = p_Vid->max_imgpel_value;
+  }
+
+  for (y = 0; y < blocksize_y; y++)
+  {
+    mcost += row(src_line, ref1_line, ref2_line, blocksize_x, &wp);
+    if(mcost > imin_cost)
+      return (dist_scale_f((distblk)mcost));
+    src_line  += blocksize_x;
+    ref1_line += p_Vid->padded_size_x;
+    ref2_line += p_Vid->padded_size_x;
+  }
+
+  if ( mv_block->ChromaMEEnable )
+  {
+    // calculate chroma conribution to motion compensation error
+    int blocksize_x_cr = mv_block->blocksize_cr_x;
+    int blocksize_y_cr = mv_block->blocksize_cr_y;
+    int k, mcr_cost;
+
+    for (k = 0; k < 2; k++)
+    {
+      if (weighted)
+      {
+        wp.w1     = mv_block->weight1_cr[k];
+        wp.w2     = mv_block->weight2_cr[k];
+        wp.offset = mv_block->offsetBi_cr[k];
+        wp.max    = p_Vid->max_pel_value_comp[1];
+      }
+      mcr_cost = 0;
+      src_line  = mv_block->orig_pic[k+1];
+      ref2_line = UMVLine8X_chroma ( ref2, k+1, cand2->mv_y, cand2->mv_x);
+      ref1_line = UMVLine8X_chroma ( ref1, k+1, cand1->mv_y, cand1->mv_x);
+      for (y = 0; y < blocksize_y_cr; y++)
+      {
+        mcr_cost += row(src_line, ref1_line, ref2_line, blocksize_x_cr, &wp);
+        src_line  += blocksize_x_cr;
+        ref1_line += p_Vid->cr_padded_size_x;
+        ref2_line += p_Vid->cr_padded_size_x;
+      }
+      mcost += mv_block->ChromaMEWeight * mcr_cost;
+
+      if(mcost > imin_cost)
+        return (dist_scale_f((distblk)mcost));
+    }
+  }
+
+  return (dist_scale((distblk)mcost));
+}
+
+/*
+ * Hadamard SATD, AVX2 only. The residual is formed directly from the source
+ * and prediction rows in 32-bit lanes (no diff[] buffer), which is exact for
+ * every bit depth. The butterfly order differs from HadamardSAD4x4/8x8, but
+ * the transform coefficients only differ in order and sign, so the sums of
+ * their magnitudes are identical.
+ */
+#define SATD_UNI    0  //!< src - ref1
+#define SATD_UNIWP  1  //!< src - weighted ref1
+#define SATD_BI     2  //!< src - average of ref1 and ref2
+#define SATD_BIWP   3  //!< src - weighted bi-prediction
+
+AVX2_INLINE __m128i residual4_avx2(const imgpel *src, const imgpel *ref1, const imgpel *ref2, int mode, const SIMDWeights *wp)
+{
+  __m128i pred = load_pel4_32(ref1);
+
+  if (mode == SATD_UNIWP)
+    pred = wp_uni_sse41(pred, wp);
+  else if (mode == SATD_BI)
+    pred = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(pred, load_pel4_32(ref2)), _mm_set1_epi32(1)), 1);
+  else if (mode == SATD_BIWP)
+    pred = wp_bi_sse41(pred, load_pel4_32(ref2), wp);
+  return _mm_sub_epi32(load_pel4_32(src), pred);
+}
+
+AVX2_INLINE __m256i residual8_avx2(const imgpel *src, const imgpel *ref1, const imgpel *ref2, int mode, const SIMDWeights *wp)
+{
+  __m256i pred = load_pel8_32(ref1);
+
+  if (mode == SATD_UNIWP)
+    pred = wp_uni_avx2(pred, wp);
+  else if (mode == SATD_BI)
+    pred = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(pred, load_pel8_32(ref2)), _mm256_set1_epi32(1)), 1);
+  else if (mode == SATD_BIWP)
+    pred = wp_bi_avx2(pred, load_pel8_32(ref2), wp);
+  return _mm256_sub_epi32(load_pel8_32(src), pred);
+}
+
+//! 4-point Hadamard across the rows r[0..3] (each lane is one column)
+AVX2_INLINE void hadamard4_x4(__m128i *r)
+{
+  __m128i a0 = _mm_add_epi32(r[0], r[1]), a1 = _mm_sub_epi32(r[0], r[1]);
+  __m128i a2 = _mm_add_epi32(r[2], r[3]), a3 = _mm_sub_epi32(r[2], r[3]);
+
+  r[0] = _mm_add_epi32(a0, a2);
+  r[1] = _mm_add_epi32(a1, a3);
+  r[2] = _mm_sub_epi32(a0, a2);
+  r[3] = _mm_sub_epi32(a1, a3);
+}
+
+AVX2_INLINE void transpose4_x4(__m128i *r)
+{
+  __m128i t0 = _mm_unpacklo_epi32(r[0], r[1]), t1 = _mm_unpacklo_epi32(r[2], r[3]);
+  __m128i t2 = _mm_unpackhi_epi32(r[0], r[1]), t3 = _mm_unpackhi_epi32(r[2], r[3]);
+
+  r[0] = _mm_unpacklo_epi64(t0, t1);
+  r[1] = _mm_unpackhi_epi64(t0, t1);
+  r[2] = _mm_unpacklo_epi64(t2, t3);
+  r[3] = _mm_unpackhi_epi64(t2, t3);
+}
+
+//! Same as HadamardSAD4x4() on the residual rows r[0..3]
+AVX2_INLINE int satd4x4_avx2(__m128i *r)
+{
+  __m128i sum;
+
+  hadamard4_x4(r);
+  transpose4_x4(r);
+  hadamard4_x4(r);
+  sum = _mm_add_epi32(_mm_add_epi32(_mm_abs_epi32(r[0]), _mm_abs_epi32(r[1])),
+                      _mm_add_epi32(_mm_abs_epi32(r[2]), _mm_abs_epi32(r[3])));
+  return (hsum_sse41(sum) + 1) >> 1;
+}
+
+/*!
+ * Two horizontally adjacent 4x4 blocks, one per 128-bit lane (the unpack
+ * instructions work within lanes). Returns the SATD of both.
+ */
+AVX2_INLINE void satd4x4x2_avx2(__m256i *r, int *satd_a, int *satd_b)
+{
+  __m256i a0 = _mm256_add_epi32(r[0], r[1]), a1 = _mm256_sub_epi32(r[0], r[1]);
+  __m256i a2 = _mm256_add_epi32(r[2], r[3]), a3 = _mm256_sub_epi32(r[2], r[3]);
+  __m256i t0, t1, t2, t3, sum;
+
+  r[0] = _mm256_add_epi32(a0, a2);
+  r[1] = _mm256_add_epi32(a1, a3);
+  r[2] = _mm256_sub_epi32(a0, a2);
+  r[3] = _mm256_sub_epi32(a1, a3);
+
+  t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+  t1 = _mm256_unpacklo_epi32(r[2], r[3]);
+  t2 = _mm256_unpackhi_epi32(r[0], r[1]);
+  t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+  r[0] = _mm256_unpacklo_epi64(t0, t1);
+  r[1] = _mm256_unpackhi_epi64(t0, t1);
+  r[2] = _mm256_unpacklo_epi64(t2, t3);
+  r[3] = _mm256_unpackhi_epi64(t2, t3);
+
+  a0 = _mm256_add_epi32(r[0], r[1]);
+  a1 = _mm256_sub_epi32(r[0], r[1]);
+  a2 = _mm256_add_epi32(r[2], r[3]);
+  a3 = _mm256_sub_epi32(r[2], r[3]);
+  sum = _mm256_add_epi32(_mm256_add_epi32(_mm256_abs_epi32(_mm256_add_epi32(a0, a2)), _mm256_abs_epi32(_mm256_add_epi32(a1, a3))),
+                         _mm256_add_epi32(_mm256_abs_epi32(_mm256_sub_epi32(a0, a2)), _mm256_abs_epi32(_mm256_sub_epi32(a1, a3))));
+
+  *satd_a = (hsum_sse41(_mm256_castsi256_si128(sum)) + 1) >> 1;
+  *satd_b = (hsum_sse41(_mm256_extracti128_si256(sum, 1)) + 1) >> 1;
+}
+
+//! 8-point Hadamard across the rows r[0..7]
+AVX2_INLINE void hadamard8_x8(__m256i *r)
+{
+  __m256i t[8];
+  int i;
+
+  for (i = 0; i < 8; i += 2)
+  {
+    t[i]     = _mm256_add_epi32(r[i], r[i + 1]);
+    t[i + 1] = _mm256_sub_epi32(r[i], r[i + 1]);
+  }
+  for (i = 0; i < 8; i += 4)
+  {
+    r[i]     = _mm256_add_epi32(t[i],     t[i + 2]);
+    r[i + 1] = _mm256_add_epi32(t[i + 1], t[i + 3]);
+    r[i + 2] = _mm256_sub_epi32(t[i],     t[i + 2]);
+    r[i + 3] = _mm256_sub_epi32(t[i + 1], t[i + 3]);
+  }
+  for (i = 0; i < 4; ++i)
+  {
+    t[i]     = _mm256_add_epi32(r[i], r[i + 4]);
+    t[i + 4] = _mm256_sub_epi32(r[i], r[i + 4]);
+  }
+  for (i = 0; i < 8; ++i)
+    r[i] = t[i];
+}
+
+AVX2_INLINE void transpose8_x8(__m256i *r)
+{
+  __m256i t[8], u[8];
+  int i;
+
+  for (i = 0; i < 8; i += 2)
+  {
+    t[i]     = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+    t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+  }
+  for (i = 0; i < 8; i += 4)
+  {
+    u[i]     = _mm256_unpacklo_epi64(t[i],     t[i + 2]);
+    u[i + 1] = _mm256_unpackhi_epi64(t[i],     t[i + 2]);
+    u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+    u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+  }
+  for (i = 0; i < 4; ++i)
+  {
+    r[i]     = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+    r[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+  }
+}
+
+//! Same as HadamardSAD8x8() on the residual rows r[0..7]
+AVX2_INLINE int satd8x8_avx2(__m256i *r)
+{
+  __m256i sum;
+  int i;
+
+  hadamard8_x8(r);
+  transpose8_x8(r);
+  hadamard8_x8(r);
+  sum = _mm256_abs_epi32(r[0]);
+  for (i = 1; i < 8; ++i)
+    sum = _mm256_add_epi32(sum, _mm256_abs_epi32(r[i]));
+  return (hsum_avx2(sum) + 2) >> 2;
+}
+
+/*!
+************************************************************************
+* \brief
+*    SATD of a luma block as in computeSATD() and its WP / BiPred
+*    variants: 4x4 or 8x8 transforms depending on test8x8, with the
+*    running cost checked against min_mcost after every transform block.
+*    Pairs of 4x4 blocks and whole 8x8 blocks are transformed at once;
+*    a 16x16 partition is four batched 8x8 transforms.
+************************************************************************
+*/
+AVX2_INLINE distblk satd_block_avx2(StorablePicture *ref1, StorablePicture *ref2, MEBlock *mv_block, distblk min_mcost,
+                                    MotionVector *cand1, MotionVector *cand2, int mode)
+{
+  VideoParameters *p_Vid = mv_block->p_Vid;
+  Slice *currSlice = mv_block->p_Slice;
+  int imin_cost = dist_down(min_mcost);
+  int mcost = 0;
+  int x, y, i;
+  int blocksize_x = mv_block->blocksize_x;
+  int blocksize_y = mv_block->blocksize_y;
+  int stride = p_Vid->padded_size_x;
+  const imgpel *src_tmp = mv_block->orig_pic[0];
+  const imgpel *src_line, *ref1_line, *ref2_line = NULL;
+  SIMDWeights wp = { 0, 0, 0, 0, 0, 0 };
+
+  if (mode == SATD_UNIWP)
+  {
+    wp.w1     = mv_block->weight_luma;
+    wp.offset = mv_block->offset_luma;
+    wp.round  = currSlice->wp_luma_round;
+    wp.denom  = currSlice->luma_log_weight_denom;
+    wp.max    = p_Vid->max_imgpel_value;
+  }
+  else if (mode == SATD_BIWP)
+  {
+    wp.w1     = mv_block->weight1;
+    wp.w2     = mv_block->weight2;
+    wp.offset = mv_block->offsetBi;
+    wp.round  = 2 * currSlice->wp_luma_round;
+    wp.denom  = currSlice->luma_log_weight_denom + 1;
+    wp.max    = p_Vid->max_imgpel_value;
+  }
+
+  if ( !mv_block->test8x8 )
+  { // 4x4 TRANSFORM
+    for (y = 0; y < (blocksize_y << 2); y += BLOCK_SIZE_SP)
+    {
+      for (x = 0; x < blocksize_x; x += 2 * BLOCK_SIZE)
+      {
+        const imgpel *ref1_b, *ref2_b = NULL, *src_b;
+
+        src_line  = src_tmp + x;
+        ref1_line = UMVLine4X(ref1, cand1->mv_y + y, cand1->mv_x + (x << 2));
+        if (mode >= SATD_BI)
+          ref2_line = UMVLine4X(ref2, cand2->mv_y + y, cand2->mv_x + (x << 2));
+
+        if (x + BLOCK_SIZE == blocksize_x)
+        {
+          __m128i r[4];
+          for (i = 0; i < BLOCK_SIZE; ++i)
+            r[i] = residual4_avx2(src_line + i * blocksize_x, ref1_line + i * stride,
+                                  ref2_line + i * stride, mode, &wp);
+          mcost += satd4x4_avx2(r);
+          if(mcost > imin_cost)
+            return dist_scale_f((distblk)mcost);
+        }
+        else
+        {
+          // the second block gets its own (possibly clipped) reference lines, as in the C code
+          __m256i r[4];
+          int satd_a, satd_b;
+
+          src_b  = src_line + BLOCK_SIZE;
+          ref1_b = UMVLine4X(ref1, cand1->mv_y + y, cand1->mv_x + ((x + BLOCK_SIZE) << 2));
+          if (mode >= SATD_BI)
+            ref2_b = UMVLine4X(ref2, cand2->mv_y + y, cand2->mv_x + ((x + BLOCK_SIZE) << 2));
+          for (i = 0; i < BLOCK_SIZE; ++i)
+          {
+            __m128i a = residual4_avx2(src_line + i * blocksize_x, ref1_line + i * stride, ref2_line + i * stride, mode, &wp);
+            __m128i b = residual4_avx2(src_b    + i * blocksize_x, ref1_b    + i * stride, ref2_b    + i * stride, mode, &wp);
+            r[i] = _mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1);
+          }
+          satd4x4x2_avx2(r, &satd_a, &satd_b);
+          mcost += satd_a;
+          if(mcost > imin_cost)
+            return dist_scale_f((distblk)mcost);
+          mcost += satd_b;
+          if(mcost > imin_cost)
+            return dist_scale_f((distblk)mcost);
+        }
+      }
+      src_tmp += blocksize_x * BLOCK_SIZE;
+    }
+  }
+  else
+  { // 8x8 TRANSFORM
+    for (y = 0; y < (blocksize_y << 2); y += BLOCK_SIZE_8x8_SP)
+    {
+      for (x = 0; x < blocksize_x; x += BLOCK_SIZE_8x8)
+      {
+        __m256i r[8];
+
+        src_line  = src_tmp + x;
+        ref1_line = UMVLine4X(ref1, cand1->mv_y + y, cand1->mv_x + (x << 2));
+        if (mode >= SATD_BI)
+          ref2_line = UMVLine4X(ref2, cand2->mv_y + y, cand2->mv_x + (x << 2));
+        for (i = 0; i < BLOCK_SIZE_8x8; ++i)
+          r[i] = residual8_avx2(src_line + i * blocksize_x, ref1_line + i * stride, ref2_line + i * stride, mode, &wp);
+        mcost += satd8x8_avx2(r);
+        if(mcost > imin_cost)
+          return dist_scale_f((distblk)mcost);
+      }
+      src_tmp += blocksize_x * BLOCK_SIZE_8x8;
+    }
+  }
+
+  return dist_scale((distblk)mcost);
+}
+
+AVX2 static distblk computeSATD_avx2(StorablePicture *ref1, MEBlock *mv_block, distblk min_mcost, MotionVector *cand)
+{ return satd_block_avx2(ref1, NULL, mv_block, min_mcost, cand, NULL, SATD_UNI); }
+AVX2 static distblk computeSATDWP_avx2(StorablePicture *ref1, MEBlock *mv_block, distblk min_mcost, MotionVector *cand)
+{ return satd_block_avx2(ref1, NULL, mv_block, min_mcost, cand, NULL, SATD_UNIWP); }
+AVX2 static distblk computeBiPredSATD1_avx2(StorablePicture *ref1, StorablePicture *ref2, MEBlock *mv_block,
+                                            distblk min_mcost, MotionVector *cand1, MotionVector *cand2)
+{ return satd_block_avx2(ref1, ref2, mv_block, min_mcost, cand1, cand2, SATD_BI); }
+AVX2 static distblk computeBiPredSATD2_avx2(StorablePicture *ref1, StorablePicture *ref2, MEBlock *mv_block,
+                                            distblk min_mcost, MotionVector *cand1, MotionVector *cand2)
+{ return satd_block_avx2(ref1, ref2, mv_block, min_mcost, cand1, cand2, SATD_BIWP); }
+
+/*
+ * Mode decision distortion on an already computed diff[] block
+ * (p_Vid->distortion4x4 / distortion8x8)
+ */
+AVX2 static distblk distortion4x4SATD_avx2(short *diff, distblk min_dist)
+{
+  __m128i r[4];
+  int i;
+
+  for (i = 0; i < 4; ++i)
+    r[i] = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *) (diff + 4 * i)));
+  return dist_scale((distblk) satd4x4_avx2(r));
+}
+
+AVX2 static distblk distortion8x8SATD_avx2(short *diff, distblk min_dist)
+{
+  __m256i r[8];
+  int i;
+
+  for (i = 0; i < 8; ++i)
+    r[i] = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) (diff + 8 * i)));
+  return dist_scale((distblk) satd8x8_avx2(r));
+}
+
+/*
+ * Entry points with the computeUniPred / computeBiPred signatures
+ */
+#define DISTORTION_SIMD_FUNCS(isa, ATTR)                                                                                \
+ATTR static distblk computeSAD_##isa(StorablePicture *ref1, MEBlock *mv_block, distblk min_mcost, MotionVector *cand)   \
+{ return uni_block(ref1, mv_block, min_mcost, cand, sad_row_##isa, 0); }                                                \
+ATTR static distblk computeSADWP_##isa(StorablePicture *ref1, MEBlock *mv_block, distblk min_mcost, MotionVector *cand) \
+{ return uni_block(ref1, mv_block, min_mcost, cand, sadwp_row_##isa, 1); }                                              \
+ATTR static distblk computeSSE_##isa(StorablePicture *ref1, MEBlock *mv_block, distblk min_mcost, MotionVector *cand)   \
+{ return uni_block(ref1, mv_block, min_mcost, cand, sse_row_##isa, 0); }                                                \
+ATTR static distblk computeSSEWP_##isa(StorablePicture *ref1, MEBlock *mv_block, distblk min_mcost, MotionVector *cand) \
+{ return uni_block(ref1, mv_block, min_mcost, cand, ssewp_row_##isa, 1); }                                              \
+ATTR static distblk computeBiPredSAD1_##isa(StorablePicture *ref1, StorablePicture *ref2, MEBlock *mv_block,            \
+                                            distblk min_mcost, MotionVector *cand1, MotionVector *cand2)                \
+{ return bi_block(ref1, ref2, mv_block, min_mcost, cand1, cand2, bisad_row_##isa, 0); }                                 \
+ATTR static distblk computeBiPredSAD2_##isa(StorablePicture *ref1, StorablePicture *ref2, MEBlock *mv_block,            \
+                                            distblk min_mcost, MotionVector *cand1, MotionVector *cand2)                \
+{ return bi_block(ref1, ref2, mv_block, min_mcost, cand1, cand2, bisadwp_row_##isa, 1); }                               \
+ATTR static distblk computeBiPredSSE1_##isa(StorablePicture *ref1, StorablePicture *ref2, MEBlock *mv_block,            \
+                                            distblk min_mcost, MotionVector *cand1, MotionVector *cand2)                \
+{ return bi_block(ref1, ref2, mv_block, min_mcost, cand1, cand2, bisse_row_##isa, 0); }                                 \
+ATTR static distblk computeBiPredSSE2_##isa(StorablePicture *ref1, StorablePicture *ref2, MEBlock *mv_block,            \
+                                            distblk min_mcost, MotionVector *cand1, MotionVector *cand2)                \
+{ return bi_block(ref1, ref2, mv_block, min_mcost, cand1, cand2, bissewp_row_##isa, 1); }
+
+DISTORTION_SIMD_FUNCS(sse41, SSE41)
+DISTORTION_SIMD_FUNCS(avx2,  AVX2)
+
+// SSE2 has no 32-bit multiply for weighted prediction; those stay in C
+SSE2 static distblk computeSAD_sse2(StorablePicture *ref1, MEBlock *mv_block, distblk min_mcost, MotionVector *cand)
+{ return uni_block(ref1, mv_block, min_mcost, cand, sad_row_sse2, 0); }
+SSE2 static distblk computeSSE_sse2(StorablePicture *ref1, MEBlock *mv_block, distblk min_mcost, MotionVector *cand)
+{ return uni_block(ref1, mv_block, min_mcost, cand, sse_row_sse2, 0); }
+SSE2 static distblk computeBiPredSAD1_sse2(StorablePicture *ref1, StorablePicture *ref2, MEBlock *mv_block,
+                                           distblk min_mcost, MotionVector *cand1, MotionVector *cand2)
+{ return bi_block(ref1, ref2, mv_block, min_mcost, cand1, cand2, bisad_row_sse2, 0); }
+SSE2 static distblk computeBiPredSSE1_sse2(StorablePicture *ref1, StorablePicture *ref2, MEBlock *mv_block,
+                                           distblk min_mcost, MotionVector *cand1, MotionVector *cand2)
+{ return bi_block(ref1, ref2, mv_block, min_mcost, cand1, cand2, bisse_row_sse2, 0); }
+
+//! Per block sums of the 32-bit lanes (a, b, c, d): (a + b, c + d, a + b, c + d)
+SSE2_INLINE __m128i pair_sums_sse2(__m128i v)
+{
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+/*!
+************************************************************************
+* \brief
+*    SSE2 version of sad4x4_row_avx2()
+************************************************************************
+*/
+SSE2 static void sad4x4_row_sse2(imgpel *src, int src_stride, imgpel *ref, int ref_stride, int n, int *sad)
+{
+  const __m128i one = _mm_set1_epi16(1);
+  __m128i acc = _mm_setzero_si128(), acc2 = _mm_setzero_si128();
+  int y;
+
+  if (n == 1)
+  {
+    for (y = 0; y < 4; ++y, src += src_stride, ref += ref_stride)
+      acc = _mm_add_epi32(acc, _mm_madd_epi16(absdiff16_sse2(load_pel4_16_sse2(src), load_pel4_16_sse2(ref)), one));
+    sad[0] = hsum_sse2(acc);
+    return;
+  }
+
+  for (y = 0; y < 4; ++y, src += src_stride, ref += ref_stride)
+  {
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(absdiff16_sse2(load_pel8_16_sse2(src), load_pel8_16_sse2(ref)), one));
+    if (n == 4)
+      acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(absdiff16_sse2(load_pel8_16_sse2(src + 8), load_pel8_16_sse2(ref + 8)), one));
+  }
+  if (n == 4)
+    _mm_storeu_si128((__m128i *) sad, _mm_unpacklo_epi64(pair_sums_sse2(acc), pair_sums_sse2(acc2)));
+  else
+    _mm_storel_epi64((__m128i *) sad, pair_sums_sse2(acc));
+}
+
+/*!
+************************************************************************
+* \brief
+*    SADs of n (1, 2 or 4) horizontally adjacent 4x4 blocks for the SAD
+*    cache: one pass over a 4, 8 or 16 pel wide strip, summed per block.
+************************************************************************
+*/
+AVX2 static void sad4x4_row_avx2(imgpel *src, int src_stride, imgpel *ref, int ref_stride, int n, int *sad)
+{
+  int y;
+
+  if (n == 4)
+  {
+    const __m256i one = _mm256_set1_epi16(1);
+    __m256i acc = _mm256_setzero_si256();
+
+    for (y = 0; y < 4; ++y, src += src_stride, ref += ref_stride)
+      acc = _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_abs_epi16(_mm256_sub_epi16(load_pel16_16(src), load_pel16_16(ref))), one));
+    // per 128 bit lane: (b0, b1, b0, b1) and (b2, b3, b2, b3)
+    acc = _mm256_hadd_epi32(acc, acc);
+    acc = _mm256_permute4x64_epi64(acc, _MM_SHUFFLE(3, 1, 2, 0));
+    _mm_storeu_si128((__m128i *) sad, _mm256_castsi256_si128(acc));
+  }
+  else
+  {
+    const __m128i one = _mm_set1_epi16(1);
+    __m128i acc = _mm_setzero_si128();
+
+    if (n == 2)
+    {
+      for (y = 0; y < 4; ++y, src += src_stride, ref += ref_stride)
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_abs_epi16(_mm_sub_epi16(load_pel8_16(src), load_pel8_16(ref))), one));
+      acc = _mm_hadd_epi32(acc, acc);
+      _mm_storel_epi64((__m128i *) sad, acc);
+    }
+    else
+    {
+      for (y = 0; y < 4; ++y, src += src_stride, ref += ref_stride)
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_abs_epi16(_mm_sub_epi16(load_pel4_16(src), load_pel4_16(ref))), one));
+      acc = _mm_hadd_epi32(acc, acc);
+      sad[0] = _mm_cvtsi128_si32(acc);
+    }
+  }
+}
+
+/*!
+************************************************************************
+* \brief
+*    Highest SIMD level supported by the CPU
+************************************************************************
+*/
+int get_simd_level(void)
+{
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return SIMD_AVX2;
+  if (__builtin_cpu_supports("sse4.1"))
+    return SIMD_SSE41;
+  if (__builtin_cpu_supports("sse2"))
+    return SIMD_SSE2;
+  return SIMD_NONE;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Replace the C SAD, SSE and SATD functions of a DPB layer by their
+*    SIMD versions. computeUniPred[] and computeBiPred1/2[] are assigned
+*    from these pointers. SATD needs AVX2, weighted prediction SSE4.1.
+************************************************************************
+*/
+void init_distortion_simd(DecodedPictureBuffer *p_Dpb)
+{
+  int level = get_simd_level();
+
+  if (level == SIMD_AVX2)
+  {
+    p_Dpb->pf_computeSAD        = computeSAD_avx2;
+    p_Dpb->pf_computeSADWP      = computeSADWP_avx2;
+    p_Dpb->pf_computeBiPredSAD1 = computeBiPredSAD1_avx2;
+    p_Dpb->pf_computeBiPredSAD2 = computeBiPredSAD2_avx2;
+    p_Dpb->pf_computeSSE        = computeSSE_avx2;
+    p_Dpb->pf_computeSSEWP      = computeSSEWP_avx2;
+    p_Dpb->pf_computeBiPredSSE1 = computeBiPredSSE1_avx2;
+    p_Dpb->pf_computeBiPredSSE2 = computeBiPredSSE2_avx2;
+    p_Dpb->pf_computeSATD        = computeSATD_avx2;
+    p_Dpb->pf_computeSATDWP      = computeSATDWP_avx2;
+    p_Dpb->pf_computeBiPredSATD1 = computeBiPredSATD1_avx2;
+    p_Dpb->pf_computeBiPredSATD2 = computeBiPredSATD2_avx2;
+  }
+  else if (level == SIMD_SSE41)
+  {
+    p_Dpb->pf_computeSAD        = computeSAD_sse41;
+    p_Dpb->pf_computeSADWP      = computeSADWP_sse41;
+    p_Dpb->pf_computeBiPredSAD1 = computeBiPredSAD1_sse41;
+    p_Dpb->pf_computeBiPredSAD2 = computeBiPredSAD2_sse41;
+    p_Dpb->pf_computeSSE        = computeSSE_sse41;
+    p_Dpb->pf_computeSSEWP      = computeSSEWP_sse41;
+    p_Dpb->pf_computeBiPredSSE1 = computeBiPredSSE1_sse41;
+    p_Dpb->pf_computeBiPredSSE2 = computeBiPredSSE2_sse41;
+  }
+  else if (level == SIMD_SSE2)
+  {
+    p_Dpb->pf_computeSAD        = computeSAD_sse2;
+    p_Dpb->pf_computeBiPredSAD1 = computeBiPredSAD1_sse2;
+    p_Dpb->pf_computeSSE        = computeSSE_sse2;
+    p_Dpb->pf_computeBiPredSSE1 = computeBiPredSSE1_sse2;
+  }
+}
+
+/*!
+************************************************************************
+* \brief
+*    Use the AVX2 Hadamard transforms for the SATD mode decision metric
+************************************************************************
+*/
+void select_distortion_simd(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  if (p_Vid->distortion4x4 == distortion4x4SATD && get_simd_level() == SIMD_AVX2)
+  {
+    p_Vid->distortion4x4 = distortion4x4SATD_avx2;
+    p_Vid->distortion8x8 = distortion8x8SATD_avx2;
+  }
+}
+
+/*!
+************************************************************************
+* \brief
+*    SIMD 4x4 SAD rows for the partition SAD cache (me_sadcache.c)
+************************************************************************
+*/
+void select_sadcache_simd(SADCache *p_cache)
+{
+  int level = get_simd_level();
+
+  if (level == SIMD_AVX2)
+    p_cache->sad4x4_row = sad4x4_row_avx2;
+  else if (level != SIMD_NONE)
+    p_cache->sad4x4_row = sad4x4_row_sse2;
+}
+
+#else
+
+int get_simd_level(void)
+{
+  return SIMD_NONE;
+}
+
+void init_distortion_simd(DecodedPictureBuffer *p_Dpb)
+{
+}
+
+void select_distortion_simd(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+}
+
+void select_sadcache_simd(SADCache *p_cache)
+{
+}
+
+#endif
@@ -438,6 +438,7 @@ EPZSStructInit (Slice * currSlice)
     1) << 2 : (2 * p_Inp->search_range[p_Vid->view_id] + 1) << 2;
   p_EPZS->p_Vid = p_Vid;
   p_EPZS->BlkCount = 1;
+  p_EPZS->searcharray = searcharray;
 
   //! In this implementation we keep threshold limits fixed.
   //! However one could adapt these limits based on lagrangian
@@ -609,6 +610,117 @@ EPZSStructDelete (Slice * currSlice)
   currSlice->p_EPZS = NULL;
 }
 
+/*!
+************************************************************************
+* \brief
+*    Sets up the EPZS structure of a slice copy. The copy has its own
+*    predictor list, search map and distortion and spatial memory, and
+*    shares the window predictors and co-located data of p_src.
+************************************************************************
+*/
+int
+EPZSStructCopy (Slice * currSlice, EPZSParameters * p_src)
+{
+  VideoParameters *p_Vid = currSlice->p_Vid;
+  InputParameters *p_Inp = currSlice->p_Inp;
+  EPZSParameters *p_EPZS;
+  int max_list_number = p_Vid->mb_aff_frame_flag ? 6 : 2;
+  int memory_size = 0;
+
+  if ((p_EPZS = (EPZSParameters *) malloc (sizeof (EPZSParameters))) == NULL)
+    no_mem_exit ("EPZSStructCopy: p_EPZS");
+  *p_EPZS = *p_src;
+  p_EPZS->p_Vid = p_Vid;
+  p_EPZS->predictor = allocEPZSpattern (p_src->predictor->searchPoints);
+  memory_size += get_mem2Dshort ((short ***) &(p_EPZS->EPZSMap), p_EPZS->searcharray, p_EPZS->searcharray);
+
+  memory_size += get_mem3Ddistblk (&(p_EPZS->distortion), max_list_number, 7, (p_Vid->width + MB_BLOCK_SIZE)/ BLOCK_SIZE);
+  if (p_Inp->BiPredMotionEstimation)
+    memory_size += get_mem3Ddistblk (&(p_EPZS->bi_distortion), max_list_number, 7, (p_Vid->width + MB_BLOCK_SIZE) / BLOCK_SIZE);
+  memory_size += get_mem3Ddistblk (&(p_EPZS->distortion_hpel), max_list_number, 7, (p_Vid->width + MB_BLOCK_SIZE)/ BLOCK_SIZE);
+
+  if (p_Inp->EPZSSpatialMem)
+  {
+#if EPZSREF
+    memory_size += get_mem5Dmv (&(p_EPZS->p_motion), 6, p_Vid->max_num_references, 7, 4, p_Vid->width / BLOCK_SIZE);
+#else 
+    memory_size += get_mem4Dmv (&(p_EPZS->p_motion), 6, 7, 4, p_Vid->width / BLOCK_SIZE);
+#endif
+  }
+
+  currSlice->p_EPZS = p_EPZS;
+  EPZSResetMemory (currSlice);
+
+  return memory_size;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Clears the search map, distortion and spatial memory of the EPZS
+*    structure of a slice copy, as at the start of a slice
+************************************************************************
+*/
+void
+EPZSResetMemory (Slice * currSlice)
+{
+  VideoParameters *p_Vid = currSlice->p_Vid;
+  InputParameters *p_Inp = currSlice->p_Inp;
+  EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  int max_list_number = p_Vid->mb_aff_frame_flag ? 6 : 2;
+  int dist_size = max_list_number * 7 * ((p_Vid->width + MB_BLOCK_SIZE)/ BLOCK_SIZE) * sizeof (distblk);
+
+  memset (&p_EPZS->EPZSMap[0][0], 0, p_EPZS->searcharray * p_EPZS->searcharray * sizeof (uint16));
+  p_EPZS->BlkCount = 1;
+
+  memset (&p_EPZS->distortion[0][0][0], 0, dist_size);
+  if (p_Inp->BiPredMotionEstimation)
+    memset (&p_EPZS->bi_distortion[0][0][0], 0, dist_size);
+  memset (&p_EPZS->distortion_hpel[0][0][0], 0, dist_size);
+
+  if (p_Inp->EPZSSpatialMem)
+  {
+#if EPZSREF
+    memset (&p_EPZS->p_motion[0][0][0][0][0], 0, 6 * p_Vid->max_num_references * 7 * 4 * (p_Vid->width / BLOCK_SIZE) * sizeof (MotionVector));
+#else 
+    memset (&p_EPZS->p_motion[0][0][0][0], 0, 6 * 7 * 4 * (p_Vid->width / BLOCK_SIZE) * sizeof (MotionVector));
+#endif
+  }
+}
+
+/*!
+************************************************************************
+* \brief
+*    Frees the EPZS structure of a slice copy
+************************************************************************
+*/
+void
+EPZSStructCopyDelete (Slice * currSlice)
+{
+  InputParameters *p_Inp = currSlice->p_Inp;
+  EPZSParameters *p_EPZS = currSlice->p_EPZS;
+
+  free_mem2Dshort ((short **) p_EPZS->EPZSMap);
+  free_mem3Ddistblk (p_EPZS->distortion);
+  free_mem3Ddistblk (p_EPZS->distortion_hpel);
+  if (p_Inp->BiPredMotionEstimation)
+    free_mem3Ddistblk (p_EPZS->bi_distortion);
+
+  if (p_Inp->EPZSSpatialMem)
+  {
+#if EPZSREF
+    free_mem5Dmv (p_EPZS->p_motion);
+#else
+    free_mem4Dmv (p_EPZS->p_motion);
+#endif
+  }
+
+  freeEPZSpattern (p_EPZS->predictor);
+
+  free (currSlice->p_EPZS);
+  currSlice->p_EPZS = NULL;
+}
+
 //! For ME purposes restricting the co-located partition is not necessary.
 /*!
 ************************************************************************
@@ -470,7 +470,8 @@ void SetMELambda(VideoParameters *p_Vid, int *lambda_mf)
   // Note that these are now computed at the slice level to reduce
   // computations and cleanup code.
   int slice_type = p_Vid->type;
-  int iHMEQP = p_Vid->masterQP;
+  // the QP of this frame: masterQP still holds the last QP of the previously coded picture
+  int iHMEQP = p_Vid->qp;
   if((p_Vid->type == B_SLICE) && p_Vid->nal_reference_idc)
   {
     slice_type = 5;
@@ -0,0 +1,164 @@
+
+/*!
+*************************************************************************************
+* \file me_sadcache.c
+*
+* \brief
+*    4x4 SAD cache for the ADS integer-pel search (SearchMode = 4).
+*
+*    PartitionMotionSearch searches the seven block types of a macroblock one
+*    after the other, and the diamond search visits many of the same
+*    displacements for each of them. computeSADCached keeps the SAD of every 4x4 block of the
+*    macroblock per reference and integer displacement, so that a partition only
+*    computes the 4x4 SADs no other partition has computed yet and sums the rest,
+*    similar to what update_full_search_large_blocks does for fast full search.
+*    The result is identical to computeSAD.
+*
+*************************************************************************************
+*/
+
+#include "global.h"
+#include "refbuf.h"
+#include "mv_search.h"
+#include "me_sadcache.h"
+#include "me_distortion_simd.h"
+
+//! SAD of a 4x4 block
+static inline int sad4x4 (imgpel *src, int src_stride, imgpel *ref, int ref_stride)
+{
+  int y, sad = 0;
+
+  for (y = 0; y < 4; ++y)
+  {
+    sad += iabs(src[0] - ref[0]) + iabs(src[1] - ref[1]) + iabs(src[2] - ref[2]) + iabs(src[3] - ref[3]);
+    src += src_stride;
+    ref += ref_stride;
+  }
+  return sad;
+}
+
+//! SADs of n horizontally adjacent 4x4 blocks
+static void sad4x4_row (imgpel *src, int src_stride, imgpel *ref, int ref_stride, int n, int *sad)
+{
+  int i;
+
+  for (i = 0; i < n; ++i)
+    sad[i] = sad4x4(src + (i << 2), src_stride, ref + (i << 2), ref_stride);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Allocates the SAD cache. Returns the number of bytes allocated.
+ ***********************************************************************
+ */
+int SADCacheInit (VideoParameters *p_Vid)
+{
+  SADCache *p_cache;
+
+  if ((p_cache = (SADCache *) calloc(1, sizeof(SADCache))) == NULL)
+    no_mem_exit("SADCacheInit: p_cache");
+  if ((p_cache->entry = (SADCacheEntry *) calloc(1 << SAD_CACHE_BITS, sizeof(SADCacheEntry))) == NULL)
+    no_mem_exit("SADCacheInit: p_cache->entry");
+
+  // entries are allocated with stamp 0, i.e. unused
+  p_cache->stamp = 1;
+  p_cache->mb_x  = -1;
+  p_cache->mb_y  = -1;
+  p_cache->sad4x4_row = sad4x4_row;
+  select_sadcache_simd(p_cache);
+  p_Vid->p_SADCache = p_cache;
+
+  return sizeof(SADCache) + (1 << SAD_CACHE_BITS) * sizeof(SADCacheEntry);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Frees the SAD cache
+ ***********************************************************************
+ */
+void SADCacheDelete (VideoParameters *p_Vid)
+{
+  if (p_Vid->p_SADCache == NULL)
+    return;
+  free(p_Vid->p_SADCache->entry);
+  free(p_Vid->p_SADCache);
+  p_Vid->p_SADCache = NULL;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Integer-pel SAD of the block through the SAD cache.
+ *    Drop-in replacement for computeSAD (luma only, no weights). Rows
+ *    of 4x4 blocks with SADs missing from the cache are computed and
+ *    stored, and the partial cost is returned as soon as a row of 4x4
+ *    blocks brings it above min_mcost.
+ ***********************************************************************
+ */
+distblk computeSADCached (StorablePicture *ref1, MEBlock *mv_block, distblk min_mcost, MotionVector *cand)
+{
+  VideoParameters *p_Vid = mv_block->p_Vid;
+  SADCache *p_cache = p_Vid->p_SADCache;
+  SADCacheEntry *entry;
+  int imin_cost = dist_down(min_mcost);
+  int stride = p_Vid->padded_size_x;
+  int src_stride = mv_block->blocksize_x;
+  int bw = mv_block->blocksize_x >> 2;
+  int bh = mv_block->blocksize_y >> 2;
+  int mb_x = mv_block->pos_x - (mv_block->block_x << 2);
+  int mb_y = mv_block->pos_y - (mv_block->block_y << 2);
+  int dx, dy, i, j, k, row_mask;
+  unsigned int hash;
+  int mcost = 0;
+  imgpel *src_line = mv_block->orig_pic[0];
+  imgpel *ref_line;
+
+  if ((cand->mv_x | cand->mv_y) & 0x03)
+    return p_Vid->computeUniPred[F_PEL](ref1, mv_block, min_mcost, cand);
+
+  if (mb_x != p_cache->mb_x || mb_y != p_cache->mb_y)
+  {
+    // new macroblock: invalidate all entries at once
+    ++p_cache->stamp;
+    p_cache->mb_x = mb_x;
+    p_cache->mb_y = mb_y;
+  }
+
+  // key on the displacement UMVLine4X really reads, so clipped candidates share entries
+  dx = iClip3(-IMG_PAD_SIZE_X, ref1->size_x_pad, cand->mv_x >> 2) - mv_block->pos_x;
+  dy = iClip3(-IMG_PAD_SIZE_Y, ref1->size_y_pad, cand->mv_y >> 2) - mv_block->pos_y;
+  hash  = (unsigned int) ((dx & 0x3f) | ((dy & 0x1f) << 6));
+  hash ^= (unsigned int) ((size_t) ref1 >> 6) * 0x9E3779B1u >> (32 - SAD_CACHE_BITS);
+  entry = &p_cache->entry[hash & ((1 << SAD_CACHE_BITS) - 1)];
+
+  if (entry->stamp != p_cache->stamp || entry->ref != ref1 || entry->dx != dx || entry->dy != dy)
+  {
+    entry->stamp = p_cache->stamp;
+    entry->ref   = ref1;
+    entry->dx    = (short) dx;
+    entry->dy    = (short) dy;
+    entry->valid = 0;
+  }
+
+  ref_line = UMVLine4X(ref1, cand->mv_y, cand->mv_x);
+  row_mask = (1 << bw) - 1;
+  for (j = 0; j < bh; ++j)
+  {
+    k = ((mv_block->block_y + j) << 2) + mv_block->block_x;
+    if ((entry->valid & (row_mask << k)) != (row_mask << k))
+    {
+      p_cache->sad4x4_row(src_line, src_stride, ref_line, stride, bw, &entry->sad[k]);
+      entry->valid |= row_mask << k;
+    }
+    for (i = 0; i < bw; ++i)
+      mcost += entry->sad[k + i];
+    if (mcost > imin_cost)
+      return (dist_scale_f((distblk) mcost));
+    src_line += src_stride << 2;
+    ref_line += stride << 2;
+  }
+
+  return (dist_scale((distblk) mcost));
+}
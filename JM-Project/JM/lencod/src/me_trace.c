@@ -0,0 +1,104 @@
+
+/*!
+ *************************************************************************************
+ * \file me_trace.c
+ *
+ * \brief
+ *    Writes the per-block motion estimation trace (METraceFile) that the ADS
+ *    harness can replay offline against the source YUV.
+ *
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "me_trace.h"
+
+static byte *put_u16(byte *p, uint16 v)
+{
+  p[0] = (byte) v;
+  p[1] = (byte) (v >> 8);
+  return p + 2;
+}
+
+static byte *put_u32(byte *p, uint32 v)
+{
+  p[0] = (byte) v;
+  p[1] = (byte) (v >> 8);
+  p[2] = (byte) (v >> 16);
+  p[3] = (byte) (v >> 24);
+  return p + 4;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Open the ME trace file and write its header
+ ************************************************************************
+ */
+void init_me_trace(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  byte header[ME_TRACE_HEADER_SIZE];
+  byte *p = header;
+
+  p_Vid->p_me_trace = NULL;
+  if (strlen(p_Inp->METraceFile) == 0)
+    return;
+
+  if ((p_Vid->p_me_trace = fopen(p_Inp->METraceFile, "wb")) == NULL)
+  {
+    snprintf(errortext, ET_SIZE, "Error open file %s", p_Inp->METraceFile);
+    error (errortext, 500);
+  }
+
+  memcpy(p, "METR", 4);
+  p = put_u32(p + 4, ME_TRACE_VERSION);
+  p = put_u32(p, (uint32) p_Inp->source.width[0]);
+  put_u32(p, (uint32) p_Inp->source.height[0]);
+  fwrite(header, 1, ME_TRACE_HEADER_SIZE, p_Vid->p_me_trace);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Close the ME trace file
+ ************************************************************************
+ */
+void close_me_trace(VideoParameters *p_Vid)
+{
+  if (p_Vid->p_me_trace)
+  {
+    fclose(p_Vid->p_me_trace);
+    p_Vid->p_me_trace = NULL;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Append one block record
+ ************************************************************************
+ */
+void write_me_trace(VideoParameters *p_Vid, const METraceRecord *rec)
+{
+  byte buf[ME_TRACE_RECORD_SIZE];
+  byte *p = buf;
+
+  p = put_u32(p, rec->frame);
+  p = put_u32(p, rec->ref_frame);
+  p = put_u16(p, rec->x);
+  p = put_u16(p, rec->y);
+  *p++ = rec->w;
+  *p++ = rec->h;
+  *p++ = rec->list;
+  *p++ = rec->ref_idx;
+  p = put_u16(p, rec->range);
+  p = put_u16(p, 0);
+  p = put_u16(p, (uint16) rec->pred_x);
+  p = put_u16(p, (uint16) rec->pred_y);
+  p = put_u16(p, (uint16) rec->mv_x);
+  p = put_u16(p, (uint16) rec->mv_y);
+  p = put_u32(p, rec->cost);
+  put_u32(p, rec->points);
+
+  fwrite(buf, 1, ME_TRACE_RECORD_SIZE, p_Vid->p_me_trace);
+}
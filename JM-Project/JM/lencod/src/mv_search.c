@@ -38,7 +38,9 @@
 #include "mc_prediction.h"
 #include "conformance.h"
 #include "mode_decision.h"
-#include "my_fast_me.h"
+#include "me_ads.h"
+#include "me_sadcache.h"
+#include "me_trace.h"
 
 // Motion estimation distortion header file
 #include "me_distortion.h"
@@ -53,6 +55,7 @@
 #include "me_umhex.h"
 #include "me_umhexsmp.h"
 #include "rdoq.h"
+#include "md_early_term.h"
 
 
 static const short bx0[5][4] = {{0,0,0,0}, {0,0,0,0}, {0,0,0,0}, {0,2,0,0}, {0,2,0,2}};
@@ -158,6 +161,12 @@ void init_ME_engine(Macroblock *currMB)
      currMB->SubPelBiPredME = sub_pel_bipred_motion_estimation;
      currMB->SubPelME       = smpUMHEXSubPelBlockME;
      break;
+   case ADS:
+     currMB->IntPelME       = ADS_motion_estimation;
+     currMB->BiPredME       = ADS_bipred_motion_estimation;
+     currMB->SubPelBiPredME = sub_pel_bipred_motion_estimation;
+     currMB->SubPelME       = sub_pel_motion_estimation;
+     break;
    case FULL_SEARCH:
      currMB->IntPelME       = full_search_motion_estimation;
      currMB->BiPredME       = full_search_bipred_motion_estimation;
@@ -513,6 +522,8 @@ void init_motion_search_module (VideoParameters *p_Vid, InputParameters *p_Inp)
     if (p_Inp->SearchMode[0] == UM_HEX || p_Inp->SearchMode[1] == UM_HEX)
       UMHEX_DefineThreshold(p_Vid);
   }
+
+  init_me_trace(p_Vid, p_Inp);
 }
 
 /*!
@@ -555,6 +566,8 @@ clear_motion_search_module (VideoParameters *p_Vid, InputParameters *p_Inp)
 
   if ((p_Inp->SearchMode[0] == FAST_FULL_SEARCH || p_Inp->SearchMode[1] == FAST_FULL_SEARCH) && (!p_Inp->IntraProfile) )
     clear_fast_full_search (p_Vid);
+
+  close_me_trace(p_Vid);
 }
 
 static inline int mv_bit_cost(Macroblock *currMB, MotionVector **all_mv, int cur_list, short cur_ref, int by, int bx, int step_v0, int step_v, int step_h0, int step_h, int mvd_bits)
@@ -766,6 +779,10 @@ void init_mv_block(Macroblock *currMB, MEBlock *mv_block, short blocktype, int l
     mv_block->computeBiPredFPel = p_Vid->computeBiPred1[F_PEL];
     mv_block->computeBiPredHPel = p_Vid->computeBiPred1[H_PEL];
     mv_block->computeBiPredQPel = p_Vid->computeBiPred1[Q_PEL];
+
+    // partitions share their 4x4 SADs; the cache is keyed on frame macroblock positions
+    if (p_Vid->p_SADCache && !p_Inp->ChromaMEEnable && currSlice->structure == FRAME && !currSlice->mb_aff_frame_flag)
+      mv_block->computePredFPel = computeSADCached;
   }
 }
 
@@ -878,7 +895,6 @@ BlockMotionSearch (Macroblock *currMB,      //!< Current Macroblock
   int   bsy       = mv_block->blocksize_y;
 
   short pic_pix_x = (short) (currMB->pix_x + mb_x);
-  short pic_pix_y = (short) (currMB->opix_y + mb_y);
 
   int  blocktype = mv_block->blocktype;
   int  list = mv_block->list;
@@ -958,30 +974,8 @@ BlockMotionSearch (Macroblock *currMB,      //!< Current Macroblock
   // valid search range limits could be precomputed once during the initialization process
   clip_mv_range(p_Vid, 0, mv, Q_PEL);
 
-  //--- perform motion search (Adaptive Diamond Search integer-pel) ---
-  {
-    imgpel **ref_img = currSlice->listX[list + currMB->list_offset][ref]->imgY;
-    imgpel **cur_img = p_Vid->pCurImg;
-
-    ADSParams ads_params;
-    ads_params.block_w = bsx;
-    ads_params.block_h = bsy;
-    ads_params.search_range = imax(abs(mv_block->searchRange.min_x), imax(abs(mv_block->searchRange.max_x), imax(abs(mv_block->searchRange.min_y), abs(mv_block->searchRange.max_y))));
-    if (ads_params.search_range <= 0) ads_params.search_range = p_Inp->search_range[p_Vid->view_id];
-    ads_params.max_iters = 64;
-
-    ADSMV init_mv;
-    init_mv.x = mv->mv_x / 4; // quarter-pel to integer-pel
-    init_mv.y = mv->mv_y / 4;
-
-    ADSMV mv_ads = xDiamondSearchADS(ref_img, cur_img, p_Vid->width, p_Vid->height, pic_pix_x, pic_pix_y, ads_params, init_mv);
-    mv->mv_x = (short)(mv_ads.x * 4); // back to quarter-pel units
-    mv->mv_y = (short)(mv_ads.y * 4);
-
-    min_mcost = (distblk)sad_block_ads(ref_img, cur_img, p_Vid->width, p_Vid->height,
-                                       pic_pix_x + mv_ads.x, pic_pix_y + mv_ads.y,
-                                       pic_pix_x, pic_pix_y, bsx, bsy);
-  }
+  //--- perform motion search ---
+  min_mcost = currMB->IntPelME (currMB, &pred, mv_block, min_mcost, lambda_factor[F_PEL]);
 
   //==============================
   //=====   SUB-PEL SEARCH   =====
@@ -1670,23 +1664,46 @@ void PartitionMotionSearch (Macroblock *currMB,
       //===== LOOP OVER REFERENCE FRAMES =====
       for (list = 0; list < numlists; list++)
       {
+        int num_ref = currSlice->listXsize[list+list_offset];
+        distblk ref0_cost = DISTBLK_MAX;
+
         //----- set arrays -----
         mv_block.list = (char) list;
-        for (ref=0; ref < currSlice->listXsize[list+list_offset]; ref++) 
+        for (ref=0; ref < num_ref; ref++) 
         {
             mv_block.ref_idx = (char) ref;
             m_cost = &p_Vid->motion_cost[blocktype][list][ref][block8x8];
 
+            if (ref > 0 && ref0_cost != DISTBLK_MAX)
+            {
+              //----- early termination: keep the first reference, with its vector for the others -----
+              *m_cost = DISTBLK_MAX;
+              currSlice->all_mv[list][ref][blocktype][by][bx] = currSlice->all_mv[list][0][blocktype][by][bx];
+            }
+            else
             {
               //----- set search range ---
               get_search_range(&mv_block, p_Inp, ref, blocktype);
 
               //===== LOOP OVER MACROBLOCK partitions        
               *m_cost = BlockMotionSearch (currMB, &mv_block, bx<<2, by<<2, lambda_factor);     
+
+              if (ref == 0 && num_ref > 1 && p_Vid->p_EarlyTerm && EarlyTermSkipRefs(currMB, blocktype, *m_cost))
+                ref0_cost = *m_cost;
             }
             //--- set motion vectors and reference frame ---            
             set_me_parameters(motion, &currSlice->all_mv[list][ref][blocktype][by][bx], list, (char) ref, step_h, step_v, pic_block_y, pic_block_x);
         }
+
+        if (p_Vid->p_EarlyTerm && num_ref > 1)
+        {
+          distblk **list_cost = p_Vid->motion_cost[blocktype][list];
+          int won = FALSE;
+
+          for (ref = 1; ref < num_ref; ref++)
+            won |= list_cost[ref][block8x8] < list_cost[0][block8x8];
+          EarlyTermTrainRefs(currMB, blocktype, list_cost[0][block8x8], won);
+        }
       }
     }
 
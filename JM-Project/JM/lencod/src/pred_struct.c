@@ -16,6 +16,7 @@
 
 #include "pred_struct.h"
 #include "explicit_seq.h"
+#include "lookahead.h"
 
 #define DEBUG_PRED_STRUCT 0
 
@@ -458,6 +459,11 @@ SeqStructure * init_seq_structure( VideoParameters *p_Vid, InputParameters *p_In
 
   p_Inp->FrmStructBufferLength = p_Inp->no_frames;
   p_Vid->frm_struct_buffer = p_Inp->no_frames;
+  // with the lookahead the structure is placed a few GOPs at a time, once the frames are analysed
+  if ( p_Vid->p_Lookahead != NULL )
+  {
+    p_Inp->FrmStructBufferLength = imin( imax( p_Inp->idr_period, p_Inp->intra_period ) + p_Inp->NumberBFrames + p_Inp->intra_delay + 2, p_Inp->no_frames );
+  }
 
   *memory_size += sizeof( SeqStructure );
 
@@ -488,7 +494,7 @@ SeqStructure * init_seq_structure( VideoParameters *p_Vid, InputParameters *p_In
   init_gop_struct ( p_Inp, p_seq_struct, 1, memory_size ); // IDR GOPs
   init_gop_struct ( p_Inp, p_seq_struct, 0, memory_size ); // Intra GOPs
 
-  frames_to_pop = p_Vid->frm_struct_buffer;
+  frames_to_pop = p_Inp->FrmStructBufferLength;
 
   // populate frames
 #if (MVC_EXTENSION_ENABLE)
@@ -2199,6 +2205,15 @@ static int populate_reg_pred_struct_atom( VideoParameters *p_Vid, InputParameter
         break; // the pred_frame loop
       }
     }        
+    // the lookahead ends the run of B frames early at a scene cut or where many blocks are intra
+    if ( p_Vid->p_Lookahead != NULL && pred_idx > 0 )
+    {
+      int b_frames = LookaheadBFrames( p_Vid, curr_frame + pred_frame, pred_idx );
+      if ( b_frames < pred_idx )
+      {
+        pred_idx = get_prd_index( p_Inp, p_seq_struct, b_frames + 1 );
+      }
+    }
     // prediction structure pointer
     p_cur_prd = p_seq_struct->p_prd + pred_idx;
     // populate gop structure from selected structure
@@ -2212,6 +2227,15 @@ static int populate_reg_pred_struct_atom( VideoParameters *p_Vid, InputParameter
       // assign values
       populate_frame( p_Inp, p_seq_struct, p_frm_struct, p_cur_prd, curr_frame, pred_frame, idx, p_seq_struct->max_num_slices, 0 );
 
+      // the anchor (first in coding order) of the structure is coded as I at a scene cut
+      if ( p_Vid->p_Lookahead != NULL && !idx && p_frm_struct->type != I_SLICE && LookaheadSceneCut( p_Vid, p_frm_struct->frame_no ) )
+      {
+        p_frm_struct->mod_qp        = 0;
+        p_frm_struct->random_access = p_Inp->EnableOpenGOP ? 1 : 0;
+        p_frm_struct->qp            = p_Inp->qp[I_SLICE];
+        populate_frame_slice_type( p_Inp, p_frm_struct, I_SLICE, p_seq_struct->max_num_slices );
+      }
+
       // update IDR and intra frame counters
       update_frame_indices( p_seq_struct, p_frm_struct, curr_frame, pred_frame + idx );
     }
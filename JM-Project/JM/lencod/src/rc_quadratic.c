@@ -22,6 +22,7 @@
 
 #include "global.h"
 #include "ratectl.h"
+#include "lookahead.h"
 
 
 static const float THETA = 1.3636F;
@@ -264,6 +265,14 @@ void rc_init_seq(VideoParameters *p_Vid, InputParameters *p_Inp, RCQuadratic *p_
   /*adaptive field/frame coding*/
   p_gen->FieldControl=0;  
 
+  // the lookahead estimates the initial QP from the costs of the first frames
+  if (p_Inp->SeinitialQP==0 && p_Vid->p_Lookahead != NULL)
+  {
+    qp = LookaheadInitialQP(p_Vid, p_quad->bit_rate, p_quad->frame_rate);
+    if (qp >= 0)
+      p_Inp->SeinitialQP = qp;
+  }
+
   if (p_Inp->SeinitialQP==0)
   {
     /*compute the initial QP*/
@@ -21,6 +21,7 @@
 #include "filehandle.h"
 #include "fmo.h"
 #include "image.h"
+#include "img_luma_tile.h"
 #include "intrarefresh.h"
 #include "leaky_bucket.h"
 #include "me_epzs.h"
@@ -28,6 +29,10 @@
 #include "output.h"
 #include "parset.h"
 #include "report.h"
+#include "lookahead.h"
+#include "md_early_term.h"
+#include "memalloc.h"
+#include "slice.h"
 #include "img_process_types.h"
 
 
@@ -564,6 +569,9 @@ void report_log(VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *
   case EPZS:
     fprintf(p_log," EPZS |");
     break;
+  case ADS:
+    fprintf(p_log,"  ADS |");
+    break;
   case FAST_FULL_SEARCH:
     fprintf(p_log,"  FFS |");
     break;
@@ -585,6 +593,9 @@ void report_log(VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *
     case EPZS:
       fprintf(p_log," EPZS |");
       break;
+    case ADS:
+      fprintf(p_log,"  ADS |");
+      break;
     case FAST_FULL_SEARCH:
       fprintf(p_log,"  FFS |");
       break;
@@ -720,6 +731,7 @@ void report( VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *p_S
   // normalize time p_Stats
   p_Vid->tot_time    = timenorm(p_Vid->tot_time);
   p_Vid->me_tot_time = timenorm(p_Vid->me_tot_time);
+  p_Vid->subpel_tot_time = timenorm(p_Vid->subpel_tot_time);
   //  Accumulate bit usage for inter and intra frames
   for (j=0; j < NUM_SLICE_TYPES; j++)
   {
@@ -800,7 +812,54 @@ void report( VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *p_S
 #endif
 
     fprintf(stdout,  " Total encoding time for the seq.  : %7.3f sec (%3.2f fps)\n", (float) p_Vid->tot_time * 0.001, 1000.0 * (float) (p_Stats->frame_counter) / (float)p_Vid->tot_time);
-    fprintf(stdout,  " Total ME time for sequence        : %7.3f sec \n\n", (float)p_Vid->me_tot_time * 0.001);
+    fprintf(stdout,  " Total ME time for sequence        : %7.3f sec \n", (float)p_Vid->me_tot_time * 0.001);
+    fprintf(stdout,  " Total sub-pel interpolation time  : %7.3f sec \n", (float)p_Vid->subpel_tot_time * 0.001);
+    if (p_Vid->p_LazySubPel && p_Vid->p_LazySubPel->tiles_total)
+      fprintf(stdout,  " Sub-pel tiles interpolated        : %7.2f %% (%" FORMAT_OFF_T " of %" FORMAT_OFF_T ")\n",
+        100.0 * (double) p_Vid->p_LazySubPel->tiles_filled / (double) p_Vid->p_LazySubPel->tiles_total,
+        p_Vid->p_LazySubPel->tiles_filled, p_Vid->p_LazySubPel->tiles_total);
+    if (p_Vid->p_Lookahead)
+    {
+      LookaheadStats la;
+
+      LookaheadGetStats(p_Vid, &la);
+      fprintf(stdout,  " Lookahead frames analysed         : %7d (%d scene cuts, %d coded as I)\n", la.frames, la.scene_cuts, la.cuts_coded);
+      if (la.runs)
+        fprintf(stdout,  " Lookahead B frames per run        : %7.2f (%d of %d runs shortened)\n", (double) la.b_frames / la.runs, la.runs_shortened, la.runs);
+      if (la.intra > 0.0)
+        fprintf(stdout,  " Lookahead propagate / intra cost  : %7.3f\n", la.propagate / la.intra);
+      if (la.initial_qp >= 0)
+        fprintf(stdout,  " Lookahead initial QP              : %7d\n", la.initial_qp);
+    }
+    if (p_Vid->p_EarlyTerm)
+    {
+      static const char *et_name[ET_DECISIONS] = { "8x8 sub-partitions", "intra in inter    ", "references > 0    " };
+      EarlyTermStats *et_stats = p_Vid->p_EarlyTerm->stats;
+      int d;
+
+      for (d = 0; d < ET_DECISIONS; ++d)
+      {
+        if (et_stats[d].tested + et_stats[d].trained == 0)
+          continue;
+        fprintf(stdout,  " Early term. %s    : %7.2f %% skipped (%" FORMAT_OFF_T " of %" FORMAT_OFF_T "), won %" FORMAT_OFF_T " of %" FORMAT_OFF_T " trained\n",
+          et_name[d], et_stats[d].tested ? 100.0 * (double) et_stats[d].skipped / (double) et_stats[d].tested : 0.0,
+          et_stats[d].skipped, et_stats[d].tested, et_stats[d].won, et_stats[d].trained);
+      }
+    }
+    if (p_Vid->p_ArenaStats)
+    {
+      MemArenaStats as;
+
+      get_slice_arena_stats(p_Vid, &as);
+      fprintf(stdout,  " Slice arena allocations           : %7" FORMAT_OFF_T " (%" FORMAT_OFF_T " heap blocks, %" FORMAT_OFF_T " resets)\n", as.allocs, as.blocks, as.resets);
+      fprintf(stdout,  " Slice arena peak                  : %7" FORMAT_OFF_T " KB\n", (as.peak + 1023) >> 10);
+    }
+    if (p_Vid->p_PicPool)
+    {
+      fprintf(stdout,  " Picture pool reuses               : %7" FORMAT_OFF_T " of %" FORMAT_OFF_T " pictures allocated\n",
+        p_Vid->p_PicPool->reuses, p_Vid->p_PicPool->allocs);
+    }
+    fprintf(stdout,  "\n");
 
     fprintf(stdout," Y { PSNR (dB), cSNR (dB), MSE }   : { %7.3f, %7.3f, %9.5f }\n", 
       snr->average[0], csnr_y, sse->average[0]/(float)impix);
@@ -1179,6 +1238,8 @@ void information_init ( VideoParameters *p_Vid, InputParameters *p_Inp, StatPara
       fprintf(stdout,  " Motion Estimation Scheme          : EPZS\n");
       EPZSOutputStats(p_Inp, stdout, 0);
     }
+    else if (p_Inp->SearchMode[0] == ADS)
+      fprintf(stdout,  " Motion Estimation Scheme          : ADS\n");
     else if (p_Inp->SearchMode[0] == FAST_FULL_SEARCH)
       fprintf(stdout,  " Motion Estimation Scheme          : Fast Full Search\n");
     else
@@ -1196,6 +1257,8 @@ void information_init ( VideoParameters *p_Vid, InputParameters *p_Inp, StatPara
         fprintf(stdout,  " Motion Estimation Scheme          : EPZS\n");
         EPZSOutputStats(p_Inp, stdout, 0);
       }
+      else if (p_Inp->SearchMode[1] == ADS)
+        fprintf(stdout,  " Motion Estimation Scheme          : ADS\n");
       else if (p_Inp->SearchMode[1] == FAST_FULL_SEARCH)
         fprintf(stdout,  " Motion Estimation Scheme          : Fast Full Search\n");
       else
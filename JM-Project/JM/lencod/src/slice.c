@@ -106,8 +106,27 @@ static void CAVLC_init(Slice *currSlice)
 
 static int alloc_rddata(Slice *currSlice, RD_DATA *rd_data)
 {
+  MemArena *arena = currSlice->arena;
   int alloc_size = 0;
 
+  if (arena != NULL)
+  {
+    alloc_size += get_mem3Dpel_arena(arena, &(rd_data->rec_mb), 3, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+
+    alloc_size += get_mem_ACcoeff_arena (arena, currSlice->p_Vid, &(rd_data->cofAC));
+    alloc_size += get_mem_DCcoeff_arena (arena, &(rd_data->cofDC));
+
+    if ((currSlice->slice_type != I_SLICE) && currSlice->slice_type != SI_SLICE)
+    {
+      alloc_size += get_mem5Dmv_arena (arena, &(rd_data->all_mv), 2, currSlice->max_num_references, 9, 4, 4);
+    }
+
+    alloc_size += get_mem2D_arena(arena, (byte***)&(rd_data->ipredmode), currSlice->height_blk, currSlice->width_blk);
+    alloc_size += get_mem3D_arena(arena, (byte****)&(rd_data->refar), 2, 4, 4);
+
+    return alloc_size;
+  }
+
   alloc_size += get_mem3Dpel(&(rd_data->rec_mb), 3, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
 
   alloc_size += get_mem_ACcoeff (currSlice->p_Vid, &(rd_data->cofAC));
@@ -143,6 +162,10 @@ static void nullify_rddata(RD_DATA *rd_data)
 
 static void free_rddata(Slice *currSlice, RD_DATA *rd_data)
 {
+  // released with the arena of the picture
+  if (currSlice->arena != NULL)
+    return;
+
   if(rd_data->refar)
     free_mem3D((byte***) rd_data->refar);
   if(rd_data->ipredmode)
@@ -192,7 +215,8 @@ static int start_slice(Slice *currSlice, StatParameters *cur_stats)
     NumberOfPartitions = 1;
   }
 
-  RTPUpdateTimestamp (p_Vid, currSlice->frame_no);   // this has no side effects, just leave it for all NALs
+  if (p_Vid->p_Inp->of_mode == PAR_OF_RTP)
+    RTPUpdateTimestamp (p_Vid, currSlice->frame_no);   // only the RTP packets carry the timestamp
 
   for (i = 0; i < NumberOfPartitions; i++)
   {
@@ -423,21 +447,22 @@ static void init_bipred_enabled(VideoParameters *p_Vid)
 /*!
 ************************************************************************
 * \brief
-*    Encodes one slice
-* \par
-*   returns the number of coded MBs in the SLice
+*    Sets up the next slice of a slice group and writes its header
+* \param p_Vid
+*    video parameters the slice is coded with
+* \param SliceGroupId
+*    slice group the slice belongs to
+* \param cur_stats
+*    statistics the slice is accounted in
+* \return
+*    the new slice
 ************************************************************************
 */
-int encode_one_slice (VideoParameters *p_Vid, int SliceGroupId, int TotalCodedMBs)
+Slice *start_encode_slice (VideoParameters *p_Vid, int SliceGroupId, StatParameters *cur_stats)
 {
   InputParameters *p_Inp = p_Vid->p_Inp;
-  Boolean end_of_slice = FALSE;
-  
   int len;
-  int NumberOfCodedMBs = 0;
-  Macroblock* currMB   = NULL;
   int CurrentMbAddr;
-  StatParameters *cur_stats = &p_Vid->enc_picture->stats;
   Slice *currSlice = NULL;  
 
   if( (p_Inp->separate_colour_plane_flag != 0) )
@@ -452,6 +477,7 @@ int encode_one_slice (VideoParameters *p_Vid, int SliceGroupId, int TotalCodedMB
 
   p_Vid->enc_picture->temporal_layer = p_Vid->p_curr_frm_struct->temporal_layer; 
   init_slice (p_Vid, &currSlice, CurrentMbAddr);
+  currSlice->cur_stats = cur_stats;
   currSlice->rdoq_motion_copy = 0;
   init_bipred_enabled(p_Vid);
 
@@ -483,6 +509,68 @@ int encode_one_slice (VideoParameters *p_Vid, int SliceGroupId, int TotalCodedMB
   if(currSlice->UseRDOQuant == 1 && currSlice->RDOQ_QP_Num > 1)
     get_dQP_table(currSlice);
 
+  return currSlice;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Decides, codes and writes one macroblock of a frame slice
+* \param currSlice
+*    the slice
+* \param currMB
+*    returns the macroblock
+* \param mb_addr
+*    address of the macroblock
+************************************************************************
+*/
+void code_slice_macroblock (Slice *currSlice, Macroblock **currMB, int mb_addr)
+{
+  VideoParameters *p_Vid = currSlice->p_Vid;
+
+  if(currSlice->UseRDOQuant) // This needs revisit
+    currSlice->rddata = &currSlice->rddata_trellis_curr;
+  else
+    currSlice->rddata = &currSlice->rddata_top_frame_mb;   // store data in top frame MB
+
+  start_macroblock (currSlice,  currMB, mb_addr, FALSE);
+
+
+  if(currSlice->UseRDOQuant)
+  {
+    trellis_coding(*currMB);   
+  }
+  else
+  {
+    p_Vid->masterQP = p_Vid->qp;
+
+    currSlice->encode_one_macroblock (*currMB);
+    end_encode_one_macroblock(*currMB);
+
+    write_macroblock (*currMB, 1);
+  }
+}
+
+/*!
+************************************************************************
+* \brief
+*    Codes the macroblocks of a slice set up by start_encode_slice()
+* \param currSlice
+*    the slice
+* \param currMB
+*    returns the last macroblock of the slice
+* \return
+*    the number of coded MBs in the slice
+************************************************************************
+*/
+int encode_slice_macroblocks (Slice *currSlice, Macroblock **currMB)
+{
+  VideoParameters *p_Vid = currSlice->p_Vid;
+  InputParameters *p_Inp = currSlice->p_Inp;
+  Boolean end_of_slice = FALSE;
+  int NumberOfCodedMBs = 0;
+  int CurrentMbAddr = currSlice->start_mb_nr;
+
   while (end_of_slice == FALSE) // loop over macroblocks
   {
     Boolean recode_macroblock = FALSE;
@@ -493,37 +581,17 @@ int encode_one_slice (VideoParameters *p_Vid, int SliceGroupId, int TotalCodedMB
         CalculateOffset8x8Param(p_Vid);
     }
 
-    if(currSlice->UseRDOQuant) // This needs revisit
-      currSlice->rddata = &currSlice->rddata_trellis_curr;
-    else
-      currSlice->rddata = &currSlice->rddata_top_frame_mb;   // store data in top frame MB
-
-    start_macroblock (currSlice,  &currMB, CurrentMbAddr, FALSE);
-
-
-    if(currSlice->UseRDOQuant)
-    {
-      trellis_coding(currMB);   
-    }
-    else
-    {
-      p_Vid->masterQP = p_Vid->qp;
-
-      currSlice->encode_one_macroblock (currMB);
-      end_encode_one_macroblock(currMB);
+    code_slice_macroblock (currSlice, currMB, CurrentMbAddr);
 
-      write_macroblock (currMB, 1);
-    }
-
-    end_macroblock (currMB, &end_of_slice, &recode_macroblock);
-    currMB->prev_recode_mb = recode_macroblock;
+    end_macroblock (*currMB, &end_of_slice, &recode_macroblock);
+    (*currMB)->prev_recode_mb = recode_macroblock;
     //       printf ("encode_one_slice: mb %d,  slice %d,   bitbuf bytepos %d EOS %d\n",
     //       p_Vid->current_mb_nr, p_Vid->current_slice_nr,
     //       currSlice->partArr[0].bitstream->byte_pos, end_of_slice);
 
     if (recode_macroblock == FALSE)       // The final processing of the macroblock has been done
     {
-      p_Vid->SumFrameQP += currMB->qp;
+      p_Vid->SumFrameQP += (*currMB)->qp;
       CurrentMbAddr = FmoGetNextMBNr (p_Vid, CurrentMbAddr);
       if (CurrentMbAddr == -1)   // end of slice
       {
@@ -531,7 +599,7 @@ int encode_one_slice (VideoParameters *p_Vid, int SliceGroupId, int TotalCodedMB
         end_of_slice = TRUE;
       }
       NumberOfCodedMBs++;       // only here we are sure that the coded MB is actually included in the slice
-      next_macroblock (currMB);
+      next_macroblock (*currMB);
     }
     else
     {
@@ -547,6 +615,24 @@ int encode_one_slice (VideoParameters *p_Vid, int SliceGroupId, int TotalCodedMB
     }
   }
 
+  return NumberOfCodedMBs;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Finishes a slice coded by encode_slice_macroblocks()
+* \param currMB
+*    the last macroblock of the slice
+* \param lastslice
+*    true for the last slice of the picture
+************************************************************************
+*/
+void end_encode_slice (Macroblock *currMB, int lastslice)
+{
+  Slice *currSlice = currMB->p_Slice;
+  VideoParameters *p_Vid = currSlice->p_Vid;
+  InputParameters *p_Inp = currSlice->p_Inp;
 
   if ((p_Inp->WPIterMC) && (p_Vid->frameOffsetAvail == 0) && p_Vid->nal_reference_idc)
   {
@@ -555,7 +641,26 @@ int encode_one_slice (VideoParameters *p_Vid, int SliceGroupId, int TotalCodedMB
   p_Vid->num_ref_idx_l0_active = currSlice->num_ref_idx_active[LIST_0];
   p_Vid->num_ref_idx_l1_active = currSlice->num_ref_idx_active[LIST_1];
 
-  terminate_slice (currMB, (NumberOfCodedMBs + TotalCodedMBs >= (int)p_Vid->PicSizeInMbs), cur_stats );
+  terminate_slice (currMB, lastslice, currSlice->cur_stats);
+}
+
+/*!
+************************************************************************
+* \brief
+*    Encodes one slice
+* \par
+*   returns the number of coded MBs in the SLice
+************************************************************************
+*/
+int encode_one_slice (VideoParameters *p_Vid, int SliceGroupId, int TotalCodedMBs)
+{
+  int NumberOfCodedMBs;
+  Macroblock* currMB = NULL;
+  Slice *currSlice = start_encode_slice (p_Vid, SliceGroupId, &p_Vid->enc_picture->stats);
+
+  NumberOfCodedMBs = encode_slice_macroblocks (currSlice, &currMB);
+
+  end_encode_slice (currMB, (NumberOfCodedMBs + TotalCodedMBs >= (int)p_Vid->PicSizeInMbs));
   return NumberOfCodedMBs;
 }
 
@@ -1352,6 +1457,7 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
 
   p_Vid->currentSlice = *currSlice;
   set_slice (p_Vid, *currSlice);
+  (*currSlice)->cur_stats = &p_Vid->enc_picture->stats;
 
   // primary and redundant slices: number of references overriding.
   if(p_Inp->redundant_pic_flag)
@@ -1612,11 +1718,17 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
 
   if (((*currSlice)->slice_type != I_SLICE) && (*currSlice)->slice_type != SI_SLICE)
   {
-    alloc_size += get_mem5Dmv (&((*currSlice)->all_mv), 2, (*currSlice)->max_num_references, 9, 4, 4);
+    if ((*currSlice)->arena != NULL)
+      alloc_size += get_mem5Dmv_arena ((*currSlice)->arena, &((*currSlice)->all_mv), 2, (*currSlice)->max_num_references, 9, 4, 4);
+    else
+      alloc_size += get_mem5Dmv (&((*currSlice)->all_mv), 2, (*currSlice)->max_num_references, 9, 4, 4);
 
     if (p_Inp->BiPredMotionEstimation && ((*currSlice)->slice_type == B_SLICE))
     {
-      alloc_size += get_mem6Dmv (&((*currSlice)->bipred_mv), 2, 2, (*currSlice)->max_num_references, 9, 4, 4);
+      if ((*currSlice)->arena != NULL)
+        alloc_size += get_mem6Dmv_arena ((*currSlice)->arena, &((*currSlice)->bipred_mv), 2, 2, (*currSlice)->max_num_references, 9, 4, 4);
+      else
+        alloc_size += get_mem6Dmv (&((*currSlice)->bipred_mv), 2, 2, (*currSlice)->max_num_references, 9, 4, 4);
     }
 
     if (p_Inp->UseRDOQuant && p_Inp->RDOQ_QP_Num > 1)
@@ -1660,7 +1772,8 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
     p_Vid->searchRange.min_y = -p_Inp->search_range[layer_id] << 2;
     p_Vid->searchRange.max_y =  p_Inp->search_range[layer_id] << 2;
 
-    if (p_Inp->SearchMode[layer_id] == EPZS)
+    // the HME pyramid search runs on the EPZS engine whatever the frame search uses
+    if (p_Inp->SearchMode[layer_id] == EPZS || p_Vid->is_hme)
     {
       if (((*currSlice)->p_EPZS =  (EPZSParameters*) calloc(1, sizeof(EPZSParameters)))==NULL) 
         no_mem_exit("init_slice: p_EPZS");
@@ -1689,6 +1802,7 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
       {
         (*currSlice)->listX[i][j]->p_curr_img     = (*currSlice)->listX[i][j]->p_img    [(short) p_Vid->colour_plane_id];
         (*currSlice)->listX[i][j]->p_curr_img_sub = (*currSlice)->listX[i][j]->p_img_sub[(short) p_Vid->colour_plane_id];
+        (*currSlice)->listX[i][j]->p_curr_plane_sub = (*currSlice)->listX[i][j]->plane_sub[(short) p_Vid->colour_plane_id];
       }
     }
   }
@@ -1731,13 +1845,28 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
     (*currSlice)->set_motion_vectors_mb = SetMotionVectorsMBISlice;
   }
 
-  get_mem3Dpel(&((*currSlice)->mb_pred),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
-  get_mem3Dint(&((*currSlice)->mb_rres),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
-  get_mem3Dint(&((*currSlice)->mb_ores),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
-  get_mem4Dpel(&((*currSlice)->mpr_4x4),   MAX_PLANE, 9, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
-  get_mem4Dpel(&((*currSlice)->mpr_8x8),   MAX_PLANE, 9, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
-  get_mem4Dpel(&((*currSlice)->mpr_16x16), MAX_PLANE, 5, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  if ((*currSlice)->arena != NULL)
+  {
+    MemArena *arena = (*currSlice)->arena;
 
+    get_mem3Dpel_arena(arena, &((*currSlice)->mb_pred),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    get_mem3Dint_arena(arena, &((*currSlice)->mb_rres),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    get_mem3Dint_arena(arena, &((*currSlice)->mb_ores),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    get_mem4Dpel_arena(arena, &((*currSlice)->mpr_4x4),   MAX_PLANE, 9, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    get_mem4Dpel_arena(arena, &((*currSlice)->mpr_8x8),   MAX_PLANE, 9, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    get_mem4Dpel_arena(arena, &((*currSlice)->mpr_16x16), MAX_PLANE, 5, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  }
+  else
+  {
+    get_mem3Dpel(&((*currSlice)->mb_pred),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    get_mem3Dint(&((*currSlice)->mb_rres),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    get_mem3Dint(&((*currSlice)->mb_ores),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    get_mem4Dpel(&((*currSlice)->mpr_4x4),   MAX_PLANE, 9, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    get_mem4Dpel(&((*currSlice)->mpr_8x8),   MAX_PLANE, 9, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    get_mem4Dpel(&((*currSlice)->mpr_16x16), MAX_PLANE, 5, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  }
+
+  // not from the arena: the RD mode decision swaps them with those of p_RDO
   get_mem_ACcoeff (p_Vid, &((*currSlice)->cofAC));
   get_mem_DCcoeff (&((*currSlice)->cofDC));
 
@@ -1877,6 +2006,7 @@ void init_slice_lite (VideoParameters *p_Vid, Slice **currSlice, int start_mb_ad
         {
           (*currSlice)->listX[i][j]->p_curr_img     = (*currSlice)->listX[i][j]->p_img    [(short) p_Vid->colour_plane_id];
           (*currSlice)->listX[i][j]->p_curr_img_sub = (*currSlice)->listX[i][j]->p_img_sub[(short) p_Vid->colour_plane_id];
+          (*currSlice)->listX[i][j]->p_curr_plane_sub = (*currSlice)->listX[i][j]->plane_sub[(short) p_Vid->colour_plane_id];
         }
       }
     }
@@ -1962,6 +2092,17 @@ static Slice *malloc_slice(VideoParameters *p_Vid, InputParameters *p_Inp)
   currSlice->p_Vid             = p_Vid;
   currSlice->p_Inp             = p_Inp;
 
+  // the buffers of the n-th slice of a picture are taken from its n-th arena
+  // (the temporary slice of the hierarchical ME keeps to the heap)
+  if (p_Inp->SliceArenas && !p_Vid->is_hme)
+  {
+    Picture *currPic = p_Vid->currentPicture;
+
+    if (currPic->arena[currPic->no_slices - 1] == NULL)
+      currPic->arena[currPic->no_slices - 1] = new_mem_arena();
+    currSlice->arena = currPic->arena[currPic->no_slices - 1];
+  }
+
   if (((currSlice->p_RDO)  = (RDOPTStructure *) calloc(1, sizeof(RDOPTStructure)))==NULL) 
     no_mem_exit("malloc_slice: p_RDO");
 
@@ -1997,7 +2138,9 @@ static Slice *malloc_slice(VideoParameters *p_Vid, InputParameters *p_Inp)
     dataPart = &(currSlice->partArr[i]);
     if ((dataPart->bitstream = (Bitstream *) calloc(1, sizeof(Bitstream))) == NULL) 
       no_mem_exit ("malloc_slice: Bitstream");
-    if ((dataPart->bitstream->streamBuffer = (byte *) calloc(buffer_size, sizeof(byte))) == NULL) 
+    if (currSlice->arena != NULL)
+      dataPart->bitstream->streamBuffer = (byte *) mem_arena_alloc(currSlice->arena, buffer_size);
+    else if ((dataPart->bitstream->streamBuffer = (byte *) calloc(buffer_size, sizeof(byte))) == NULL) 
       no_mem_exit ("malloc_slice: StreamBuffer");
     dataPart->bitstream->buffer_size = buffer_size;
     // Initialize storage of bitstream parameters
@@ -2128,7 +2271,6 @@ void free_slice(Slice *currSlice)
 {
   if (currSlice != NULL)
   {
-    VideoParameters *p_Vid = currSlice->p_Vid;
     InputParameters *p_Inp = currSlice->p_Inp;
 
     int i;
@@ -2153,11 +2295,9 @@ void free_slice(Slice *currSlice)
         {
           if (dataPart->bitstream != NULL)
           {
-            if (dataPart->bitstream->streamBuffer != NULL)
-            {
-              free(dataPart->bitstream->streamBuffer);       
-              dataPart->bitstream->streamBuffer = NULL;
-            }
+            if (dataPart->bitstream->streamBuffer != NULL && currSlice->arena == NULL)
+              free(dataPart->bitstream->streamBuffer);
+            dataPart->bitstream->streamBuffer = NULL;
             free(dataPart->bitstream);
             dataPart->bitstream = NULL;
           }
@@ -2180,18 +2320,23 @@ void free_slice(Slice *currSlice)
     if(currSlice->cofDC)
       free_mem_DCcoeff (currSlice->cofDC);
 
-    if(currSlice->mb_rres)
-      free_mem3Dint(currSlice->mb_rres  );
-    if(currSlice->mb_ores)
-      free_mem3Dint(currSlice->mb_ores  );
-    if(currSlice->mb_pred)
-      free_mem3Dpel(currSlice->mb_pred  );
-    if(currSlice->mpr_16x16)
-      free_mem4Dpel(currSlice->mpr_16x16);
-    if(currSlice->mpr_8x8)
-      free_mem4Dpel(currSlice->mpr_8x8  );
-    if(currSlice->mpr_4x4)
-      free_mem4Dpel(currSlice->mpr_4x4  );
+    // the macroblock buffers, the motion vectors and the RD data of a
+    // slice with an arena are released with the arena of the picture
+    if (currSlice->arena == NULL)
+    {
+      if(currSlice->mb_rres)
+        free_mem3Dint(currSlice->mb_rres  );
+      if(currSlice->mb_ores)
+        free_mem3Dint(currSlice->mb_ores  );
+      if(currSlice->mb_pred)
+        free_mem3Dpel(currSlice->mb_pred  );
+      if(currSlice->mpr_16x16)
+        free_mem4Dpel(currSlice->mpr_16x16);
+      if(currSlice->mpr_8x8)
+        free_mem4Dpel(currSlice->mpr_8x8  );
+      if(currSlice->mpr_4x4)
+        free_mem4Dpel(currSlice->mpr_4x4  );
+    }
 
 
     if (currSlice->partArr != NULL)
@@ -2240,9 +2385,9 @@ void free_slice(Slice *currSlice)
 
     if ((currSlice->slice_type == P_SLICE) || (currSlice->slice_type == SP_SLICE) || (currSlice->slice_type == B_SLICE))
     {
-      if(currSlice->all_mv)
+      if(currSlice->all_mv && currSlice->arena == NULL)
         free_mem5Dmv (currSlice->all_mv);
-      if (p_Inp->BiPredMotionEstimation && (currSlice->slice_type == B_SLICE) && currSlice->bipred_mv)
+      if (p_Inp->BiPredMotionEstimation && (currSlice->slice_type == B_SLICE) && currSlice->bipred_mv && currSlice->arena == NULL)
         free_mem6Dmv(currSlice->bipred_mv);
 
       if (currSlice->UseRDOQuant && currSlice->RDOQ_QP_Num > 1)
@@ -2273,17 +2418,164 @@ void free_slice(Slice *currSlice)
 
     if (currSlice->slice_type != I_SLICE && currSlice->slice_type != SI_SLICE)
     {
-      if (p_Inp->SearchMode[p_Vid->view_id] == EPZS)
-      {
-        if(currSlice->p_EPZS)
-          EPZSStructDelete (currSlice);    
-      }
+      if(currSlice->p_EPZS)
+        EPZSStructDelete (currSlice);    
     }
 
     free(currSlice);
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocates a copy of a slice set up by start_encode_slice() for
+ *    coding macroblocks with p_Vid, a copy of the coding state the slice
+ *    was set up with. The copy shares the reference lists and picture
+ *    level buffers of the slice and has its own bitstream (sized for one
+ *    macroblock row), context models and macroblock buffers.
+ * \return
+ *    Pointer to the copy
+ ************************************************************************
+ */
+Slice *copy_slice(VideoParameters *p_Vid, Slice *currSlice)
+{
+  InputParameters *p_Inp = currSlice->p_Inp;
+  int cr_size = (p_Inp->separate_colour_plane_flag != 0) ? 0 : 512;
+  int buffer_size = 500 + p_Vid->PicWidthInMbs * ((128 + 256 * p_Vid->bitdepth_luma + cr_size * p_Vid->bitdepth_chroma) >> 3);
+  DataPartition *dataPart;
+  Slice *copy;
+  int i;
+
+  if ((copy = (Slice *) malloc(sizeof(Slice))) == NULL) 
+    no_mem_exit ("copy_slice: copy");
+  *copy = *currSlice;
+  copy->p_Vid = p_Vid;
+  copy->arena = NULL;
+
+  if ((copy->partArr = (DataPartition *) calloc(copy->max_part_nr, sizeof(DataPartition))) == NULL) 
+    no_mem_exit ("copy_slice: partArr");
+  for (i = 0; i < copy->max_part_nr; i++)
+  {
+    dataPart = &(copy->partArr[i]);
+    if ((dataPart->bitstream = (Bitstream *) calloc(1, sizeof(Bitstream))) == NULL) 
+      no_mem_exit ("copy_slice: Bitstream");
+    if ((dataPart->bitstream->streamBuffer = (byte *) calloc(buffer_size, sizeof(byte))) == NULL) 
+      no_mem_exit ("copy_slice: StreamBuffer");
+    dataPart->bitstream->buffer_size = buffer_size;
+    dataPart->p_Slice = copy;
+    dataPart->p_Vid   = p_Vid;
+    dataPart->p_Inp   = p_Inp;
+    dataPart->ee_cabac.p_Vid = p_Vid;
+  }
+
+  if (copy->symbol_mode == CABAC)
+  {
+    copy->mot_ctx = create_contexts_MotionInfo ();
+    copy->tex_ctx = create_contexts_TextureInfo();
+  }
+
+  if ((copy->slice_type != I_SLICE) && copy->slice_type != SI_SLICE)
+  {
+    get_mem5Dmv (&(copy->all_mv), 2, copy->max_num_references, 9, 4, 4);
+
+    if (p_Inp->BiPredMotionEstimation && (copy->slice_type == B_SLICE))
+      get_mem6Dmv (&(copy->bipred_mv), 2, 2, copy->max_num_references, 9, 4, 4);
+
+    if (currSlice->p_EPZS != NULL)
+      EPZSStructCopy (copy, currSlice->p_EPZS);
+  }
+
+  if (copy->UseRDOQuant)
+  {
+    if ((copy->estBitsCabac = (estBitsCabacStruct*) calloc(NUM_BLOCK_TYPES, sizeof(estBitsCabacStruct)))==NULL) 
+      no_mem_exit("copy_slice: copy->estBitsCabac"); 
+    memcpy(copy->estBitsCabac, currSlice->estBitsCabac, NUM_BLOCK_TYPES * sizeof(estBitsCabacStruct));
+
+    alloc_rddata(copy, &copy->rddata_trellis_curr);
+  }
+
+  get_mem3Dpel(&(copy->mb_pred),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  get_mem3Dint(&(copy->mb_rres),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  get_mem3Dint(&(copy->mb_ores),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  get_mem4Dpel(&(copy->mpr_4x4),   MAX_PLANE, 9, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  get_mem4Dpel(&(copy->mpr_8x8),   MAX_PLANE, 9, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  get_mem4Dpel(&(copy->mpr_16x16), MAX_PLANE, 5, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+
+  get_mem_ACcoeff (p_Vid, &(copy->cofAC));
+  get_mem_DCcoeff (&(copy->cofDC));
+
+  allocate_block_mem(copy);
+
+  if (((copy->p_RDO) = (RDOPTStructure *) calloc(1, sizeof(RDOPTStructure)))==NULL) 
+    no_mem_exit("copy_slice: p_RDO");
+  init_rdopt(copy);
+
+  return copy;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Frees a slice copy allocated by copy_slice()
+ * \param copy
+ *    Slice copy to be freed
+ ************************************************************************
+ */
+void free_slice_copy(Slice *copy)
+{
+  int i;
+
+  if (copy == NULL)
+    return;
+
+  for (i = 0; i < copy->max_part_nr; i++)
+  {
+    free(copy->partArr[i].bitstream->streamBuffer);
+    free(copy->partArr[i].bitstream);
+  }
+  free(copy->partArr);
+
+  if (copy->symbol_mode == CABAC)
+  {
+    delete_contexts_MotionInfo(copy->mot_ctx);
+    delete_contexts_TextureInfo(copy->tex_ctx);
+  }
+
+  if ((copy->slice_type != I_SLICE) && copy->slice_type != SI_SLICE)
+  {
+    free_mem5Dmv (copy->all_mv);
+    if (copy->p_Inp->BiPredMotionEstimation && (copy->slice_type == B_SLICE))
+      free_mem6Dmv(copy->bipred_mv);
+
+    if (copy->p_EPZS != NULL)
+      EPZSStructCopyDelete (copy);
+  }
+
+  if (copy->UseRDOQuant)
+  {
+    free(copy->estBitsCabac);
+    free_rddata(copy, &copy->rddata_trellis_curr);
+  }
+
+  free_mem3Dint(copy->mb_rres  );
+  free_mem3Dint(copy->mb_ores  );
+  free_mem3Dpel(copy->mb_pred  );
+  free_mem4Dpel(copy->mpr_16x16);
+  free_mem4Dpel(copy->mpr_8x8  );
+  free_mem4Dpel(copy->mpr_4x4  );
+
+  free_mem_ACcoeff (copy->cofAC);
+  free_mem_DCcoeff (copy->cofDC);
+
+  free_block_mem(copy);
+
+  clear_rdopt (copy);
+  free (copy->p_RDO);
+
+  free(copy);
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -2306,9 +2598,69 @@ void free_slice_list(Picture *currPic)
       free_slice (currPic->slices[i]);
       currPic->slices[i] = NULL;
     }
+
+    // the arenas are kept for the slices of the next picture
+    for (i = 0; i < MAXSLICEPERPICTURE; i++)
+    {
+      if (currPic->arena[i] != NULL && currPic->arena[i]->in_use)
+        reset_mem_arena(currPic->arena[i]);
+    }
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Adds the counters of the slice arenas of a picture to sum
+ ************************************************************************
+ */
+void add_slice_arena_stats(MemArenaStats *sum, Picture *currPic)
+{
+  int i;
+
+  if (currPic != NULL)
+  {
+    for (i = 0; i < MAXSLICEPERPICTURE; i++)
+    {
+      if (currPic->arena[i] != NULL)
+        add_mem_arena_stats(sum, currPic->arena[i]);
+    }
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Counters of all slice arenas: those of the pictures already freed
+ *    and those of the pictures of p_Vid
+ ************************************************************************
+ */
+void get_slice_arena_stats(VideoParameters *p_Vid, MemArenaStats *sum)
+{
+  int i;
+
+  *sum = *p_Vid->p_ArenaStats;
+
+  for (i = 0; i < p_Vid->frm_iter; i++)
+    add_slice_arena_stats(sum, p_Vid->frame_pic[i]);
+  add_slice_arena_stats(sum, p_Vid->frame_pic_si);
+#if (MVC_EXTENSION_ENABLE)
+  for (i = 0; i < 2; i++)
+  {
+    if (p_Vid->field_pic1)
+      add_slice_arena_stats(sum, p_Vid->field_pic1[i]);
+    if (p_Vid->field_pic2)
+      add_slice_arena_stats(sum, p_Vid->field_pic2[i]);
+  }
+#else
+  for (i = 0; i < 2; i++)
+  {
+    if (p_Vid->field_pic)
+      add_slice_arena_stats(sum, p_Vid->field_pic[i]);
+  }
+#endif
+}
+
 void UpdateMELambda(Slice *currSlice)
 {  
   InputParameters *p_Inp = currSlice->p_Inp;
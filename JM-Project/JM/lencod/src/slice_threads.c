@@ -0,0 +1,398 @@
+
+/*!
+*************************************************************************************
+* \file slice_threads.c
+*
+* \brief
+*    Concurrent coding of the slices of a picture (SliceThreads > 1).
+*
+*    With SliceMode = 1 the macroblocks of a slice only use neighbours of
+*    the same slice, so once the slice is set up its macroblock loop does
+*    not depend on the other slices of the picture. The slices are coded
+*    in batches of up to SliceThreads slices: each slice of a batch is set
+*    up by start_encode_slice() on the master VideoParameters, in order and
+*    exactly as encode_one_slice() would do it, and handed to a private
+*    copy (a worker) with its own RD and motion cost buffers. The macroblock
+*    loops of the batch then run concurrently on a thread pool of
+*    SliceThreads threads, and the workers are merged back in
+*    slice order: the picture counters are summed, the slice statistics
+*    are added to those of the picture and the slices are handed back to
+*    the master for writing. The bitstream is identical to the one coded
+*    slice by slice.
+*
+*    A slice whose CABAC context model is taken from the preceding slice
+*    (ContextInitMethod = 1) starts a new batch. Configurations with
+*    other cross slice state are rejected in PatchInp().
+*
+*************************************************************************************
+*/
+
+#include "global.h"
+#include "slice_threads.h"
+#include "slice.h"
+#include "image.h"
+#include "fmo.h"
+#include "nal.h"
+#include "memalloc.h"
+#include "me_sadcache.h"
+#include "me_epzs_common.h"
+#include "thread_pool.h"
+
+//! Reads the picture counters of p_Vid
+static void get_slice_counters (VideoParameters *p_Vid, SliceCounters *c)
+{
+  c->pic_bin_count            = p_Vid->pic_bin_count;
+  c->bytes_in_picture         = p_Vid->bytes_in_picture;
+  c->intras                   = p_Vid->intras;
+  c->iInterViewMBs            = p_Vid->iInterViewMBs;
+  c->SumFrameQP               = p_Vid->SumFrameQP;
+  c->NumberofCodedMacroBlocks = p_Vid->NumberofCodedMacroBlocks;
+  c->me_time                  = p_Vid->me_time;
+  c->me_tot_time              = p_Vid->me_tot_time;
+}
+
+//! Adds what a worker counted from start to end to the counters in sum
+static void add_slice_counters (SliceCounters *sum, SliceCounters *end, SliceCounters *start)
+{
+  sum->pic_bin_count            += end->pic_bin_count            - start->pic_bin_count;
+  sum->bytes_in_picture         += end->bytes_in_picture         - start->bytes_in_picture;
+  sum->intras                   += end->intras                   - start->intras;
+  sum->iInterViewMBs            += end->iInterViewMBs            - start->iInterViewMBs;
+  sum->SumFrameQP               += end->SumFrameQP               - start->SumFrameQP;
+  sum->NumberofCodedMacroBlocks += end->NumberofCodedMacroBlocks - start->NumberofCodedMacroBlocks;
+  sum->me_time                  += end->me_time                  - start->me_time;
+  sum->me_tot_time              += end->me_tot_time              - start->me_tot_time;
+}
+
+//! Writes the picture counters of p_Vid
+static void set_slice_counters (VideoParameters *p_Vid, SliceCounters *c)
+{
+  p_Vid->pic_bin_count            = c->pic_bin_count;
+  p_Vid->bytes_in_picture         = c->bytes_in_picture;
+  p_Vid->intras                   = c->intras;
+  p_Vid->iInterViewMBs            = c->iInterViewMBs;
+  p_Vid->SumFrameQP               = c->SumFrameQP;
+  p_Vid->NumberofCodedMacroBlocks = c->NumberofCodedMacroBlocks;
+  p_Vid->me_time                  = c->me_time;
+  p_Vid->me_tot_time              = c->me_tot_time;
+}
+
+//! Copies the coding state of src to dst, dst keeping its own RD buffers
+void copy_coding_state (VideoParameters *dst, VideoParameters *src)
+{
+  Block8x8Info     *b8x8info    = dst->b8x8info;
+  distblk      ****motion_cost = dst->motion_cost;
+  SADCache         *p_SADCache  = dst->p_SADCache;
+  StatParameters   *p_Stats     = dst->p_Stats;
+
+  *dst = *src;
+
+  dst->b8x8info    = b8x8info;
+  dst->motion_cost = motion_cost;
+  dst->p_SADCache  = p_SADCache;
+  dst->p_Stats     = p_Stats;
+}
+
+//! Points a slice and its partitions to p_Vid
+static void bind_slice (VideoParameters *p_Vid, Slice *currSlice)
+{
+  int i;
+
+  currSlice->p_Vid = p_Vid;
+  for (i = 0; i < currSlice->max_part_nr; ++i)
+  {
+    currSlice->partArr[i].p_Vid = p_Vid;
+    currSlice->partArr[i].ee_cabac.p_Vid = p_Vid;
+  }
+  if (currSlice->p_EPZS != NULL)
+    currSlice->p_EPZS->p_Vid = p_Vid;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Allocates the RD buffers of a worker coding macroblocks in place of
+ *    p_Vid. Returns the number of bytes allocated.
+ ***********************************************************************
+ */
+int init_coding_worker (VideoParameters *p_Vid, VideoParameters *worker, StatParameters *p_Stats)
+{
+  int memory_size = 0;
+
+  if ((worker->b8x8info = (Block8x8Info *) calloc(1, sizeof(Block8x8Info))) == NULL)
+    no_mem_exit("init_coding_worker: worker->b8x8info");
+  memory_size += sizeof(Block8x8Info);
+  if (p_Vid->max_num_references)
+    memory_size += get_mem4Ddistblk (&worker->motion_cost, 8, 2, p_Vid->max_num_references, 4);
+  if (p_Vid->p_SADCache != NULL)
+    memory_size += SADCacheInit(worker);
+  worker->p_Stats = p_Stats;
+
+  return memory_size;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Frees the RD buffers of a worker
+ ***********************************************************************
+ */
+void free_coding_worker (VideoParameters *worker)
+{
+  free(worker->b8x8info);
+  worker->b8x8info = NULL;
+  if (worker->motion_cost)
+    free_mem4Ddistblk (worker->motion_cost);
+  worker->motion_cost = NULL;
+  SADCacheDelete(worker);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    True if the slice starting at start_mb_nr takes its CABAC context
+ *    model from the slice before it, which must then be coded first
+ ***********************************************************************
+ */
+static int uses_previous_context_model (VideoParameters *p_Vid, int start_mb_nr)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  int ctx_number = start_mb_nr / p_Vid->num_mb_per_slice;
+
+  if (p_Inp->symbol_mode != CABAC || p_Inp->context_init_method == 0 || p_Vid->type == I_SLICE)
+    return FALSE;
+
+  return (ctx_number > 0 && !p_Vid->initialized[p_Vid->field_picture][p_Vid->type][ctx_number]);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Sets up the slices of the next batch. Returns the number of slices.
+ ***********************************************************************
+ */
+static int setup_slices (VideoParameters *p_Vid, SliceThreads *p_st)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  int n, i;
+
+  for (n = 0; n < p_st->num_threads; ++n)
+  {
+    VideoParameters *worker = &p_st->worker[n];
+    int start_mb_nr = FmoGetFirstMacroblockInSlice (p_Vid, 0);
+    int last_mb_nr;
+
+    if (start_mb_nr < 0 || (n > 0 && uses_previous_context_model(p_Vid, start_mb_nr)))
+      break;
+
+    memset(&p_st->slice_stats[n], 0, sizeof(StatParameters));
+    p_st->slice[n] = start_encode_slice (p_Vid, 0, &p_st->slice_stats[n]);
+
+    // the worker codes the slice, the master continues with the next one
+    copy_coding_state(worker, p_Vid);
+    *worker->p_Stats = *p_Vid->p_Stats;
+    bind_slice(worker, p_st->slice[n]);
+    get_slice_counters(worker, &p_st->start[n]);
+
+    last_mb_nr = imin(start_mb_nr + p_Inp->slice_argument, (int) p_Vid->PicSizeInMbs) - 1;
+    for (i = start_mb_nr; i <= last_mb_nr; ++i)
+      p_Vid->mb_data[i].slice_nr = p_st->slice[n]->slice_nr;
+    p_st->last_mb_nr[n] = last_mb_nr;
+
+    FmoSetLastMacroblockInSlice (p_Vid, last_mb_nr);
+    p_Vid->current_slice_nr++;
+    p_Vid->p_Stats->bit_slice = 0;
+  }
+
+  return n;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Codes the macroblocks of the slices of the batch taken by one
+ *    thread of the pool
+ ***********************************************************************
+ */
+static void code_slices (void *arg, int thread)
+{
+  SliceThreads *p_st = (SliceThreads *) arg;
+
+  for (;;)
+  {
+    int i;
+
+    lock_thread_pool(p_st->pool);
+    i = p_st->next_slice++;
+    unlock_thread_pool(p_st->pool);
+    if (i >= p_st->batch_size)
+      break;
+
+    p_st->coded_mbs[i] = encode_slice_macroblocks (p_st->slice[i], &p_st->last_mb[i]);
+    end_encode_slice (p_st->last_mb[i], FALSE);
+  }
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Merges the n coded slices of a batch into p_Vid, in slice order.
+ *    Returns the number of coded macroblocks.
+ ***********************************************************************
+ */
+static int merge_slices (VideoParameters *p_Vid, SliceThreads *p_st, int n)
+{
+  SliceCounters sum;
+  int FirstMBInSlice[MAXSLICEGROUPIDS];
+  short current_slice_nr = p_Vid->current_slice_nr;
+  int NumberOfCodedMBs = 0;
+  int i, j;
+
+  get_slice_counters(p_Vid, &sum);
+  memcpy(FirstMBInSlice, p_Vid->FirstMBInSlice, sizeof(FirstMBInSlice));
+
+  // the state left by the last slice is the one the serial loop ends with
+  copy_coding_state(p_Vid, &p_st->worker[n - 1]);
+  p_Vid->current_slice_nr = current_slice_nr;
+  memcpy(p_Vid->FirstMBInSlice, FirstMBInSlice, sizeof(FirstMBInSlice));
+
+  for (i = 0; i < n; ++i)
+  {
+    VideoParameters *worker = &p_st->worker[i];
+    Slice *currSlice = p_st->slice[i];
+    SliceCounters end;
+
+    if (p_st->coded_mbs[i] != p_st->last_mb_nr[i] - currSlice->start_mb_nr + 1)
+    {
+      snprintf(errortext, ET_SIZE, "SliceThreads: slice %d coded %d macroblocks, expected %d.",
+        currSlice->slice_nr, p_st->coded_mbs[i], p_st->last_mb_nr[i] - currSlice->start_mb_nr + 1);
+      error(errortext, 500);
+    }
+
+    get_slice_counters(worker, &end);
+    add_slice_counters(&sum, &end, &p_st->start[i]);
+    if (currSlice->start_mb_nr == 0)
+      p_Vid->BasicUnitQP = worker->BasicUnitQP;
+
+    accumulate_coding_stats(&p_Vid->enc_picture->stats, &p_st->slice_stats[i]);
+    bind_slice(p_Vid, currSlice);
+    for (j = currSlice->start_mb_nr; j <= p_st->last_mb_nr[i]; ++j)
+      p_Vid->mb_data[j].p_Vid = p_Vid;
+    NumberOfCodedMBs += p_st->coded_mbs[i];
+  }
+  set_slice_counters(p_Vid, &sum);
+
+  return NumberOfCodedMBs;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Allocates the workers coding the slices concurrently. Returns the
+ *    number of bytes allocated.
+ ***********************************************************************
+ */
+int SliceThreadsInit (VideoParameters *p_Vid)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  SliceThreads *p_st;
+  int n = p_Inp->SliceThreads;
+  int memory_size = 0;
+  int i;
+
+  if ((p_st = (SliceThreads *) calloc(1, sizeof(SliceThreads))) == NULL)
+    no_mem_exit("SliceThreadsInit: p_st");
+  if ((p_st->worker = (VideoParameters *) calloc(n, sizeof(VideoParameters))) == NULL)
+    no_mem_exit("SliceThreadsInit: p_st->worker");
+  if ((p_st->stats = (StatParameters *) calloc(n, sizeof(StatParameters))) == NULL)
+    no_mem_exit("SliceThreadsInit: p_st->stats");
+  if ((p_st->slice_stats = (StatParameters *) calloc(n, sizeof(StatParameters))) == NULL)
+    no_mem_exit("SliceThreadsInit: p_st->slice_stats");
+  if ((p_st->start = (SliceCounters *) calloc(n, sizeof(SliceCounters))) == NULL)
+    no_mem_exit("SliceThreadsInit: p_st->start");
+  if ((p_st->slice = (Slice **) calloc(n, sizeof(Slice *))) == NULL)
+    no_mem_exit("SliceThreadsInit: p_st->slice");
+  if ((p_st->last_mb = (Macroblock **) calloc(n, sizeof(Macroblock *))) == NULL)
+    no_mem_exit("SliceThreadsInit: p_st->last_mb");
+  if ((p_st->last_mb_nr = (int *) calloc(n, sizeof(int))) == NULL)
+    no_mem_exit("SliceThreadsInit: p_st->last_mb_nr");
+  if ((p_st->coded_mbs = (int *) calloc(n, sizeof(int))) == NULL)
+    no_mem_exit("SliceThreadsInit: p_st->coded_mbs");
+  memory_size += sizeof(SliceThreads) + n * (sizeof(VideoParameters) + 2 * sizeof(StatParameters) + sizeof(SliceCounters)
+    + sizeof(Slice *) + sizeof(Macroblock *) + 2 * sizeof(int));
+
+  for (i = 0; i < n; ++i)
+    memory_size += init_coding_worker(p_Vid, &p_st->worker[i], &p_st->stats[i]);
+
+  p_st->pool = create_thread_pool(n);
+  p_st->num_threads = n;
+  p_Vid->p_SliceThreads = p_st;
+
+  return memory_size;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Frees the slice workers
+ ***********************************************************************
+ */
+void SliceThreadsDelete (VideoParameters *p_Vid)
+{
+  SliceThreads *p_st = p_Vid->p_SliceThreads;
+  int i;
+
+  if (p_st == NULL)
+    return;
+
+  free_thread_pool(p_st->pool);
+  for (i = 0; i < p_st->num_threads; ++i)
+    free_coding_worker(&p_st->worker[i]);
+  free(p_st->coded_mbs);
+  free(p_st->last_mb_nr);
+  free(p_st->last_mb);
+  free(p_st->slice);
+  free(p_st->start);
+  free(p_st->slice_stats);
+  free(p_st->stats);
+  free(p_st->worker);
+  free(p_st);
+  p_Vid->p_SliceThreads = NULL;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Codes all slices of the current picture (or plane), replacing the
+ *    slice loop of code_a_plane(). Returns the number of coded MBs.
+ ***********************************************************************
+ */
+int SliceThreadsEncodePlane (VideoParameters *p_Vid)
+{
+  SliceThreads *p_st = p_Vid->p_SliceThreads;
+  int NumberOfCodedMBs = 0;
+
+  while (NumberOfCodedMBs < (int) p_Vid->PicSizeInMbs)
+  {
+    int n = setup_slices(p_Vid, p_st);
+
+    p_st->batch_size = n;
+    p_st->next_slice = 0;
+    if (!run_thread_pool(p_st->pool, code_slices, p_st))
+      code_slices(p_st, 0);
+
+    NumberOfCodedMBs += merge_slices(p_Vid, p_st, n);
+  }
+
+  // cabac_zero_words depend on the bins and bytes of the whole picture
+  if (p_Vid->p_Inp->symbol_mode == CABAC)
+  {
+    Slice *currSlice = p_Vid->currentSlice;
+    DataPartition *dataPart = &currSlice->partArr[currSlice->max_part_nr - 1];
+
+    if (dataPart->bitstream->write_flag)
+      addCabacZeroWords(p_Vid, dataPart->nal_unit, &p_Vid->enc_picture->stats);
+  }
+
+  return NumberOfCodedMBs;
+}
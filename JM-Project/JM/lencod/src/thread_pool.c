@@ -0,0 +1,322 @@
+
+/*!
+*************************************************************************************
+* \file thread_pool.c
+*
+* \brief
+*    Persistent worker threads of the encoder.
+*
+*    A pool of n threads keeps n - 1 workers alive between jobs. A job is
+*    run by all of them and by the calling thread, which returns once every
+*    worker is done, so a job costs two wake ups instead of creating
+*    threads each time. A pool runs one job at a time; run_thread_pool()
+*    returns 0 without running the job when the pool is in use by another
+*    thread (e.g. another frame coded concurrently), and the caller does
+*    the work itself.
+*
+*    All the threads of the encoder are pool threads: the slices
+*    (SliceThreads), the macroblock rows (WavefrontThreads), the B frame
+*    runs (BFrameThreads), the deblocking (DeblockThreads) and the
+*    lookahead each have their own pool. PatchInp() allows only one of
+*    SliceThreads, WavefrontThreads and BFrameThreads, so pools are not
+*    nested; the frames of a B frame run share the deblocking pool, which
+*    one of them uses at a time.
+*
+*    start_thread_pool() and finish_thread_pool() run a job on the
+*    workers only, while the calling thread goes on with its own work
+*    (e.g. the lookahead, a pool of one worker).
+*
+*    The pool lock and the progress condition may be used by the jobs to
+*    share their own state, e.g. the progress of macroblock rows.
+*
+*************************************************************************************
+*/
+
+#include "global.h"
+#include "thread_pool.h"
+
+#if defined(WIN32) || defined(WIN64)
+
+typedef HANDLE             PoolThread;
+typedef CRITICAL_SECTION   PoolMutex;
+typedef CONDITION_VARIABLE PoolCond;
+
+#define POOL_THREAD_FUNC(f, p)   DWORD WINAPI f (LPVOID p)
+
+static void mutex_init   (PoolMutex *m)              { InitializeCriticalSection(m); }
+static void mutex_free   (PoolMutex *m)              { DeleteCriticalSection(m); }
+static void mutex_lock   (PoolMutex *m)              { EnterCriticalSection(m); }
+static void mutex_unlock (PoolMutex *m)              { LeaveCriticalSection(m); }
+static void cond_init    (PoolCond *c)               { InitializeConditionVariable(c); }
+static void cond_free    (PoolCond *c)               { (void) c; }
+static void cond_wait    (PoolCond *c, PoolMutex *m) { SleepConditionVariableCS(c, m, INFINITE); }
+static void cond_signal  (PoolCond *c)               { WakeAllConditionVariable(c); }
+
+#else
+
+#include <pthread.h>
+
+typedef pthread_t       PoolThread;
+typedef pthread_mutex_t PoolMutex;
+typedef pthread_cond_t  PoolCond;
+
+#define POOL_THREAD_FUNC(f, p)   void *f (void *p)
+
+static void mutex_init   (PoolMutex *m)              { pthread_mutex_init(m, NULL); }
+static void mutex_free   (PoolMutex *m)              { pthread_mutex_destroy(m); }
+static void mutex_lock   (PoolMutex *m)              { pthread_mutex_lock(m); }
+static void mutex_unlock (PoolMutex *m)              { pthread_mutex_unlock(m); }
+static void cond_init    (PoolCond *c)               { pthread_cond_init(c, NULL); }
+static void cond_free    (PoolCond *c)               { pthread_cond_destroy(c); }
+static void cond_wait    (PoolCond *c, PoolMutex *m) { pthread_cond_wait(c, m); }
+static void cond_signal  (PoolCond *c)               { pthread_cond_broadcast(c); }
+
+#endif
+
+typedef struct pool_worker
+{
+  struct thread_pool *pool;
+  int                 index;      //!< thread number passed to the jobs (1..n-1)
+} PoolWorker;
+
+struct thread_pool
+{
+  int         num_threads;        //!< threads running a job, the calling thread included
+  PoolThread *thread;             //!< the num_threads - 1 workers
+  PoolWorker *worker;
+  PoolMutex   lock;               //!< guards the pool and the state the jobs share through it
+  PoolCond    start;              //!< a job was posted or the pool is closing
+  PoolCond    done;               //!< a worker finished the job
+  PoolCond    progress;           //!< signal_thread_pool()
+  ThreadJob   job;
+  void       *arg;
+  int         jobs;               //!< jobs posted so far
+  int         running;            //!< workers still running the current job
+  int         busy;               //!< a job is being run
+  int         quit;
+};
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Main function of a worker: runs each job posted to the pool
+ ***********************************************************************
+ */
+static POOL_THREAD_FUNC(pool_worker_main, p)
+{
+  PoolWorker *w = (PoolWorker *) p;
+  ThreadPool *pool = w->pool;
+  int jobs = 0;
+
+  mutex_lock(&pool->lock);
+  for (;;)
+  {
+    ThreadJob job;
+    void *arg;
+
+    while (pool->jobs == jobs && !pool->quit)
+      cond_wait(&pool->start, &pool->lock);
+    if (pool->quit)
+      break;
+
+    jobs = pool->jobs;
+    job  = pool->job;
+    arg  = pool->arg;
+    mutex_unlock(&pool->lock);
+
+    job(arg, w->index);
+
+    mutex_lock(&pool->lock);
+    if (--pool->running == 0)
+      cond_signal(&pool->done);
+  }
+  mutex_unlock(&pool->lock);
+
+  return 0;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Starts a pool of num_threads threads (the caller and num_threads - 1
+ *    workers)
+ ***********************************************************************
+ */
+ThreadPool *create_thread_pool (int num_threads)
+{
+  ThreadPool *pool;
+  int i;
+
+  if ((pool = (ThreadPool *) calloc(1, sizeof(ThreadPool))) == NULL)
+    no_mem_exit("create_thread_pool: pool");
+
+  pool->num_threads = imax(num_threads, 1);
+  mutex_init(&pool->lock);
+  cond_init(&pool->start);
+  cond_init(&pool->done);
+  cond_init(&pool->progress);
+
+  if (pool->num_threads > 1)
+  {
+    if ((pool->thread = (PoolThread *) calloc(pool->num_threads - 1, sizeof(PoolThread))) == NULL)
+      no_mem_exit("create_thread_pool: pool->thread");
+    if ((pool->worker = (PoolWorker *) calloc(pool->num_threads - 1, sizeof(PoolWorker))) == NULL)
+      no_mem_exit("create_thread_pool: pool->worker");
+  }
+
+  for (i = 0; i < pool->num_threads - 1; ++i)
+  {
+    pool->worker[i].pool  = pool;
+    pool->worker[i].index = i + 1;
+#if defined(WIN32) || defined(WIN64)
+    if ((pool->thread[i] = CreateThread(NULL, 0, pool_worker_main, &pool->worker[i], 0, NULL)) == NULL)
+#else
+    if (pthread_create(&pool->thread[i], NULL, pool_worker_main, &pool->worker[i]) != 0)
+#endif
+      error("create_thread_pool: cannot create worker thread", 500);
+  }
+
+  return pool;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Stops the workers of a pool and frees it
+ ***********************************************************************
+ */
+void free_thread_pool (ThreadPool *pool)
+{
+  int i;
+
+  if (pool == NULL)
+    return;
+
+  mutex_lock(&pool->lock);
+  pool->quit = 1;
+  cond_signal(&pool->start);
+  mutex_unlock(&pool->lock);
+
+  for (i = 0; i < pool->num_threads - 1; ++i)
+  {
+#if defined(WIN32) || defined(WIN64)
+    WaitForSingleObject(pool->thread[i], INFINITE);
+    CloseHandle(pool->thread[i]);
+#else
+    pthread_join(pool->thread[i], NULL);
+#endif
+  }
+
+  cond_free(&pool->progress);
+  cond_free(&pool->done);
+  cond_free(&pool->start);
+  mutex_free(&pool->lock);
+  free(pool->worker);
+  free(pool->thread);
+  free(pool);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Starts job(arg, thread) on the workers of the pool (not on the
+ *    calling thread) and returns at once; finish_thread_pool() waits
+ *    for it.
+ * \return
+ *    1 if the job was started, 0 if the pool is running another job
+ ***********************************************************************
+ */
+int start_thread_pool (ThreadPool *pool, ThreadJob job, void *arg)
+{
+  mutex_lock(&pool->lock);
+  if (pool->busy)
+  {
+    mutex_unlock(&pool->lock);
+    return 0;
+  }
+  pool->busy    = 1;
+  pool->job     = job;
+  pool->arg     = arg;
+  pool->running = pool->num_threads - 1;
+  pool->jobs++;
+  cond_signal(&pool->start);
+  mutex_unlock(&pool->lock);
+
+  return 1;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Waits until the workers are done with the job started by
+ *    start_thread_pool()
+ ***********************************************************************
+ */
+void finish_thread_pool (ThreadPool *pool)
+{
+  mutex_lock(&pool->lock);
+  while (pool->running > 0)
+    cond_wait(&pool->done, &pool->lock);
+  pool->busy = 0;
+  mutex_unlock(&pool->lock);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Runs job(arg, thread) on every thread of the pool and returns once
+ *    all of them are done.
+ * \return
+ *    1 if the job was run, 0 if the pool is running another job
+ ***********************************************************************
+ */
+int run_thread_pool (ThreadPool *pool, ThreadJob job, void *arg)
+{
+  if (!start_thread_pool(pool, job, arg))
+    return 0;
+
+  job(arg, 0);
+  finish_thread_pool(pool);
+
+  return 1;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Lock of the state the threads of a job share
+ ***********************************************************************
+ */
+void lock_thread_pool (ThreadPool *pool)
+{
+  mutex_lock(&pool->lock);
+}
+
+void unlock_thread_pool (ThreadPool *pool)
+{
+  mutex_unlock(&pool->lock);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Waits, with the pool locked, until a thread calls
+ *    signal_thread_pool()
+ ***********************************************************************
+ */
+void wait_thread_pool (ThreadPool *pool)
+{
+  cond_wait(&pool->progress, &pool->lock);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Wakes the threads waiting in wait_thread_pool(); called with the
+ *    pool locked
+ ***********************************************************************
+ */
+void signal_thread_pool (ThreadPool *pool)
+{
+  cond_signal(&pool->progress);
+}
@@ -1393,8 +1393,8 @@ void trace2out(SyntaxElement *sym)
         fputc('0', p_Enc->p_trace);
     }
     fprintf(p_Enc->p_trace, " (%3d) \n",sym->value1);
+    fflush (p_Enc->p_trace);
   }
-  fflush (p_Enc->p_trace);
 }
 
 void trace2out_cabac(SyntaxElement *sym)
@@ -1413,8 +1413,8 @@ void trace2out_cabac(SyntaxElement *sym)
       putc(' ',p_Enc->p_trace);
 
     fprintf(p_Enc->p_trace, " (%3d) \n",sym->value1);
+    fflush (p_Enc->p_trace);
   }
-  fflush (p_Enc->p_trace);
   bitcounter += sym->len;
 }
 #endif
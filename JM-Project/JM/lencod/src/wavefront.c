@@ -0,0 +1,407 @@
+
+/*!
+*************************************************************************************
+* \file wavefront.c
+*
+* \brief
+*    Wavefront mode decision of the macroblock rows of a picture
+*    (WavefrontThreads > 1).
+*
+*    A picture coded as one slice (SliceMode = 0) is coded in two passes.
+*    The mode decision pass runs the macroblock rows concurrently on a
+*    thread pool of WavefrontThreads threads, each row two macroblocks
+*    behind the row above, so that the left, upper
+*    and upper right neighbours of a macroblock are always decided (and
+*    reconstructed) before it. Each thread decides its rows with a private
+*    copy of the coding state (a worker) and of the slice, writing the
+*    macroblocks to a private bitstream for the rate estimates only. As in
+*    WPP, the CABAC models of a row start from those left by the second
+*    macroblock of the row above and the EPZS memory of a row starts
+*    cleared, so the decisions do not depend on the number of threads.
+*    The coefficients of each macroblock are kept, and the entropy coding
+*    pass then writes the macroblocks to the slice in raster order from
+*    the recorded decisions.
+*
+*    The bitstream is a conformant single slice picture. It differs from
+*    the one coded macroblock by macroblock since the rate estimates of
+*    the mode decision see other CABAC models. Configurations with other
+*    state carried from macroblock to macroblock are rejected in
+*    PatchInp().
+*
+*************************************************************************************
+*/
+
+#include "global.h"
+#include "wavefront.h"
+#include "slice_threads.h"
+#include "slice.h"
+#include "macroblock.h"
+#include "biariencode.h"
+#include "fmo.h"
+#include "memalloc.h"
+#include "me_epzs_common.h"
+#include "thread_pool.h"
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Waits until mbs macroblocks of the given row are decided. done is
+ *    the number last seen, the pool is not locked when it suffices.
+ ***********************************************************************
+ */
+static void wait_for_row (Wavefront *p_wf, int row, int mbs, int *done)
+{
+  if (row < 0 || *done >= mbs)
+    return;
+
+  lock_thread_pool(p_wf->pool);
+  while ((*done = p_wf->mbs_done[row]) < mbs)
+    wait_thread_pool(p_wf->pool);
+  unlock_thread_pool(p_wf->pool);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Sets up worker t for deciding the given row: the coding state is
+ *    taken from p_Vid, the bitstream and the EPZS memory are reset and
+ *    the CABAC models are loaded from those kept for the row
+ ***********************************************************************
+ */
+static void start_row (VideoParameters *p_Vid, Wavefront *p_wf, int t, int row)
+{
+  VideoParameters *worker = &p_wf->worker[t];
+  Slice *currSlice = p_wf->slice[t];
+  int i;
+
+  copy_coding_state(worker, p_Vid);
+  worker->currentSlice = currSlice;
+  worker->cod_counter  = 0;
+
+  for (i = 0; i < currSlice->max_part_nr; ++i)
+  {
+    DataPartition *dataPart = &currSlice->partArr[i];
+    Bitstream *currStream = dataPart->bitstream;
+
+    currStream->bits_to_go = 8;
+    currStream->byte_pos   = 0;
+    currStream->byte_buf   = 0;
+    if (currSlice->symbol_mode == CABAC)
+    {
+      arienco_start_encoding(&dataPart->ee_cabac, currStream->streamBuffer, &(currStream->byte_pos));
+      arienco_reset_EC(&dataPart->ee_cabac);
+    }
+  }
+
+  if (currSlice->symbol_mode == CABAC)
+  {
+    *currSlice->mot_ctx = p_wf->mot_ctx[row];
+    *currSlice->tex_ctx = p_wf->tex_ctx[row];
+  }
+
+  if (currSlice->p_EPZS != NULL)
+    EPZSResetMemory(currSlice);
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Decides the macroblocks of a row with worker t
+ ***********************************************************************
+ */
+static void decide_row (VideoParameters *p_Vid, Wavefront *p_wf, int t, int row)
+{
+  VideoParameters *worker = &p_wf->worker[t];
+  Slice *currSlice = p_wf->slice[t];
+  int width = p_Vid->PicWidthInMbs;
+  int last_row = (int) p_Vid->PicSizeInMbs / width - 1;
+  Macroblock *currMB;
+  int above = 0;
+  int x;
+
+  // the models of the row are those left by the second macroblock above
+  wait_for_row(p_wf, row - 1, imin(2, width), &above);
+  start_row(p_Vid, p_wf, t, row);
+
+  for (x = 0; x < width; ++x)
+  {
+    int mb_nr = row * width + x;
+
+    wait_for_row(p_wf, row - 1, imin(x + 2, width), &above);
+
+    code_slice_macroblock(currSlice, &currMB, mb_nr);
+
+    // keep the coefficients for the entropy coding pass
+    memcpy(&p_wf->cofAC[mb_nr][0][0][0][0], &currSlice->cofAC[0][0][0][0], (4 + p_Vid->num_blk8x8_uv) * 4 * 2 * 65 * sizeof(int));
+    memcpy(&p_wf->cofDC[mb_nr][0][0][0], &currSlice->cofDC[0][0][0], 3 * 2 * 18 * sizeof(int));
+
+    if (x == imin(1, width - 1) && row < last_row && currSlice->symbol_mode == CABAC)
+    {
+      p_wf->mot_ctx[row + 1] = *currSlice->mot_ctx;
+      p_wf->tex_ctx[row + 1] = *currSlice->tex_ctx;
+    }
+
+    lock_thread_pool(p_wf->pool);
+    p_wf->mbs_done[row] = x + 1;
+    signal_thread_pool(p_wf->pool);
+    unlock_thread_pool(p_wf->pool);
+  }
+
+  p_wf->me_time[t]     += worker->me_time     - p_Vid->me_time;
+  p_wf->me_tot_time[t] += worker->me_tot_time - p_Vid->me_tot_time;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Decides the rows taken by one thread of the pool, in order of
+ *    increasing row
+ ***********************************************************************
+ */
+static void decide_rows (void *arg, int thread)
+{
+  Wavefront *p_wf = (Wavefront *) arg;
+  VideoParameters *p_Vid = p_wf->p_Vid;
+  int rows = (int) p_Vid->PicSizeInMbs / p_Vid->PicWidthInMbs;
+
+  for (;;)
+  {
+    int row;
+
+    lock_thread_pool(p_wf->pool);
+    row = p_wf->next_row++;
+    unlock_thread_pool(p_wf->pool);
+    if (row >= rows)
+      break;
+
+    decide_row(p_Vid, p_wf, thread, row);
+  }
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Writes the decided macroblocks of the plane to the slice, in raster
+ *    order. Returns the number of coded MBs.
+ ***********************************************************************
+ */
+static int write_plane (VideoParameters *p_Vid, Wavefront *p_wf, Slice *currSlice, Macroblock **currMB)
+{
+  int ****cofAC = currSlice->cofAC;
+  int ***cofDC  = currSlice->cofDC;
+  Boolean end_of_slice = FALSE;
+  Boolean recode_macroblock;
+  int NumberOfCodedMBs = 0;
+  int mb_nr;
+
+  for (mb_nr = 0; mb_nr < (int) p_Vid->PicSizeInMbs; ++mb_nr)
+  {
+    *currMB = &p_Vid->mb_data[mb_nr];
+    (*currMB)->p_Slice = currSlice;
+    (*currMB)->p_Vid   = p_Vid;
+    set_MB_parameters (currSlice, *currMB);
+    p_Vid->qp = (*currMB)->qp;
+
+    currSlice->cofAC = p_wf->cofAC[mb_nr];
+    currSlice->cofDC = p_wf->cofDC[mb_nr];
+
+    // the syntax elements the writing accumulates start from the state
+    // the macroblock was decided with
+    memset(&(*currMB)->bits, 0, sizeof(BitCounter));
+    memset((*currMB)->cbp_bits    , 0, 3 * sizeof(int64));
+    memset((*currMB)->cbp_bits_8x8, 0, 3 * sizeof(int64));
+    memset((*currMB)->mvd, 0, BLOCK_CONTEXT * sizeof(short));
+
+    write_macroblock (*currMB, 1);
+    end_macroblock (*currMB, &end_of_slice, &recode_macroblock);
+
+    p_Vid->SumFrameQP += (*currMB)->qp;
+    NumberOfCodedMBs++;
+    next_macroblock (*currMB);
+  }
+
+  currSlice->cofAC = cofAC;
+  currSlice->cofDC = cofDC;
+
+  return NumberOfCodedMBs;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Allocates the workers and the per macroblock and row storage of the
+ *    wavefront mode decision. Returns the number of bytes allocated.
+ ***********************************************************************
+ */
+int WavefrontInit (VideoParameters *p_Vid)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  Wavefront *p_wf;
+  int n = p_Inp->WavefrontThreads;
+  int mbs = p_Vid->FrameSizeInMbs;
+  int rows = p_Vid->FrameHeightInMbs;
+  int memory_size = 0;
+  int i;
+
+  if ((p_wf = (Wavefront *) calloc(1, sizeof(Wavefront))) == NULL)
+    no_mem_exit("WavefrontInit: p_wf");
+  if ((p_wf->worker = (VideoParameters *) calloc(n, sizeof(VideoParameters))) == NULL)
+    no_mem_exit("WavefrontInit: p_wf->worker");
+  if ((p_wf->stats = (StatParameters *) calloc(n, sizeof(StatParameters))) == NULL)
+    no_mem_exit("WavefrontInit: p_wf->stats");
+  if ((p_wf->slice_stats = (StatParameters *) calloc(n, sizeof(StatParameters))) == NULL)
+    no_mem_exit("WavefrontInit: p_wf->slice_stats");
+  if ((p_wf->slice = (Slice **) calloc(n, sizeof(Slice *))) == NULL)
+    no_mem_exit("WavefrontInit: p_wf->slice");
+  if ((p_wf->me_time = (int64 *) calloc(n, sizeof(int64))) == NULL)
+    no_mem_exit("WavefrontInit: p_wf->me_time");
+  if ((p_wf->me_tot_time = (int64 *) calloc(n, sizeof(int64))) == NULL)
+    no_mem_exit("WavefrontInit: p_wf->me_tot_time");
+  memory_size += sizeof(Wavefront) + n * (sizeof(VideoParameters) + 2 * sizeof(StatParameters) + sizeof(Slice *) + 2 * sizeof(int64));
+
+  for (i = 0; i < n; ++i)
+    memory_size += init_coding_worker(p_Vid, &p_wf->worker[i], &p_wf->stats[i]);
+
+  if ((p_wf->cofAC = (int *****) calloc(mbs, sizeof(int ****))) == NULL)
+    no_mem_exit("WavefrontInit: p_wf->cofAC");
+  if ((p_wf->cofDC = (int ****) calloc(mbs, sizeof(int ***))) == NULL)
+    no_mem_exit("WavefrontInit: p_wf->cofDC");
+  for (i = 0; i < mbs; ++i)
+  {
+    memory_size += get_mem_ACcoeff(p_Vid, &p_wf->cofAC[i]);
+    memory_size += get_mem_DCcoeff(&p_wf->cofDC[i]);
+  }
+
+  if (p_Inp->symbol_mode == CABAC)
+  {
+    if ((p_wf->mot_ctx = (MotionInfoContexts *) calloc(rows, sizeof(MotionInfoContexts))) == NULL)
+      no_mem_exit("WavefrontInit: p_wf->mot_ctx");
+    if ((p_wf->tex_ctx = (TextureInfoContexts *) calloc(rows, sizeof(TextureInfoContexts))) == NULL)
+      no_mem_exit("WavefrontInit: p_wf->tex_ctx");
+    memory_size += rows * (sizeof(MotionInfoContexts) + sizeof(TextureInfoContexts));
+  }
+
+  if ((p_wf->mbs_done = (int *) calloc(rows, sizeof(int))) == NULL)
+    no_mem_exit("WavefrontInit: p_wf->mbs_done");
+  memory_size += mbs * (sizeof(int ****) + sizeof(int ***)) + rows * sizeof(int);
+
+  p_wf->pool = create_thread_pool(n);
+  p_wf->num_threads = n;
+  p_Vid->p_Wavefront = p_wf;
+
+  return memory_size;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Frees the wavefront mode decision
+ ***********************************************************************
+ */
+void WavefrontDelete (VideoParameters *p_Vid)
+{
+  Wavefront *p_wf = p_Vid->p_Wavefront;
+  int i;
+
+  if (p_wf == NULL)
+    return;
+
+  free_thread_pool(p_wf->pool);
+  for (i = 0; i < p_wf->num_threads; ++i)
+    free_coding_worker(&p_wf->worker[i]);
+  for (i = 0; i < (int) p_Vid->FrameSizeInMbs; ++i)
+  {
+    free_mem_ACcoeff(p_wf->cofAC[i]);
+    free_mem_DCcoeff(p_wf->cofDC[i]);
+  }
+  free(p_wf->mbs_done);
+  free(p_wf->tex_ctx);
+  free(p_wf->mot_ctx);
+  free(p_wf->cofDC);
+  free(p_wf->cofAC);
+  free(p_wf->me_tot_time);
+  free(p_wf->me_time);
+  free(p_wf->slice);
+  free(p_wf->slice_stats);
+  free(p_wf->stats);
+  free(p_wf->worker);
+  free(p_wf);
+  p_Vid->p_Wavefront = NULL;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Codes the current picture (or plane) as one slice, replacing the
+ *    slice loop of code_a_plane(). Returns the number of coded MBs.
+ ***********************************************************************
+ */
+int WavefrontEncodePlane (VideoParameters *p_Vid)
+{
+  Wavefront *p_wf = p_Vid->p_Wavefront;
+  int rows = (int) p_Vid->PicSizeInMbs / p_Vid->PicWidthInMbs;
+  Macroblock *currMB = NULL;
+  Slice *currSlice;
+  int NumberOfCodedMBs;
+  int i;
+
+  currSlice = start_encode_slice (p_Vid, 0, &p_Vid->enc_picture->stats);
+
+  // all macroblocks are coded with the slice QP, so that the first
+  // macroblock of a row does not depend on the end of the row above
+  for (i = 0; i < (int) p_Vid->PicSizeInMbs; ++i)
+  {
+    p_Vid->mb_data[i].slice_nr = currSlice->slice_nr;
+    p_Vid->mb_data[i].qp       = (short) p_Vid->qp;
+    p_Vid->mb_data[i].prev_qp  = (short) p_Vid->qp;
+  }
+  for (i = 0; i < rows; ++i)
+    p_wf->mbs_done[i] = 0;
+
+  if (currSlice->symbol_mode == CABAC)
+  {
+    p_wf->mot_ctx[0] = *currSlice->mot_ctx;
+    p_wf->tex_ctx[0] = *currSlice->tex_ctx;
+  }
+
+  for (i = 0; i < p_wf->num_threads; ++i)
+  {
+    VideoParameters *worker = &p_wf->worker[i];
+
+    copy_coding_state(worker, p_Vid);
+    *worker->p_Stats = *p_Vid->p_Stats;
+    p_wf->slice[i] = copy_slice(worker, currSlice);
+    p_wf->slice[i]->cur_stats = &p_wf->slice_stats[i];
+    p_wf->me_time[i] = p_wf->me_tot_time[i] = 0;
+  }
+
+  // the decisions do not depend on the number of threads, nor on which
+  // thread decides a row
+  p_wf->p_Vid    = p_Vid;
+  p_wf->next_row = 0;
+  if (!run_thread_pool(p_wf->pool, decide_rows, p_wf))
+    decide_rows(p_wf, 0);
+
+  for (i = 0; i < p_wf->num_threads; ++i)
+  {
+    p_Vid->me_time     += p_wf->me_time[i];
+    p_Vid->me_tot_time += p_wf->me_tot_time[i];
+  }
+
+  NumberOfCodedMBs = write_plane(p_Vid, p_wf, currSlice, &currMB);
+  p_Vid->BasicUnitQP = p_Vid->mb_data[0].qp;
+
+  end_encode_slice (currMB, TRUE);
+
+  FmoSetLastMacroblockInSlice (p_Vid, p_Vid->current_mb_nr);
+  p_Vid->current_slice_nr++;
+  p_Vid->p_Stats->bit_slice = 0;
+
+  for (i = 0; i < p_wf->num_threads; ++i)
+  {
+    free_slice_copy(p_wf->slice[i]);
+    p_wf->slice[i] = NULL;
+  }
+
+  return NumberOfCodedMBs;
+}
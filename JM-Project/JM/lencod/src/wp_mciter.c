@@ -17,6 +17,7 @@
 #include "global.h"
 #include "image.h"
 #include "wp.h"
+#include "img_luma_tile.h"
 
 /*!
 ************************************************************************
@@ -810,6 +811,8 @@ void compute_offset(Slice *currSlice)
                 //x_pos = imax(0,imin(out4Y_width, 4*(x+xj)+4*IMG_PAD_SIZE+mvx));
                 x_pos = imax(-4*IMG_PAD_SIZE_X, imin(out4Y_width, 4*(x+xj)+mvx));
 
+                if (currSlice->listX[LIST_0][ref_frame]->sub_tile_map && ((x_pos | y_pos) & 0x03))
+                  LazySubPelFill(p_Vid, currSlice->listX[LIST_0][ref_frame], (x_pos >> 2) + IMG_PAD_SIZE_X, (y_pos >> 2) + IMG_PAD_SIZE_Y, 1, 1);
                 temp=currSlice->listX[LIST_0][ref_frame]->p_curr_img_sub[(y_pos & 0x03)][(x_pos & 0x03)][y_pos >> 2][x_pos >> 2];
                 p_Vid->frameOffsetTotal[LIST_0][ref_frame]+=(valOrg-temp);
                 p_Vid->frameOffsetCount[LIST_0][ref_frame]++;          
@@ -835,6 +838,8 @@ void compute_offset(Slice *currSlice)
                 //x_pos = imax(0, imin(out4Y_width, 4*(x+xj)+4*IMG_PAD_SIZE+mvx));
                 x_pos = imax(-4*IMG_PAD_SIZE_X, imin(out4Y_width, 4*(x+xj) + mvx));
 
+                if (currSlice->listX[LIST_0][ref_frame]->sub_tile_map && ((x_pos | y_pos) & 0x03))
+                  LazySubPelFill(p_Vid, currSlice->listX[LIST_0][ref_frame], (x_pos >> 2) + IMG_PAD_SIZE_X, (y_pos >> 2) + IMG_PAD_SIZE_Y, 1, 1);
                 temp=currSlice->listX[LIST_0][ref_frame]->p_curr_img_sub[(y_pos & 0x03)][(x_pos & 0x03)][y_pos >> 2][x_pos >> 2];
                 p_Vid->frameOffsetTotal[LIST_1][ref_frame]+=(valOrg-temp);
                 p_Vid->frameOffsetCount[LIST_1][ref_frame]++;          
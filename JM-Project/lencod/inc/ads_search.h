@@ -4,6 +4,21 @@
 
 MV xDiamondSearchOpt(const Frame* ref, const Frame* cur, int bx, int by, MEParams params, MV init);
 MV xDiamondSearchADS(const Frame* ref, const Frame* cur, int bx, int by, MEParams params, MV init);
+// Per-block convergence counters, filled by the *Stats variants below. The plain
+// entry points are compiled without any of this bookkeeping.
+typedef struct {
+    unsigned int points;       // SAD evaluations, including the start point(s)
+    unsigned int ldsp_points;  // evaluated large-diamond candidates
+    unsigned int sdsp_points;  // evaluated small-diamond candidates
+    unsigned int iterations;   // pattern steps taken
+    unsigned int clipped;      // candidates dropped by the search window
+    unsigned char early_exit;  // stopped on the SAD threshold (DS opt only)
+    unsigned char iter_cap;    // stopped by max_iters before converging
+    unsigned char budget_hit;  // stopped by params.max_points (DS opt only)
+} SearchStats;
+
+MV xDiamondSearchOptStats(const Frame* ref, const Frame* cur, int bx, int by, MEParams params, MV init, SearchStats* st);
+MV xDiamondSearchADSStats(const Frame* ref, const Frame* cur, int bx, int by, MEParams params, MV init, SearchStats* st);
 MV full_search_motion_estimation(const Frame* ref, const Frame* cur, int bx, int by, MEParams params, MV init);
 
 unsigned int sad_block(const Frame* ref, const Frame* cur, int rx, int ry, int bx, int by, int bw, int bh);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "defines.h"
+#include "ads_search.h"
+
+// Per-frame search controller for DS opt. From the previous frame's MVs and
+// convergence counters it picks each block's search range and iteration cap
+// (adaptive mode), and it splits a per-frame point budget across the blocks so
+// that ME never evaluates more than `frame_budget` SADs per frame.
+typedef struct BudgetCtl BudgetCtl;
+
+typedef struct {
+    unsigned long long budget;     // 0 = no frame budget
+    unsigned long long used;       // SAD evaluations spent this frame
+    int blocks;
+    int budget_hits;               // blocks stopped by their point allowance
+    int skipped;                   // blocks left at their predictor, budget already spent
+    double avg_range;
+    double avg_iters;
+} BudgetReport;
+
+// base = configured block size, range and iteration cap (the upper bounds).
+BudgetCtl* budget_create(int blocks_x, int blocks_y, const MEParams* base, unsigned long long frame_budget, int adaptive);
+void budget_frame_begin(BudgetCtl* ctl);
+// Fills out for block (bx, by). Returns 0 if the frame budget is exhausted and the
+// block must not be searched.
+int budget_block_params(BudgetCtl* ctl, int bx, int by, MEParams* out);
+// Result of the block just searched (st == NULL for a skipped block).
+void budget_block_done(BudgetCtl* ctl, int bx, int by, MV mv, const SearchStats* st);
+void budget_frame_end(BudgetCtl* ctl, BudgetReport* report);
+void budget_destroy(BudgetCtl* ctl);
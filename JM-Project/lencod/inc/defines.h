@@ -22,4 +22,5 @@ typedef struct {
     int block_h;
     int search_range; // +/- range
     int max_iters;     // safety cap
+    unsigned int max_points; // SAD evaluations allowed per block, 0 = unlimited (DS opt only)
 } MEParams;
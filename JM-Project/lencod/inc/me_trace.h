@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Per-block ME trace, shared with JM's lencod (JM/lencod/inc/me_trace.h).
+// File = 16-byte header followed by fixed 36-byte records, all little-endian:
+//   header: "METR", u32 version, u32 width, u32 height
+//   record: u32 frame, u32 ref_frame, u16 x, u16 y, u8 w, u8 h, u8 list, u8 ref_idx,
+//           u16 range, u16 reserved, i16 pred_x, i16 pred_y, i16 mv_x, i16 mv_y,
+//           u32 cost, u32 points
+// Frame numbers index the input YUV file; MVs and predictors are integer-pel.
+#define ME_TRACE_VERSION     1
+#define ME_TRACE_HEADER_SIZE 16
+#define ME_TRACE_RECORD_SIZE 36
+
+typedef struct {
+    uint32_t frame;      // current frame in the YUV file
+    uint32_t ref_frame;  // reference frame in the YUV file
+    uint16_t x;          // block position in pels
+    uint16_t y;
+    uint8_t w;           // block size in pels
+    uint8_t h;
+    uint8_t list;
+    uint8_t ref_idx;
+    uint16_t range;      // +/- search range the block was searched with
+    int16_t pred_x;      // search start (predictor)
+    int16_t pred_y;
+    int16_t mv_x;        // chosen MV
+    int16_t mv_y;
+    uint32_t cost;       // cost reported by the searching encoder
+    uint32_t points;     // search points visited
+} METraceRecord;
+
+int me_trace_write_header(FILE* f, int width, int height);
+int me_trace_write(FILE* f, const METraceRecord* rec);
+// Returns 1 and fills width/height on a valid header, 0 otherwise.
+int me_trace_read_header(FILE* f, int* width, int* height);
+// Returns 1 per record, 0 at end of file.
+int me_trace_read(FILE* f, METraceRecord* rec);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+#include "defines.h"
+#include "yuv_reader.h"
+
+// A frame that has been read and prepared ahead of motion estimation.
+typedef struct {
+    Frame luma;           // zero-copy view into the mapping (owned copy on the stdio fallback)
+    int index;            // frame number in the sequence
+} PreparedFrame;
+
+typedef struct {
+    unsigned long long frames;
+    unsigned long long depth_sum; // ready frames in the queue, sampled at every pop
+    int depth_max;
+    double consumer_stall_ms;     // ME waiting for the next frame
+    double producer_stall_ms;     // I/O thread waiting for a free slot
+    double prepare_ms;            // page-in, on the I/O thread
+} PrefetchStats;
+
+typedef struct Prefetcher Prefetcher;
+
+// depth = how many frames the I/O thread may run ahead of ME (0 = prepare synchronously).
+Prefetcher* prefetch_start(YUVReader* rd, int frames, int depth);
+// Next frame in order, or NULL once the sequence is exhausted. Blocks until it is ready.
+const PreparedFrame* prefetch_next(Prefetcher* pf);
+// Hands back the oldest frame obtained from prefetch_next().
+void prefetch_release(Prefetcher* pf);
+void prefetch_stop(Prefetcher* pf, PrefetchStats* stats);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "ads_search.h"
+
+#define STATS_ITER_BINS  17 // 0..15 iterations, last bin = 16+
+#define STATS_POINT_BINS 17 // 4-point wide bins, last bin = 64+
+
+// Per-frame-pair summary of SearchStats for one DS variant, plus the per-block
+// point map used for the heatmap.
+typedef struct {
+    int blocks_x;
+    int blocks_y;
+    unsigned int* block_points;  // blocks_x * blocks_y, raster order
+    unsigned long long blocks;
+    unsigned long long points;
+    unsigned long long ldsp_points;
+    unsigned long long sdsp_points;
+    unsigned long long iterations;
+    unsigned long long clipped;
+    unsigned long long early_exits;
+    unsigned long long iter_caps;
+    unsigned long long iter_hist[STATS_ITER_BINS];
+    unsigned long long point_hist[STATS_POINT_BINS];
+} StatsSummary;
+
+int stats_summary_init(StatsSummary* sum, int blocks_x, int blocks_y);
+void stats_summary_add(StatsSummary* sum, int bx, int by, const SearchStats* st);
+void stats_summary_print(const StatsSummary* sum, const char* label);
+// Writes an 8-bit PGM of points per block at frame resolution (white = most points).
+int stats_write_heatmap(const StatsSummary* sum, const char* path, int block_w, int block_h);
+void stats_summary_free(StatsSummary* sum);
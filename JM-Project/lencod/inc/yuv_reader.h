@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+#include "defines.h"
+
+// Read-only YUV420 sequence mapped into memory (Y plane exposed, chroma skipped).
+// Frames handed out by yuv_reader_get_luma() point straight into the mapping,
+// so they must not be written to and are only valid until yuv_reader_close().
+// On the stdio fallback only the last two frames fetched stay valid.
+typedef struct {
+    int width;
+    int height;
+    int frames;           // number of complete frames in the file
+    uint64_t luma_size;   // width * height
+    uint64_t frame_size;  // luma + both 4:2:0 chroma planes
+    uint64_t file_size;
+    uint8_t* base;        // start of the mapping, NULL on the stdio fallback
+    int fd;
+    void* fp;             // FILE* used by the stdio fallback, NULL when mapped
+    uint8_t* cache[2];    // stdio fallback: the two most recently read luma planes
+    int cache_frame[2];
+    int cache_next;
+} YUVReader;
+
+int yuv_reader_open(YUVReader* rd, const char* path, int width, int height);
+int yuv_reader_get_luma(YUVReader* rd, int idx, Frame* out);
+void yuv_reader_release(YUVReader* rd, int idx);
+void yuv_reader_close(YUVReader* rd);
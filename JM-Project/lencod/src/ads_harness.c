@@ -4,13 +4,18 @@
 #include <time.h>
 #include "defines.h"
 #include "ads_search.h"
+#include "yuv_reader.h"
+#include "prefetch.h"
+#include "me_trace.h"
+#include "search_stats.h"
+#include "budget.h"
 
 unsigned long long g_sad_count_fs = 0;
 unsigned long long g_sad_count_ds = 0;
 int g_count_mode = 0; // 0: none, 1: FS, 2: DS
 
 typedef struct {
-    const char* input_path; // YUV420 file (Y plane only)
+    const char* input_path; // YUV420 file (Y plane only, memory-mapped)
     int width;
     int height;
     int frames;
@@ -18,12 +23,45 @@ typedef struct {
     int block_h;
     int search_range;
     int max_iters;
+    int prefetch;   // frames the I/O thread may read ahead (0 = synchronous)
+    const char* trace_out;  // per-block DS opt trace to write
+    const char* replay;     // trace to replay against -i instead of the normal comparison
+    const char* algo;       // search used for --replay: opt, base or fs
+    int stats;              // per-block convergence counters and histograms for both DS variants
+    const char* heatmap;    // PGM heatmap path prefix (implies stats)
+    int adaptive;           // DS opt range/iteration cap learned from the previous frame
+    unsigned long long point_budget; // DS opt SAD evaluations allowed per frame, 0 = unlimited
     int verbose;
 } CLIParams;
 
+// Destination for per-block trace records of the current frame pair.
+typedef struct {
+    FILE* f;
+    int ref_no;
+    int cur_no;
+} TraceSink;
+
+typedef MV (*SearchFn)(const Frame*, const Frame*, int, int, MEParams, MV);
+typedef MV (*StatsSearchFn)(const Frame*, const Frame*, int, int, MEParams, MV, SearchStats*);
+
+typedef struct {
+    const char* name;
+    SearchFn fn;
+    int count_mode;
+} SearchAlgo;
+
+static const SearchAlgo g_algos[] = {
+    { "opt",  xDiamondSearchOpt,             2 },
+    { "base", xDiamondSearchADS,             2 },
+    { "fs",   full_search_motion_estimation, 1 },
+};
+
 static void print_usage(const char* exe) {
-    printf("Usage: %s [-i input.yuv -w W -h H --frames N] [--block B] [--range R] [--max-iters M] [--verbose]\n", exe);
+    printf("Usage: %s [-i input.yuv -w W -h H --frames N] [--block B] [--range R] [--max-iters M] [--prefetch D] [--trace-out T] [--replay T --algo opt|base|fs] [--stats] [--heatmap P] [--adaptive] [--point-budget N] [--verbose]\n", exe);
     printf("If -i is omitted, runs synthetic gradient + shift (3,-2) unit test; otherwise runs YUV test (Y plane only).\n");
+    printf("--trace-out writes a per-block DS opt trace; --replay re-runs a trace (harness or JM) against -i and diffs the MVs.\n");
+    printf("--stats prints DS iteration/point histograms; --heatmap P also writes P_f<frame>_<opt|base>.pgm (points per block).\n");
+    printf("--adaptive sets DS opt range/iterations per block from the previous frame; --point-budget caps DS opt SADs per frame.\n");
 }
 
 static int parse_int(const char* s, int* out) {
@@ -35,17 +73,26 @@ static int parse_int(const char* s, int* out) {
     return 1;
 }
 
-static int read_y_plane(FILE* f, Frame* dst, int width, int height) {
-    size_t sz = (size_t)width * (size_t)height;
-    size_t rd = fread(dst->data, 1, sz, f);
-    return rd == sz;
-}
+// One DS variant to run over a frame pair.
+typedef struct {
+    const char* label;
+    SearchFn fn;
+    StatsSearchFn stats_fn;  // counting variant, used when print_stats or budget is set
+    int print_stats;
+    const char* heatmap;     // written when print_stats is set, NULL for none
+    BudgetCtl* budget;       // per-block params and frame point budget, NULL for fixed params
+} DSRun;
 
-static void run_ds(const char* label,
-                   MV (*ds_fn)(const Frame*, const Frame*, int, int, MEParams, MV),
-                   const Frame* ref, const Frame* cur, const MEParams* params,
+static void run_ds(const DSRun* run, const Frame* ref, const Frame* cur, const MEParams* params,
                    int blocks_x, int blocks_y, int block_w, int block_h,
-                   const unsigned int* fs_costs, int verbose) {
+                   const unsigned int* fs_costs, const TraceSink* trace, int verbose) {
+    const char* label = run->label;
+    StatsSearchFn stats_fn = (run->print_stats || run->budget) ? run->stats_fn : NULL;
+    int print_stats = run->print_stats;
+    StatsSummary summary;
+    if (print_stats && !stats_summary_init(&summary, blocks_x, blocks_y)) print_stats = 0;
+    if (run->budget) budget_frame_begin(run->budget);
+
     g_count_mode = 2;
     clock_t start_ds = clock();
     unsigned long long total_sad_ds = 0;
@@ -58,8 +105,39 @@ static void run_ds(const char* label,
             int px = bx * block_w;
             int py = by * block_h;
             MV pred = (MV){0,0};
-            MV mv_ds = ds_fn(ref, cur, px, py, *params, pred);
+            unsigned long long points_before = g_sad_count_ds;
+            MEParams blk = *params;
+            MV mv_ds;
+            if (run->budget && !budget_block_params(run->budget, bx, by, &blk)) {
+                // Frame budget already spent: the block keeps its predictor.
+                mv_ds = pred;
+                budget_block_done(run->budget, bx, by, mv_ds, NULL);
+            } else if (stats_fn) {
+                SearchStats st;
+                mv_ds = stats_fn(ref, cur, px, py, blk, pred, &st);
+                if (print_stats) stats_summary_add(&summary, bx, by, &st);
+                if (run->budget) budget_block_done(run->budget, bx, by, mv_ds, &st);
+            } else {
+                mv_ds = run->fn(ref, cur, px, py, blk, pred);
+            }
             unsigned int cost_ds = sad_block(ref, cur, px + mv_ds.x, py + mv_ds.y, px, py, block_w, block_h);
+            if (trace) {
+                METraceRecord rec = {0};
+                rec.frame = (uint32_t)trace->cur_no;
+                rec.ref_frame = (uint32_t)trace->ref_no;
+                rec.x = (uint16_t)px;
+                rec.y = (uint16_t)py;
+                rec.w = (uint8_t)block_w;
+                rec.h = (uint8_t)block_h;
+                rec.range = (uint16_t)blk.search_range;
+                rec.pred_x = (int16_t)pred.x;
+                rec.pred_y = (int16_t)pred.y;
+                rec.mv_x = (int16_t)mv_ds.x;
+                rec.mv_y = (int16_t)mv_ds.y;
+                rec.cost = cost_ds;
+                rec.points = (uint32_t)(g_sad_count_ds - points_before);
+                me_trace_write(trace->f, &rec);
+            }
             unsigned int cost_fs = fs_costs[idx];
             total_sad_ds += cost_ds;
             double loss = 0.0;
@@ -79,6 +157,166 @@ static void run_ds(const char* label,
            label, g_sad_count_ds, time_ds, (double)total_sad_ds / total_blocks, avg_loss);
     g_sad_count_ds = 0;
     g_count_mode = 0;
+
+    if (run->budget) {
+        BudgetReport br;
+        budget_frame_end(run->budget, &br);
+        printf("[%s budget] Budget: %llu | Used: %llu | Budget-capped blocks: %d | Skipped blocks: %d | Avg range: %.2f | Avg max iters: %.2f\n",
+               label, br.budget, br.used, br.budget_hits, br.skipped, br.avg_range, br.avg_iters);
+    }
+    if (print_stats) {
+        stats_summary_print(&summary, label);
+        if (run->heatmap && !stats_write_heatmap(&summary, run->heatmap, block_w, block_h)) {
+            fprintf(stderr, "Cannot write heatmap: %s\n", run->heatmap);
+        }
+        stats_summary_free(&summary);
+    }
+}
+
+// Runs FS baseline plus both DS variants on one reference/current pair and prints the summary.
+static int compare_pair(const Frame* ref, const Frame* cur, int cur_no, const MEParams* params,
+                        const CLIParams* cli, const TraceSink* trace, BudgetCtl* budget) {
+    int block_w = params->block_w;
+    int block_h = params->block_h;
+    int blocks_x = ref->width / block_w;
+    int blocks_y = ref->height / block_h;
+    int blocks_total = blocks_x * blocks_y;
+
+    unsigned int* fs_costs = (unsigned int*)malloc((size_t)blocks_total * sizeof(unsigned int));
+    if (!fs_costs) return 1;
+
+    // Full Search baseline
+    g_count_mode = 1;
+    clock_t start_fs = clock();
+    unsigned long long total_sad_fs = 0;
+    int idx = 0;
+    for (int by = 0; by < blocks_y; ++by) {
+        for (int bx = 0; bx < blocks_x; ++bx, ++idx) {
+            int px = bx * block_w;
+            int py = by * block_h;
+            MV pred = (MV){0,0};
+            MV mv_fs = full_search_motion_estimation(ref, cur, px, py, *params, pred);
+            unsigned int sad_fs = sad_block(ref, cur, px + mv_fs.x, py + mv_fs.y, px, py, block_w, block_h);
+            fs_costs[idx] = sad_fs;
+            total_sad_fs += sad_fs;
+            if (cli->verbose) {
+                printf("FS Block (%2d,%2d): MV=(%3d,%3d) Cost=%6u\n", bx, by, mv_fs.x, mv_fs.y, sad_fs);
+            }
+        }
+    }
+    clock_t end_fs = clock();
+    double time_fs = ((double)(end_fs - start_fs)) / CLOCKS_PER_SEC * 1000.0;
+    g_count_mode = 0;
+
+    printf("FS baseline: Points: %llu | Time: %.2f ms | Avg SAD: %.2f\n",
+           g_sad_count_fs, time_fs, (double)total_sad_fs / blocks_total);
+    g_sad_count_fs = 0;
+
+    int stats = cli->stats || cli->heatmap;
+    char heat_opt[512], heat_base[512];
+    if (cli->heatmap) {
+        snprintf(heat_opt, sizeof(heat_opt), "%s_f%d_opt.pgm", cli->heatmap, cur_no);
+        snprintf(heat_base, sizeof(heat_base), "%s_f%d_base.pgm", cli->heatmap, cur_no);
+    }
+    DSRun opt = { "DS opt", xDiamondSearchOpt, xDiamondSearchOptStats, stats, cli->heatmap ? heat_opt : NULL, budget };
+    DSRun base = { "DS base", xDiamondSearchADS, xDiamondSearchADSStats, stats, cli->heatmap ? heat_base : NULL, NULL };
+    run_ds(&opt, ref, cur, params, blocks_x, blocks_y, block_w, block_h, fs_costs, trace, cli->verbose);
+    run_ds(&base, ref, cur, params, blocks_x, blocks_y, block_w, block_h, fs_costs, NULL, cli->verbose);
+
+    printf("\n");
+
+    free(fs_costs);
+    return 0;
+}
+
+// Re-runs every block of a trace with the selected search on the original YUV frames
+// and diffs the result against the recorded MV. JM traces were searched on
+// reconstructed references, so both SADs below are recomputed on the source.
+static int run_replay(const CLIParams* cli) {
+    const SearchAlgo* algo = NULL;
+    for (size_t i = 0; i < sizeof(g_algos) / sizeof(g_algos[0]); ++i) {
+        if (!strcmp(cli->algo, g_algos[i].name)) algo = &g_algos[i];
+    }
+    if (!algo) {
+        fprintf(stderr, "Unknown search algorithm: %s\n", cli->algo);
+        return 1;
+    }
+
+    FILE* tf = fopen(cli->replay, "rb");
+    int tw = 0, th = 0;
+    if (!tf || !me_trace_read_header(tf, &tw, &th)) {
+        fprintf(stderr, "Cannot read trace file: %s\n", cli->replay);
+        if (tf) fclose(tf);
+        return 1;
+    }
+    YUVReader rd;
+    if (!yuv_reader_open(&rd, cli->input_path, tw, th)) {
+        fprintf(stderr, "Cannot open input file: %s\n", cli->input_path);
+        fclose(tf);
+        return 1;
+    }
+
+    printf("===== Trace Replay =====\n");
+    printf("Trace: %s (%dx%d), Algo: %s\n\n", cli->replay, tw, th, algo->name);
+
+    unsigned long long records = 0, skipped = 0, diffs = 0;
+    unsigned long long points_new = 0, points_trace = 0;
+    unsigned long long sad_new = 0, sad_trace = 0;
+    METraceRecord rec;
+    clock_t start = clock();
+    while (me_trace_read(tf, &rec)) {
+        Frame ref, cur;
+        if (rec.w == 0 || rec.h == 0 || rec.x + rec.w > tw || rec.y + rec.h > th ||
+            !yuv_reader_get_luma(&rd, (int)rec.ref_frame, &ref) ||
+            !yuv_reader_get_luma(&rd, (int)rec.frame, &cur)) {
+            ++skipped;
+            continue;
+        }
+
+        MEParams params;
+        params.block_w = rec.w;
+        params.block_h = rec.h;
+        params.search_range = rec.range > 0 ? rec.range : cli->search_range;
+        params.max_iters = cli->max_iters;
+        params.max_points = 0;
+        MV pred = (MV){ rec.pred_x, rec.pred_y };
+
+        g_count_mode = algo->count_mode;
+        unsigned long long before = g_sad_count_fs + g_sad_count_ds;
+        MV mv = algo->fn(&ref, &cur, rec.x, rec.y, params, pred);
+        points_new += g_sad_count_fs + g_sad_count_ds - before;
+        g_count_mode = 0;
+
+        // The recorded MV may point outside the frame (JM searches into the padding).
+        int tx = CLIP3(0, tw - rec.w, rec.x + rec.mv_x);
+        int ty = CLIP3(0, th - rec.h, rec.y + rec.mv_y);
+        unsigned int cost_new = sad_block(&ref, &cur, rec.x + mv.x, rec.y + mv.y, rec.x, rec.y, rec.w, rec.h);
+        unsigned int cost_trace = sad_block(&ref, &cur, tx, ty, rec.x, rec.y, rec.w, rec.h);
+        sad_new += cost_new;
+        sad_trace += cost_trace;
+        points_trace += rec.points;
+        ++records;
+        if (mv.x != rec.mv_x || mv.y != rec.mv_y) {
+            ++diffs;
+            if (cli->verbose) {
+                printf("Frame %u Block (%4u,%4u) %2ux%-2u: Trace_MV=(%3d,%3d) SAD=%6u | %s_MV=(%3d,%3d) SAD=%6u\n",
+                       rec.frame, rec.x, rec.y, rec.w, rec.h, rec.mv_x, rec.mv_y, cost_trace,
+                       algo->name, mv.x, mv.y, cost_new);
+            }
+        }
+    }
+    double time_ms = ((double)(clock() - start)) / CLOCKS_PER_SEC * 1000.0;
+    g_sad_count_fs = 0;
+    g_sad_count_ds = 0;
+
+    double n = records ? (double)records : 1.0;
+    printf("[Replay] Records: %llu (skipped %llu) | Algo: %s | Points: %llu (trace %llu) | Time: %.2f ms | Avg SAD: %.2f (trace MV %.2f) | MV diffs: %llu (%.2f%%)\n",
+           records, skipped, algo->name, points_new, points_trace, time_ms,
+           (double)sad_new / n, (double)sad_trace / n, diffs, 100.0 * (double)diffs / n);
+
+    fclose(tf);
+    yuv_reader_close(&rd);
+    return 0;
 }
 
 int main(int argc, char** argv) {
@@ -90,6 +328,8 @@ int main(int argc, char** argv) {
     cli.block_h = 16;
     cli.search_range = 32;
     cli.max_iters = 64;
+    cli.prefetch = 2;
+    cli.algo = "opt";
     cli.verbose = 0;
 
     for (int i = 1; i < argc; ++i) {
@@ -104,10 +344,33 @@ int main(int argc, char** argv) {
         } else if (!strcmp(argv[i], "--block") && i + 1 < argc) {
             parse_int(argv[++i], &cli.block_w);
             cli.block_h = cli.block_w;
+            if (cli.block_w > 255) {
+                // METraceRecord keeps the block size in 8 bits
+                fprintf(stderr, "--block must be at most 255.\n");
+                return 1;
+            }
         } else if (!strcmp(argv[i], "--range") && i + 1 < argc) {
             parse_int(argv[++i], &cli.search_range);
         } else if (!strcmp(argv[i], "--max-iters") && i + 1 < argc) {
             parse_int(argv[++i], &cli.max_iters);
+        } else if (!strcmp(argv[i], "--prefetch") && i + 1 < argc) {
+            parse_int(argv[++i], &cli.prefetch);
+        } else if (!strcmp(argv[i], "--trace-out") && i + 1 < argc) {
+            cli.trace_out = argv[++i];
+        } else if (!strcmp(argv[i], "--replay") && i + 1 < argc) {
+            cli.replay = argv[++i];
+        } else if (!strcmp(argv[i], "--algo") && i + 1 < argc) {
+            cli.algo = argv[++i];
+        } else if (!strcmp(argv[i], "--stats")) {
+            cli.stats = 1;
+        } else if (!strcmp(argv[i], "--heatmap") && i + 1 < argc) {
+            cli.heatmap = argv[++i];
+        } else if (!strcmp(argv[i], "--adaptive")) {
+            cli.adaptive = 1;
+        } else if (!strcmp(argv[i], "--point-budget") && i + 1 < argc) {
+            int v = 0;
+            parse_int(argv[++i], &v);
+            cli.point_budget = v > 0 ? (unsigned long long)v : 0;
         } else if (!strcmp(argv[i], "--verbose")) {
             cli.verbose = 1;
         } else if (!strcmp(argv[i], "-help") || !strcmp(argv[i], "--help")) {
@@ -119,6 +382,14 @@ int main(int argc, char** argv) {
         }
     }
 
+    if (cli.replay) {
+        if (!cli.input_path) {
+            fprintf(stderr, "--replay needs the source YUV (-i).\n");
+            return 1;
+        }
+        return run_replay(&cli);
+    }
+
     int W = cli.width;
     int H = cli.height;
     int block_w = cli.block_w;
@@ -128,34 +399,98 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    Frame ref = { W, H, W, NULL };
-    Frame cur = { W, H, W, NULL };
-    ref.data = (uint8_t*)malloc((size_t)W * (size_t)H);
-    cur.data = (uint8_t*)malloc((size_t)W * (size_t)H);
-    if (!ref.data || !cur.data) return 1;
+    MEParams params;
+    params.block_w = block_w;
+    params.block_h = block_h;
+    params.search_range = cli.search_range;
+    params.max_iters = cli.max_iters;
+    params.max_points = 0;
+
+    printf("===== Motion Estimation Comparison =====\n");
+    printf("Frame: %dx%d, Block: %dx%d, Search Range: %d\n", W, H, block_w, block_h, params.search_range);
+    printf("Modes: FS baseline, DS opt, DS base\n\n");
+
+    TraceSink trace = { NULL, 0, 1 };
+    if (cli.trace_out) {
+        trace.f = fopen(cli.trace_out, "wb");
+        if (!trace.f || !me_trace_write_header(trace.f, W, H)) {
+            fprintf(stderr, "Cannot write trace file: %s\n", cli.trace_out);
+            if (trace.f) fclose(trace.f);
+            return 1;
+        }
+    }
+    const TraceSink* sink = trace.f ? &trace : NULL;
+
+    BudgetCtl* budget = NULL;
+    if (cli.adaptive || cli.point_budget) {
+        budget = budget_create(W / block_w, H / block_h, &params, cli.point_budget, cli.adaptive);
+        if (!budget) {
+            fprintf(stderr, "Out of memory\n");
+            if (trace.f) fclose(trace.f);
+            return 1;
+        }
+    }
 
+    int ret = 0;
     if (cli.input_path) {
-        FILE* f = fopen(cli.input_path, "rb");
-        if (!f) {
+        YUVReader rd;
+        if (!yuv_reader_open(&rd, cli.input_path, W, H)) {
             fprintf(stderr, "Cannot open input file: %s\n", cli.input_path);
+            budget_destroy(budget);
+            if (trace.f) fclose(trace.f);
             return 1;
         }
-        size_t y_sz = (size_t)W * (size_t)H;
-        size_t frame_sz = y_sz + 2 * (y_sz / 4); // YUV420
-
-        if (!read_y_plane(f, &ref, W, H)) {
+        int frames = cli.frames < rd.frames ? cli.frames : rd.frames;
+        Prefetcher* pf = prefetch_start(&rd, frames, cli.prefetch < 0 ? 0 : cli.prefetch);
+        const PreparedFrame* ref = pf ? prefetch_next(pf) : NULL;
+        if (!ref) {
             fprintf(stderr, "Failed to read frame 0\n");
-            fclose(f);
+            prefetch_stop(pf, NULL);
+            yuv_reader_close(&rd);
+            budget_destroy(budget);
+            if (trace.f) fclose(trace.f);
             return 1;
         }
-        fseek(f, (long)(frame_sz - y_sz), SEEK_CUR);
-        if (!read_y_plane(f, &cur, W, H)) {
-            memcpy(cur.data, ref.data, y_sz);
-        } else {
-            fseek(f, (long)(frame_sz - y_sz), SEEK_CUR);
+        // A single-frame file compares frame 0 against itself.
+        const PreparedFrame* cur = prefetch_next(pf);
+        if (!cur) {
+            trace.cur_no = 0;
+            ret = compare_pair(&ref->luma, &ref->luma, 0, &params, &cli, sink, budget);
         }
-        fclose(f);
+        while (cur && ret == 0) {
+            if (frames > 2) printf("--- Frame %d -> %d ---\n", ref->index, cur->index);
+            trace.ref_no = ref->index;
+            trace.cur_no = cur->index;
+            ret = compare_pair(&ref->luma, &cur->luma, cur->index, &params, &cli, sink, budget);
+
+            // The I/O thread keeps preparing frame N+1 while the pair above is searched.
+            int done = ref->index;
+            prefetch_release(pf);
+            yuv_reader_release(&rd, done);
+            ref = cur;
+            cur = prefetch_next(pf);
+        }
+
+        PrefetchStats ps;
+        prefetch_stop(pf, &ps);
+        printf("[Pipeline] Frames: %llu | Prefetch depth: %d | Avg queue depth: %.2f | Max queue depth: %d | ME stall: %.2f ms | I/O stall: %.2f ms | Prepare: %.2f ms\n",
+               ps.frames, cli.prefetch, ps.frames ? (double)ps.depth_sum / ps.frames : 0.0, ps.depth_max,
+               ps.consumer_stall_ms, ps.producer_stall_ms, ps.prepare_ms);
+        yuv_reader_close(&rd);
     } else {
+        Frame ref = { W, H, W, NULL };
+        Frame cur = { W, H, W, NULL };
+        ref.data = (uint8_t*)malloc((size_t)W * (size_t)H);
+        cur.data = (uint8_t*)malloc((size_t)W * (size_t)H);
+        if (!ref.data || !cur.data) {
+            fprintf(stderr, "Out of memory\n");
+            free(ref.data);
+            free(cur.data);
+            budget_destroy(budget);
+            if (trace.f) fclose(trace.f);
+            return 1;
+        }
+
         int shift_x = 3, shift_y = -2;
         for (int y = 0; y < H; ++y) {
             for (int x = 0; x < W; ++x) {
@@ -169,59 +504,11 @@ int main(int argc, char** argv) {
                 cur.data[y*W + x] = ref.data[sy*W + sx];
             }
         }
+        ret = compare_pair(&ref, &cur, 1, &params, &cli, sink, budget);
+        free(ref.data);
+        free(cur.data);
     }
-
-    MEParams params;
-    params.block_w = block_w;
-    params.block_h = block_h;
-    params.search_range = cli.search_range;
-    params.max_iters = cli.max_iters;
-
-    int blocks_x = W / block_w;
-    int blocks_y = H / block_h;
-    int blocks_total = blocks_x * blocks_y;
-
-    unsigned int* fs_costs = (unsigned int*)malloc((size_t)blocks_total * sizeof(unsigned int));
-    if (!fs_costs) return 1;
-
-    printf("===== Motion Estimation Comparison =====\n");
-    printf("Frame: %dx%d, Block: %dx%d, Search Range: %d\n", W, H, block_w, block_h, params.search_range);
-    printf("Modes: FS baseline, DS opt, DS base\n\n");
-
-    // Full Search baseline
-    g_count_mode = 1;
-    clock_t start_fs = clock();
-    unsigned long long total_sad_fs = 0;
-    int idx = 0;
-    for (int by = 0; by < blocks_y; ++by) {
-        for (int bx = 0; bx < blocks_x; ++bx, ++idx) {
-            int px = bx * block_w;
-            int py = by * block_h;
-            MV pred = (MV){0,0};
-            MV mv_fs = full_search_motion_estimation(&ref, &cur, px, py, params, pred);
-            unsigned int sad_fs = sad_block(&ref, &cur, px + mv_fs.x, py + mv_fs.y, px, py, block_w, block_h);
-            fs_costs[idx] = sad_fs;
-            total_sad_fs += sad_fs;
-            if (cli.verbose) {
-                printf("FS Block (%2d,%2d): MV=(%3d,%3d) Cost=%6u\n", bx, by, mv_fs.x, mv_fs.y, sad_fs);
-            }
-        }
-    }
-    clock_t end_fs = clock();
-    double time_fs = ((double)(end_fs - start_fs)) / CLOCKS_PER_SEC * 1000.0;
-    g_count_mode = 0;
-
-    printf("FS baseline: Points: %llu | Time: %.2f ms | Avg SAD: %.2f\n",
-           g_sad_count_fs, time_fs, (double)total_sad_fs / blocks_total);
-    g_sad_count_fs = 0;
-
-    run_ds("DS opt", xDiamondSearchOpt, &ref, &cur, &params, blocks_x, blocks_y, block_w, block_h, fs_costs, cli.verbose);
-    run_ds("DS base", xDiamondSearchADS, &ref, &cur, &params, blocks_x, blocks_y, block_w, block_h, fs_costs, cli.verbose);
-
-    printf("\n");
-
-    free(fs_costs);
-    free(ref.data);
-    free(cur.data);
-    return 0;
+    budget_destroy(budget);
+    if (trace.f) fclose(trace.f);
+    return ret;
 }
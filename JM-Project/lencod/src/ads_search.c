@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 #include <immintrin.h> // AVX2
 #include "ads_search.h" 
 
@@ -105,6 +106,16 @@ static unsigned int sad_point_internal(const Frame* ref, const Frame* cur, int c
 
 // search algorithms implementations
 
+// Each DS body is force-inlined into two entry points: the plain one passes
+// st == NULL, so every STAT() below folds away and the hot path is unchanged;
+// the *Stats one fills a SearchStats for the block.
+#if defined(_MSC_VER)
+#define DS_INLINE static __forceinline
+#else
+#define DS_INLINE static inline __attribute__((always_inline))
+#endif
+#define STAT(stmt) do { if (st) { stmt; } } while (0)
+
 static const int ldsp_offsets[8][2] = {
     {  0, -2 }, {  2,  0 }, {  0,  2 }, { -2,  0 },
     {  2, -2 }, {  2,  2 }, { -2,  2 }, { -2, -2 }
@@ -114,11 +125,12 @@ static const int sdsp_offsets[4][2] = {
 };
 
 // optimize DS : : use SAD with AVX2
-MV xDiamondSearchOpt(const Frame* ref, const Frame* cur, int bx, int by, MEParams params, MV init) {
+DS_INLINE MV ds_opt_body(const Frame* ref, const Frame* cur, int bx, int by, MEParams params, MV init, SearchStats* st) {
     int bw = params.block_w;
     int bh = params.block_h;
     int range = params.search_range;
     int max_iters = params.max_iters > 0 ? params.max_iters : 64;
+    unsigned int max_points = params.max_points; // 0 = no cap
     unsigned int et_threshold = (unsigned int)(bw * bh / 4);
 
     int cx = CLIP3(0, ref->width - bw, bx + init.x);
@@ -126,13 +138,17 @@ MV xDiamondSearchOpt(const Frame* ref, const Frame* cur, int bx, int by, MEParam
     
     // our key step : start AVX
     unsigned int current_sad = sad_point_internal(ref, cur, cx, cy, bx, by, bw, bh, true);
+    unsigned int used = 1;
+    STAT(++st->points);
     
     MV best_mv = (MV){ cx - bx, cy - by };
 
-    if (init.x != 0 || init.y != 0) {
+    if ((init.x != 0 || init.y != 0) && (!max_points || used < max_points)) {
         int zx = CLIP3(0, ref->width - bw, bx);
         int zy = CLIP3(0, ref->height - bh, by);
         unsigned int zero_sad = sad_point_internal(ref, cur, zx, zy, bx, by, bw, bh, true);
+        ++used;
+        STAT(++st->points);
         if (zero_sad < current_sad) {
             current_sad = zero_sad;
             cx = zx; cy = zy; best_mv = (MV){ 0, 0 };
@@ -159,6 +175,8 @@ MV xDiamondSearchOpt(const Frame* ref, const Frame* cur, int bx, int by, MEParam
     int iters = 0;
     bool use_ldsp = true;
     bool moved = false;
+    bool converged = false;
+    bool exhausted = false;
 
     while (iters < max_iters) {
         ++iters;
@@ -175,9 +193,19 @@ MV xDiamondSearchOpt(const Frame* ref, const Frame* cur, int bx, int by, MEParam
             int nx = cx + dx;
             int ny = cy + dy;
 
-            if (nx < min_x || nx > max_x || ny < min_y || ny > max_y) continue;
+            if (nx < min_x || nx > max_x || ny < min_y || ny > max_y) {
+                STAT(++st->clipped);
+                continue;
+            }
+            // Point budget spent: keep the best of what has been evaluated.
+            if (max_points && used >= max_points) {
+                exhausted = true;
+                break;
+            }
 
             unsigned int s = sad_point_internal(ref, cur, nx, ny, bx, by, bw, bh, true);
+            ++used;
+            STAT(++st->points; if (use_ldsp) ++st->ldsp_points; else ++st->sdsp_points);
             if (s < next_sad) {
                 next_sad = s;
                 best_dx = dx; best_dy = dy;
@@ -194,19 +222,34 @@ MV xDiamondSearchOpt(const Frame* ref, const Frame* cur, int bx, int by, MEParam
             // Fix 3 : Removed early termination here to match the baseline implementation.
             // This ensures the comparison between DS-Base and DS-Opt is fair.            
             if (moved && current_sad < et_threshold) {
+                STAT(st->early_exit = 1);
                 break;
             }
+            if (exhausted) break;
             // Just continue to next iteration
             continue;
         }
+        if (exhausted) break;
         if (use_ldsp) { use_ldsp = false; continue; }
+        converged = true;
         break;
     }
+    STAT(st->iterations = (unsigned int)iters; st->budget_hit = exhausted;
+         st->iter_cap = !converged && !exhausted && !st->early_exit);
     return best_mv;
 }
 
+MV xDiamondSearchOpt(const Frame* ref, const Frame* cur, int bx, int by, MEParams params, MV init) {
+    return ds_opt_body(ref, cur, bx, by, params, init, NULL);
+}
+
+MV xDiamondSearchOptStats(const Frame* ref, const Frame* cur, int bx, int by, MEParams params, MV init, SearchStats* st) {
+    memset(st, 0, sizeof(*st));
+    return ds_opt_body(ref, cur, bx, by, params, init, st);
+}
+
 // DS baseline : use SAD C version
-MV xDiamondSearchADS(const Frame* ref, const Frame* cur, int bx, int by, MEParams params, MV init) {
+DS_INLINE MV ds_base_body(const Frame* ref, const Frame* cur, int bx, int by, MEParams params, MV init, SearchStats* st) {
     int bw = params.block_w;
     int bh = params.block_h;
     int range = params.search_range;
@@ -220,6 +263,7 @@ MV xDiamondSearchADS(const Frame* ref, const Frame* cur, int bx, int by, MEParam
     // notice : not use AVX, instead use C
     // you will see ldsp_offsets(大菱形) and sdsp_offsets（小菱形）, this is how they work
     unsigned int best_sad = sad_point_internal(ref, cur, cx, cy, bx, by, bw, bh, false);
+    STAT(++st->points);
     MV best_mv = (MV){ cx - bx, cy - by };
 
     const int ldsp_offsets[8][2] = {
@@ -242,6 +286,7 @@ MV xDiamondSearchADS(const Frame* ref, const Frame* cur, int bx, int by, MEParam
     while (iters < max_iters) {
         ++iters;
         unsigned int center_sad = sad_point_internal(ref, cur, cx, cy, bx, by, bw, bh, false);
+        STAT(++st->points);
         unsigned int local_best = center_sad;
         int best_dx = 0, best_dy = 0;
 
@@ -249,9 +294,14 @@ MV xDiamondSearchADS(const Frame* ref, const Frame* cur, int bx, int by, MEParam
             int nx = cx + ldsp_offsets[i][0];
             int ny = cy + ldsp_offsets[i][1];
             int mvx = nx - bx; int mvy = ny - by;
-            if (mvx < -effective_range || mvx > effective_range || mvy < -effective_range || mvy > effective_range) continue;
+            if (mvx < -effective_range || mvx > effective_range || mvy < -effective_range || mvy > effective_range) {
+                STAT(++st->clipped);
+                continue;
+            }
             
-            unsigned int s = sad_point_internal(ref, cur, nx, ny, bx, by, bw, bh, false);
+            // clamp like JM's sad_block_ads: the window check alone can step outside the frame
+            unsigned int s = sad_point_internal(ref, cur, CLIP3(0, ref->width - bw, nx), CLIP3(0, ref->height - bh, ny), bx, by, bw, bh, false);
+            STAT(++st->points; ++st->ldsp_points);
             if (s < local_best) {
                 local_best = s;
                 best_dx = ldsp_offsets[i][0]; best_dy = ldsp_offsets[i][1];
@@ -276,9 +326,13 @@ MV xDiamondSearchADS(const Frame* ref, const Frame* cur, int bx, int by, MEParam
                 int nx = cx + sdsp_offsets[i][0];
                 int ny = cy + sdsp_offsets[i][1];
                 int mvx = nx - bx; int mvy = ny - by;
-                if (mvx < -effective_range || mvx > effective_range || mvy < -effective_range || mvy > effective_range) continue;
+                if (mvx < -effective_range || mvx > effective_range || mvy < -effective_range || mvy > effective_range) {
+                    STAT(++st->clipped);
+                    continue;
+                }
                 
-                unsigned int s = sad_point_internal(ref, cur, nx, ny, bx, by, bw, bh, false);
+                unsigned int s = sad_point_internal(ref, cur, CLIP3(0, ref->width - bw, nx), CLIP3(0, ref->height - bh, ny), bx, by, bw, bh, false);
+                STAT(++st->points; ++st->sdsp_points);
                 if (s < best2) {
                     best2 = s;
                     bdx2 = sdsp_offsets[i][0]; bdy2 = sdsp_offsets[i][1];
@@ -290,12 +344,23 @@ MV xDiamondSearchADS(const Frame* ref, const Frame* cur, int bx, int by, MEParam
                 best_sad = best2;
                 best_mv.x = cx - bx; best_mv.y = cy - by;
             }
-            break;
+            STAT(st->iterations = (unsigned int)iters);
+            return best_mv;
         }
     }
+    STAT(st->iterations = (unsigned int)iters; st->iter_cap = 1);
     return best_mv;
 }
 
+MV xDiamondSearchADS(const Frame* ref, const Frame* cur, int bx, int by, MEParams params, MV init) {
+    return ds_base_body(ref, cur, bx, by, params, init, NULL);
+}
+
+MV xDiamondSearchADSStats(const Frame* ref, const Frame* cur, int bx, int by, MEParams params, MV init, SearchStats* st) {
+    memset(st, 0, sizeof(*st));
+    return ds_base_body(ref, cur, bx, by, params, init, st);
+}
+
 // full research Baseline
 MV full_search_motion_estimation(const Frame* ref, const Frame* cur, int bx, int by, MEParams params, MV init) {
     int bw = params.block_w;
@@ -0,0 +1,190 @@
+#include <stdlib.h>
+#include <string.h>
+#include "budget.h"
+
+#define ADAPT_MIN_RANGE  8  // same floor DS opt uses when it narrows the window
+#define ADAPT_MIN_ITERS  4
+#define ADAPT_MARGIN     4  // pels added on top of the motion seen last frame
+#define ADAPT_PERCENTILE 90 // frame-wide range floor follows this MV magnitude percentile
+
+typedef struct {
+    int mag;              // max(|mv.x|, |mv.y|) of the last search, -1 = not searched
+    int range;            // range the block was searched with
+    unsigned int points;
+    unsigned int iters;
+    unsigned char expand; // hit the iteration cap, the point budget or the window edge
+} BlockHistory;
+
+struct BudgetCtl {
+    int blocks_x;
+    int blocks_y;
+    MEParams base;
+    int base_iters;
+    int min_range;        // adaptive lower bounds, never above the configured values
+    int min_iters;
+    unsigned long long frame_budget;
+    int adaptive;
+    int has_history;
+    BlockHistory* prev;   // last frame
+    BlockHistory* cur;    // frame being searched
+    unsigned int* weight; // expected cost of each block, drives the budget split
+    int* mag_hist;        // MV magnitude histogram, base range + 1 bins
+    int floor_range;
+    unsigned long long remaining;
+    unsigned long long weight_left;
+    BudgetReport rep;
+    unsigned long long range_sum;
+    unsigned long long iters_sum;
+};
+
+BudgetCtl* budget_create(int blocks_x, int blocks_y, const MEParams* base, unsigned long long frame_budget, int adaptive) {
+    size_t n = (size_t)blocks_x * (size_t)blocks_y;
+    BudgetCtl* ctl = (BudgetCtl*)calloc(1, sizeof(BudgetCtl));
+    if (!ctl) return NULL;
+    ctl->blocks_x = blocks_x;
+    ctl->blocks_y = blocks_y;
+    ctl->base = *base;
+    ctl->base.max_points = 0;
+    ctl->base_iters = base->max_iters > 0 ? base->max_iters : 64;
+    ctl->min_range = base->search_range < ADAPT_MIN_RANGE ? base->search_range : ADAPT_MIN_RANGE;
+    ctl->min_iters = ctl->base_iters < ADAPT_MIN_ITERS ? ctl->base_iters : ADAPT_MIN_ITERS;
+    ctl->frame_budget = frame_budget;
+    ctl->adaptive = adaptive;
+    ctl->prev = (BlockHistory*)calloc(n, sizeof(BlockHistory));
+    ctl->cur = (BlockHistory*)calloc(n, sizeof(BlockHistory));
+    ctl->weight = (unsigned int*)calloc(n, sizeof(unsigned int));
+    ctl->mag_hist = (int*)calloc((size_t)(base->search_range > 0 ? base->search_range : 0) + 1, sizeof(int));
+    if (!ctl->prev || !ctl->cur || !ctl->weight || !ctl->mag_hist) {
+        budget_destroy(ctl);
+        return NULL;
+    }
+    return ctl;
+}
+
+void budget_frame_begin(BudgetCtl* ctl) {
+    int n = ctl->blocks_x * ctl->blocks_y;
+    int range = ctl->base.search_range > 0 ? ctl->base.search_range : 0;
+
+    ctl->remaining = ctl->frame_budget;
+    ctl->weight_left = 0;
+    for (int i = 0; i < n; ++i) {
+        // Blocks that were expensive last frame are expected to be expensive again.
+        ctl->weight[i] = ctl->has_history ? ctl->prev[i].points + 1 : 1;
+        ctl->weight_left += ctl->weight[i];
+    }
+
+    ctl->floor_range = range;
+    if (ctl->adaptive && ctl->has_history) {
+        int searched = 0;
+        memset(ctl->mag_hist, 0, (size_t)(range + 1) * sizeof(int));
+        for (int i = 0; i < n; ++i) {
+            if (ctl->prev[i].mag < 0) continue;
+            ctl->mag_hist[ctl->prev[i].mag < range ? ctl->prev[i].mag : range]++;
+            ++searched;
+        }
+        int target = (searched * ADAPT_PERCENTILE + 99) / 100;
+        int acc = 0, pct = range;
+        for (int m = 0; m <= range; ++m) {
+            acc += ctl->mag_hist[m];
+            if (acc >= target) {
+                pct = m;
+                break;
+            }
+        }
+        ctl->floor_range = CLIP3(ctl->min_range, range, pct + ADAPT_MARGIN);
+    }
+
+    memset(&ctl->rep, 0, sizeof(ctl->rep));
+    ctl->rep.budget = ctl->frame_budget;
+    ctl->range_sum = 0;
+    ctl->iters_sum = 0;
+}
+
+int budget_block_params(BudgetCtl* ctl, int bx, int by, MEParams* out) {
+    int i = by * ctl->blocks_x + bx;
+    *out = ctl->base;
+
+    if (ctl->adaptive && ctl->has_history && !ctl->prev[i].expand) {
+        // Largest motion around the block last frame; objects move across block borders.
+        int need = 0;
+        for (int y = by - 1; y <= by + 1; ++y) {
+            for (int x = bx - 1; x <= bx + 1; ++x) {
+                if (x < 0 || y < 0 || x >= ctl->blocks_x || y >= ctl->blocks_y) continue;
+                int m = ctl->prev[y * ctl->blocks_x + x].mag;
+                if (m > need) need = m;
+            }
+        }
+        int range = 2 * need + ADAPT_MARGIN;
+        if (range < ctl->floor_range) range = ctl->floor_range;
+        out->search_range = CLIP3(ctl->min_range, ctl->base.search_range, range);
+
+        // An LDSP step moves 2 pels, so reaching `need` takes about need / 2 steps.
+        int iters = (int)ctl->prev[i].iters + 2;
+        if (iters < need / 2 + 3) iters = need / 2 + 3;
+        out->max_iters = CLIP3(ctl->min_iters, ctl->base_iters, iters);
+    }
+
+    ctl->cur[i].range = out->search_range;
+    ctl->range_sum += (unsigned long long)out->search_range;
+    ctl->iters_sum += (unsigned long long)(out->max_iters > 0 ? out->max_iters : ctl->base_iters);
+
+    unsigned long long w = ctl->weight[i];
+    unsigned long long left = ctl->weight_left;
+    ctl->weight_left -= w;
+    if (!ctl->frame_budget) return 1;
+    if (!ctl->remaining) return 0;
+
+    // Share of what is left, proportional to the block's expected cost. Points a
+    // block does not use roll over to the blocks after it.
+    unsigned long long allowance = left ? ctl->remaining * w / left : ctl->remaining;
+    if (allowance < 1) allowance = 1;
+    if (allowance > 0xFFFFFFFFull) allowance = 0xFFFFFFFFull;
+    out->max_points = (unsigned int)allowance;
+    return 1;
+}
+
+void budget_block_done(BudgetCtl* ctl, int bx, int by, MV mv, const SearchStats* st) {
+    BlockHistory* h = &ctl->cur[by * ctl->blocks_x + bx];
+    ctl->rep.blocks++;
+    if (!st) {
+        // Not searched: no evidence about its motion, give it the full window next frame.
+        h->mag = -1;
+        h->points = 0;
+        h->iters = 0;
+        h->expand = 1;
+        ctl->rep.skipped++;
+        return;
+    }
+
+    int ax = abs(mv.x), ay = abs(mv.y);
+    h->mag = ax > ay ? ax : ay;
+    h->points = st->points;
+    h->iters = st->iterations;
+    h->expand = st->iter_cap || st->budget_hit || h->mag >= h->range - 1;
+
+    ctl->rep.used += st->points;
+    ctl->rep.budget_hits += st->budget_hit;
+    ctl->remaining -= st->points < ctl->remaining ? st->points : ctl->remaining;
+}
+
+void budget_frame_end(BudgetCtl* ctl, BudgetReport* report) {
+    if (report) {
+        *report = ctl->rep;
+        int n = ctl->rep.blocks ? ctl->rep.blocks : 1;
+        report->avg_range = (double)ctl->range_sum / n;
+        report->avg_iters = (double)ctl->iters_sum / n;
+    }
+    BlockHistory* t = ctl->prev;
+    ctl->prev = ctl->cur;
+    ctl->cur = t;
+    ctl->has_history = 1;
+}
+
+void budget_destroy(BudgetCtl* ctl) {
+    if (!ctl) return;
+    free(ctl->prev);
+    free(ctl->cur);
+    free(ctl->weight);
+    free(ctl->mag_hist);
+    free(ctl);
+}
@@ -0,0 +1,90 @@
+#include <string.h>
+#include "me_trace.h"
+
+// Explicit little-endian packing keeps traces portable between the harness and
+// JM builds regardless of struct padding or host byte order.
+
+static uint8_t* put_u16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static uint8_t* put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+static uint16_t get_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+int me_trace_write_header(FILE* f, int width, int height) {
+    uint8_t buf[ME_TRACE_HEADER_SIZE];
+    uint8_t* p = buf;
+    memcpy(p, "METR", 4);
+    p = put_u32(p + 4, ME_TRACE_VERSION);
+    p = put_u32(p, (uint32_t)width);
+    put_u32(p, (uint32_t)height);
+    return fwrite(buf, 1, sizeof(buf), f) == sizeof(buf);
+}
+
+int me_trace_write(FILE* f, const METraceRecord* rec) {
+    uint8_t buf[ME_TRACE_RECORD_SIZE];
+    uint8_t* p = buf;
+    p = put_u32(p, rec->frame);
+    p = put_u32(p, rec->ref_frame);
+    p = put_u16(p, rec->x);
+    p = put_u16(p, rec->y);
+    *p++ = rec->w;
+    *p++ = rec->h;
+    *p++ = rec->list;
+    *p++ = rec->ref_idx;
+    p = put_u16(p, rec->range);
+    p = put_u16(p, 0);
+    p = put_u16(p, (uint16_t)rec->pred_x);
+    p = put_u16(p, (uint16_t)rec->pred_y);
+    p = put_u16(p, (uint16_t)rec->mv_x);
+    p = put_u16(p, (uint16_t)rec->mv_y);
+    p = put_u32(p, rec->cost);
+    put_u32(p, rec->points);
+    return fwrite(buf, 1, sizeof(buf), f) == sizeof(buf);
+}
+
+int me_trace_read_header(FILE* f, int* width, int* height) {
+    uint8_t buf[ME_TRACE_HEADER_SIZE];
+    if (fread(buf, 1, sizeof(buf), f) != sizeof(buf)) return 0;
+    if (memcmp(buf, "METR", 4) != 0 || get_u32(buf + 4) != ME_TRACE_VERSION) return 0;
+    *width = (int)get_u32(buf + 8);
+    *height = (int)get_u32(buf + 12);
+    return 1;
+}
+
+int me_trace_read(FILE* f, METraceRecord* rec) {
+    uint8_t buf[ME_TRACE_RECORD_SIZE];
+    if (fread(buf, 1, sizeof(buf), f) != sizeof(buf)) return 0;
+    const uint8_t* p = buf;
+    rec->frame = get_u32(p);
+    rec->ref_frame = get_u32(p + 4);
+    rec->x = get_u16(p + 8);
+    rec->y = get_u16(p + 10);
+    rec->w = p[12];
+    rec->h = p[13];
+    rec->list = p[14];
+    rec->ref_idx = p[15];
+    rec->range = get_u16(p + 16);
+    rec->pred_x = (int16_t)get_u16(p + 20);
+    rec->pred_y = (int16_t)get_u16(p + 22);
+    rec->mv_x = (int16_t)get_u16(p + 24);
+    rec->mv_y = (int16_t)get_u16(p + 26);
+    rec->cost = get_u32(p + 28);
+    rec->points = get_u32(p + 32);
+    return 1;
+}
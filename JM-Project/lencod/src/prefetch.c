@@ -0,0 +1,218 @@
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE // clock_gettime() under -std=c99
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "prefetch.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// Producer/consumer pipeline: an I/O thread maps frame N+1 and faults its pages in
+// while the harness runs ME on frame N. Slots form a ring of depth + 2
+// entries because the consumer keeps two frames (ref and cur) checked out.
+// Frame k always lives in slot k % cap, so three counters describe the queue.
+struct Prefetcher {
+    YUVReader* rd;
+    int frames;
+    int depth;
+    int cap;
+    PreparedFrame* slots;
+    uint8_t** owned;      // per-slot luma copies, only on the stdio fallback
+    int produced;         // frames prepared so far
+    int taken;            // frames handed to the consumer
+    int released;         // frames handed back
+    PrefetchStats stats;
+    int threaded;
+#ifndef _WIN32
+    int stop;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t can_fill;
+    pthread_cond_t can_take;
+#endif
+};
+
+static double now_ms(void) {
+#ifndef _WIN32
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+#else
+    return (double)clock() / CLOCKS_PER_SEC * 1000.0;
+#endif
+}
+
+// Touches one byte per page so the frame's pages are faulted in here, on the
+// I/O thread, instead of inside the ME loop.
+static void page_in(const Frame* f) {
+    volatile uint8_t sink = 0;
+    size_t size = f->height > 0 ? (size_t)(f->height - 1) * f->stride + f->width : 0;
+    for (size_t off = 0; off < size; off += 4096)
+        sink ^= f->data[off];
+    if (size) sink ^= f->data[size - 1];
+    (void)sink;
+}
+
+static int prepare_frame(Prefetcher* pf, int n) {
+    int slot = n % pf->cap;
+    PreparedFrame* pfr = &pf->slots[slot];
+    double t0 = now_ms();
+
+    if (!yuv_reader_get_luma(pf->rd, n, &pfr->luma)) return 0;
+    if (pf->owned) {
+        // The stdio fallback reuses one buffer for every read.
+        memcpy(pf->owned[slot], pfr->luma.data, (size_t)pf->rd->luma_size);
+        pfr->luma.data = pf->owned[slot];
+    }
+    pfr->index = n;
+    page_in(&pfr->luma);
+
+    pf->stats.prepare_ms += now_ms() - t0;
+    return 1;
+}
+
+#ifndef _WIN32
+static void* producer_main(void* arg) {
+    Prefetcher* pf = (Prefetcher*)arg;
+    for (int n = 0; n < pf->frames; ++n) {
+        pthread_mutex_lock(&pf->lock);
+        double t0 = now_ms();
+        while (!pf->stop && (n - pf->released >= pf->cap || n - pf->taken >= pf->depth))
+            pthread_cond_wait(&pf->can_fill, &pf->lock);
+        pf->stats.producer_stall_ms += now_ms() - t0;
+        int stop = pf->stop;
+        pthread_mutex_unlock(&pf->lock);
+        if (stop) break;
+
+        // Slot n % cap is free and invisible to the consumer until produced is bumped.
+        int ok = prepare_frame(pf, n);
+
+        pthread_mutex_lock(&pf->lock);
+        if (ok) pf->produced = n + 1;
+        else pf->frames = n; // short read: end the sequence here
+        pthread_cond_signal(&pf->can_take);
+        pthread_mutex_unlock(&pf->lock);
+        if (!ok) break;
+    }
+    return NULL;
+}
+#endif
+
+Prefetcher* prefetch_start(YUVReader* rd, int frames, int depth) {
+    Prefetcher* pf = (Prefetcher*)calloc(1, sizeof(Prefetcher));
+    if (!pf) return NULL;
+    pf->rd = rd;
+    pf->frames = frames < rd->frames ? frames : rd->frames;
+#ifndef _WIN32
+    pf->threaded = depth > 0;
+#else
+    depth = 0;
+#endif
+    pf->depth = depth;
+    pf->cap = depth + 2;
+
+    pf->slots = (PreparedFrame*)calloc((size_t)pf->cap, sizeof(PreparedFrame));
+    if (!pf->slots) {
+        free(pf);
+        return NULL;
+    }
+    if (rd->fp) {
+        pf->owned = (uint8_t**)calloc((size_t)pf->cap, sizeof(uint8_t*));
+        for (int i = 0; pf->owned && i < pf->cap; ++i)
+            pf->owned[i] = (uint8_t*)malloc((size_t)rd->luma_size);
+    }
+
+#ifndef _WIN32
+    if (pf->threaded) {
+        pthread_mutex_init(&pf->lock, NULL);
+        pthread_cond_init(&pf->can_fill, NULL);
+        pthread_cond_init(&pf->can_take, NULL);
+        if (pthread_create(&pf->thread, NULL, producer_main, pf) != 0) {
+            pthread_cond_destroy(&pf->can_take);
+            pthread_cond_destroy(&pf->can_fill);
+            pthread_mutex_destroy(&pf->lock);
+            pf->threaded = 0; // run the pipeline synchronously instead
+        }
+    }
+#endif
+    return pf;
+}
+
+const PreparedFrame* prefetch_next(Prefetcher* pf) {
+    int n = pf->taken;
+    int depth = 0;
+
+    if (!pf->threaded) {
+        if (n >= pf->frames) return NULL;
+        double t0 = now_ms();
+        if (!prepare_frame(pf, n)) {
+            pf->frames = n;
+            return NULL;
+        }
+        pf->produced = n + 1;
+        pf->taken = n + 1;
+        pf->stats.consumer_stall_ms += now_ms() - t0;
+    }
+#ifndef _WIN32
+    else {
+        pthread_mutex_lock(&pf->lock);
+        double t0 = now_ms();
+        while (n >= pf->produced && n < pf->frames)
+            pthread_cond_wait(&pf->can_take, &pf->lock);
+        pf->stats.consumer_stall_ms += now_ms() - t0;
+        if (n >= pf->frames) {
+            pthread_mutex_unlock(&pf->lock);
+            return NULL;
+        }
+        depth = pf->produced - n;
+        pf->taken = n + 1;
+        pthread_cond_signal(&pf->can_fill);
+        pthread_mutex_unlock(&pf->lock);
+    }
+#endif
+
+    pf->stats.frames++;
+    pf->stats.depth_sum += (unsigned long long)depth;
+    if (depth > pf->stats.depth_max) pf->stats.depth_max = depth;
+    return &pf->slots[n % pf->cap];
+}
+
+void prefetch_release(Prefetcher* pf) {
+#ifndef _WIN32
+    if (pf->threaded) {
+        pthread_mutex_lock(&pf->lock);
+        pf->released++;
+        pthread_cond_signal(&pf->can_fill);
+        pthread_mutex_unlock(&pf->lock);
+        return;
+    }
+#endif
+    pf->released++;
+}
+
+void prefetch_stop(Prefetcher* pf, PrefetchStats* stats) {
+    if (!pf) return;
+#ifndef _WIN32
+    if (pf->threaded) {
+        pthread_mutex_lock(&pf->lock);
+        pf->stop = 1;
+        pthread_cond_signal(&pf->can_fill);
+        pthread_mutex_unlock(&pf->lock);
+        pthread_join(pf->thread, NULL);
+        pthread_cond_destroy(&pf->can_take);
+        pthread_cond_destroy(&pf->can_fill);
+        pthread_mutex_destroy(&pf->lock);
+    }
+#endif
+    if (stats) *stats = pf->stats;
+
+    for (int i = 0; pf->owned && i < pf->cap; ++i)
+        free(pf->owned[i]);
+    free(pf->owned);
+    free(pf->slots);
+    free(pf);
+}
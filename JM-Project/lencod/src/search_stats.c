@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "search_stats.h"
+
+#define HIST_BAR_WIDTH 40
+
+int stats_summary_init(StatsSummary* sum, int blocks_x, int blocks_y) {
+    memset(sum, 0, sizeof(*sum));
+    sum->blocks_x = blocks_x;
+    sum->blocks_y = blocks_y;
+    sum->block_points = (unsigned int*)calloc((size_t)blocks_x * (size_t)blocks_y, sizeof(unsigned int));
+    return sum->block_points != NULL;
+}
+
+void stats_summary_add(StatsSummary* sum, int bx, int by, const SearchStats* st) {
+    sum->block_points[by * sum->blocks_x + bx] = st->points;
+    sum->blocks++;
+    sum->points += st->points;
+    sum->ldsp_points += st->ldsp_points;
+    sum->sdsp_points += st->sdsp_points;
+    sum->iterations += st->iterations;
+    sum->clipped += st->clipped;
+    sum->early_exits += st->early_exit;
+    sum->iter_caps += st->iter_cap;
+
+    unsigned int ib = st->iterations < STATS_ITER_BINS - 1 ? st->iterations : STATS_ITER_BINS - 1;
+    unsigned int pb = st->points / 4 < STATS_POINT_BINS - 1 ? st->points / 4 : STATS_POINT_BINS - 1;
+    sum->iter_hist[ib]++;
+    sum->point_hist[pb]++;
+}
+
+static void print_hist(const unsigned long long* hist, int bins, int bin_width, const char* unit) {
+    unsigned long long peak = 0;
+    for (int i = 0; i < bins; ++i) {
+        if (hist[i] > peak) peak = hist[i];
+    }
+    for (int i = 0; i < bins; ++i) {
+        if (!hist[i]) continue;
+        char range[32];
+        int lo = i * bin_width;
+        if (i == bins - 1) snprintf(range, sizeof(range), "%d+", lo);
+        else if (bin_width == 1) snprintf(range, sizeof(range), "%d", lo);
+        else snprintf(range, sizeof(range), "%d-%d", lo, lo + bin_width - 1);
+        int bar = (int)((hist[i] * HIST_BAR_WIDTH + peak - 1) / peak);
+        printf("    %-6s %-6s %8llu  %.*s\n", range, unit, hist[i], bar,
+               "########################################");
+    }
+}
+
+void stats_summary_print(const StatsSummary* sum, const char* label) {
+    double n = sum->blocks ? (double)sum->blocks : 1.0;
+    printf("[%s stats] Blocks: %llu | Avg iters: %.2f | LDSP points: %llu | SDSP points: %llu | Early exits: %llu (%.2f%%) | Iter cap hits: %llu | Window-clipped candidates: %llu\n",
+           label, sum->blocks, (double)sum->iterations / n, sum->ldsp_points, sum->sdsp_points,
+           sum->early_exits, 100.0 * (double)sum->early_exits / n, sum->iter_caps, sum->clipped);
+    printf("  Iterations per block:\n");
+    print_hist(sum->iter_hist, STATS_ITER_BINS, 1, "iters");
+    printf("  Points per block:\n");
+    print_hist(sum->point_hist, STATS_POINT_BINS, 4, "points");
+}
+
+int stats_write_heatmap(const StatsSummary* sum, const char* path, int block_w, int block_h) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return 0;
+
+    int w = sum->blocks_x * block_w;
+    int h = sum->blocks_y * block_h;
+    unsigned int peak = 1;
+    for (int i = 0; i < sum->blocks_x * sum->blocks_y; ++i) {
+        if (sum->block_points[i] > peak) peak = sum->block_points[i];
+    }
+
+    unsigned char* row = (unsigned char*)malloc((size_t)w);
+    if (!row) {
+        fclose(f);
+        return 0;
+    }
+    fprintf(f, "P5\n# points per block, max %u\n%d %d\n255\n", peak, w, h);
+    int ok = 1;
+    for (int by = 0; by < sum->blocks_y && ok; ++by) {
+        for (int bx = 0; bx < sum->blocks_x; ++bx) {
+            unsigned int v = sum->block_points[by * sum->blocks_x + bx];
+            memset(row + bx * block_w, (int)((v * 255u + peak / 2) / peak), (size_t)block_w);
+        }
+        for (int y = 0; y < block_h && ok; ++y) {
+            ok = fwrite(row, 1, (size_t)w, f) == (size_t)w;
+        }
+    }
+    free(row);
+    fclose(f);
+    return ok;
+}
+
+void stats_summary_free(StatsSummary* sum) {
+    free(sum->block_points);
+    sum->block_points = NULL;
+}
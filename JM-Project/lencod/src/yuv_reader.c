@@ -0,0 +1,133 @@
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE // madvise() / MADV_* under -std=c99
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yuv_reader.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Zero-copy input: the whole file is mapped once and every frame's luma plane is
+// handed out as a Frame that points into the mapping (stride == width).
+// All offsets are 64-bit so multi-GB 4K sequences do not overflow like the old
+// fseek((long)...) path did.
+
+int yuv_reader_open(YUVReader* rd, const char* path, int width, int height) {
+    memset(rd, 0, sizeof(*rd));
+    rd->fd = -1;
+    rd->width = width;
+    rd->height = height;
+    rd->luma_size = (uint64_t)width * (uint64_t)height;
+    rd->frame_size = rd->luma_size + 2 * (rd->luma_size / 4); // YUV420
+
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return 0;
+    }
+    rd->file_size = (uint64_t)st.st_size;
+
+    void* p = mmap(NULL, (size_t)rd->file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+        close(fd);
+        return 0;
+    }
+    // Frames are consumed front to back: let the kernel read ahead aggressively
+    // and drop pages behind us.
+    madvise(p, (size_t)rd->file_size, MADV_SEQUENTIAL);
+
+    rd->fd = fd;
+    rd->base = (uint8_t*)p;
+#else
+    // No mmap on Windows: fall back to reading into two reusable frame buffers,
+    // enough for a reference/current pair.
+    FILE* f = fopen(path, "rb");
+    if (!f) return 0;
+    _fseeki64(f, 0, SEEK_END);
+    rd->file_size = (uint64_t)_ftelli64(f);
+    for (int i = 0; i < 2; ++i) {
+        rd->cache[i] = (uint8_t*)malloc((size_t)rd->luma_size);
+        rd->cache_frame[i] = -1;
+        if (!rd->cache[i]) {
+            free(rd->cache[0]);
+            fclose(f);
+            return 0;
+        }
+    }
+    rd->fp = f;
+#endif
+
+    rd->frames = (int)(rd->file_size / rd->frame_size);
+    return 1;
+}
+
+int yuv_reader_get_luma(YUVReader* rd, int idx, Frame* out) {
+    if (idx < 0 || idx >= rd->frames) return 0;
+
+    uint64_t offset = (uint64_t)idx * rd->frame_size;
+    out->width = rd->width;
+    out->height = rd->height;
+    out->stride = rd->width;
+
+#ifndef _WIN32
+    out->data = rd->base + offset;
+#else
+    for (int i = 0; i < 2; ++i) {
+        if (rd->cache_frame[i] == idx) {
+            out->data = rd->cache[i];
+            return 1;
+        }
+    }
+    int slot = rd->cache_next;
+    FILE* f = (FILE*)rd->fp;
+    rd->cache_frame[slot] = -1;
+    if (_fseeki64(f, (__int64)offset, SEEK_SET) != 0) return 0;
+    if (fread(rd->cache[slot], 1, (size_t)rd->luma_size, f) != (size_t)rd->luma_size) return 0;
+    rd->cache_frame[slot] = idx;
+    rd->cache_next = slot ^ 1;
+    out->data = rd->cache[slot];
+#endif
+    return 1;
+}
+
+// Drop the pages of a frame that will not be touched again, so resident memory
+// stays at a couple of frames no matter how long the sequence is.
+void yuv_reader_release(YUVReader* rd, int idx) {
+#ifndef _WIN32
+    if (idx < 0 || idx >= rd->frames) return;
+
+    uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t start = (uint64_t)idx * rd->frame_size;
+    uint64_t end = start + rd->frame_size;
+    start = (start + page - 1) / page * page; // only whole pages owned by this frame
+    end = end / page * page;
+    if (end > start) madvise(rd->base + start, (size_t)(end - start), MADV_DONTNEED);
+#else
+    (void)rd;
+    (void)idx;
+#endif
+}
+
+void yuv_reader_close(YUVReader* rd) {
+#ifndef _WIN32
+    if (rd->base) munmap(rd->base, (size_t)rd->file_size);
+    if (rd->fd >= 0) close(rd->fd);
+#else
+    free(rd->cache[0]);
+    free(rd->cache[1]);
+    if (rd->fp) fclose((FILE*)rd->fp);
+#endif
+    memset(rd, 0, sizeof(*rd));
+    rd->fd = -1;
+}